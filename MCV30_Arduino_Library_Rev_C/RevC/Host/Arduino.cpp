@@ -0,0 +1,181 @@
+/*---------------------------------------------------
+ * Arduino.cpp
+ * implements the Arduino API of the host build
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include <time.h>
+#include <errno.h>
+
+//--- globals ---
+
+HostConsole Serial(stderr);
+HostConsole Serial1(NULL);
+
+//--- HardwareSerial ---
+
+/*---------------------------------------------------------------------
+ * print()
+ * the numbers are printed as the Arduino does: w/o leading zeros,
+ * negative ones are printed as such for DEC only
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void HardwareSerial::print(const char *Text)
+{
+	write((const uint8_t *)Text, strlen(Text));
+}
+
+void HardwareSerial::print(char c)
+{
+	write((uint8_t)c);
+}
+
+void HardwareSerial::print(char c, int Base)
+{
+	print((int)c, Base);
+}
+
+void HardwareSerial::print(unsigned char Value, int Base)
+{
+	PrintNumber(Value, Base, false);
+}
+
+void HardwareSerial::print(int Value, int Base)
+{
+	print((long)Value, Base);
+}
+
+void HardwareSerial::print(unsigned int Value, int Base)
+{
+	PrintNumber(Value, Base, false);
+}
+
+void HardwareSerial::print(long Value, int Base)
+{
+	if((Base == DEC) && (Value < 0))
+		PrintNumber((unsigned long)(-Value), Base, true);
+	else if(Base == DEC)
+		PrintNumber((unsigned long)Value, Base, false);
+	else
+		PrintNumber((uint32_t)Value, Base, false);
+}
+
+void HardwareSerial::print(unsigned long Value, int Base)
+{
+	PrintNumber(Value, Base, false);
+}
+
+void HardwareSerial::print(double Value, int Digits)
+{
+	char Text[32];
+
+	snprintf(Text, sizeof(Text), "%.*f", Digits, Value);
+	print(Text);
+}
+
+void HardwareSerial::println()
+{
+	write((const uint8_t *)"\r\n", 2);
+}
+
+void HardwareSerial::PrintNumber(unsigned long Value, int Base, bool isNegative)
+{
+	char Text[8 * sizeof(unsigned long) + 2];
+	char *Digit = &Text[sizeof(Text) - 1];
+
+	if((Base < 2) || (Base > 16))
+		Base = DEC;
+
+	*Digit = 0;
+	do
+	{
+		*--Digit = "0123456789ABCDEF"[Value % Base];
+		Value /= Base;
+	} while(Value > 0);
+
+	if(isNegative)
+		*--Digit = '-';
+	print(Digit);
+}
+
+//--- HostConsole ---
+
+HostConsole::HostConsole(FILE *Console)
+{
+	Stream = Console;
+}
+
+size_t HostConsole::write(uint8_t c)
+{
+	if(Stream != NULL)
+		fputc(c, Stream);
+	return 1;
+}
+
+size_t HostConsole::write(const uint8_t *Buffer, size_t Len)
+{
+	if(Stream != NULL)
+		fwrite(Buffer, 1, Len, Stream);
+	return Len;
+}
+
+void HostConsole::flush()
+{
+	if(Stream != NULL)
+		fflush(Stream);
+}
+
+//--- time ---
+
+/*---------------------------------------------------------------------
+ * millis() / micros()
+ * wrap around at 32 bit as on the Arduino, so the wrap-safe compare
+ * of the libraries is used the same way
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static uint64_t MonotonicUs()
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint64_t)Now.tv_sec * 1000000ULL + (uint64_t)(Now.tv_nsec / 1000);
+}
+
+unsigned long millis()
+{
+	return (uint32_t)(MonotonicUs() / 1000);
+}
+
+unsigned long micros()
+{
+	return (uint32_t)MonotonicUs();
+}
+
+void delay(unsigned long ms)
+{
+	struct timespec Wait;
+
+	Wait.tv_sec = ms / 1000;
+	Wait.tv_nsec = (ms % 1000) * 1000000L;
+	while((nanosleep(&Wait, &Wait) != 0) && (errno == EINTR))
+		;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	struct timespec Wait;
+
+	Wait.tv_sec = us / 1000000;
+	Wait.tv_nsec = (us % 1000000) * 1000L;
+	while((nanosleep(&Wait, &Wait) != 0) && (errno == EINTR))
+		;
+}
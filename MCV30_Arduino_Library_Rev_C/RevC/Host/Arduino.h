@@ -0,0 +1,127 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/*--------------------------------------------------------------
+ * Arduino.h
+ * the part of the Arduino API used by the libraries, so they can
+ * be built on a Linux host unchanged.
+ * HardwareSerial is the interface of the serial ports. Serial is the
+ * console and prints to stderr, Serial1 is a dummy port which is
+ * never used as long as every MCUart gets its own port attached.
+ * The time base is CLOCK_MONOTONIC.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+//--- service define ---
+
+typedef uint8_t byte;
+
+#define HEX 16
+#define DEC 10
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define memcpy_P memcpy
+
+#define noInterrupts()
+#define interrupts()
+
+//--- the serial ports ---
+
+class HardwareSerial {
+	public:
+		virtual ~HardwareSerial() {};
+		virtual void begin(unsigned long) = 0;
+		virtual void end() = 0;
+		virtual int available() = 0;
+		virtual int read() = 0;
+		virtual int availableForWrite() = 0;
+		virtual size_t write(uint8_t) = 0;
+		virtual size_t write(const uint8_t *, size_t) = 0;
+		virtual void flush() = 0;
+		virtual operator bool() = 0;
+
+		size_t write(const char *Buffer, size_t Len) {
+			return write((const uint8_t *)Buffer, Len);
+		};
+
+		void print(const char *);
+		void print(char);
+		void print(char, int);
+		void print(unsigned char, int = DEC);
+		void print(int, int = DEC);
+		void print(unsigned int, int = DEC);
+		void print(long, int = DEC);
+		void print(unsigned long, int = DEC);
+		void print(double, int = 2);
+
+		template<typename T> void println(T Value) {
+			print(Value);
+			println();
+		};
+		template<typename T> void println(T Value, int Format) {
+			print(Value, Format);
+			println();
+		};
+		void println();
+
+	private:
+		void PrintNumber(unsigned long, int, bool);
+};
+
+//console on stderr - or a dummy if there is no stream
+
+class HostConsole : public HardwareSerial {
+	public:
+		HostConsole(FILE *);
+		void begin(unsigned long) {};
+		void end() {};
+		int available() {
+			return 0;
+		};
+		int read() {
+			return -1;
+		};
+		int availableForWrite() {
+			return 0;
+		};
+		size_t write(uint8_t);
+		size_t write(const uint8_t *, size_t);
+		void flush();
+		operator bool() {
+			return true;
+		};
+
+		using HardwareSerial::write;
+
+	private:
+		FILE *Stream;
+};
+
+extern HostConsole Serial;
+extern HostConsole Serial1;
+
+//--- time ---
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+
+#endif
@@ -0,0 +1,718 @@
+/*---------------------------------------------------
+ * BusWorker.cpp
+ * implements a serial bus of the host gateway run by
+ * a thread of its own
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <BusWorker.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+//--- local defines ---
+
+#define DEBUG_START		0x0001
+#define DEBUG_ERROR		0x0002
+
+#define DEBUG_BUSWORKER (DEBUG_ERROR)
+
+const int MaxIdleWait = 100;		//ms w/o a deadline
+const uint8_t NodeIdDefault = 1;
+
+typedef enum WorkerFdKinds {
+	eWorkerPort = 1,
+	eWorkerWake = 2
+} WorkerFdKinds;
+
+static uint64_t NowUs()
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint64_t)Now.tv_sec * 1000000ULL + (uint64_t)(Now.tv_nsec / 1000);
+}
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * BusWorker()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+BusWorker::BusWorker()
+{
+	for(uint8_t i = 0; i < DriveBusMaxDrives; i++)
+	{
+		Drive[i].Head = 0;
+		Drive[i].Count = 0;
+		Drive[i].isAccessing = false;
+		Drive[i].Period = 0;
+		Drive[i].ExportPeriod = 0;
+		Drive[i].Exported = 0;
+		memset(&Drive[i].Snapshot, 0, sizeof(DriveSnapshot));
+		Drive[i].isRefreshing = false;
+		Drive[i].Depth.store(0);
+		Drive[i].isLive.store(0);
+	}
+}
+
+BusWorker::~BusWorker()
+{
+	Stop();
+	if(EpollFd >= 0)
+		close(EpollFd);
+	if(WakeFd >= 0)
+		close(WakeFd);
+}
+
+/*---------------------------------------------------------------------
+ * bool Open(char *Arg, uint32_t baud, uint8_t BusIdx, int Notify)
+ * Arg is the device with an optional list of node ids: /dev/ttyUSB0@1,2
+ * The string is kept as the device path.
+ * Notify is the eventfd the IO thread waits at for the events, -1 if
+ * the owner runs the worker by RunOnce() and takes the events itself
+ * returns false if the port can't be opened
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool BusWorker::Open(char *Arg, uint32_t baud, uint8_t BusIdx, int Notify)
+{
+	char *Ids = strchr(Arg, '@');
+
+	if(Ids != NULL)
+		*Ids++ = 0;
+
+	Idx = BusIdx;
+	NotifyFd = Notify;
+	Port.SetDevice(Arg);
+	if(!Port.Open(baud))
+		return false;
+
+	EpollFd = epoll_create1(EPOLL_CLOEXEC);
+	WakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if((EpollFd < 0) || (WakeFd < 0))
+		return false;
+
+	struct epoll_event Event;
+
+	Event.events = EPOLLIN;
+	Event.data.u32 = eWorkerPort;
+	epoll_ctl(EpollFd, EPOLL_CTL_ADD, Port.GetFd(), &Event);
+	Event.data.u32 = eWorkerWake;
+	epoll_ctl(EpollFd, EPOLL_CTL_ADD, WakeFd, &Event);
+
+	Bus.GetMsgHandler()->AttachPort(&Port);
+	Bus.Open(baud);
+
+	do
+	{
+		uint8_t NodeId = NodeIdDefault;
+
+		if(Ids != NULL)
+		{
+			NodeId = (uint8_t)strtoul(Ids, &Ids, 10);
+			if(*Ids == ',')
+				Ids++;
+			else
+				Ids = NULL;
+		}
+
+		if(DriveCount >= DriveBusMaxDrives)
+		{
+			#if(DEBUG_BUSWORKER & DEBUG_ERROR)
+			fprintf(stderr, "Worker: more than %d drives at %s\n", DriveBusMaxDrives, Arg);
+			#endif
+			break;
+		}
+
+		pfunction_holder Cb;
+
+		Cb.callback = BusWorker::OperateCb;
+		Cb.op = (void *)this;
+		Drive[DriveCount].NodeId = NodeId;
+		Bus.AddDrive(&Drive[DriveCount].Drive, NodeId, &Cb);
+		DriveCount++;
+	} while(Ids != NULL);
+
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * bool Start(int Cpu)
+ * run the worker by a thread of its own
+ * Cpu >= 0: pin the thread to this CPU (modulo the CPUs there are)
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool BusWorker::Start(int Cpu)
+{
+	if(pthread_create(&Thread, NULL, BusWorker::RunCb, (void *)this) != 0)
+		return false;
+
+	isThreaded = true;
+
+	if(Cpu >= 0)
+	{
+		cpu_set_t Set;
+		long Cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+		CPU_ZERO(&Set);
+		CPU_SET(Cpu % ((Cpus > 0) ? Cpus : 1), &Set);
+		pthread_setaffinity_np(Thread, sizeof(Set), &Set);
+	}
+
+	#if(DEBUG_BUSWORKER & DEBUG_START)
+	fprintf(stderr, "Worker: %s on CPU %d\n", Port.GetDevice(), Cpu);
+	#endif
+
+	return true;
+}
+
+void BusWorker::Stop()
+{
+	if(!isThreaded)
+		return;
+
+	isStopping.store(true);
+	Wake();
+	pthread_join(Thread, NULL);
+	isThreaded = false;
+}
+
+/*---------------------------------------------------------------------
+ * void AttachExport(ShmTelemetryWriter *Writer, uint32_t First, uint16_t Period)
+ * the drives write their snapshots to the records First.. of the
+ * segment every Period ms - before Start()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void BusWorker::AttachExport(ShmTelemetryWriter *Writer, uint32_t First, uint16_t Period)
+{
+	Export = Writer;
+	ExportFirst = First;
+
+	for(uint8_t i = 0; i < DriveCount; i++)
+	{
+		Drive[i].ExportPeriod = Period;
+		Drive[i].TelemetryAt = millis();
+	}
+	isDirty = true;
+}
+
+/*---------------------------------------------------------------------
+ * int GetFd()
+ * the epoll fd of the worker - readable if RunOnce() has got
+ * something to do
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+int BusWorker::GetFd()
+{
+	return EpollFd;
+}
+
+/*---------------------------------------------------------------------
+ * int GetWaitTime(uint32_t actTime)
+ * ms until the next deadline or telemetry of the bus is due
+ * 0 if the bus is to be updated anyway
+ * to be called by the thread running the worker
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+int BusWorker::GetWaitTime(uint32_t actTime)
+{
+	int Wait = MaxIdleWait;
+	uint32_t Due;
+
+	if(isDirty)
+		return 0;
+
+	if(Bus.GetMsgHandler()->GetDeadlines()->GetNextDue(&Due))
+	{
+		int32_t Left = (int32_t)(Due - actTime);
+
+		if(Left < Wait)
+			Wait = (Left > 0) ? Left : 0;
+	}
+
+	for(uint8_t i = 0; i < DriveCount; i++)
+	{
+		//a batch running goes on by the port or its deadline
+		if((GetPeriod(&Drive[i]) == 0) || Drive[i].isRefreshing || Drive[i].isAccessing)
+			continue;
+
+		int32_t Left = (int32_t)(Drive[i].TelemetryAt - actTime);
+
+		if(Left < Wait)
+			Wait = (Left > 0) ? Left : 0;
+	}
+	return Wait;
+}
+
+/*---------------------------------------------------------------------
+ * void RunOnce(int Wait)
+ * wait up to Wait ms for the port or a wake-up, take the commands
+ * queued and update the bus if there is anything to do for it
+ * The IO thread is notified once if any events have been pushed.
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void BusWorker::RunOnce(int Wait)
+{
+	struct epoll_event Event[2];
+	int Count = epoll_wait(EpollFd, Event, 2, Wait);
+
+	for(int i = 0; i < Count; i++)
+	{
+		if(Event[i].data.u32 == eWorkerPort)
+			OnPortEvent(Event[i].events);
+		else
+		{
+			uint64_t Wakes;
+
+			if(read(WakeFd, &Wakes, sizeof(Wakes)) < 0)
+				Wakes = 0;
+		}
+	}
+
+	BusCommand Command;
+
+	while(Commands.Pop(&Command))
+		Accept(&Command);
+
+	uint32_t actTime = millis();
+	uint32_t Due;
+
+	if(isDirty || (GetWaitTime(actTime) == 0) ||
+	   (Bus.GetMsgHandler()->GetDeadlines()->GetNextDue(&Due) && IsTimeReached(actTime, Due)))
+		Update(actTime);
+
+	if(hasNotified && (NotifyFd >= 0))
+	{
+		uint64_t One = 1;
+
+		hasNotified = false;
+		if(write(NotifyFd, &One, sizeof(One)) < 0)
+			One = 0;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * bool PushCommand(const BusCommand *Command)
+ * any thread - has to call Wake() afterwards if the worker runs
+ * a thread of its own. Several commands may share a single Wake().
+ * returns false if the queue is full
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool BusWorker::PushCommand(const BusCommand *Command)
+{
+	if(Commands.Push(*Command))
+		return true;
+
+	Rejected.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+void BusWorker::Wake()
+{
+	uint64_t One = 1;
+
+	if(write(WakeFd, &One, sizeof(One)) < 0)
+		One = 0;
+}
+
+/*---------------------------------------------------------------------
+ * bool PopEvent(BusEvent *Event)
+ * the IO thread only
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool BusWorker::PopEvent(BusEvent *Event)
+{
+	return Events.Pop(Event);
+}
+
+/*---------------------------------------------------------------------
+ * the drives as seen by any thread
+ * the node ids don't change once opened, the others are a copy
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t BusWorker::GetDriveCount()
+{
+	return DriveCount;
+}
+
+uint8_t BusWorker::GetNodeId(uint8_t DriveIdx)
+{
+	return Drive[DriveIdx].NodeId;
+}
+
+uint8_t BusWorker::GetDepth(uint8_t DriveIdx)
+{
+	return Drive[DriveIdx].Depth.load(std::memory_order_relaxed);
+}
+
+bool BusWorker::IsLive(uint8_t DriveIdx)
+{
+	return Drive[DriveIdx].isLive.load(std::memory_order_relaxed);
+}
+
+const char *BusWorker::GetDevice()
+{
+	return Port.GetDevice();
+}
+
+void BusWorker::GetStats(RpcBusStats *Stats)
+{
+	uint32_t Completed = Done.load(std::memory_order_relaxed) + Failed.load(std::memory_order_relaxed);
+
+	Stats->Bus = Idx;
+	Stats->Drives = DriveCount;
+	Stats->Requests = Requests.load(std::memory_order_relaxed);
+	Stats->Done = Done.load(std::memory_order_relaxed);
+	Stats->Failed = Failed.load(std::memory_order_relaxed);
+	Stats->Rejected = Rejected.load(std::memory_order_relaxed);
+	Stats->Objects = Objects.load(std::memory_order_relaxed);
+	Stats->RxBytes = RxBytes.load(std::memory_order_relaxed);
+	Stats->TxBytes = TxBytes.load(std::memory_order_relaxed);
+	Stats->LatencyAvg = Completed ? (uint32_t)(LatencySum.load(std::memory_order_relaxed) / Completed) : 0;
+	Stats->LatencyMax = LatencyMax.load(std::memory_order_relaxed);
+	Stats->Telemetry = Telemetry.load(std::memory_order_relaxed);
+	Stats->TelemetryDropped = TelemetryDropped.load(std::memory_order_relaxed);
+}
+
+//--- private functions ---
+
+void BusWorker::Run()
+{
+	while(!isStopping.load(std::memory_order_relaxed))
+		RunOnce(GetWaitTime(millis()));
+}
+
+/*---------------------------------------------------------------------
+ * void Accept(BusCommand *Command)
+ * a command taken from the queue goes to the queue of its drive or
+ * is answered right away
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void BusWorker::Accept(BusCommand *Command)
+{
+	uint8_t DriveIdx;
+
+	for(DriveIdx = 0; DriveIdx < DriveCount; DriveIdx++)
+		if(Drive[DriveIdx].NodeId == Command->Node)
+			break;
+
+	if(DriveIdx >= DriveCount)
+	{
+		Respond(Command, DriveIdx, eRpcUnknownDrive, Command->Op, NULL, 0);
+		return;
+	}
+
+	HostDrive *ThisDrive = &Drive[DriveIdx];
+
+	if(Command->Op == eRpcSubscribe)
+	{
+		ThisDrive->Period = Command->Period;
+		ThisDrive->TelemetryAt = millis();
+		isDirty = true;
+		Respond(Command, DriveIdx, eRpcOk, eRpcSubscribe, NULL, 0);
+		return;
+	}
+
+	if(ThisDrive->Count >= HOSTGW_QUEUE_SIZE)
+	{
+		Rejected.fetch_add(1, std::memory_order_relaxed);
+		Respond(Command, DriveIdx, eRpcQueueFull, Command->Op, NULL, 0);
+		return;
+	}
+
+	ThisDrive->Queue[(ThisDrive->Head + ThisDrive->Count) % HOSTGW_QUEUE_SIZE] = *Command;
+	ThisDrive->Count++;
+	ThisDrive->Depth.store(ThisDrive->Count, std::memory_order_relaxed);
+	Requests.fetch_add(1, std::memory_order_relaxed);
+	isDirty = true;
+}
+
+void BusWorker::Respond(const BusCommand *Command, uint8_t DriveIdx, uint8_t Status, uint8_t Op, const RpcObject *List, uint8_t Count)
+{
+	BusEvent Event;
+
+	Event.Op = Op;
+	Event.Client = Command->Client;
+	Event.Generation = Command->Generation;
+	Event.Seq = Command->Seq;
+	Event.Node = Command->Node;
+	Event.DriveIdx = DriveIdx;
+	Event.Status = Status;
+	Event.Count = Count;
+	if(Count > 0)
+		memcpy(Event.List, List, Count * sizeof(RpcObject));
+
+	//can't fail by the reserve kept free
+	if(!Events.Push(Event))
+	{
+		#if(DEBUG_BUSWORKER & DEBUG_ERROR)
+		fprintf(stderr, "Worker: event ring of %s full\n", Port.GetDevice());
+		#endif
+	}
+	hasNotified = true;
+}
+
+/*---------------------------------------------------------------------
+ * void *Operate(MCDrive *ThisMCDrive)
+ * called by the DriveBus for every drive while it's updated
+ * runs the oldest request as a batch and answers it when done. The
+ * snapshot for the telemetry is read in between the requests.
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void *BusWorker::Operate(MCDrive *ThisMCDrive)
+{
+	uint8_t DriveIdx;
+
+	for(DriveIdx = 0; DriveIdx < DriveCount; DriveIdx++)
+		if(&Drive[DriveIdx].Drive == ThisMCDrive)
+			break;
+
+	if(DriveIdx >= DriveCount)
+		return NULL;
+
+	HostDrive *ThisDrive = &Drive[DriveIdx];
+
+	if(RunTelemetry(ThisDrive, DriveIdx))
+		return NULL;
+
+	if(ThisDrive->Count == 0)
+		return NULL;
+
+	BusCommand *Command = &ThisDrive->Queue[ThisDrive->Head];
+	DriveCommStates State = ThisDrive->Drive.AccessObjects(Command->List, Command->Count);
+
+	if((State == eMCDone) || (State == eMCError) || (State == eMCTimeout))
+		Complete(ThisDrive, DriveIdx, State);
+	else
+		ThisDrive->isAccessing = true;
+
+	return NULL;
+}
+
+void BusWorker::Complete(HostDrive *ThisDrive, uint8_t DriveIdx, DriveCommStates State)
+{
+	BusCommand *Command = &ThisDrive->Queue[ThisDrive->Head];
+	RpcObject List[RpcMaxObjects];
+	uint8_t Status = eRpcOk;
+
+	for(uint8_t i = 0; i < Command->Count; i++)
+	{
+		List[i].Idx = Command->List[i].Idx;
+		List[i].SubIdx = Command->List[i].SubIdx;
+		List[i].Len = Command->List[i].Len;
+		List[i].Value = Command->List[i].Value;
+		List[i].isFailed = Command->List[i].isFailed;
+		if(Command->List[i].isFailed)
+			Status = eRpcFailed;
+	}
+	if(State == eMCError)
+		Status = eRpcFailed;
+	else if(State == eMCTimeout)
+		Status = eRpcTimeout;
+
+	uint32_t Latency = (uint32_t)(NowUs() - Command->ReceivedAt);
+
+	LatencySum.fetch_add(Latency, std::memory_order_relaxed);
+	if(Latency > LatencyMax.load(std::memory_order_relaxed))
+		LatencyMax.store(Latency, std::memory_order_relaxed);
+	if(Status == eRpcOk)
+		Done.fetch_add(1, std::memory_order_relaxed);
+	else
+		Failed.fetch_add(1, std::memory_order_relaxed);
+	Objects.fetch_add(Command->Count, std::memory_order_relaxed);
+
+	Respond(Command, DriveIdx, Status, eRpcAccess, List, Command->Count);
+
+	ThisDrive->Head = (ThisDrive->Head + 1) % HOSTGW_QUEUE_SIZE;
+	ThisDrive->Count--;
+	ThisDrive->isAccessing = false;
+	ThisDrive->Depth.store(ThisDrive->Count, std::memory_order_relaxed);
+	ThisDrive->isLive.store(ThisDrive->Drive.IsLive(), std::memory_order_relaxed);
+	//the next one is started in the next update
+	isDirty = true;
+}
+
+//the shorter of the periods set - 0 if there is none
+
+uint16_t BusWorker::GetPeriod(HostDrive *ThisDrive)
+{
+	if((ThisDrive->Period == 0) || ((ThisDrive->ExportPeriod != 0) && (ThisDrive->ExportPeriod < ThisDrive->Period)))
+		return ThisDrive->ExportPeriod;
+
+	return ThisDrive->Period;
+}
+
+/*---------------------------------------------------------------------
+ * bool RunTelemetry(HostDrive *ThisDrive, uint8_t DriveIdx)
+ * read the snapshot of the drive if it's due. It goes to the record
+ * of the export and - if subscribed - as an event to the IO thread
+ * if there is room beyond the reserve of the responses.
+ * returns true while the snapshot is being read
+ *
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW shared memory export
+ *--------------------------------------------------------------------*/
+
+bool BusWorker::RunTelemetry(HostDrive *ThisDrive, uint8_t DriveIdx)
+{
+	uint32_t actTime = millis();
+
+	if(!ThisDrive->isRefreshing)
+	{
+		//a request which is running already is finished first
+		uint16_t Period = GetPeriod(ThisDrive);
+
+		if((Period == 0) || ThisDrive->isAccessing ||
+		   !IsTimeReached(actTime, ThisDrive->TelemetryAt))
+			return false;
+
+		ThisDrive->isRefreshing = true;
+		ThisDrive->TelemetryAt = actTime + Period;
+	}
+
+	DriveCommStates State = ThisDrive->Drive.RefreshAll(&ThisDrive->Snapshot);
+
+	if(State == eMCWaiting)
+		return true;
+
+	ThisDrive->isRefreshing = false;
+	ThisDrive->isLive.store(ThisDrive->Drive.IsLive(), std::memory_order_relaxed);
+	isDirty = true;
+
+	//a drive which has failed keeps its last snapshot with isLive cleared
+	if(Export != NULL)
+		ExportSnapshot(ThisDrive, DriveIdx, State == eMCDone);
+
+	if((State != eMCDone) || (ThisDrive->Period == 0))
+		return false;
+
+	if(Events.GetFree() <= BusEventReserve)
+	{
+		TelemetryDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	BusEvent Event;
+	DriveSnapshot *Snapshot = &ThisDrive->Snapshot;
+
+	Event.Op = eRpcTelemetry;
+	Event.Client = 0;
+	Event.Generation = 0;
+	Event.Seq = 0;
+	Event.Node = ThisDrive->NodeId;
+	Event.DriveIdx = DriveIdx;
+	Event.Status = eRpcOk;
+	Event.Count = 0;
+	Event.Telemetry.StatusWord = Snapshot->StatusWord;
+	Event.Telemetry.OpMode = Snapshot->OpMode;
+	Event.Telemetry.Position = Snapshot->Position;
+	Event.Telemetry.Speed = Snapshot->Speed;
+	Event.Telemetry.MotorTemp = Snapshot->MotorTemp;
+	Event.Telemetry.DriveErrors = Snapshot->DriveErrors;
+	Event.Telemetry.TimeStamp = Snapshot->TimeStamp;
+
+	Events.Push(Event);
+	Telemetry.fetch_add(1, std::memory_order_relaxed);
+	hasNotified = true;
+
+	return false;
+}
+
+void BusWorker::ExportSnapshot(HostDrive *ThisDrive, uint8_t DriveIdx, bool isRead)
+{
+	ShmDriveImage Image;
+	DriveSnapshot *Snapshot = &ThisDrive->Snapshot;
+
+	Image.Bus = Idx;
+	Image.Node = ThisDrive->NodeId;
+	Image.isLive = isRead;
+	Image.OpMode = Snapshot->OpMode;
+	Image.StatusWord = Snapshot->StatusWord;
+	Image.DriveErrors = Snapshot->DriveErrors;
+	Image.Position = Snapshot->Position;
+	Image.Speed = Snapshot->Speed;
+	Image.MotorTemp = Snapshot->MotorTemp;
+	Image.Reserved = 0;
+	Image.TimeStamp = Snapshot->TimeStamp;
+	Image.Updates = ++ThisDrive->Exported;
+
+	Export->Write(ExportFirst + DriveIdx, &Image);
+}
+
+void BusWorker::OnPortEvent(uint32_t PortEvents)
+{
+	if(PortEvents & EPOLLIN)
+	{
+		if(Port.Fill() < 0)
+			PortEvents |= EPOLLHUP;
+	}
+	if(PortEvents & EPOLLOUT)
+		Port.FlushTx();
+
+	if((PortEvents & (EPOLLHUP | EPOLLERR)) && !isLost)
+	{
+		//a pty w/o its master or an adapter unplugged
+		//the requests run into their time-out
+		#if(DEBUG_BUSWORKER & DEBUG_ERROR)
+		fprintf(stderr, "Worker: lost %s\n", Port.GetDevice());
+		#endif
+		epoll_ctl(EpollFd, EPOLL_CTL_DEL, Port.GetFd(), NULL);
+		isLost = true;
+	}
+	isDirty = true;
+}
+
+void BusWorker::Update(uint32_t actTime)
+{
+	isDirty = false;
+	Bus.Update(actTime);
+
+	RxBytes.store(Port.GetRxBytes(), std::memory_order_relaxed);
+	TxBytes.store(Port.GetTxBytes(), std::memory_order_relaxed);
+
+	if(isLost)
+		return;
+
+	bool isWaiting = Port.HasTxPending();
+
+	if(isWaiting != isWatchingOut)
+	{
+		struct epoll_event Event;
+
+		Event.events = isWaiting ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+		Event.data.u32 = eWorkerPort;
+		epoll_ctl(EpollFd, EPOLL_CTL_MOD, Port.GetFd(), &Event);
+		isWatchingOut = isWaiting;
+	}
+}
@@ -0,0 +1,184 @@
+#ifndef BUS_WORKER_H
+#define BUS_WORKER_H
+
+/*--------------------------------------------------------------
+ * class BusWorker
+ * a serial bus of the host gateway with everything it owns: the
+ * PosixSerial, the DriveBus with its MsgHandler and the drives.
+ * All of it is touched by the thread running the worker only.
+ * The other threads talk to it by two queues:
+ * - Commands: a MPSC queue of the requests from any thread
+ * - Events: a SPSC ring of the responses and telemetry records to
+ *   the single IO thread, which is woken by the Notify eventfd
+ * The worker has got its own epoll for the port and its wake-up
+ * eventfd. Either Start() runs it by a thread of its own - pinned to
+ * a CPU if asked to - or the owner calls RunOnce() when the epoll fd
+ * of the worker is readable, all in one thread as before.
+ * If a telemetry segment is attached, the worker writes the snapshot
+ * of each drive into its record in place - read at the period of the
+ * export or of a subscription, whichever is shorter.
+ *
+ * 2026-10-18 AW Frame
+ * 2026-10-18 AW shared memory export
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <Arduino.h>
+#include <PosixSerial.h>
+#include <LockFreeQueue.h>
+#include <HostRpc.h>
+#include <ShmTelemetry.h>
+#include <DriveBus.h>
+#include <MCDrive.h>
+#include <pthread.h>
+#include <atomic>
+#include <stdint.h>
+
+//--- service define ---
+
+//requests waiting per drive
+#ifndef HOSTGW_QUEUE_SIZE
+#define HOSTGW_QUEUE_SIZE 8
+#endif
+
+const uint32_t BusCommandQueueSize = 64;
+const uint32_t BusEventRingSize = 512;
+
+//a response is never dropped: there is room for one of every
+//command which can be in the worker - telemetry is dropped before
+const uint32_t BusEventReserve = BusCommandQueueSize + DriveBusMaxDrives * HOSTGW_QUEUE_SIZE;
+
+static_assert(BusEventRingSize > 2 * BusEventReserve, "the event ring is too small");
+
+typedef struct BusCommand {
+	uint8_t Op;					//eRpcAccess or eRpcSubscribe
+	uint8_t Client;
+	uint16_t Generation;		//of the client - it might be gone
+	uint16_t Seq;
+	uint8_t Node;
+	uint8_t Count;
+	uint16_t Period;
+	SDOBatchEntry List[RpcMaxObjects];
+	uint64_t ReceivedAt;
+} BusCommand;
+
+typedef struct BusEvent {
+	uint8_t Op;					//of the request or eRpcTelemetry
+	uint8_t Client;
+	uint16_t Generation;
+	uint16_t Seq;
+	uint8_t Node;
+	uint8_t DriveIdx;
+	uint8_t Status;
+	uint8_t Count;
+	union {
+		RpcObject List[RpcMaxObjects];
+		RpcTelemetry Telemetry;
+	};
+} BusEvent;
+
+typedef struct HostDrive {
+	MCDrive Drive;
+	uint8_t NodeId;
+	BusCommand Queue[HOSTGW_QUEUE_SIZE];
+	uint8_t Head;
+	uint8_t Count;
+	bool isAccessing;			//the batch of Queue[Head] is running
+
+	uint16_t Period;			//of the subscription
+	uint16_t ExportPeriod;
+	uint32_t TelemetryAt;
+	uint32_t Exported;
+	bool isRefreshing;
+	DriveSnapshot Snapshot;
+
+	std::atomic<uint8_t> Depth;		//as seen by the other threads
+	std::atomic<uint8_t> isLive;
+} HostDrive;
+
+class BusWorker {
+	public:
+		BusWorker();
+		~BusWorker();
+		bool Open(char *, uint32_t, uint8_t, int);
+		bool Start(int);
+		void Stop();
+		void AttachExport(ShmTelemetryWriter *, uint32_t, uint16_t);
+
+		int GetFd();
+		int GetWaitTime(uint32_t);
+		void RunOnce(int);
+
+		bool PushCommand(const BusCommand *);
+		void Wake();
+		bool PopEvent(BusEvent *);
+
+		uint8_t GetDriveCount();
+		uint8_t GetNodeId(uint8_t);
+		uint8_t GetDepth(uint8_t);
+		bool IsLive(uint8_t);
+		const char *GetDevice();
+		void GetStats(RpcBusStats *);
+
+		static void *OperateCb(void *op, void *p) {
+			return ((BusWorker *)op)->Operate((MCDrive *)p);
+		};
+
+		static void *RunCb(void *op) {
+			((BusWorker *)op)->Run();
+			return NULL;
+		};
+
+	private:
+		void Run();
+		void *Operate(MCDrive *);
+		void Accept(BusCommand *);
+		void Respond(const BusCommand *, uint8_t, uint8_t, uint8_t, const RpcObject *, uint8_t);
+		void Complete(HostDrive *, uint8_t, DriveCommStates);
+		bool RunTelemetry(HostDrive *, uint8_t);
+		uint16_t GetPeriod(HostDrive *);
+		void ExportSnapshot(HostDrive *, uint8_t, bool);
+		void OnPortEvent(uint32_t);
+		void Update(uint32_t);
+
+		uint8_t Idx = 0;
+		PosixSerial Port;
+		DriveBus Bus;
+		HostDrive Drive[DriveBusMaxDrives];
+		uint8_t DriveCount = 0;
+
+		int EpollFd = -1;
+		int WakeFd = -1;
+		int NotifyFd = -1;
+		bool isDirty = false;
+		bool isLost = false;
+		bool isWatchingOut = false;
+		bool hasNotified = false;
+
+		ShmTelemetryWriter *Export = NULL;
+		uint32_t ExportFirst = 0;			//record of the first drive
+
+		pthread_t Thread;
+		bool isThreaded = false;
+		std::atomic<bool> isStopping {false};
+
+		MpscQueue<BusCommand, BusCommandQueueSize> Commands;
+		SpscRing<BusEvent, BusEventRingSize> Events;
+
+		//written by the worker, read by any thread
+		std::atomic<uint32_t> Requests {0};
+		std::atomic<uint32_t> Done {0};
+		std::atomic<uint32_t> Failed {0};
+		std::atomic<uint32_t> Rejected {0};
+		std::atomic<uint32_t> Objects {0};
+		std::atomic<uint64_t> LatencySum {0};
+		std::atomic<uint32_t> LatencyMax {0};
+		std::atomic<uint32_t> Telemetry {0};
+		std::atomic<uint32_t> TelemetryDropped {0};
+		std::atomic<uint32_t> RxBytes {0};
+		std::atomic<uint32_t> TxBytes {0};
+};
+
+#endif
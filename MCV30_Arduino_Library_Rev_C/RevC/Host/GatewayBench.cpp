@@ -0,0 +1,459 @@
+/*--------------------------------------------------------------
+ * GatewayBench.cpp
+ * client of the HostGateway to check it and to measure its
+ * throughput per bus and in aggregate.
+ * First every drive is checked once: an object is written and read
+ * back and an object which doesn't exist has to be rejected.
+ * Then every drive gets a number of read requests in flight which
+ * are renewed as soon as they are answered until the time is up.
+ * The position 0x6064 has to grow with every read at SimDrive, so
+ * a response out of order is counted as such.
+ * The latency of every request is kept for its percentiles. With -p
+ * every drive sends its telemetry at this period in ms meanwhile.
+ * -q prints a single line of the totals, e.g. for a table of runs.
+ *
+ * usage:
+ *   GatewayBench [-s socket] [-t seconds] [-w in flight] [-o objects] [-p period] [-q]
+ *
+ * 2026-10-18 AW Frame
+ * 2026-10-18 AW percentiles, telemetry, -q
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <HostRpc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <algorithm>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+//--- local defines ---
+
+const uint16_t BenchMaxDrives = 1024;
+const uint16_t BenchMaxBuses = 256;
+const uint32_t BenchMaxSamples = 1 << 22;		//latencies kept for the percentiles
+
+const char SocketDefault[] = "/tmp/mcgateway.sock";
+
+//objects read per request - the first is the position
+static const uint16_t BenchObjects[RpcMaxObjects] = {
+	0x6064, 0x6041, 0x6081, 0x6083, 0x6084, 0x606C, 0x6060, 0x6061
+};
+
+typedef struct BenchDrive {
+	uint8_t Bus;
+	uint8_t Node;
+	uint8_t InFlight;
+	bool hasPosition;
+	uint32_t Position;
+} BenchDrive;
+
+typedef struct BenchBus {
+	uint16_t Drives;
+	uint32_t Done;
+	uint32_t Failed;
+	uint32_t Objects;
+	uint32_t OutOfOrder;
+	uint64_t LatencySum;
+	uint32_t LatencyMax;
+} BenchBus;
+
+//--- globals ---
+
+static int Fd = -1;
+static BenchDrive Drives[BenchMaxDrives];
+static uint16_t DriveCount = 0;
+static BenchBus Buses[BenchMaxBuses];
+static uint16_t BusCount = 0;
+static uint64_t SentAt[65536];
+static uint16_t NextSeq = 0;
+static uint32_t Samples[BenchMaxSamples];
+static uint32_t SampleCount = 0;
+static uint32_t Telemetry = 0;
+
+static uint8_t Rx[sizeof(RpcHdr) + 8192];
+static uint32_t RxLen = 0;
+
+//--- implementation ---
+
+static uint64_t NowUs()
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint64_t)Now.tv_sec * 1000000ULL + (uint64_t)(Now.tv_nsec / 1000);
+}
+
+static bool Send(uint8_t Op, uint8_t Bus, uint8_t Node, const void *Payload, uint16_t Len)
+{
+	uint8_t Frame[sizeof(RpcHdr) + RpcMaxObjects * sizeof(RpcObject)];
+	RpcHdr Hdr;
+
+	Hdr.Len = Len;
+	Hdr.Seq = NextSeq++;
+	Hdr.Op = Op;
+	Hdr.Bus = Bus;
+	Hdr.Node = Node;
+	Hdr.Status = 0;
+	memcpy(Frame, &Hdr, sizeof(RpcHdr));
+	memcpy(&Frame[sizeof(RpcHdr)], Payload, Len);
+
+	SentAt[Hdr.Seq] = NowUs();
+	return (send(Fd, Frame, sizeof(RpcHdr) + Len, MSG_NOSIGNAL) == (ssize_t)(sizeof(RpcHdr) + Len));
+}
+
+/*---------------------------------------------------------------------
+ * bool Receive(RpcHdr *Hdr, uint8_t *Payload, int Wait)
+ * the next response - waits up to Wait ms for it
+ * returns false if there is none
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static bool Receive(RpcHdr *Hdr, uint8_t *Payload, int Wait)
+{
+	for(;;)
+	{
+		if(RxLen >= sizeof(RpcHdr))
+		{
+			memcpy(Hdr, Rx, sizeof(RpcHdr));
+			if(RxLen >= sizeof(RpcHdr) + Hdr->Len)
+			{
+				memcpy(Payload, &Rx[sizeof(RpcHdr)], Hdr->Len);
+				RxLen -= sizeof(RpcHdr) + Hdr->Len;
+				memmove(Rx, &Rx[sizeof(RpcHdr) + Hdr->Len], RxLen);
+				return true;
+			}
+		}
+
+		struct pollfd In = {Fd, POLLIN, 0};
+
+		if(poll(&In, 1, Wait) <= 0)
+			return false;
+
+		ssize_t Len = recv(Fd, &Rx[RxLen], sizeof(Rx) - RxLen, 0);
+
+		if(Len <= 0)
+		{
+			fprintf(stderr, "Bench: gateway closed the connection\n");
+			exit(1);
+		}
+		RxLen += Len;
+	}
+}
+
+static bool SendRead(BenchDrive *Drive, uint8_t Objects)
+{
+	RpcObject List[RpcMaxObjects];
+
+	for(uint8_t i = 0; i < Objects; i++)
+	{
+		List[i].Idx = BenchObjects[i];
+		List[i].SubIdx = 0;
+		List[i].Len = 0;
+		List[i].Value = 0;
+		List[i].isFailed = 0;
+	}
+	Drive->InFlight++;
+	return Send(eRpcAccess, Drive->Bus, Drive->Node, List, Objects * sizeof(RpcObject));
+}
+
+static BenchDrive *FindDrive(uint8_t Bus, uint8_t Node)
+{
+	for(uint16_t i = 0; i < DriveCount; i++)
+		if((Drives[i].Bus == Bus) && (Drives[i].Node == Node))
+			return &Drives[i];
+
+	return NULL;
+}
+
+//a single request which is waited for
+
+static uint8_t Call(uint8_t Bus, uint8_t Node, RpcObject *List, uint8_t Count)
+{
+	RpcHdr Hdr;
+
+	Send(eRpcAccess, Bus, Node, List, Count * sizeof(RpcObject));
+	if(!Receive(&Hdr, (uint8_t *)List, 1000))
+		return eRpcTimeout;
+	return Hdr.Status;
+}
+
+//telemetry of the drive at this period, 0 to stop - not waited for
+
+static bool Subscribe(BenchDrive *Drive, uint16_t Period)
+{
+	return Send(eRpcSubscribe, Drive->Bus, Drive->Node, &Period, sizeof(Period));
+}
+
+//the latency below which the share Part of the requests have been answered
+
+static uint32_t GetPercentile(double Part)
+{
+	if(SampleCount == 0)
+		return 0;
+
+	uint32_t Rank = (uint32_t)(Part * (SampleCount - 1) + 0.5);
+
+	std::nth_element(Samples, Samples + Rank, Samples + SampleCount);
+	return Samples[Rank];
+}
+
+/*---------------------------------------------------------------------
+ * bool CheckDrive(BenchDrive *Drive)
+ * write 0x607A, read it back and read an object which doesn't exist
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static bool CheckDrive(BenchDrive *Drive)
+{
+	RpcObject List[2];
+	uint32_t Value = 0x12340000 | (Drive->Bus << 8) | Drive->Node;
+
+	memset(List, 0, sizeof(List));
+	List[0].Idx = 0x607A;
+	List[0].Len = 4;
+	List[0].Value = Value;
+	if(Call(Drive->Bus, Drive->Node, List, 1) != eRpcOk)
+		return false;
+
+	memset(List, 0, sizeof(List));
+	List[0].Idx = 0x607A;
+	List[1].Idx = 0x5FFF;
+	if(Call(Drive->Bus, Drive->Node, List, 2) != eRpcFailed)
+		return false;
+
+	return ((List[0].Value == Value) && !List[0].isFailed && List[1].isFailed);
+}
+
+int main(int argc, char **argv)
+{
+	const char *SocketPath = SocketDefault;
+	uint32_t Duration = 5;
+	uint8_t Window = 4;
+	uint8_t Objects = 1;
+	uint16_t Period = 0;
+	bool isQuiet = false;
+	int Opt;
+
+	while((Opt = getopt(argc, argv, "s:t:w:o:p:q")) != -1)
+	{
+		switch(Opt)
+		{
+			case 's':
+				SocketPath = optarg;
+				break;
+			case 't':
+				Duration = strtoul(optarg, NULL, 10);
+				break;
+			case 'w':
+				Window = atoi(optarg);
+				break;
+			case 'o':
+				Objects = atoi(optarg);
+				break;
+			case 'p':
+				Period = atoi(optarg);
+				break;
+			case 'q':
+				isQuiet = true;
+				break;
+			default:
+				fprintf(stderr, "usage: GatewayBench [-s socket] [-t seconds] [-w in flight] [-o objects] [-p period] [-q]\n");
+				return 1;
+		}
+	}
+	if((Objects == 0) || (Objects > RpcMaxObjects) || (Window == 0))
+	{
+		fprintf(stderr, "Bench: 1..%u objects, at least 1 in flight\n", RpcMaxObjects);
+		return 1;
+	}
+
+	struct sockaddr_un Addr;
+
+	memset(&Addr, 0, sizeof(Addr));
+	Addr.sun_family = AF_UNIX;
+	strncpy(Addr.sun_path, SocketPath, sizeof(Addr.sun_path) - 1);
+	Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(connect(Fd, (struct sockaddr *)&Addr, sizeof(Addr)) != 0)
+	{
+		fprintf(stderr, "Bench: can't connect to %s: %s\n", SocketPath, strerror(errno));
+		return 1;
+	}
+
+	//--- the drives ---
+
+	RpcHdr Hdr;
+	uint8_t Payload[8192];
+
+	Send(eRpcListDrives, 0, 0, NULL, 0);
+	if(!Receive(&Hdr, Payload, 1000))
+	{
+		fprintf(stderr, "Bench: no response\n");
+		return 1;
+	}
+	for(uint16_t i = 0; (i < Hdr.Len / sizeof(RpcDriveInfo)) && (DriveCount < BenchMaxDrives); i++)
+	{
+		RpcDriveInfo Info;
+
+		memcpy(&Info, &Payload[i * sizeof(RpcDriveInfo)], sizeof(RpcDriveInfo));
+		memset(&Drives[DriveCount], 0, sizeof(BenchDrive));
+		Drives[DriveCount].Bus = Info.Bus;
+		Drives[DriveCount].Node = Info.Node;
+		DriveCount++;
+		if(Info.Bus < BenchMaxBuses)
+		{
+			Buses[Info.Bus].Drives++;
+			if(Info.Bus >= BusCount)
+				BusCount = Info.Bus + 1;
+		}
+	}
+
+	uint16_t Checked = 0;
+
+	for(uint16_t i = 0; i < DriveCount; i++)
+	{
+		if(CheckDrive(&Drives[i]))
+			Checked++;
+		else
+			fprintf(stderr, "Bench: check of drive %u.%u failed\n", Drives[i].Bus, Drives[i].Node);
+	}
+	if(!isQuiet)
+		printf("%u buses, %u drives, %u checked ok\n", BusCount, DriveCount, Checked);
+
+	//--- the load ---
+
+	if(Period > 0)
+		for(uint16_t i = 0; i < DriveCount; i++)
+			Subscribe(&Drives[i], Period);
+
+	uint64_t StartedAt = NowUs();
+	uint64_t EndAt = StartedAt + (uint64_t)Duration * 1000000ULL;
+	uint32_t InFlight = 0;
+
+	for(uint16_t i = 0; i < DriveCount; i++)
+		for(uint8_t w = 0; w < Window; w++)
+			if(SendRead(&Drives[i], Objects))
+				InFlight++;
+
+	while(InFlight > 0)
+	{
+		if(!Receive(&Hdr, Payload, 2000))
+		{
+			fprintf(stderr, "Bench: %u requests lost\n", InFlight);
+			break;
+		}
+		if(Hdr.Op == eRpcTelemetry)
+		{
+			if(NowUs() < EndAt)
+				Telemetry++;
+			continue;
+		}
+		if(Hdr.Op != eRpcAccess)
+			continue;
+
+		BenchDrive *Drive = FindDrive(Hdr.Bus, Hdr.Node);
+
+		if((Drive == NULL) || (Hdr.Bus >= BenchMaxBuses))
+			continue;
+
+		BenchBus *Bus = &Buses[Hdr.Bus];
+		uint32_t Latency = (uint32_t)(NowUs() - SentAt[Hdr.Seq]);
+
+		InFlight--;
+		Drive->InFlight--;
+		Bus->LatencySum += Latency;
+		if(Latency > Bus->LatencyMax)
+			Bus->LatencyMax = Latency;
+		if(SampleCount < BenchMaxSamples)
+			Samples[SampleCount++] = Latency;
+
+		if(Hdr.Status == eRpcOk)
+		{
+			RpcObject First;
+
+			memcpy(&First, Payload, sizeof(RpcObject));
+			if(Drive->hasPosition && ((int32_t)(First.Value - Drive->Position) <= 0))
+				Bus->OutOfOrder++;
+			Drive->Position = First.Value;
+			Drive->hasPosition = true;
+			Bus->Done++;
+			Bus->Objects += Hdr.Len / sizeof(RpcObject);
+		}
+		else
+			Bus->Failed++;
+
+		if(NowUs() < EndAt)
+		{
+			if(SendRead(Drive, Objects))
+				InFlight++;
+		}
+	}
+
+	double Seconds = (NowUs() - StartedAt) / 1e6;
+
+	if(Period > 0)
+		for(uint16_t i = 0; i < DriveCount; i++)
+			Subscribe(&Drives[i], 0);
+
+	//--- the results ---
+
+	BenchBus Total;
+
+	memset(&Total, 0, sizeof(Total));
+	if(!isQuiet)
+		printf("bus  drives    req/s    obj/s  failed  order  avg us  max us\n");
+	for(uint16_t b = 0; b < BusCount; b++)
+	{
+		BenchBus *Bus = &Buses[b];
+		uint32_t Completed = Bus->Done + Bus->Failed;
+
+		if(!isQuiet)
+			printf("%3u  %6u  %7.0f  %7.0f  %6u  %5u  %6u  %6u\n", b, Bus->Drives,
+		       Bus->Done / Seconds, Bus->Objects / Seconds, Bus->Failed, Bus->OutOfOrder,
+		       Completed ? (uint32_t)(Bus->LatencySum / Completed) : 0, Bus->LatencyMax);
+
+		Total.Drives += Bus->Drives;
+		Total.Done += Bus->Done;
+		Total.Failed += Bus->Failed;
+		Total.Objects += Bus->Objects;
+		Total.OutOfOrder += Bus->OutOfOrder;
+		Total.LatencySum += Bus->LatencySum;
+		if(Bus->LatencyMax > Total.LatencyMax)
+			Total.LatencyMax = Bus->LatencyMax;
+	}
+
+	uint32_t Completed = Total.Done + Total.Failed;
+	uint32_t P50 = GetPercentile(0.5);
+	uint32_t P99 = GetPercentile(0.99);
+	uint32_t P999 = GetPercentile(0.999);
+
+	if(isQuiet)
+	{
+		//buses drives req/s obj/s p50 p99 p99.9 max telemetry/s failed order
+		printf("%5u  %6u  %7.0f  %7.0f  %6u  %6u  %6u  %6u  %7.0f  %6u  %5u\n", BusCount, Total.Drives,
+		       Total.Done / Seconds, Total.Objects / Seconds, P50, P99, P999, Total.LatencyMax,
+		       Telemetry / Seconds, Total.Failed, Total.OutOfOrder);
+	}
+	else
+	{
+		printf("all  %6u  %7.0f  %7.0f  %6u  %5u  %6u  %6u\n", Total.Drives,
+		       Total.Done / Seconds, Total.Objects / Seconds, Total.Failed, Total.OutOfOrder,
+		       Completed ? (uint32_t)(Total.LatencySum / Completed) : 0, Total.LatencyMax);
+		printf("latency us: p50 %u  p99 %u  p99.9 %u\n", P50, P99, P999);
+		if(Period > 0)
+			printf("telemetry: %.0f records/s\n", Telemetry / Seconds);
+	}
+
+	close(Fd);
+	return ((Checked == DriveCount) && (Total.Failed == 0) && (Total.OutOfOrder == 0)) ? 0 : 1;
+}
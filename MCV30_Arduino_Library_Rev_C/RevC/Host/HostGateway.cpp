@@ -0,0 +1,746 @@
+/*--------------------------------------------------------------
+ * HostGateway.cpp
+ * gateway daemon for a Linux host: serves the drives of any number
+ * of serial buses - USB-serial adapters or ptys - to local clients.
+ * Every bus is a BusWorker: a DriveBus with its own PosixSerial
+ * attached, so the protocol stack is the one of the Arduino, unchanged.
+ * The epoll loop of the IO thread serves the Unix socket and its
+ * clients. The requests go to the workers by their command queues,
+ * the responses and telemetry records come back by their event rings.
+ * A bus is updated when its port has got data, when one of its
+ * deadlines is due or when there is a new request for it - not in
+ * every cycle. The clients use the binary RPC of HostRpc.h.
+ * By default the workers are run by the IO thread as well. With -T
+ * every worker is run by a thread of its own pinned to a CPU - the
+ * IO thread keeps the first one.
+ * With -m the process image of all the drives is exported to a
+ * shared memory segment as of ShmTelemetry.h, updated every -i ms.
+ *
+ * usage:
+ *   HostGateway [-s socket] [-b baud] [-T] [-m shm name] [-i period ms]
+ *               port[@id,id..] [port..]
+ * e.g.
+ *   HostGateway -s /tmp/mc.sock /dev/ttyUSB0@1,2 /dev/ttyUSB1
+ * a port w/o ids serves the node 1
+ *
+ * 2026-10-18 AW Frame
+ * 2026-10-18 AW a worker per bus, threaded by -T
+ * 2026-10-18 AW shared memory export
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include <HostRpc.h>
+#include <BusWorker.h>
+#include <stdio.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+//--- local defines ---
+
+//can be raised by a build flag e.g. -DHOSTGW_MAX_BUSES=64
+#ifndef HOSTGW_MAX_BUSES
+#define HOSTGW_MAX_BUSES 32
+#endif
+
+#ifndef HOSTGW_MAX_CLIENTS
+#define HOSTGW_MAX_CLIENTS 16
+#endif
+
+const uint32_t ClientTxSize = 65536;
+const int MaxIdleWait = 100;		//ms epoll waits w/o a deadline
+
+const char SocketDefault[] = "/tmp/mcgateway.sock";
+const uint32_t BaudDefault = 115200;
+const uint16_t ExportPeriodDefault = 100;
+
+typedef enum HostFdKinds {
+	eFdListen = 1,
+	eFdWorker = 2,
+	eFdClient = 3,
+	eFdNotify = 4
+} HostFdKinds;
+
+typedef struct HostClient {
+	int Fd;
+	uint16_t Generation;
+	uint8_t Rx[sizeof(RpcHdr) + RpcMaxPayload];
+	uint16_t RxLen;
+	uint8_t Tx[ClientTxSize];
+	uint32_t TxLen;
+	bool isWatchingOut;
+	uint8_t Subscribed[HOSTGW_MAX_BUSES];		//a bit per drive of the bus
+} HostClient;
+
+static_assert(DriveBusMaxDrives <= 8, "the subscriptions are a byte per bus");
+
+//--- globals ---
+
+static BusWorker *Workers[HOSTGW_MAX_BUSES];
+static bool isPending[HOSTGW_MAX_BUSES];		//commands pushed or port ready
+static uint8_t BusCount = 0;
+static HostClient Clients[HOSTGW_MAX_CLIENTS];
+static int EpollFd = -1;
+static int ListenFd = -1;
+static int NotifyFd = -1;
+static bool isThreaded = false;
+static ShmTelemetryWriter Export;
+static volatile sig_atomic_t isStopped = 0;
+
+//--- implementation ---
+
+static uint64_t NowUs()
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint64_t)Now.tv_sec * 1000000ULL + (uint64_t)(Now.tv_nsec / 1000);
+}
+
+static void OnSignal(int Signal)
+{
+	(void)Signal;
+	isStopped = 1;
+}
+
+static bool Watch(int Op, int Fd, uint32_t Events, HostFdKinds Kind, uint32_t Idx)
+{
+	struct epoll_event Event;
+
+	Event.events = Events;
+	Event.data.u64 = ((uint64_t)Kind << 32) | Idx;
+	return (epoll_ctl(EpollFd, Op, Fd, &Event) == 0);
+}
+
+//--- clients ---
+
+static void CloseClient(HostClient *Client)
+{
+	if(Client->Fd < 0)
+		return;
+
+	epoll_ctl(EpollFd, EPOLL_CTL_DEL, Client->Fd, NULL);
+	close(Client->Fd);
+	Client->Fd = -1;
+	//responses still queued for it are dropped by the generation
+	Client->Generation++;
+}
+
+static void FlushClient(uint8_t Idx)
+{
+	HostClient *Client = &Clients[Idx];
+
+	while(Client->TxLen > 0)
+	{
+		ssize_t Written = send(Client->Fd, Client->Tx, Client->TxLen, MSG_NOSIGNAL);
+
+		if(Written < 0)
+		{
+			if((errno == EAGAIN) || (errno == EINTR))
+				break;
+			CloseClient(Client);
+			return;
+		}
+		Client->TxLen -= Written;
+		memmove(Client->Tx, &Client->Tx[Written], Client->TxLen);
+	}
+
+	bool isWaiting = (Client->TxLen > 0);
+
+	if(isWaiting != Client->isWatchingOut)
+	{
+		Watch(EPOLL_CTL_MOD, Client->Fd, isWaiting ? (EPOLLIN | EPOLLOUT) : EPOLLIN, eFdClient, Idx);
+		Client->isWatchingOut = isWaiting;
+	}
+}
+
+//a client which doesn't read its responses is dropped
+
+static void SendResponse(uint8_t Idx, const RpcHdr *Request, uint8_t Status, const void *Payload, uint16_t Len)
+{
+	HostClient *Client = &Clients[Idx];
+	RpcHdr Hdr = *Request;
+
+	if(Client->Fd < 0)
+		return;
+
+	if(Client->TxLen + sizeof(RpcHdr) + Len > ClientTxSize)
+	{
+		fprintf(stderr, "GW: client %u doesn't read - closed\n", Idx);
+		CloseClient(Client);
+		return;
+	}
+
+	Hdr.Len = Len;
+	Hdr.Status = Status;
+	memcpy(&Client->Tx[Client->TxLen], &Hdr, sizeof(RpcHdr));
+	memcpy(&Client->Tx[Client->TxLen + sizeof(RpcHdr)], Payload, Len);
+	Client->TxLen += sizeof(RpcHdr) + Len;
+
+	//the most recent ones are written right away - the rest on EPOLLOUT
+	if(!Client->isWatchingOut)
+		FlushClient(Idx);
+}
+
+static void AcceptClient()
+{
+	int Fd;
+
+	while((Fd = accept4(ListenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		uint8_t Idx;
+
+		for(Idx = 0; Idx < HOSTGW_MAX_CLIENTS; Idx++)
+			if(Clients[Idx].Fd < 0)
+				break;
+
+		if(Idx >= HOSTGW_MAX_CLIENTS)
+		{
+			fprintf(stderr, "GW: too many clients\n");
+			close(Fd);
+			continue;
+		}
+
+		Clients[Idx].Fd = Fd;
+		Clients[Idx].RxLen = 0;
+		Clients[Idx].TxLen = 0;
+		Clients[Idx].isWatchingOut = false;
+		memset(Clients[Idx].Subscribed, 0, sizeof(Clients[Idx].Subscribed));
+		Watch(EPOLL_CTL_ADD, Fd, EPOLLIN, eFdClient, Idx);
+	}
+}
+
+//--- requests ---
+
+static void ListDrives(uint8_t Idx, const RpcHdr *Request)
+{
+	RpcDriveInfo Info[HOSTGW_MAX_BUSES * DriveBusMaxDrives];
+	uint16_t Count = 0;
+
+	for(uint8_t b = 0; b < BusCount; b++)
+	{
+		for(uint8_t d = 0; d < Workers[b]->GetDriveCount(); d++)
+		{
+			Info[Count].Bus = b;
+			Info[Count].Node = Workers[b]->GetNodeId(d);
+			Info[Count].isLive = Workers[b]->IsLive(d);
+			Info[Count].Depth = Workers[b]->GetDepth(d);
+			Count++;
+		}
+	}
+	SendResponse(Idx, Request, eRpcOk, Info, Count * sizeof(RpcDriveInfo));
+}
+
+static void GetStats(uint8_t Idx, const RpcHdr *Request)
+{
+	RpcBusStats Stats[HOSTGW_MAX_BUSES];
+
+	for(uint8_t b = 0; b < BusCount; b++)
+		Workers[b]->GetStats(&Stats[b]);
+
+	SendResponse(Idx, Request, eRpcOk, Stats, BusCount * sizeof(RpcBusStats));
+}
+
+static void InitCommand(BusCommand *Command, uint8_t Idx, const RpcHdr *Request)
+{
+	Command->Op = Request->Op;
+	Command->Client = Idx;
+	Command->Generation = Clients[Idx].Generation;
+	Command->Seq = Request->Seq;
+	Command->Node = Request->Node;
+	Command->Count = 0;
+	Command->Period = 0;
+	Command->ReceivedAt = NowUs();
+}
+
+//the worker checks the node - it answers eRpcUnknownDrive itself
+
+static void PushCommand(uint8_t Idx, const RpcHdr *Request, const BusCommand *Command)
+{
+	if(!Workers[Request->Bus]->PushCommand(Command))
+	{
+		SendResponse(Idx, Request, eRpcQueueFull, NULL, 0);
+		return;
+	}
+	isPending[Request->Bus] = true;
+}
+
+static void QueueAccess(uint8_t Idx, const RpcHdr *Request, const uint8_t *Payload)
+{
+	uint8_t Count = Request->Len / sizeof(RpcObject);
+	BusCommand Command;
+
+	if(Request->Bus >= BusCount)
+	{
+		SendResponse(Idx, Request, eRpcUnknownDrive, NULL, 0);
+		return;
+	}
+
+	if((Request->Len % sizeof(RpcObject)) || (Count == 0) || (Count > RpcMaxObjects))
+	{
+		SendResponse(Idx, Request, eRpcBadRequest, NULL, 0);
+		return;
+	}
+
+	for(uint8_t i = 0; i < Count; i++)
+	{
+		RpcObject Object;
+
+		memcpy(&Object, &Payload[i * sizeof(RpcObject)], sizeof(RpcObject));
+		if((Object.Len != 0) && (Object.Len != 1) && (Object.Len != 2) && (Object.Len != 4))
+		{
+			SendResponse(Idx, Request, eRpcBadRequest, NULL, 0);
+			return;
+		}
+		Command.List[i].Idx = Object.Idx;
+		Command.List[i].SubIdx = Object.SubIdx;
+		Command.List[i].Len = Object.Len;
+		Command.List[i].Value = Object.Value;
+		Command.List[i].isFailed = false;
+	}
+
+	InitCommand(&Command, Idx, Request);
+	Command.Count = Count;
+	PushCommand(Idx, Request, &Command);
+}
+
+/*---------------------------------------------------------------------
+ * Subscribe(uint8_t Idx, const RpcHdr *Request, const uint8_t *Payload)
+ * sets the telemetry period of the drive and marks the client to get
+ * the records of it - period 0 stops both
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static void Subscribe(uint8_t Idx, const RpcHdr *Request, const uint8_t *Payload)
+{
+	uint8_t DriveIdx;
+	BusCommand Command;
+
+	if(Request->Bus >= BusCount)
+	{
+		SendResponse(Idx, Request, eRpcUnknownDrive, NULL, 0);
+		return;
+	}
+
+	if(Request->Len != sizeof(uint16_t))
+	{
+		SendResponse(Idx, Request, eRpcBadRequest, NULL, 0);
+		return;
+	}
+
+	for(DriveIdx = 0; DriveIdx < Workers[Request->Bus]->GetDriveCount(); DriveIdx++)
+		if(Workers[Request->Bus]->GetNodeId(DriveIdx) == Request->Node)
+			break;
+
+	if(DriveIdx >= Workers[Request->Bus]->GetDriveCount())
+	{
+		SendResponse(Idx, Request, eRpcUnknownDrive, NULL, 0);
+		return;
+	}
+
+	InitCommand(&Command, Idx, Request);
+	memcpy(&Command.Period, Payload, sizeof(uint16_t));
+
+	if(Command.Period > 0)
+		Clients[Idx].Subscribed[Request->Bus] |= (1 << DriveIdx);
+	else
+		Clients[Idx].Subscribed[Request->Bus] &= ~(1 << DriveIdx);
+
+	PushCommand(Idx, Request, &Command);
+}
+
+static void HandleRequest(uint8_t Idx, const RpcHdr *Request, const uint8_t *Payload)
+{
+	switch(Request->Op)
+	{
+		case eRpcListDrives:
+			ListDrives(Idx, Request);
+			break;
+		case eRpcAccess:
+			QueueAccess(Idx, Request, Payload);
+			break;
+		case eRpcGetStats:
+			GetStats(Idx, Request);
+			break;
+		case eRpcSubscribe:
+			Subscribe(Idx, Request, Payload);
+			break;
+		default:
+			SendResponse(Idx, Request, eRpcBadRequest, NULL, 0);
+			break;
+	}
+}
+
+static void ReadClient(uint8_t Idx)
+{
+	HostClient *Client = &Clients[Idx];
+
+	for(;;)
+	{
+		ssize_t Len = recv(Client->Fd, &Client->Rx[Client->RxLen], sizeof(Client->Rx) - Client->RxLen, 0);
+
+		if(Len == 0)
+		{
+			CloseClient(Client);
+			return;
+		}
+		if(Len < 0)
+		{
+			if((errno == EAGAIN) || (errno == EINTR))
+				return;
+			CloseClient(Client);
+			return;
+		}
+		Client->RxLen += Len;
+
+		//all the complete frames
+		uint16_t Used = 0;
+
+		while((uint16_t)(Client->RxLen - Used) >= sizeof(RpcHdr))
+		{
+			RpcHdr Request;
+
+			memcpy(&Request, &Client->Rx[Used], sizeof(RpcHdr));
+			if(Request.Len > RpcMaxPayload)
+			{
+				fprintf(stderr, "GW: client %u sent garbage - closed\n", Idx);
+				CloseClient(Client);
+				return;
+			}
+			if((uint16_t)(Client->RxLen - Used) < sizeof(RpcHdr) + Request.Len)
+				break;
+
+			HandleRequest(Idx, &Request, &Client->Rx[Used + sizeof(RpcHdr)]);
+			if(Client->Fd < 0)
+				return;
+			Used += sizeof(RpcHdr) + Request.Len;
+		}
+		Client->RxLen -= Used;
+		memmove(Client->Rx, &Client->Rx[Used], Client->RxLen);
+	}
+}
+
+//--- the buses ---
+
+/*---------------------------------------------------------------------
+ * DrainEvents(uint8_t Bus)
+ * the responses go to the clients which are still there, the
+ * telemetry records to every client subscribed to the drive
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static void DrainEvents(uint8_t Bus)
+{
+	BusEvent Event;
+
+	while(Workers[Bus]->PopEvent(&Event))
+	{
+		RpcHdr Response;
+
+		Response.Seq = Event.Seq;
+		Response.Op = Event.Op;
+		Response.Bus = Bus;
+		Response.Node = Event.Node;
+
+		if(Event.Op == eRpcTelemetry)
+		{
+			for(uint8_t c = 0; c < HOSTGW_MAX_CLIENTS; c++)
+				if((Clients[c].Fd >= 0) && (Clients[c].Subscribed[Bus] & (1 << Event.DriveIdx)))
+					SendResponse(c, &Response, eRpcOk, &Event.Telemetry, sizeof(RpcTelemetry));
+			continue;
+		}
+
+		if(Clients[Event.Client].Generation == Event.Generation)
+			SendResponse(Event.Client, &Response, Event.Status, Event.List, Event.Count * sizeof(RpcObject));
+	}
+}
+
+static bool AddBus(char *Arg, uint32_t baud)
+{
+	if(BusCount >= HOSTGW_MAX_BUSES)
+	{
+		fprintf(stderr, "GW: more than %d buses\n", HOSTGW_MAX_BUSES);
+		return false;
+	}
+
+	BusWorker *Worker = new BusWorker();
+
+	if(!Worker->Open(Arg, baud, BusCount, isThreaded ? NotifyFd : -1))
+	{
+		fprintf(stderr, "GW: can't open %s\n", Arg);
+		delete Worker;
+		return false;
+	}
+
+	//the IO thread runs the worker when its epoll is readable
+	if(!isThreaded)
+		Watch(EPOLL_CTL_ADD, Worker->GetFd(), EPOLLIN, eFdWorker, BusCount);
+
+	Workers[BusCount++] = Worker;
+
+	return true;
+}
+
+//ms until the next deadline of any bus - 0 if a bus is to be updated anyway
+
+static int GetWaitTime(uint32_t actTime)
+{
+	int Wait = MaxIdleWait;
+
+	if(isThreaded)
+		return Wait;
+
+	for(uint8_t b = 0; b < BusCount; b++)
+	{
+		int Left = isPending[b] ? 0 : Workers[b]->GetWaitTime(actTime);
+
+		if(Left < Wait)
+			Wait = Left;
+	}
+	return Wait;
+}
+
+static bool OpenSocket(const char *Path)
+{
+	struct sockaddr_un Addr;
+
+	if(strlen(Path) >= sizeof(Addr.sun_path))
+		return false;
+
+	ListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(ListenFd < 0)
+		return false;
+
+	memset(&Addr, 0, sizeof(Addr));
+	Addr.sun_family = AF_UNIX;
+	strcpy(Addr.sun_path, Path);
+	unlink(Path);
+
+	if((bind(ListenFd, (struct sockaddr *)&Addr, sizeof(Addr)) != 0) || (listen(ListenFd, 8) != 0))
+		return false;
+
+	return Watch(EPOLL_CTL_ADD, ListenFd, EPOLLIN, eFdListen, 0);
+}
+
+static void PrintStats()
+{
+	printf("bus  drives  requests      done    failed  rejected    rx bytes    tx bytes  avg us  max us  telemetry   dropped  port\n");
+	for(uint8_t b = 0; b < BusCount; b++)
+	{
+		RpcBusStats Stats;
+
+		Workers[b]->GetStats(&Stats);
+		printf("%3u  %6u  %8u  %8u  %8u  %8u  %10u  %10u  %6u  %6u  %9u  %8u  %s\n",
+		       b, Stats.Drives, Stats.Requests, Stats.Done, Stats.Failed, Stats.Rejected,
+		       Stats.RxBytes, Stats.TxBytes, Stats.LatencyAvg, Stats.LatencyMax,
+		       Stats.Telemetry, Stats.TelemetryDropped, Workers[b]->GetDevice());
+	}
+}
+
+static void Usage()
+{
+	fprintf(stderr, "usage: HostGateway [-s socket] [-b baud] [-T] [-m shm name] [-i period ms] port[@id,id..] [port..]\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *SocketPath = SocketDefault;
+	uint32_t baud = BaudDefault;
+	const char *ExportName = NULL;
+	uint16_t ExportPeriod = ExportPeriodDefault;
+	int Opt;
+
+	while((Opt = getopt(argc, argv, "s:b:Tm:i:")) != -1)
+	{
+		switch(Opt)
+		{
+			case 's':
+				SocketPath = optarg;
+				break;
+			case 'b':
+				baud = strtoul(optarg, NULL, 10);
+				break;
+			case 'T':
+				isThreaded = true;
+				break;
+			case 'm':
+				ExportName = optarg;
+				break;
+			case 'i':
+				ExportPeriod = atoi(optarg);
+				break;
+			default:
+				Usage();
+				return 1;
+		}
+	}
+	if(optind >= argc)
+	{
+		Usage();
+		return 1;
+	}
+
+	for(uint8_t i = 0; i < HOSTGW_MAX_CLIENTS; i++)
+		Clients[i].Fd = -1;
+
+	EpollFd = epoll_create1(EPOLL_CLOEXEC);
+	if(EpollFd < 0)
+	{
+		perror("epoll");
+		return 1;
+	}
+
+	NotifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if((NotifyFd < 0) || !Watch(EPOLL_CTL_ADD, NotifyFd, EPOLLIN, eFdNotify, 0))
+	{
+		perror("eventfd");
+		return 1;
+	}
+
+	for(int i = optind; i < argc; i++)
+		if(!AddBus(argv[i], baud))
+			return 1;
+
+	if(ExportName != NULL)
+	{
+		uint32_t Records = 0;
+
+		for(uint8_t b = 0; b < BusCount; b++)
+			Records += Workers[b]->GetDriveCount();
+
+		if(!Export.Open(ExportName, Records))
+		{
+			fprintf(stderr, "GW: can't export to %s: %s\n", ExportName, strerror(errno));
+			return 1;
+		}
+
+		//the records in the order of the buses and their drives
+		Records = 0;
+		for(uint8_t b = 0; b < BusCount; b++)
+		{
+			Workers[b]->AttachExport(&Export, Records, ExportPeriod);
+			Records += Workers[b]->GetDriveCount();
+		}
+	}
+
+	if(!OpenSocket(SocketPath))
+	{
+		fprintf(stderr, "GW: can't listen at %s: %s\n", SocketPath, strerror(errno));
+		return 1;
+	}
+
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+	signal(SIGPIPE, SIG_IGN);
+
+	if(isThreaded)
+	{
+		//the IO thread keeps CPU 0
+		for(uint8_t b = 0; b < BusCount; b++)
+		{
+			if(!Workers[b]->Start(b + 1))
+			{
+				fprintf(stderr, "GW: can't start the worker of %s\n", Workers[b]->GetDevice());
+				return 1;
+			}
+		}
+	}
+
+	fprintf(stderr, "GW: %u buses at %s%s\n", BusCount, SocketPath, isThreaded ? " threaded" : "");
+
+	struct epoll_event Events[64];
+
+	while(!isStopped)
+	{
+		int Count = epoll_wait(EpollFd, Events, 64, GetWaitTime(millis()));
+
+		if((Count < 0) && (errno != EINTR))
+		{
+			perror("epoll_wait");
+			break;
+		}
+
+		for(int i = 0; i < Count; i++)
+		{
+			uint32_t Kind = (uint32_t)(Events[i].data.u64 >> 32);
+			uint32_t Idx = (uint32_t)Events[i].data.u64;
+
+			switch(Kind)
+			{
+				case eFdListen:
+					AcceptClient();
+					break;
+				case eFdWorker:
+					isPending[Idx] = true;
+					break;
+				case eFdNotify:
+				{
+					uint64_t Notes;
+
+					if(read(NotifyFd, &Notes, sizeof(Notes)) < 0)
+						Notes = 0;
+					for(uint8_t b = 0; b < BusCount; b++)
+						DrainEvents(b);
+					break;
+				}
+				case eFdClient:
+					if(Events[i].events & (EPOLLHUP | EPOLLERR))
+					{
+						CloseClient(&Clients[Idx]);
+						break;
+					}
+					if(Events[i].events & EPOLLOUT)
+						FlushClient(Idx);
+					if((Events[i].events & EPOLLIN) && (Clients[Idx].Fd >= 0))
+						ReadClient(Idx);
+					break;
+			}
+		}
+
+		if(isThreaded)
+		{
+			//a single wake-up for all the commands pushed to a worker
+			for(uint8_t b = 0; b < BusCount; b++)
+			{
+				if(isPending[b])
+				{
+					isPending[b] = false;
+					Workers[b]->Wake();
+				}
+			}
+			continue;
+		}
+
+		uint32_t actTime = millis();
+
+		for(uint8_t b = 0; b < BusCount; b++)
+		{
+			if(isPending[b] || (Workers[b]->GetWaitTime(actTime) == 0))
+			{
+				isPending[b] = false;
+				Workers[b]->RunOnce(0);
+				DrainEvents(b);
+			}
+		}
+	}
+
+	for(uint8_t b = 0; b < BusCount; b++)
+		Workers[b]->Stop();
+
+	PrintStats();
+	unlink(SocketPath);
+	Export.Close();
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+#ifndef HOST_RPC_H
+#define HOST_RPC_H
+
+/*--------------------------------------------------------------
+ * HostRpc.h
+ * the binary RPC of the HostGateway at its Unix socket.
+ * Every request and every response is a RpcHdr followed by Len bytes
+ * of payload, all of it little endian. The response carries the Seq,
+ * Op, Bus and Node of its request, so a client may keep any number
+ * of requests in flight and match them by the Seq.
+ * The requests to a single drive are answered in order. Requests to
+ * different drives are not.
+ *
+ * eRpcListDrives: no payload
+ *   response: RpcDriveInfo for every drive
+ * eRpcAccess: 1..RpcMaxObjects RpcObject to be read (Len = 0) or
+ *   written (Len = 1, 2 or 4) in one batch
+ *   response: the same list with the values read and isFailed set
+ *   for the objects the drive has rejected - Value is the SDO error
+ *   code then
+ * eRpcGetStats: no payload
+ *   response: RpcBusStats for every bus
+ * eRpcSubscribe: uint16_t period in ms, 0 to stop
+ *   the drive reads its snapshot at this period and the client gets
+ *   an eRpcTelemetry with a RpcTelemetry each time, Seq is 0 then.
+ *   The period is the one of the drive - the last one set counts.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <stdint.h>
+
+//--- service define ---
+
+const uint16_t RpcMaxPayload = 1024;
+const uint8_t RpcMaxObjects = 8;		//SDOMaxBatch
+
+typedef enum RpcOps {
+	eRpcListDrives = 1,
+	eRpcAccess = 2,
+	eRpcGetStats = 3,
+	eRpcSubscribe = 4,
+	eRpcTelemetry = 5
+}
+ RpcOps;
+
+typedef enum RpcStates {
+	eRpcOk = 0,
+	eRpcFailed = 1,			//at least one object has been rejected
+	eRpcTimeout = 2,		//the drive didn't respond
+	eRpcUnknownDrive = 3,
+	eRpcQueueFull = 4,
+	eRpcBadRequest = 5
+}
+ RpcStates;
+
+typedef struct __attribute__((packed)) RpcHdr {
+	uint16_t Len;			//bytes of payload following
+	uint16_t Seq;
+	uint8_t Op;
+	uint8_t Bus;
+	uint8_t Node;
+	uint8_t Status;
+} RpcHdr;
+
+typedef struct __attribute__((packed)) RpcObject {
+	uint16_t Idx;
+	uint8_t SubIdx;
+	uint8_t Len;
+	uint32_t Value;
+	uint8_t isFailed;
+} RpcObject;
+
+typedef struct __attribute__((packed)) RpcDriveInfo {
+	uint8_t Bus;
+	uint8_t Node;
+	uint8_t isLive;
+	uint8_t Depth;			//requests waiting
+} RpcDriveInfo;
+
+typedef struct __attribute__((packed)) RpcBusStats {
+	uint8_t Bus;
+	uint8_t Drives;
+	uint32_t Requests;
+	uint32_t Done;
+	uint32_t Failed;
+	uint32_t Rejected;
+	uint32_t Objects;
+	uint32_t RxBytes;
+	uint32_t TxBytes;
+	uint32_t LatencyAvg;	//us from the request to its response
+	uint32_t LatencyMax;
+	uint32_t Telemetry;
+	uint32_t TelemetryDropped;
+} RpcBusStats;
+
+typedef struct __attribute__((packed)) RpcTelemetry {
+	uint16_t StatusWord;
+	int8_t OpMode;
+	int32_t Position;
+	int32_t Speed;
+	int16_t MotorTemp;
+	uint16_t DriveErrors;
+	uint32_t TimeStamp;		//ms of the gateway
+} RpcTelemetry;
+
+#endif
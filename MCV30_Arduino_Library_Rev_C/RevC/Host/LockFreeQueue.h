@@ -0,0 +1,142 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+
+/*--------------------------------------------------------------
+ * LockFreeQueue.h
+ * bounded queues between the threads of the host gateway - no locks,
+ * no allocation, Size has to be a power of 2.
+ *
+ * MpscQueue: any number of producers, a single consumer. Every slot
+ * carries a sequence number which tells whether it's free for the
+ * producer of this round or filled for the consumer (D. Vyukov's
+ * bounded queue). A producer claims a slot by a CAS of the tail, so
+ * producers never wait for each other to finish their copy.
+ *
+ * SpscRing: a single producer and a single consumer. Each side owns
+ * its index and keeps a copy of the other one, so the cache line of
+ * the other side is only read when the copy says full or empty.
+ *
+ * The indices of both sides are kept on their own cache lines.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <atomic>
+#include <stdint.h>
+
+//--- service define ---
+
+#define CACHE_LINE_SIZE 64
+
+template <typename T, uint32_t Size>
+class MpscQueue {
+	static_assert((Size & (Size - 1)) == 0, "Size has to be a power of 2");
+
+	public:
+		MpscQueue() {
+			for(uint32_t i = 0; i < Size; i++)
+				Cell[i].Seq.store(i, std::memory_order_relaxed);
+		};
+
+		//any thread - false if the queue is full
+		bool Push(const T &Item) {
+			uint32_t Pos = Tail.load(std::memory_order_relaxed);
+			Slot *ThisCell;
+
+			for(;;)
+			{
+				ThisCell = &Cell[Pos & (Size - 1)];
+				int32_t Diff = (int32_t)(ThisCell->Seq.load(std::memory_order_acquire) - Pos);
+
+				if(Diff == 0)
+				{
+					if(Tail.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if(Diff < 0)
+					return false;
+				else
+					Pos = Tail.load(std::memory_order_relaxed);
+			}
+			ThisCell->Item = Item;
+			ThisCell->Seq.store(Pos + 1, std::memory_order_release);
+			return true;
+		};
+
+		//the consumer only - false if there is nothing
+		bool Pop(T *Item) {
+			Slot *ThisCell = &Cell[Head & (Size - 1)];
+
+			if((int32_t)(ThisCell->Seq.load(std::memory_order_acquire) - (Head + 1)) < 0)
+				return false;
+
+			*Item = ThisCell->Item;
+			ThisCell->Seq.store(Head + Size, std::memory_order_release);
+			Head++;
+			return true;
+		};
+
+	private:
+		typedef struct Slot {
+			std::atomic<uint32_t> Seq;
+			T Item;
+		} Slot;
+
+		alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> Tail {0};
+		alignas(CACHE_LINE_SIZE) uint32_t Head = 0;
+		alignas(CACHE_LINE_SIZE) Slot Cell[Size];
+};
+
+template <typename T, uint32_t Size>
+class SpscRing {
+	static_assert((Size & (Size - 1)) == 0, "Size has to be a power of 2");
+
+	public:
+		//the producer only - false if the ring is full
+		bool Push(const T &Item) {
+			uint32_t Pos = Tail.load(std::memory_order_relaxed);
+
+			if(Pos - HeadSeen == Size)
+			{
+				HeadSeen = Head.load(std::memory_order_acquire);
+				if(Pos - HeadSeen == Size)
+					return false;
+			}
+			Slot[Pos & (Size - 1)] = Item;
+			Tail.store(Pos + 1, std::memory_order_release);
+			return true;
+		};
+
+		//the producer only - slots which can be pushed for sure
+		uint32_t GetFree() {
+			HeadSeen = Head.load(std::memory_order_acquire);
+			return Size - (Tail.load(std::memory_order_relaxed) - HeadSeen);
+		};
+
+		//the consumer only - false if there is nothing
+		bool Pop(T *Item) {
+			uint32_t Pos = Head.load(std::memory_order_relaxed);
+
+			if(Pos == TailSeen)
+			{
+				TailSeen = Tail.load(std::memory_order_acquire);
+				if(Pos == TailSeen)
+					return false;
+			}
+			*Item = Slot[Pos & (Size - 1)];
+			Head.store(Pos + 1, std::memory_order_release);
+			return true;
+		};
+
+	private:
+		alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> Tail {0};
+		uint32_t HeadSeen = 0;		//the producer's copy
+		alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> Head {0};
+		uint32_t TailSeen = 0;		//the consumer's copy
+		alignas(CACHE_LINE_SIZE) T Slot[Size];
+};
+
+#endif
@@ -0,0 +1,350 @@
+/*---------------------------------------------------
+ * PosixSerial.cpp
+ * implements a serial port of a Linux host by termios
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <PosixSerial.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+#include <errno.h>
+
+//--- local defines ---
+
+#define DEBUG_OPEN		0x0001
+#define DEBUG_ERROR		0x0002
+
+#define DEBUG_POSIXSERIAL (DEBUG_ERROR)
+
+typedef struct BaudMapping {
+	uint32_t Baud;
+	speed_t Speed;
+} BaudMapping;
+
+static const BaudMapping BaudRates[] = {
+	{9600, B9600},
+	{19200, B19200},
+	{38400, B38400},
+	{57600, B57600},
+	{115200, B115200},
+	{230400, B230400},
+	{460800, B460800},
+	{500000, B500000},
+	{921600, B921600},
+	{1000000, B1000000},
+	{2000000, B2000000},
+	{3000000, B3000000},
+	{4000000, B4000000}
+};
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * PosixSerial()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+PosixSerial::PosixSerial()
+{
+}
+
+PosixSerial::~PosixSerial()
+{
+	end();
+}
+
+/*---------------------------------------------------------------------
+ * void SetDevice(const char *Path)
+ * e.g. /dev/ttyUSB0 - the path is not copied
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void PosixSerial::SetDevice(const char *Path)
+{
+	Device = Path;
+}
+
+const char *PosixSerial::GetDevice()
+{
+	return Device;
+}
+
+/*---------------------------------------------------------------------
+ * bool Open(uint32_t baud)
+ * open the device if it isn't yet and set it to raw mode at the
+ * given rate - a rate which is not known is replaced by 115200
+ * returns false if the device can't be opened or configured
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool PosixSerial::Open(uint32_t baud)
+{
+	if(Device == NULL)
+		return false;
+
+	if(Fd < 0)
+	{
+		Fd = ::open(Device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+		if(Fd < 0)
+		{
+			#if(DEBUG_POSIXSERIAL & DEBUG_ERROR)
+			fprintf(stderr, "Port: can't open %s: %s\n", Device, strerror(errno));
+			#endif
+			return false;
+		}
+		RxHead = RxCount = 0;
+		TxHead = TxCount = 0;
+	}
+
+	struct termios Settings;
+
+	if(tcgetattr(Fd, &Settings) != 0)
+	{
+		#if(DEBUG_POSIXSERIAL & DEBUG_ERROR)
+		fprintf(stderr, "Port: %s is no tty\n", Device);
+		#endif
+		end();
+		return false;
+	}
+
+	speed_t Speed = B115200;
+
+	for(uint8_t i = 0; i < sizeof(BaudRates) / sizeof(BaudMapping); i++)
+		if(BaudRates[i].Baud == baud)
+			Speed = BaudRates[i].Speed;
+
+	cfmakeraw(&Settings);
+	Settings.c_cflag |= (CLOCAL | CREAD);
+	Settings.c_cflag &= ~(CSTOPB | CRTSCTS);
+	Settings.c_cc[VMIN] = 0;
+	Settings.c_cc[VTIME] = 0;
+	cfsetispeed(&Settings, Speed);
+	cfsetospeed(&Settings, Speed);
+
+	if(tcsetattr(Fd, TCSANOW, &Settings) != 0)
+	{
+		end();
+		return false;
+	}
+	tcflush(Fd, TCIOFLUSH);
+
+	#if(DEBUG_POSIXSERIAL & DEBUG_OPEN)
+	fprintf(stderr, "Port: %s @ %u\n", Device, baud);
+	#endif
+
+	return true;
+}
+
+void PosixSerial::begin(unsigned long baud)
+{
+	Open((uint32_t)baud);
+}
+
+void PosixSerial::end()
+{
+	if(Fd >= 0)
+		::close(Fd);
+	Fd = -1;
+}
+
+int PosixSerial::available()
+{
+	return RxCount;
+}
+
+int PosixSerial::read()
+{
+	if(RxCount == 0)
+		return -1;
+
+	uint8_t c = RxBuffer[RxHead];
+
+	RxHead = (RxHead + 1) % POSIX_SERIAL_BUFFER;
+	RxCount--;
+	return c;
+}
+
+int PosixSerial::availableForWrite()
+{
+	return POSIX_SERIAL_BUFFER - TxCount;
+}
+
+size_t PosixSerial::write(uint8_t c)
+{
+	return write(&c, 1);
+}
+
+/*---------------------------------------------------------------------
+ * size_t write(const uint8_t *Buffer, size_t Len)
+ * write directly if nothing is waiting, keep the rest in the buffer
+ * returns the number of bytes taken
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+size_t PosixSerial::write(const uint8_t *Buffer, size_t Len)
+{
+	if(Fd < 0)
+		return 0;
+
+	size_t Taken = 0;
+
+	if(TxCount == 0)
+	{
+		ssize_t Written = ::write(Fd, Buffer, Len);
+
+		if(Written > 0)
+		{
+			Taken = Written;
+			TxBytes += Written;
+		}
+	}
+
+	while((Taken < Len) && (TxCount < POSIX_SERIAL_BUFFER))
+	{
+		TxBuffer[(TxHead + TxCount) % POSIX_SERIAL_BUFFER] = Buffer[Taken++];
+		TxCount++;
+	}
+	return Taken;
+}
+
+/*---------------------------------------------------------------------
+ * void flush()
+ * blocks until the buffer has been written - as on the Arduino
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void PosixSerial::flush()
+{
+	while((Fd >= 0) && !FlushTx())
+	{
+		struct pollfd Wait = {Fd, POLLOUT, 0};
+
+		if(poll(&Wait, 1, 100) < 0)
+			break;
+	}
+}
+
+PosixSerial::operator bool()
+{
+	return (Fd >= 0);
+}
+
+int PosixSerial::GetFd()
+{
+	return Fd;
+}
+
+/*---------------------------------------------------------------------
+ * int Fill()
+ * read all the data the fd has got into the Rx buffer
+ * if the buffer is full the new data is dropped
+ * returns the number of bytes read or -1 if the port has been lost
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+int PosixSerial::Fill()
+{
+	uint8_t Chunk[512];
+	int Total = 0;
+
+	if(Fd < 0)
+		return -1;
+
+	for(;;)
+	{
+		ssize_t Len = ::read(Fd, Chunk, sizeof(Chunk));
+
+		if(Len < 0)
+		{
+			if((errno == EAGAIN) || (errno == EINTR))
+				break;
+			return -1;
+		}
+		if(Len == 0)
+			break;
+
+		RxBytes += Len;
+		Total += Len;
+		for(ssize_t i = 0; i < Len; i++)
+		{
+			if(RxCount >= POSIX_SERIAL_BUFFER)
+			{
+				RxOverflows++;
+				break;
+			}
+			RxBuffer[(RxHead + RxCount) % POSIX_SERIAL_BUFFER] = Chunk[i];
+			RxCount++;
+		}
+	}
+	return Total;
+}
+
+/*---------------------------------------------------------------------
+ * bool FlushTx()
+ * write what's waiting as far as the fd takes it
+ * returns true if the buffer is empty now
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool PosixSerial::FlushTx()
+{
+	while((TxCount > 0) && (Fd >= 0))
+	{
+		uint16_t Len = TxCount;
+
+		//up to the end of the ring in one go
+		if(TxHead + Len > POSIX_SERIAL_BUFFER)
+			Len = POSIX_SERIAL_BUFFER - TxHead;
+
+		ssize_t Written = ::write(Fd, &TxBuffer[TxHead], Len);
+
+		if(Written <= 0)
+			break;
+
+		TxBytes += Written;
+		TxHead = (TxHead + Written) % POSIX_SERIAL_BUFFER;
+		TxCount -= Written;
+	}
+	return (TxCount == 0);
+}
+
+bool PosixSerial::HasTxPending()
+{
+	return (TxCount > 0);
+}
+
+/*---------------------------------------------------------------------
+ * the counters
+ * RxBytes/TxBytes: bytes read from and written to the fd
+ * RxOverflows: reads which were cut as the Rx buffer was full
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t PosixSerial::GetRxBytes()
+{
+	return RxBytes;
+}
+
+uint32_t PosixSerial::GetTxBytes()
+{
+	return TxBytes;
+}
+
+uint32_t PosixSerial::GetRxOverflows()
+{
+	return RxOverflows;
+}
@@ -0,0 +1,76 @@
+#ifndef POSIX_SERIAL_H
+#define POSIX_SERIAL_H
+
+/*--------------------------------------------------------------
+ * class PosixSerial
+ * a serial port of a Linux host - a USB-serial adapter or a pty.
+ * It's opened non-blocking in raw mode by termios and buffered
+ * both ways, so it can be attached to a MCUart in place of Serial1.
+ * The owner is expected to multiplex the fd e.g. by epoll:
+ * - Fill() reads what's there if the fd is readable
+ * - FlushTx() writes what's left once the fd is writable again
+ * available() and read() never call the OS.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <Arduino.h>
+#include <stdint.h>
+
+//--- service define ---
+
+//can be raised by a build flag e.g. -DPOSIX_SERIAL_BUFFER=16384
+#ifndef POSIX_SERIAL_BUFFER
+#define POSIX_SERIAL_BUFFER 4096
+#endif
+
+class PosixSerial : public HardwareSerial {
+	public:
+		PosixSerial();
+		~PosixSerial();
+		void SetDevice(const char *);
+		const char *GetDevice();
+		bool Open(uint32_t);
+
+		void begin(unsigned long);
+		void end();
+		int available();
+		int read();
+		int availableForWrite();
+		size_t write(uint8_t);
+		size_t write(const uint8_t *, size_t);
+		void flush();
+		operator bool();
+
+		using HardwareSerial::write;
+
+		int GetFd();
+		int Fill();
+		bool FlushTx();
+		bool HasTxPending();
+
+		uint32_t GetRxBytes();
+		uint32_t GetTxBytes();
+		uint32_t GetRxOverflows();
+
+	private:
+		const char *Device = NULL;
+		int Fd = -1;
+
+		uint8_t RxBuffer[POSIX_SERIAL_BUFFER];
+		uint16_t RxHead = 0;
+		uint16_t RxCount = 0;
+
+		uint8_t TxBuffer[POSIX_SERIAL_BUFFER];
+		uint16_t TxHead = 0;
+		uint16_t TxCount = 0;
+
+		uint32_t RxBytes = 0;
+		uint32_t TxBytes = 0;
+		uint32_t RxOverflows = 0;
+};
+
+#endif
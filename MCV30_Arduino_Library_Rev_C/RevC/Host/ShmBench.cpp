@@ -0,0 +1,255 @@
+/*--------------------------------------------------------------
+ * ShmBench.cpp
+ * measures the cost of the telemetry segment of ShmTelemetry.h for
+ * the writer and the readers, w/o a gateway:
+ * - single: a single thread writes every record, then reads every
+ *   record - the cost of a write and a read as such
+ * - shared: a writer thread updates the records as fast as it can
+ *   while reader threads poll all of them - the cost of the seqlock
+ *   under contention and the share of copies read again
+ * Every image written carries its own check: Position, Speed and
+ * MotorTemp are derived from Updates. A reader counts any image which
+ * doesn't match as torn - there must be none.
+ *
+ * usage:
+ *   ShmBench [-d drives] [-t seconds] [-r readers] [-n rounds]
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <ShmTelemetry.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+//--- local defines ---
+
+const uint32_t BenchMaxReaders = 16;
+
+typedef struct BenchReader {
+	pthread_t Thread;
+	uint64_t Reads;
+	uint64_t Retries;
+	uint64_t Torn;
+	uint64_t Changes;			//records seen updated
+} BenchReader;
+
+//--- globals ---
+
+static char ShmName[64];
+static uint32_t DriveCount = 64;
+static ShmTelemetryWriter Writer;
+static std::atomic<bool> isRunning {false};
+static std::atomic<bool> isStopping {false};
+static uint64_t Writes = 0;
+
+//--- implementation ---
+
+static uint64_t NowNs()
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint64_t)Now.tv_sec * 1000000000ULL + (uint64_t)Now.tv_nsec;
+}
+
+static void MakeImage(ShmDriveImage *Image, uint32_t Idx, uint32_t Updates)
+{
+	Image->Bus = Idx / 8;
+	Image->Node = Idx % 8 + 1;
+	Image->isLive = 1;
+	Image->OpMode = 1;
+	Image->StatusWord = 0x0237;
+	Image->DriveErrors = 0;
+	Image->Position = (int32_t)Updates;
+	Image->Speed = -(int32_t)Updates;
+	Image->MotorTemp = (int16_t)(Updates & 0x7FFF);
+	Image->Reserved = 0;
+	Image->TimeStamp = Updates;
+	Image->Updates = Updates;
+}
+
+static bool IsConsistent(const ShmDriveImage *Image)
+{
+	return (Image->Position == (int32_t)Image->Updates) && (Image->Speed == -(int32_t)Image->Updates) &&
+	       (Image->MotorTemp == (int16_t)(Image->Updates & 0x7FFF)) && (Image->TimeStamp == Image->Updates);
+}
+
+static void *RunWriter(void *op)
+{
+	(void)op;
+	uint32_t Updates = 1;
+	ShmDriveImage Image;
+
+	while(!isRunning.load(std::memory_order_acquire))
+		;
+
+	while(!isStopping.load(std::memory_order_relaxed))
+	{
+		for(uint32_t i = 0; i < DriveCount; i++)
+		{
+			MakeImage(&Image, i, Updates);
+			Writer.Write(i, &Image);
+		}
+		Writes += DriveCount;
+		Updates++;
+	}
+	return NULL;
+}
+
+static void *RunReader(void *op)
+{
+	BenchReader *Bench = (BenchReader *)op;
+	ShmTelemetryReader Reader;
+	uint32_t Seen[1024] = {0};
+	ShmDriveImage Image;
+
+	if(!Reader.Open(ShmName))
+		return NULL;
+
+	while(!isRunning.load(std::memory_order_acquire))
+		;
+
+	while(!isStopping.load(std::memory_order_relaxed))
+	{
+		for(uint32_t i = 0; i < Reader.GetCount(); i++)
+		{
+			if(!Reader.Read(i, &Image))
+				continue;
+			if(!IsConsistent(&Image))
+				Bench->Torn++;
+			if((i < 1024) && (Image.Updates != Seen[i]))
+			{
+				Seen[i] = Image.Updates;
+				Bench->Changes++;
+			}
+		}
+		Bench->Reads += Reader.GetCount();
+	}
+	Bench->Retries = Reader.GetRetries();
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t Duration = 2;
+	uint32_t ReaderCount = 2;
+	uint32_t Rounds = 100000;
+	int Opt;
+
+	while((Opt = getopt(argc, argv, "d:t:r:n:")) != -1)
+	{
+		switch(Opt)
+		{
+			case 'd':
+				DriveCount = strtoul(optarg, NULL, 10);
+				break;
+			case 't':
+				Duration = strtoul(optarg, NULL, 10);
+				break;
+			case 'r':
+				ReaderCount = strtoul(optarg, NULL, 10);
+				break;
+			case 'n':
+				Rounds = strtoul(optarg, NULL, 10);
+				break;
+			default:
+				fprintf(stderr, "usage: ShmBench [-d drives] [-t seconds] [-r readers] [-n rounds]\n");
+				return 1;
+		}
+	}
+	if((DriveCount == 0) || (ReaderCount == 0) || (ReaderCount > BenchMaxReaders) || (Rounds == 0))
+	{
+		fprintf(stderr, "Bench: at least 1 drive and 1..%u readers\n", BenchMaxReaders);
+		return 1;
+	}
+
+	snprintf(ShmName, sizeof(ShmName), "/mcshmbench.%d", (int)getpid());
+	if(!Writer.Open(ShmName, DriveCount))
+	{
+		fprintf(stderr, "Bench: can't create %s\n", ShmName);
+		return 1;
+	}
+
+	//--- single ---
+
+	ShmTelemetryReader Reader;
+	ShmDriveImage Image;
+	uint64_t Torn = 0;
+
+	Reader.Open(ShmName);
+
+	uint64_t StartedAt = NowNs();
+
+	for(uint32_t r = 1; r <= Rounds; r++)
+	{
+		for(uint32_t i = 0; i < DriveCount; i++)
+		{
+			MakeImage(&Image, i, r);
+			Writer.Write(i, &Image);
+		}
+	}
+
+	uint64_t WrittenAt = NowNs();
+
+	for(uint32_t r = 0; r < Rounds; r++)
+	{
+		for(uint32_t i = 0; i < DriveCount; i++)
+		{
+			Reader.Read(i, &Image);
+			Torn += !IsConsistent(&Image);
+		}
+	}
+
+	uint64_t ReadAt = NowNs();
+	double Count = (double)Rounds * DriveCount;
+
+	printf("%u records of %u bytes, %ld CPUs\n", DriveCount, (uint32_t)sizeof(ShmDriveRecord), sysconf(_SC_NPROCESSORS_ONLN));
+	printf("single: write %.1f ns  read %.1f ns  torn %lu\n",
+	       (WrittenAt - StartedAt) / Count, (ReadAt - WrittenAt) / Count, (unsigned long)Torn);
+
+	//--- shared ---
+
+	pthread_t WriterThread;
+	BenchReader Readers[BenchMaxReaders] = {};
+
+	pthread_create(&WriterThread, NULL, RunWriter, NULL);
+	for(uint32_t r = 0; r < ReaderCount; r++)
+		pthread_create(&Readers[r].Thread, NULL, RunReader, &Readers[r]);
+
+	usleep(100000);
+	StartedAt = NowNs();
+	isRunning.store(true, std::memory_order_release);
+	sleep(Duration);
+	isStopping.store(true);
+
+	pthread_join(WriterThread, NULL);
+	double Seconds = (NowNs() - StartedAt) / 1e9;
+
+	uint64_t Reads = 0;
+	uint64_t Retries = 0;
+	uint64_t Changes = 0;
+
+	Torn = 0;
+	for(uint32_t r = 0; r < ReaderCount; r++)
+	{
+		pthread_join(Readers[r].Thread, NULL);
+		Reads += Readers[r].Reads;
+		Retries += Readers[r].Retries;
+		Torn += Readers[r].Torn;
+		Changes += Readers[r].Changes;
+	}
+
+	printf("shared: %u readers  writes %.0f/s  reads %.0f/s  retried %.3f%%  updates seen %.1f%%  torn %lu\n",
+	       ReaderCount, Writes / Seconds, Reads / Seconds,
+	       Reads ? 100.0 * Retries / Reads : 0.0,
+	       Writes ? 100.0 * Changes / ((double)Writes * ReaderCount) : 0.0, (unsigned long)Torn);
+
+	Writer.Close();
+	return (Torn == 0) ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/*--------------------------------------------------------------
+ * ShmMonitor.cpp
+ * reader of the telemetry segment the HostGateway exports by -m:
+ * prints the process image of every drive at an interval. The
+ * records are polled by the ShmTelemetryReader - no syscall and no
+ * request to the gateway per record.
+ *
+ * usage:
+ *   ShmMonitor [-m shm name] [-i interval ms] [-n count]
+ * -n 0 (default) prints until SIGINT
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <ShmTelemetry.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+
+//--- globals ---
+
+static volatile sig_atomic_t isStopped = 0;
+
+//--- implementation ---
+
+static void OnSignal(int Signal)
+{
+	(void)Signal;
+	isStopped = 1;
+}
+
+//the clock of the gateway's millis()
+
+static uint32_t NowMs()
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint32_t)((uint64_t)Now.tv_sec * 1000ULL + (uint64_t)(Now.tv_nsec / 1000000));
+}
+
+int main(int argc, char **argv)
+{
+	const char *ShmName = ShmNameDefault;
+	uint32_t Interval = 1000;
+	uint32_t Rounds = 0;
+	int Opt;
+
+	while((Opt = getopt(argc, argv, "m:i:n:")) != -1)
+	{
+		switch(Opt)
+		{
+			case 'm':
+				ShmName = optarg;
+				break;
+			case 'i':
+				Interval = strtoul(optarg, NULL, 10);
+				break;
+			case 'n':
+				Rounds = strtoul(optarg, NULL, 10);
+				break;
+			default:
+				fprintf(stderr, "usage: ShmMonitor [-m shm name] [-i interval ms] [-n count]\n");
+				return 1;
+		}
+	}
+
+	ShmTelemetryReader Reader;
+
+	if(!Reader.Open(ShmName))
+	{
+		fprintf(stderr, "Monitor: no telemetry at %s\n", ShmName);
+		return 1;
+	}
+
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+
+	for(uint32_t Round = 0; !isStopped && ((Rounds == 0) || (Round < Rounds)); Round++)
+	{
+		if(Round > 0)
+			usleep(Interval * 1000);
+
+		uint32_t actTime = NowMs();
+
+		printf("bus  node  live      SW  mode    position       speed  temp  errors  age ms   updates\n");
+		for(uint32_t i = 0; i < Reader.GetCount(); i++)
+		{
+			ShmDriveImage Image;
+
+			if(!Reader.Read(i, &Image))
+				continue;
+
+			printf("%3u  %4u  %4u  0x%04X  %4d  %10d  %10d  %4d  0x%04X  %6d  %8u\n",
+			       Image.Bus, Image.Node, Image.isLive, Image.StatusWord, Image.OpMode,
+			       Image.Position, Image.Speed, Image.MotorTemp, Image.DriveErrors,
+			       Image.TimeStamp ? (int32_t)(actTime - Image.TimeStamp) : -1, Image.Updates);
+		}
+		fflush(stdout);
+	}
+
+	return 0;
+}
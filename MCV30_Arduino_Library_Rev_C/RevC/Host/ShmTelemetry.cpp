@@ -0,0 +1,151 @@
+/*---------------------------------------------------
+ * ShmTelemetry.cpp
+ * maps the telemetry segment for the writer and the readers
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <ShmTelemetry.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//--- writer ---
+
+ShmTelemetryWriter::~ShmTelemetryWriter()
+{
+	Close();
+}
+
+/*---------------------------------------------------------------------
+ * bool Open(const char *ShmName, uint32_t RecordCount)
+ * creates the segment with all the records cleared. The one of a
+ * gateway before is unlinked, not truncated: its readers keep their
+ * mapping instead of a SIGBUS and see the new one when they reopen.
+ * The header is completed last, so a reader never sees a segment
+ * which is valid but too short.
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool ShmTelemetryWriter::Open(const char *ShmName, uint32_t RecordCount)
+{
+	shm_unlink(ShmName);
+
+	int Fd = shm_open(ShmName, O_CREAT | O_EXCL | O_RDWR, 0644);
+
+	if(Fd < 0)
+		return false;
+
+	Size = sizeof(ShmHeader) + RecordCount * sizeof(ShmDriveRecord);
+	if(ftruncate(Fd, Size) != 0)
+	{
+		close(Fd);
+		shm_unlink(ShmName);
+		return false;
+	}
+
+	void *Base = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+
+	close(Fd);
+	if(Base == MAP_FAILED)
+	{
+		shm_unlink(ShmName);
+		return false;
+	}
+
+	//the segment is zeroed by ftruncate
+	Header = (ShmHeader *)Base;
+	Records = (ShmDriveRecord *)((uint8_t *)Base + sizeof(ShmHeader));
+	Count = RecordCount;
+	strncpy(Name, ShmName, sizeof(Name) - 1);
+
+	Header->Version = ShmVersion;
+	Header->RecordSize = sizeof(ShmDriveRecord);
+	Header->RecordCount = RecordCount;
+	Header->WriterPid = getpid();
+	std::atomic_thread_fence(std::memory_order_release);
+	Header->Magic = ShmMagic;
+
+	return true;
+}
+
+void ShmTelemetryWriter::Close()
+{
+	if(Header == NULL)
+		return;
+
+	munmap(Header, Size);
+	shm_unlink(Name);
+	Header = NULL;
+	Records = NULL;
+	Count = 0;
+}
+
+//--- reader ---
+
+ShmTelemetryReader::~ShmTelemetryReader()
+{
+	Close();
+}
+
+/*---------------------------------------------------------------------
+ * bool Open(const char *ShmName)
+ * maps the segment of a running gateway read-only
+ * returns false if there is none or it's of another version
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool ShmTelemetryReader::Open(const char *ShmName)
+{
+	int Fd = shm_open(ShmName, O_RDONLY, 0);
+	struct stat Stat;
+
+	if(Fd < 0)
+		return false;
+
+	if((fstat(Fd, &Stat) != 0) || ((size_t)Stat.st_size < sizeof(ShmHeader)))
+	{
+		close(Fd);
+		return false;
+	}
+
+	Size = Stat.st_size;
+	void *Base = mmap(NULL, Size, PROT_READ, MAP_SHARED, Fd, 0);
+
+	close(Fd);
+	if(Base == MAP_FAILED)
+		return false;
+
+	Header = (const ShmHeader *)Base;
+	Records = (const ShmDriveRecord *)((const uint8_t *)Base + sizeof(ShmHeader));
+
+	if((Header->Magic != ShmMagic) || (Header->Version != ShmVersion) ||
+	   (Header->RecordSize != sizeof(ShmDriveRecord)) ||
+	   (sizeof(ShmHeader) + Header->RecordCount * sizeof(ShmDriveRecord) > Size))
+	{
+		Close();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	Count = Header->RecordCount;
+
+	return true;
+}
+
+void ShmTelemetryReader::Close()
+{
+	if(Header == NULL)
+		return;
+
+	munmap((void *)Header, Size);
+	Header = NULL;
+	Records = NULL;
+	Count = 0;
+}
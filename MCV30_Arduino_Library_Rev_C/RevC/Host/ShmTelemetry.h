@@ -0,0 +1,135 @@
+#ifndef SHM_TELEMETRY_H
+#define SHM_TELEMETRY_H
+
+/*--------------------------------------------------------------
+ * ShmTelemetry.h
+ * the process image of the drives in a POSIX shared memory segment,
+ * exported by the HostGateway for any number of local readers.
+ * The segment is a ShmHeader followed by a ShmDriveRecord per drive,
+ * each on a cache line of its own. A record is written in place by
+ * the single thread owning the drive and guarded by a seqlock: the
+ * sequence is odd while the record is written. A reader copies the
+ * image and takes it if the sequence was even and didn't change
+ * meanwhile - otherwise it tries again. Neither side takes a lock or
+ * calls the kernel once the segment is mapped, and a reader never
+ * delays the writer.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+//--- service define ---
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+const uint32_t ShmMagic = 0x4554434D;		//"MCTE"
+const uint16_t ShmVersion = 1;
+const char ShmNameDefault[] = "/mcgateway";
+
+typedef struct ShmDriveImage {
+	uint8_t Bus;
+	uint8_t Node;
+	uint8_t isLive;			//the last snapshot has been read
+	int8_t OpMode;
+	uint16_t StatusWord;
+	uint16_t DriveErrors;
+	int32_t Position;
+	int32_t Speed;
+	int16_t MotorTemp;
+	uint16_t Reserved;
+	uint32_t TimeStamp;		//ms of CLOCK_MONOTONIC (32 bit) the snapshot has been taken, 0: never
+	uint32_t Updates;		//snapshots written
+} ShmDriveImage;
+
+typedef struct alignas(CACHE_LINE_SIZE) ShmDriveRecord {
+	std::atomic<uint32_t> Seq;
+	ShmDriveImage Image;
+} ShmDriveRecord;
+
+typedef struct alignas(CACHE_LINE_SIZE) ShmHeader {
+	uint32_t Magic;
+	uint16_t Version;
+	uint16_t RecordSize;
+	uint32_t RecordCount;
+	uint32_t WriterPid;
+} ShmHeader;
+
+static_assert(sizeof(ShmDriveRecord) == CACHE_LINE_SIZE, "a record has to fill a cache line");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "the seqlock has to be lock-free across processes");
+
+class ShmTelemetryWriter {
+	public:
+		~ShmTelemetryWriter();
+		bool Open(const char *, uint32_t);
+		void Close();
+		uint32_t GetCount() { return Count; };
+
+		//the thread owning the drive only - one writer per record
+		void Write(uint32_t Idx, const ShmDriveImage *Image) {
+			ShmDriveRecord *Record = &Records[Idx];
+			uint32_t Seq = Record->Seq.load(std::memory_order_relaxed);
+
+			Record->Seq.store(Seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			memcpy(&Record->Image, Image, sizeof(ShmDriveImage));
+			Record->Seq.store(Seq + 2, std::memory_order_release);
+		};
+
+	private:
+		char Name[64] = {0};
+		ShmHeader *Header = NULL;
+		ShmDriveRecord *Records = NULL;
+		uint32_t Count = 0;
+		size_t Size = 0;
+};
+
+class ShmTelemetryReader {
+	public:
+		~ShmTelemetryReader();
+		bool Open(const char *);
+		void Close();
+		uint32_t GetCount() { return Count; };
+		uint64_t GetRetries() { return Retries; };
+
+		//the sequence changes with every update of the record
+		uint32_t GetSeq(uint32_t Idx) {
+			return Records[Idx].Seq.load(std::memory_order_acquire);
+		};
+
+		//a consistent copy - false if the record has never been written
+		bool Read(uint32_t Idx, ShmDriveImage *Image) {
+			const ShmDriveRecord *Record = &Records[Idx];
+			uint32_t Before, After;
+
+			do
+			{
+				Before = Record->Seq.load(std::memory_order_acquire);
+				while(Before & 1)
+					Before = Record->Seq.load(std::memory_order_acquire);
+
+				memcpy(Image, (const void *)&Record->Image, sizeof(ShmDriveImage));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				After = Record->Seq.load(std::memory_order_relaxed);
+				Retries += (Before != After);
+			} while(Before != After);
+
+			return (Before != 0);
+		};
+
+	private:
+		const ShmHeader *Header = NULL;
+		const ShmDriveRecord *Records = NULL;
+		uint32_t Count = 0;
+		size_t Size = 0;
+		uint64_t Retries = 0;		//copies torn by the writer
+};
+
+#endif
@@ -0,0 +1,573 @@
+/*--------------------------------------------------------------
+ * SimDrive.cpp
+ * simulated MC V3.0 drives behind ptys, so the HostGateway can be
+ * run and benchmarked w/o any hardware.
+ * Creates a pty for every bus and serves the nodes 1..n at each.
+ * The slave side of every pty is printed to stdout in the form
+ * the HostGateway takes it - <path>@1,2,..,n - one per line.
+ * Every node has got a small object dictionary. Reads and writes of
+ * SDOs are answered, a CW is acknowledged and followed by the SW.
+ * The actual position 0x6064 moves on with every read.
+ * Optionally the responses are paced as on a real line: the time of
+ * the frame at the given rate plus a processing delay of the drive.
+ * The buses are served by a single thread or spread over -j threads,
+ * so the simulation doesn't limit a threaded gateway.
+ *
+ * usage:
+ *   SimDrive [-b buses] [-n nodes] [-r baud] [-d delay us] [-j threads]
+ * runs until SIGINT or SIGTERM and prints its counters to stderr
+ *
+ * 2026-10-18 AW Frame
+ * 2026-10-18 AW threads, the snapshot objects of MCDrive::RefreshAll()
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+//--- local defines ---
+
+#ifndef SIMDRIVE_MAX_BUSES
+#define SIMDRIVE_MAX_BUSES 64
+#endif
+
+const uint8_t SimMaxThreads = 16;
+
+const uint8_t SimMaxNodes = 16;
+const uint8_t SimMaxObjects = 24;
+const uint8_t SimMaxFrame = 64;
+const uint8_t SimTxQueueSize = 64;
+
+const uint8_t MsgPrefix = 0x53;
+const uint8_t MsgSuffix = 0x45;
+
+//the commands as of MsgHandler.h
+const uint8_t CmdSdoRead = 1;
+const uint8_t CmdSdoWrite = 2;
+const uint8_t CmdSdoError = 3;
+const uint8_t CmdCtrlWord = 4;
+const uint8_t CmdStatusWord = 5;
+
+const uint32_t SdoErrNoObject = 0x06020000;
+const uint32_t SdoErrReadOnly = 0x06010002;
+
+typedef struct SimObject {
+	uint16_t Idx;
+	uint8_t Sub;
+	uint8_t Len;
+	uint32_t Value;
+	bool isReadOnly;
+} SimObject;
+
+static const SimObject SimDictionary[] = {
+	{0x1000, 0x00, 4, 0x00420192, true},	//device type
+	{0x1001, 0x00, 1, 0, true},				//error register
+	{0x6040, 0x00, 2, 0, false},			//CW
+	{0x6041, 0x00, 2, 0x0250, true},		//SW
+	{0x6060, 0x00, 1, 1, false},			//op mode
+	{0x6061, 0x00, 1, 1, true},
+	{0x6064, 0x00, 4, 0, true},				//actual position
+	{0x606C, 0x00, 4, 0, true},				//actual speed
+	{0x607A, 0x00, 4, 0, false},			//target position
+	{0x6081, 0x00, 4, 1000, false},			//profile
+	{0x6083, 0x00, 4, 1000, false},
+	{0x6084, 0x00, 4, 1000, false},
+	{0x6086, 0x00, 2, 0, false},
+	{0x6098, 0x00, 1, 17, false},			//homing method
+	{0x60FF, 0x00, 4, 0, false},			//target speed
+	{0x2320, 0x00, 2, 0, true},				//drive errors
+	{0x2326, 0x03, 2, 30, true}				//motor temp
+};
+
+const uint8_t SimDictionarySize = sizeof(SimDictionary) / sizeof(SimObject);
+
+typedef struct SimNode {
+	SimObject Object[SimMaxObjects];
+	uint8_t ObjectCount;
+} SimNode;
+
+typedef struct SimFrame {
+	uint64_t Due;
+	uint8_t Len;
+	uint8_t Data[SimMaxFrame];
+} SimFrame;
+
+typedef struct SimBus {
+	int Master;
+	int Slave;					//kept open - w/o it the master gets a HUP
+	char Path[64];
+	SimNode Node[SimMaxNodes];
+
+	uint8_t Rx[2 * SimMaxFrame];
+	uint8_t RxLen;
+
+	SimFrame TxQueue[SimTxQueueSize];
+	uint8_t TxHead;
+	uint8_t TxCount;
+	uint64_t LineFreeAt;
+
+	uint32_t Requests;
+	uint32_t Responses;
+	uint32_t Errors;
+	uint32_t Garbage;
+} SimBus;
+
+//--- globals ---
+
+static SimBus *Buses[SIMDRIVE_MAX_BUSES];
+static uint8_t BusCount = 1;
+static uint8_t NodeCount = 1;
+static uint32_t BaudRate = 0;		//0: respond at once
+static uint32_t DelayUs = 0;
+static uint8_t ThreadCount = 1;		//bus b is served by thread b % ThreadCount
+static volatile sig_atomic_t isStopped = 0;
+
+//--- implementation ---
+
+static uint64_t NowUs()
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return (uint64_t)Now.tv_sec * 1000000ULL + (uint64_t)(Now.tv_nsec / 1000);
+}
+
+static void OnSignal(int Signal)
+{
+	(void)Signal;
+	isStopped = 1;
+}
+
+//the CRC as of MsgHandler::CalcCRC()
+
+static uint8_t CalcCRC(const uint8_t *Buffer, int Len)
+{
+	uint8_t CRC = 0xFF;
+
+	for(int i = 0; i < Len; i++)
+	{
+		CRC = CRC ^ Buffer[i];
+		for(uint8_t j = 0; j < 8; j++)
+		{
+			if(CRC & 0x01)
+				CRC = (CRC >> 1) ^ 0xd5;
+			else
+				CRC = (CRC >> 1);
+		}
+	}
+	return CRC;
+}
+
+static SimObject *FindObject(SimNode *Node, uint16_t Idx, uint8_t Sub)
+{
+	for(uint8_t i = 0; i < Node->ObjectCount; i++)
+		if((Node->Object[i].Idx == Idx) && (Node->Object[i].Sub == Sub))
+			return &Node->Object[i];
+
+	return NULL;
+}
+
+//the SW a CiA 402 drive would report for a CW
+
+static uint16_t StatusOfControl(uint16_t CW)
+{
+	switch(CW & 0x008F)
+	{
+		case 0x0006:
+			return 0x0221;		//ready to switch on
+		case 0x0007:
+			return 0x0233;		//switched on
+		case 0x000F:
+			return 0x0237;		//operation enabled
+		default:
+			return 0x0250;		//switch on disabled
+	}
+}
+
+static void WriteOut(SimBus *Bus)
+{
+	uint64_t Now = NowUs();
+
+	while(Bus->TxCount > 0)
+	{
+		SimFrame *Frame = &Bus->TxQueue[Bus->TxHead];
+
+		if(Frame->Due > Now)
+			break;
+
+		if(write(Bus->Master, Frame->Data, Frame->Len) < 0)
+		{
+			if(errno == EAGAIN)
+				break;
+		}
+		Bus->TxHead = (Bus->TxHead + 1) % SimTxQueueSize;
+		Bus->TxCount--;
+		Bus->Responses++;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * Respond(SimBus *Bus, uint8_t NodeId, uint8_t Cmd, const uint8_t *Data, uint8_t Len)
+ * frame the payload and queue it
+ * w/o pacing it's written right away
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static void Respond(SimBus *Bus, uint8_t NodeId, uint8_t Cmd, const uint8_t *Data, uint8_t Len)
+{
+	if(Bus->TxCount >= SimTxQueueSize)
+		return;
+
+	SimFrame *Frame = &Bus->TxQueue[(Bus->TxHead + Bus->TxCount) % SimTxQueueSize];
+	uint8_t FrameLen = Len + 4;		//len, node, cmd, data.., crc
+
+	Frame->Data[0] = MsgPrefix;
+	Frame->Data[1] = FrameLen;
+	Frame->Data[2] = NodeId;
+	Frame->Data[3] = Cmd;
+	memcpy(&Frame->Data[4], Data, Len);
+	Frame->Data[FrameLen] = CalcCRC(&Frame->Data[1], FrameLen - 1);
+	Frame->Data[FrameLen + 1] = MsgSuffix;
+	Frame->Len = FrameLen + 2;
+
+	uint64_t Now = NowUs();
+
+	Frame->Due = Now;
+	if(BaudRate > 0)
+	{
+		uint64_t Start = Now + DelayUs;
+
+		if(Bus->LineFreeAt > Start)
+			Start = Bus->LineFreeAt;
+		Frame->Due = Start + (uint64_t)Frame->Len * 10 * 1000000ULL / BaudRate;
+		Bus->LineFreeAt = Frame->Due;
+	}
+	else
+		Frame->Due += DelayUs;
+
+	Bus->TxCount++;
+	WriteOut(Bus);
+}
+
+static void SdoError(SimBus *Bus, uint8_t NodeId, uint16_t Idx, uint8_t Sub, uint32_t Code)
+{
+	uint8_t Data[7];
+
+	Data[0] = Idx & 0xff;
+	Data[1] = Idx >> 8;
+	Data[2] = Sub;
+	memcpy(&Data[3], &Code, 4);
+	Bus->Errors++;
+	Respond(Bus, NodeId, CmdSdoError, Data, 7);
+}
+
+static void OnFrame(SimBus *Bus, const uint8_t *Frame)
+{
+	uint8_t Len = Frame[1];
+	uint8_t NodeId = Frame[2];
+	uint8_t Cmd = Frame[3];
+
+	if((NodeId == 0) || (NodeId > NodeCount))
+		return;
+
+	SimNode *Node = &Bus->Node[NodeId - 1];
+
+	Bus->Requests++;
+
+	switch(Cmd)
+	{
+		case CmdSdoRead:
+		case CmdSdoWrite:
+			{
+				uint16_t Idx = Frame[4] | (Frame[5] << 8);
+				uint8_t Sub = Frame[6];
+				SimObject *Object = FindObject(Node, Idx, Sub);
+				uint8_t Data[7];
+
+				if(Object == NULL)
+				{
+					SdoError(Bus, NodeId, Idx, Sub, SdoErrNoObject);
+					break;
+				}
+
+				memcpy(Data, &Frame[4], 3);
+				if(Cmd == CmdSdoRead)
+				{
+					if(Idx == 0x6064)
+						Object->Value += NodeId;
+
+					memcpy(&Data[3], &Object->Value, Object->Len);
+					Respond(Bus, NodeId, CmdSdoRead, Data, 3 + Object->Len);
+					break;
+				}
+
+				if(Object->isReadOnly)
+				{
+					SdoError(Bus, NodeId, Idx, Sub, SdoErrReadOnly);
+					break;
+				}
+
+				uint32_t Value = 0;
+				uint8_t DataLen = Len - 7;
+
+				memcpy(&Value, &Frame[7], (DataLen > 4) ? 4 : DataLen);
+				Object->Value = Value;
+
+				if(Idx == 0x6060)
+					FindObject(Node, 0x6061, 0)->Value = Value;
+				if(Idx == 0x6040)
+					FindObject(Node, 0x6041, 0)->Value = StatusOfControl(Value);
+
+				Respond(Bus, NodeId, CmdSdoWrite, Data, 3);
+			}
+			break;
+		case CmdCtrlWord:
+			{
+				uint16_t CW = Frame[4] | (Frame[5] << 8);
+				uint16_t SW = StatusOfControl(CW);
+				uint8_t Error = 0;
+
+				FindObject(Node, 0x6040, 0)->Value = CW;
+				FindObject(Node, 0x6041, 0)->Value = SW;
+				Respond(Bus, NodeId, CmdCtrlWord, &Error, 1);
+				Respond(Bus, NodeId, CmdStatusWord, (uint8_t *)&SW, 2);
+			}
+			break;
+		case CmdStatusWord:
+			{
+				uint16_t SW = FindObject(Node, 0x6041, 0)->Value;
+
+				Respond(Bus, NodeId, CmdStatusWord, (uint8_t *)&SW, 2);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * ReadIn(SimBus *Bus)
+ * collect the frames - anything not starting with the prefix or
+ * failing the CRC is skipped byte by byte
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static void ReadIn(SimBus *Bus)
+{
+	for(;;)
+	{
+		ssize_t Len = read(Bus->Master, &Bus->Rx[Bus->RxLen], sizeof(Bus->Rx) - Bus->RxLen);
+
+		if(Len <= 0)
+			return;
+		Bus->RxLen += Len;
+
+		uint8_t Used = 0;
+
+		while(Bus->RxLen - Used >= 2)
+		{
+			const uint8_t *Frame = &Bus->Rx[Used];
+			uint8_t FrameLen = Frame[1] + 2;
+
+			if((Frame[0] != MsgPrefix) || (FrameLen > SimMaxFrame) || (Frame[1] < 4))
+			{
+				Bus->Garbage++;
+				Used++;
+				continue;
+			}
+			if(Bus->RxLen - Used < FrameLen)
+				break;
+
+			if((Frame[FrameLen - 1] != MsgSuffix) || (Frame[Frame[1]] != CalcCRC(&Frame[1], Frame[1] - 1)))
+			{
+				Bus->Garbage++;
+				Used++;
+				continue;
+			}
+			OnFrame(Bus, Frame);
+			Used += FrameLen;
+		}
+		Bus->RxLen -= Used;
+		memmove(Bus->Rx, &Bus->Rx[Used], Bus->RxLen);
+	}
+}
+
+static SimBus *OpenBus()
+{
+	SimBus *Bus = (SimBus *)calloc(1, sizeof(SimBus));
+
+	Bus->Master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if((Bus->Master < 0) || (grantpt(Bus->Master) != 0) || (unlockpt(Bus->Master) != 0) ||
+	   (ptsname_r(Bus->Master, Bus->Path, sizeof(Bus->Path)) != 0))
+	{
+		perror("pty");
+		exit(1);
+	}
+
+	//raw at both ends - the gateway sets its own settings again
+	struct termios Settings;
+
+	Bus->Slave = open(Bus->Path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+	if((Bus->Slave < 0) || (tcgetattr(Bus->Slave, &Settings) != 0))
+	{
+		perror(Bus->Path);
+		exit(1);
+	}
+	cfmakeraw(&Settings);
+	tcsetattr(Bus->Slave, TCSANOW, &Settings);
+
+	for(uint8_t n = 0; n < SimMaxNodes; n++)
+	{
+		memcpy(Bus->Node[n].Object, SimDictionary, sizeof(SimDictionary));
+		Bus->Node[n].ObjectCount = SimDictionarySize;
+	}
+	return Bus;
+}
+
+static int GetWaitTime(uint8_t Thread)
+{
+	uint64_t Now = NowUs();
+	int Wait = -1;
+
+	for(uint8_t b = Thread; b < BusCount; b += ThreadCount)
+	{
+		if(Buses[b]->TxCount == 0)
+			continue;
+
+		uint64_t Due = Buses[b]->TxQueue[Buses[b]->TxHead].Due;
+		int Left = (Due > Now) ? (int)((Due - Now + 999) / 1000) : 0;
+
+		if((Wait < 0) || (Left < Wait))
+			Wait = Left;
+	}
+	return Wait;
+}
+
+//the loop of a thread serving its share of the buses
+
+static void *Serve(void *op)
+{
+	uint8_t Thread = (uint8_t)(uintptr_t)op;
+	int EpollFd = epoll_create1(EPOLL_CLOEXEC);
+
+	for(uint8_t b = Thread; b < BusCount; b += ThreadCount)
+	{
+		struct epoll_event Event;
+
+		Event.events = EPOLLIN;
+		Event.data.u32 = b;
+		epoll_ctl(EpollFd, EPOLL_CTL_ADD, Buses[b]->Master, &Event);
+	}
+
+	struct epoll_event Events[64];
+
+	while(!isStopped)
+	{
+		//only the thread taking the signal is interrupted - the others look now and then
+		int Wait = GetWaitTime(Thread);
+		int Count = epoll_wait(EpollFd, Events, 64, ((Wait < 0) || (Wait > 100)) ? 100 : Wait);
+
+		for(int i = 0; i < Count; i++)
+			ReadIn(Buses[Events[i].data.u32]);
+
+		for(uint8_t b = Thread; b < BusCount; b += ThreadCount)
+			if(Buses[b]->TxCount > 0)
+				WriteOut(Buses[b]);
+	}
+	close(EpollFd);
+
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	int Opt;
+
+	while((Opt = getopt(argc, argv, "b:n:r:d:j:")) != -1)
+	{
+		switch(Opt)
+		{
+			case 'b':
+				BusCount = atoi(optarg);
+				break;
+			case 'n':
+				NodeCount = atoi(optarg);
+				break;
+			case 'r':
+				BaudRate = strtoul(optarg, NULL, 10);
+				break;
+			case 'd':
+				DelayUs = strtoul(optarg, NULL, 10);
+				break;
+			case 'j':
+				ThreadCount = atoi(optarg);
+				break;
+			default:
+				fprintf(stderr, "usage: SimDrive [-b buses] [-n nodes] [-r baud] [-d delay us] [-j threads]\n");
+				return 1;
+		}
+	}
+	if((BusCount == 0) || (BusCount > SIMDRIVE_MAX_BUSES) || (NodeCount == 0) || (NodeCount > SimMaxNodes))
+	{
+		fprintf(stderr, "SimDrive: 1..%d buses of 1..%d nodes\n", SIMDRIVE_MAX_BUSES, SimMaxNodes);
+		return 1;
+	}
+	if((ThreadCount == 0) || (ThreadCount > SimMaxThreads))
+	{
+		fprintf(stderr, "SimDrive: 1..%d threads\n", SimMaxThreads);
+		return 1;
+	}
+	if(ThreadCount > BusCount)
+		ThreadCount = BusCount;
+
+	for(uint8_t b = 0; b < BusCount; b++)
+	{
+		Buses[b] = OpenBus();
+
+		printf("%s@", Buses[b]->Path);
+		for(uint8_t n = 1; n <= NodeCount; n++)
+			printf((n < NodeCount) ? "%u," : "%u\n", n);
+	}
+	fflush(stdout);
+
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+
+	pthread_t Threads[SimMaxThreads];
+
+	for(uint8_t t = 1; t < ThreadCount; t++)
+		pthread_create(&Threads[t], NULL, Serve, (void *)(uintptr_t)t);
+
+	Serve((void *)0);
+
+	for(uint8_t t = 1; t < ThreadCount; t++)
+		pthread_join(Threads[t], NULL);
+
+	uint32_t Requests = 0;
+	uint32_t Errors = 0;
+	uint32_t Garbage = 0;
+
+	for(uint8_t b = 0; b < BusCount; b++)
+	{
+		Requests += Buses[b]->Requests;
+		Errors += Buses[b]->Errors;
+		Garbage += Buses[b]->Garbage;
+	}
+	fprintf(stderr, "SimDrive: %u requests %u SDO errors %u bytes skipped\n", Requests, Errors, Garbage);
+
+	return 0;
+}
@@ -0,0 +1,357 @@
+/*--------------------------------------------------------------
+ * StackCheck.cpp
+ * checks of the libraries w/o any pty or SimDrive: the drive is
+ * played by the check itself behind a LoopSerial, so the order and
+ * the time of every response can be set up exactly as needed.
+ * The stack runs on a time of its own which is stepped by 1ms.
+ * Every check prints a line and the exit code is 0 if all have
+ * passed.
+ *
+ * usage:
+ *   StackCheck
+ *
+ * 2026-10-18 AW Frame
+ * 2026-10-18 AW PollPlanner
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include <MsgHandler.h>
+#include <SDOHandler.h>
+#include <MCDrive.h>
+#include <PollPlanner.h>
+
+//--- local defines ---
+
+const uint8_t CheckNodeId = 1;
+const uint16_t LoopBufferSize = 512;
+const uint8_t CheckMaxRequests = 16;
+
+const uint8_t MsgPrefix = 0x53;
+const uint8_t MsgSuffix = 0x45;
+
+//the commands as of MsgHandler.h
+const uint8_t CmdSdoRead = 1;
+const uint8_t CmdSdoWrite = 2;
+const uint8_t CmdSdoError = 3;
+
+const uint32_t SdoErrNoObject = 0x06020000;
+
+typedef struct CheckRequest {
+	uint8_t Cmd;
+	uint16_t Idx;
+	uint8_t SubIdx;
+} CheckRequest;
+
+/*---------------------------------------------------------------------
+ * class LoopSerial
+ * the port of the MsgHandler - what is written is kept to be taken by
+ * the check, what the check puts in is read by the MCUart
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+class LoopSerial : public HardwareSerial {
+	public:
+		void begin(unsigned long) {};
+		void end() {};
+		int available() {
+			return RxLen - RxIdx;
+		};
+		int read() {
+			return (RxIdx < RxLen) ? Rx[RxIdx++] : -1;
+		};
+		int availableForWrite() {
+			return UART_MAX_MSG_SIZE;
+		};
+		size_t write(uint8_t c) {
+			return write(&c, 1);
+		};
+		size_t write(const uint8_t *Buffer, size_t Len) {
+			if(TxLen + Len > LoopBufferSize)
+				return 0;
+			memcpy(&Tx[TxLen], Buffer, Len);
+			TxLen += Len;
+			return Len;
+		};
+		void flush() {};
+		operator bool() {
+			return true;
+		};
+
+		using HardwareSerial::write;
+
+		uint8_t TakeRequests(CheckRequest *, uint8_t);
+		void Respond(uint8_t, uint16_t, uint8_t, const uint8_t *, uint8_t);
+		void RespondRead(uint16_t, uint8_t, uint32_t, uint8_t);
+		void RespondError(uint16_t, uint8_t, uint32_t);
+
+	private:
+		uint8_t Tx[LoopBufferSize];
+		uint16_t TxLen = 0;
+		uint8_t Rx[LoopBufferSize];
+		uint16_t RxLen = 0;
+		uint16_t RxIdx = 0;
+};
+
+//--- globals ---
+
+static uint32_t CheckTime = 1000;
+static uint16_t Failed = 0;
+
+//--- implementation ---
+
+//the CRC as of MsgHandler::CalcCRC()
+
+static uint8_t CalcCRC(const uint8_t *Buffer, int Len)
+{
+	uint8_t CRC = 0xFF;
+
+	for(int i = 0; i < Len; i++)
+	{
+		CRC = CRC ^ Buffer[i];
+		for(uint8_t j = 0; j < 8; j++)
+		{
+			if(CRC & 0x01)
+				CRC = (CRC >> 1) ^ 0xd5;
+			else
+				CRC = (CRC >> 1);
+		}
+	}
+	return CRC;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t TakeRequests(CheckRequest *List, uint8_t max)
+ * the SDO requests sent since the last call - anything else is skipped
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t LoopSerial::TakeRequests(CheckRequest *List, uint8_t max)
+{
+	uint8_t Count = 0;
+	uint16_t Used = 0;
+
+	while(TxLen - Used >= 2)
+	{
+		const uint8_t *Frame = &Tx[Used];
+		uint16_t FrameLen = Frame[1] + 2;
+
+		if((Frame[0] != MsgPrefix) || (Frame[1] < 4) || (TxLen - Used < FrameLen))
+		{
+			Used++;
+			continue;
+		}
+		if(((Frame[3] == CmdSdoRead) || (Frame[3] == CmdSdoWrite)) && (Count < max))
+		{
+			List[Count].Cmd = Frame[3];
+			List[Count].Idx = Frame[4] | (Frame[5] << 8);
+			List[Count].SubIdx = Frame[6];
+			Count++;
+		}
+		Used += FrameLen;
+	}
+	TxLen = 0;
+	return Count;
+}
+
+/*---------------------------------------------------------------------
+ * void Respond(uint8_t Cmd, uint16_t Idx, uint8_t SubIdx, const uint8_t *Data, uint8_t Len)
+ * frame an SDO response of the drive to be read by the MCUart
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void LoopSerial::Respond(uint8_t Cmd, uint16_t Idx, uint8_t SubIdx, const uint8_t *Data, uint8_t Len)
+{
+	uint8_t FrameLen = Len + 7;		//len, node, cmd, idx, sub, data.., crc
+
+	if(RxIdx == RxLen)
+		RxIdx = RxLen = 0;
+	if(RxLen + FrameLen + 2 > LoopBufferSize)
+		return;
+
+	uint8_t *Frame = &Rx[RxLen];
+
+	Frame[0] = MsgPrefix;
+	Frame[1] = FrameLen;
+	Frame[2] = CheckNodeId;
+	Frame[3] = Cmd;
+	Frame[4] = Idx & 0xff;
+	Frame[5] = Idx >> 8;
+	Frame[6] = SubIdx;
+	memcpy(&Frame[7], Data, Len);
+	Frame[FrameLen] = CalcCRC(&Frame[1], FrameLen - 1);
+	Frame[FrameLen + 1] = MsgSuffix;
+	RxLen += FrameLen + 2;
+}
+
+void LoopSerial::RespondRead(uint16_t Idx, uint8_t SubIdx, uint32_t Value, uint8_t Len)
+{
+	Respond(CmdSdoRead, Idx, SubIdx, (const uint8_t *)&Value, Len);
+}
+
+void LoopSerial::RespondError(uint16_t Idx, uint8_t SubIdx, uint32_t Code)
+{
+	Respond(CmdSdoError, Idx, SubIdx, (const uint8_t *)&Code, 4);
+}
+
+/*---------------------------------------------------------------------
+ * void Step(MsgHandler *Handler, uint16_t ms)
+ * let the time of the stack go on
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static void Step(MsgHandler *Handler, uint16_t ms)
+{
+	for(uint16_t i = 0; i < ms; i++)
+	{
+		CheckTime++;
+		Handler->Update(CheckTime);
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void Serve(LoopSerial *Port, uint32_t Value)
+ * answer all the reads sent meanwhile with Value - 0x2326.03 is
+ * rejected as by a drive w/o a temperature sensor
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static void Serve(LoopSerial *Port, uint32_t Value)
+{
+	CheckRequest Requests[CheckMaxRequests];
+	uint8_t Count = Port->TakeRequests(Requests, CheckMaxRequests);
+
+	for(uint8_t i = 0; i < Count; i++)
+	{
+		if(Requests[i].Cmd != CmdSdoRead)
+			continue;
+		if((Requests[i].Idx == 0x2326) && (Requests[i].SubIdx == 0x03))
+			Port->RespondError(Requests[i].Idx, Requests[i].SubIdx, SdoErrNoObject);
+		else
+			Port->RespondRead(Requests[i].Idx, Requests[i].SubIdx, Value, 4);
+	}
+}
+
+static void Report(const char *Name, bool isOk)
+{
+	printf("%-40s %s\n", Name, isOk ? "ok" : "FAILED");
+	if(!isOk)
+		Failed++;
+}
+
+/*---------------------------------------------------------------------
+ * bool CheckBatchErrorLateRx()
+ * A read batch is failed by the error response to one of its objects
+ * while the others are still in flight. Their late responses must not
+ * be taken as the response of the next single read of the same object.
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static bool CheckBatchErrorLateRx()
+{
+	LoopSerial Port;
+	MsgHandler Handler;
+	SDOHandler Sdo;
+	CheckRequest Requests[CheckMaxRequests];
+	SDOBatchEntry List[3];
+
+	Handler.AttachPort(&Port);
+	Handler.Open(115200);
+	Handler.Update(CheckTime);
+	Sdo.init(&Handler, Handler.RegisterNode(CheckNodeId));
+
+	memset(List, 0, sizeof(List));
+	List[0].Idx = 0x6064;
+	List[1].Idx = 0x5FFF;
+	List[2].Idx = 0x6041;
+
+	Port.TakeRequests(Requests, CheckMaxRequests);
+	if(Sdo.ReadBatch(List, 3) != eWaiting)
+		return false;
+	if(Port.TakeRequests(Requests, CheckMaxRequests) != 3)
+		return false;
+
+	//only the rejected one is answered in time
+	Port.RespondError(0x5FFF, 0x00, SdoErrNoObject);
+	Step(&Handler, 1);
+	if(Sdo.ReadBatch(List, 3) != eError)
+		return false;
+	Sdo.ResetBatchState();
+
+	if(Sdo.ReadSDO(0x6041, 0x00) != eWaiting)
+		return false;
+
+	//the late ones of the batch arrive ahead of the single response
+	Port.RespondRead(0x6041, 0x00, 0x1111, 2);
+	Port.RespondRead(0x6064, 0x00, 0x5555, 4);
+	Port.RespondRead(0x6041, 0x00, 0x0237, 2);
+	Step(&Handler, 1);
+
+	if(Sdo.ReadSDO(0x6041, 0x00) != eDone)
+		return false;
+
+	return (Sdo.GetObjValue() == 0x0237);
+}
+
+/*---------------------------------------------------------------------
+ * bool CheckPollRejectedObject()
+ * One of the objects polled of a drive is rejected by it. The others
+ * of the drive have to be updated at their rate anyway and the rejected
+ * one is disabled after PollMaxFailures.
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+static bool CheckPollRejectedObject()
+{
+	LoopSerial Port;
+	MsgHandler Handler;
+	MCDrive Drive;
+	PollPlanner Poller;
+
+	Handler.AttachPort(&Port);
+	Handler.Open(115200);
+	Handler.Update(CheckTime);
+	Drive.SetNodeId(CheckNodeId);
+	Drive.Connect2MsgHandler(&Handler);
+
+	uint8_t Pos = Poller.AddObject(&Drive, 0x6064, 0x00, 10, 2);
+	uint8_t Temp = Poller.AddObject(&Drive, 0x2326, 0x03, 10, 1);
+	uint8_t Speed = Poller.AddObject(&Drive, 0x606C, 0x00, 10, 1);
+	uint16_t PosUpdates = 0;
+	uint16_t SpeedUpdates = 0;
+
+	for(uint32_t i = 0; i < 2000; i++)
+	{
+		Poller.Update(CheckTime);
+		Serve(&Port, i);
+		Step(&Handler, 1);
+
+		if(Poller.HasChanged(Pos))
+			PosUpdates++;
+		if(Poller.HasChanged(Speed))
+			SpeedUpdates++;
+	}
+
+	uint32_t Value;
+
+	//a new value every 10ms - allow for the one or other late one
+	return ((PosUpdates > 150) && (SpeedUpdates > 150) && !Poller.GetValue(Temp, &Value) &&
+			Poller.IsDisabled(Temp) && (Poller.GetErrors() == PollMaxFailures));
+}
+
+int main()
+{
+	Report("batch error with late responses", CheckBatchErrorLateRx());
+	Report("poll with an object rejected", CheckPollRejectedObject());
+
+	return (Failed == 0) ? 0 : 1;
+}
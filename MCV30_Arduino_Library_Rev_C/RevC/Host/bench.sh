@@ -0,0 +1,33 @@
+#!/bin/sh
+#--------------------------------------------------------------
+# bench.sh [buses] [nodes] [seconds]
+# runs the HostGateway against SimDrive ptys and measures it
+# by the GatewayBench - the results are printed by both the
+# bench and the gateway
+# SIMFLAGS, GWFLAGS and BENCHFLAGS are passed to the three
+#
+# 2026-10-18 AW Frame
+#--------------------------------------------------------------
+
+BUSES=${1:-4}
+NODES=${2:-2}
+SECONDS=${3:-5}
+BUILD=$(dirname "$0")/build
+SOCKET=/tmp/mcgateway.$$.sock
+PORTS=/tmp/mcgateway.$$.ports
+
+"$BUILD/SimDrive" -b "$BUSES" -n "$NODES" $SIMFLAGS > "$PORTS" &
+SIM=$!
+while [ "$(wc -l < "$PORTS")" -lt "$BUSES" ]; do sleep 0.1; done
+
+"$BUILD/HostGateway" -s "$SOCKET" $GWFLAGS $(cat "$PORTS") >&2 &
+GW=$!
+while [ ! -S "$SOCKET" ]; do sleep 0.1; done
+
+"$BUILD/GatewayBench" -s "$SOCKET" -t "$SECONDS" $BENCHFLAGS
+RESULT=$?
+
+kill -TERM $GW; wait $GW
+kill -TERM $SIM; wait $SIM
+rm -f "$PORTS"
+exit $RESULT
@@ -56,7 +56,6 @@ void loop() {
    DriveCommStates NodeState;
    uint32_t currentMillis = millis();
    
-   Drive_A.SetActTime(currentMillis);
    MCMsgHandler.Update(currentMillis); 
    //check the status of the MsgHandler here too
 
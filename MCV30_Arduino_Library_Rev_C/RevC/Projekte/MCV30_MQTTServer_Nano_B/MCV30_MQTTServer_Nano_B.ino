@@ -13,6 +13,12 @@
 #include "WiFiAccess.h"
 #include <MsgHandler.h>
 #include <MCDrive.h>
+#include <DriveBus.h>
+#include <PollPlanner.h>
+#include <MCTelemetry.h>
+#include <TelemetryOutbox.h>
+#include <CommandQueue.h>
+#include <TopicRouter.h>
 #include <stdint.h>
 
 //--- globals ---
@@ -28,46 +34,386 @@ const char* mqttPassword = mqttPASSWORD;
 char subTopic[] = "Nano/ledControl";     //payload[0] will control/set LED
 char pubTopic[] = "Nano/ledState";       //payload[0] will have ledState value
 
-char MCControlSubTopicAll[] = "Nano/MC/Ctrl/+";            //subscribe to all /MC/* topics
-char MCControlSubTopic[] =    "Nano/MC/Ctrl/Control";      //payload[0] will be the requested state
-char MCControlTargetSpeed[] = "Nano/MC/Ctrl/TargetSpeed";  //payload[] is a numeric value
-char MCControlTargetPos[] =   "Nano/MC/Ctrl/TargetPos";    //payload[] is a numeric value
+//the first + is the node id of the drive
+char MCControlSubTopicAll[] = "Nano/MC/+/Ctrl/+";            //subscribe to all /MC/<node>/Ctrl/* topics
+char MCControlSubTopic[] =    "Nano/MC/+/Ctrl/Control";      //payload[] is the requested step
+char MCControlTargetSpeed[] = "Nano/MC/+/Ctrl/TargetSpeed";  //payload[] is a numeric value
+char MCControlTargetPos[] =   "Nano/MC/+/Ctrl/TargetPos";    //payload[] is a numeric value
+char MCObjectReqTopic[] =     "Nano/MC/+/Obj/Req";           //payload[] is a list of objects - see parseObjects()
 
-char MCStatePubTopic[] =      "Nano/MC/State";        //payload will be "EN" or "DI"
-char pubTopicDriveError[] =   "Nano/MC/DriveErrors";
-char pubTopicPosition[] =     "Nano/MC/ActPosition";
-char pubTopicSpeed[] =        "Nano/MC/ActSpeed";
-char pubTopicMotorTemp[] =    "Nano/MC/MotorTemp";
+//published per drive - the %d is the node id
+const char MCStatePubFormat[] =   "Nano/MC/%d/State";
+const char MCTelemetryFormat[] =  "Nano/MC/%d/Telemetry";
+const char MCTelemetryCborFormat[] = "Nano/MC/%d/Telemetry/cbor";
+const char MCAckFormat[] =        "Nano/MC/%d/Ack";
+const char MCQueueFormat[] =      "Nano/MC/%d/Queue";
+const char MCObjectRespFormat[] = "Nano/MC/%d/Obj/Resp";
 
 
 WiFiClient wifiClient;
 PubSubClient mqttClient(wifiClient);
+TopicRouter Router;
+
+//--- MQTT connection ----
+//the connection is kept by a state machine advanced from loop()
+//so the drive communication goes on while the broker is away.
+//Messages are buffered meanwhile and sent again on reconnect.
+
+typedef enum MqttStates {
+  eMqttConnected,
+  eMqttBackoff
+} MqttStates;
+
+const uint32_t mqttBackoffMin = 500;      //ms before the first retry
+const uint32_t mqttBackoffMax = 30000;
+const uint16_t mqttSocketTimeout = 2;     //s a connect may block at most
+const uint8_t outboxFlushPerLoop = 2;     //buffered messages sent per loop pass
+const uint16_t mqttBufferSize = 512;      //the response of a full object batch is about 300
+
+MqttStates MqttState = eMqttBackoff;
+uint32_t mqttBackoff = mqttBackoffMin;
+uint32_t mqttRetryAt = 0;
+TelemetryOutbox Outbox;
 
 //--- LED handling -----
 int ledState = 0;  //store the stae of the led to be able to report it
 
 //--- 4MCDrive ----
+//all the drives found on the bus are served - each one by its own
+//entry of Drives[] with its own command queue, step machine and
+//telemetry. The topics of a drive are Nano/MC/<node>/...
 
-MsgHandler MCMsgHandler;
-MCDrive Drive_A;
+DriveBus MCBus;
+PollPlanner Poller;
 
-const int16_t DriveIdA = 1;
+const uint8_t GatewayMaxDrives = DriveBusMaxDrives;
+const uint8_t GatewayScanLastId = 8;     //node ids scanned at start-up
+const int16_t DriveIdDefault = 1;        //served if none answers the scan
+const uint8_t GatewayTopicLen = 32;
 
-uint8_t requestedDriveStep;
-uint8_t actDriveStep = 0;
-uint32_t updateRate = 10000;
+//--- commands received ----
+//all of them are queued and executed in order, each one is acked
+//with its sequence number. The steps of the drive are the ops 1..8 and 20,
+//the setpoints are ops too so they take effect in order with the moves.
+//The ops from 21 on are internal - they are pushed by the routes of their
+//own topics only and can't be requested by the Control topic.
 
-uint8_t RequestedDriveState = 0;
-uint8_t ActualDriveState = 0;
-int32_t TargetSpeed = 100;
-int32_t TargetPos = 0;
+const uint8_t OpObjectAccess = 21;
+const uint8_t OpSetTargetSpeed = 30;
+const uint8_t OpSetTargetPos = 31;
 
+//--- remote access to any object ----
+//a list of up to SDOMaxBatch objects is read/written by a single
+//batch of SDO requests and answered by a single message
 
-void setup_drive()
+const uint8_t ObjectTagLen = 12;
+const uint16_t ObjectRespLen = 360;
+
+//--- polling of the actual values ----
+//each object at its own rate - the line is scheduled by the PollPlanner
+//the values are published as fields of a single telemetry message per drive
+//if they have moved by more than their deadband or are older than MaxAge
+
+const uint16_t telemetryRate = 10;      //messages per second at most - shared by the drives
+const uint8_t telemetryBurst = 3;
+const uint16_t telemetryWindow = 50;    //ms to collect the changes
+
+//in CBOR mode the position is sampled and sent delta encoded, the
+//messages go to .../Telemetry/cbor then
+const TelemetryEncodings telemetryEncoding = eTelemetryCbor;
+const uint16_t telemetrySamplePeriod = 20;   //ms - 50Hz
+const uint8_t telemetrySamplesPerMsg = 10;
+
+typedef struct PolledObject {
+  uint16_t Idx;
+  uint8_t SubIdx;
+  uint16_t Period;
+  uint8_t Priority;
+  const char *Field;
+  uint32_t Deadband;
+  uint32_t MaxAge;
+} PolledObject;
+
+//the order is the one of the DriveSnapshot used by op 20
+const PolledObject PolledObjects[] = {
+  {0x6064, 0x00,   10, 3, "pos",  10,  1000},
+  {0x6041, 0x00,   20, 3, "sw",    0,  5000},
+  {0x606C, 0x00,  100, 2, "spd",   5,  2000},
+  {0x2320, 0x00,  500, 2, "err",   0, 10000},
+  {0x2326, 0x03, 1000, 1, "temp",  1, 10000}
+};
+
+const uint8_t NumPolledObjects = sizeof(PolledObjects)/sizeof(PolledObjects[0]);
+
+typedef struct GatewayDrive {
+  int16_t NodeId;
+  MCDrive Drive;
+  CommandQueue Commands;
+  MCTelemetry Telemetry;
+  DriveSnapshot Snapshot;
+  uint8_t actDriveStep;
+  int32_t TargetSpeed;
+  int32_t TargetPos;
+  uint8_t PollSlot[NumPolledObjects];
+  uint8_t FieldSlot[NumPolledObjects];
+  char StateTopic[GatewayTopicLen];      //payload "Enabled" or "Disabled"
+  char TelemetryTopic[GatewayTopicLen];  //payload {"pos":..,"sw":..} the changed values
+  char AckTopic[GatewayTopicLen];        //payload {"seq":..,"op":..,"res":..} per command
+  char QueueTopic[GatewayTopicLen];      //payload {"depth":..,"drop":..} every 5s
+  char ObjectTopic[GatewayTopicLen];     //payload {"tag":..,"res":..,"obj":{..}} per object request
+  SDOBatchEntry ObjList[SDOMaxBatch];
+  uint8_t ObjCount;
+  bool isObjPending;                     //ObjList is in use by a queued command
+  uint16_t ObjSeq;
+  char ObjTag[ObjectTagLen];
+} GatewayDrive;
+
+GatewayDrive Drives[GatewayMaxDrives];
+uint8_t NumDrives = 0;
+
+
+
+//publish or buffer a message if the broker is away
+//isLatestOnly: a buffered message of the same topic is replaced
+
+bool publishRaw(const char *Topic, const uint8_t *Payload, uint16_t Len, bool isRetained, bool isLatestOnly)
+{
+  //keep the order - nothing is sent directly while older ones are waiting
+  if((MqttState == eMqttConnected) && (Outbox.GetCount() == 0))
+  {
+    if(mqttClient.publish(Topic, Payload, Len, isRetained))
+      return true;
+  }
+  return Outbox.Push(Topic, Payload, Len, isRetained, isLatestOnly);
+}
+
+bool publishOut(const char *Topic, const char *Payload, bool isRetained, bool isLatestOnly)
+{
+  return publishRaw(Topic, (const uint8_t *)Payload, strlen(Payload), isRetained, isLatestOnly);
+}
+
+void publishLed()
+{
+  char payLoad[2];
+
+  payLoad[0] = ledState ? '1' : '0';
+  payLoad[1] = 0;
+  publishOut(pubTopic, payLoad, true, true);
+}
+
+//send the buffered messages again - a few per loop pass only
+
+void flushOutbox()
+{
+  OutboxEntry *Entry;
+
+  for(uint8_t i = 0; (i < outboxFlushPerLoop) && ((Entry = Outbox.Peek()) != NULL); i++)
+  {
+    if(!mqttClient.publish(Entry->Topic, (const uint8_t *)Entry->Payload, Entry->Len, Entry->isRetained))
+      break;
+    Outbox.Pop();
+  }
+}
+
+//hands the telemetry message over to the MQTT client
+//it is buffered if the broker is away
+
+void OnTelemetryPublish(void *op, void *p)
+{
+  GatewayDrive *gw = (GatewayDrive *)op;
+  TelemetryMsg *Msg = (TelemetryMsg *)p;
+
+  Msg->isSent = publishRaw(gw->TelemetryTopic, (const uint8_t *)Msg->Payload, Msg->Len, false, false);
+}
+
+//publishes the state of a command received
+
+void OnCommandAck(void *op, void *p)
+{
+  GatewayDrive *gw = (GatewayDrive *)op;
+  CommandAck *Ack = (CommandAck *)p;
+  const char *Results[] = {"queued", "coalesced", "dropped", "done", "failed"};
+  char payload[80];
+
+  snprintf(payload, sizeof(payload), "{\"seq\":%u,\"op\":%u,\"val\":%ld,\"res\":\"%s\",\"ms\":%lu}",
+           Ack->Seq, Ack->Op, (long)Ack->Value, Results[Ack->Result], (unsigned long)Ack->Latency);
+  publishOut(gw->AckTopic, payload, false, false);
+
+  //the object list is free again once its command is finished anyhow
+  if((Ack->Op == OpObjectAccess) && (Ack->Seq == gw->ObjSeq) && (Ack->Result != eCmdQueued))
+    gw->isObjPending = false;
+}
+
+//the drive of a node id or NULL
+
+GatewayDrive *findDrive(int32_t NodeId)
+{
+  for(uint8_t i = 0; i < NumDrives; i++)
+  {
+    if(Drives[i].NodeId == NodeId)
+      return &Drives[i];
+  }
+  return NULL;
+}
+
+//a hex number of up to MaxDigits at Text - returns the digits used
+
+uint8_t parseHex(const uint8_t *Text, const uint8_t *End, uint8_t MaxDigits, uint16_t *Value)
+{
+  uint8_t digits = 0;
+
+  *Value = 0;
+  while((Text < End) && (digits < MaxDigits) && isxdigit(*Text))
+  {
+    *Value = (*Value << 4) + (isdigit(*Text) ? (*Text - '0') : ((*Text | 0x20) - 'a' + 10));
+    Text++;
+    digits++;
+  }
+  return digits;
+}
+
+//fill the object list of a drive from a request like
+//  #dash1 6064 6041.00 6081.00=1000 6060=1/1
+//the optional #tag is returned with the response, an object is
+//<Idx>[.<SubIdx>] in hex, =<value> in decimal writes it with 4 bytes
+//or the /<len> given. Tokens are separated by blanks or commas.
+//The payload is parsed in place, the tag is copied to Tag.
+
+bool parseObjects(const uint8_t *Payload, uint16_t Len, SDOBatchEntry *List, uint8_t *Count, char *Tag)
+{
+  const uint8_t *Text = Payload;
+  const uint8_t *End = Payload + Len;
+
+  *Count = 0;
+  Tag[0] = '\0';
+
+  while(Text < End)
+  {
+    const uint8_t *TokenEnd = Text;
+    while((TokenEnd < End) && (*TokenEnd != ' ') && (*TokenEnd != ','))
+      TokenEnd++;
+
+    if(TokenEnd == Text)
+    {
+      //a separator
+      Text++;
+      continue;
+    }
+
+    if((*Text == '#') && (*Count == 0) && (Tag[0] == '\0'))
+    {
+      uint8_t n = TokenEnd - Text - 1;
+      if(n >= ObjectTagLen)
+        n = ObjectTagLen - 1;
+      memcpy(Tag, Text + 1, n);
+      Tag[n] = '\0';
+    }
+    else
+    {
+      SDOBatchEntry *Entry = &List[*Count];
+      const uint8_t *Value;
+      const uint8_t *ValueEnd;
+      uint16_t Number;
+      uint8_t digits;
+
+      if(*Count >= SDOMaxBatch)
+        return false;
+
+      if((digits = parseHex(Text, TokenEnd, 4, &Number)) == 0)
+        return false;
+      Entry->Idx = Number;
+      Entry->SubIdx = 0;
+      Entry->Value = 0;
+      Entry->Len = 0;
+      Text += digits;
+
+      if((Text < TokenEnd) && (*Text == '.'))
+      {
+        Text++;
+        if((digits = parseHex(Text, TokenEnd, 2, &Number)) == 0)
+          return false;
+        Entry->SubIdx = (uint8_t)Number;
+        Text += digits;
+      }
+
+      if((Text < TokenEnd) && (*Text == '='))
+      {
+        int32_t WriteValue;
+
+        Value = ++Text;
+        ValueEnd = Value;
+        while((ValueEnd < TokenEnd) && (*ValueEnd != '/'))
+          ValueEnd++;
+        if(!TopicRouter::ParseValue(Value, ValueEnd - Value, &WriteValue))
+          return false;
+        Entry->Value = (uint32_t)WriteValue;
+        Entry->Len = 4;
+
+        Text = ValueEnd;
+        if(Text < TokenEnd)
+        {
+          Text++;
+          if((parseHex(Text, TokenEnd, 1, &Number) != 1) || ((Number != 1) && (Number != 2) && (Number != 4)))
+            return false;
+          Entry->Len = (uint8_t)Number;
+          Text++;
+        }
+      }
+
+      if(Text != TokenEnd)
+        return false;
+      (*Count)++;
+    }
+    Text = TokenEnd;
+  }
+  return (*Count > 0);
+}
+
+//the response to an object request - a read value is given as
+//a signed number, a write as "ok" and an object rejected by the
+//drive as "!<error code in hex>"
+//It's longer than the Outbox can keep, so it's published directly.
+//If that fails the short result "lost" is published instead - this
+//one is buffered if the broker is away.
+
+void publishObjects(GatewayDrive *gw, const char *Tag, uint16_t Seq, const char *Result, bool hasObjects)
 {
-  MCMsgHandler.Open(115200);
-  Drive_A.SetNodeId(DriveIdA);
-  Drive_A.Connect2MsgHandler(&MCMsgHandler);
+  char payload[ObjectRespLen];
+  uint16_t len;
+
+  len = snprintf(payload, sizeof(payload), "{\"tag\":\"%s\",\"seq\":%u,\"res\":\"%s\"", Tag, Seq, Result);
+
+  if(hasObjects)
+  {
+    len += snprintf(payload + len, sizeof(payload) - len, ",\"obj\":{");
+    for(uint8_t i = 0; (i < gw->ObjCount) && (len < sizeof(payload)); i++)
+    {
+      SDOBatchEntry *Entry = &gw->ObjList[i];
+
+      len += snprintf(payload + len, sizeof(payload) - len, "%s\"%04X.%02X\":", (i > 0) ? "," : "", Entry->Idx, Entry->SubIdx);
+      if(len >= sizeof(payload))
+        break;
+      if(Entry->isFailed)
+        len += snprintf(payload + len, sizeof(payload) - len, "\"!%08lX\"", (unsigned long)Entry->Value);
+      else if(Entry->Len > 0)
+        len += snprintf(payload + len, sizeof(payload) - len, "\"ok\"");
+      else
+        len += snprintf(payload + len, sizeof(payload) - len, "%ld", (long)(int32_t)Entry->Value);
+    }
+    if(len < sizeof(payload))
+      len += snprintf(payload + len, sizeof(payload) - len, "}");
+  }
+  if(len < sizeof(payload))
+    snprintf(payload + len, sizeof(payload) - len, "}");
+
+  if((MqttState == eMqttConnected) && mqttClient.publish(gw->ObjectTopic, payload, false))
+    return;
+  
+  if(!publishOut(gw->ObjectTopic, payload, false, false))
+  {
+    snprintf(payload, sizeof(payload), "{\"tag\":\"%s\",\"seq\":%u,\"res\":\"lost\"}", Tag, Seq);
+    publishOut(gw->ObjectTopic, payload, false, false);
+  }
 }
 
 void setup_wifi() 
@@ -121,263 +467,628 @@ void setup_wifi()
 
 }
 
-bool identifyTopic(char *RxTopic,char *Reference)
+//--- handlers of the topics subscribed ----
+//they get the message as a TopicMatch - the value is parsed already
+//the topic and the payload are part of the buffer of the client which
+//is used for the acks too - so they're not used anymore after a push
+
+void OnLedControl(void *op, void *p)
 {
-  if(strcmp(RxTopic,Reference) == 0)
-    return true;
-  else
-    return false; 
+  TopicMatch *Msg = (TopicMatch *)p;
+  
+  // Switch on the LED if 1 was received as first character
+  if ((Msg->Len > 0) && ((char)Msg->Payload[0] == '1')) 
+  {
+    digitalWrite(LED_PIN, HIGH);   
+    ledState = 1;
+    publishLed();
+  } 
+  else 
+  {
+    digitalWrite(LED_PIN, LOW); 
+    ledState = 0;
+    publishLed();
+  }
+}
+
+//a step which may be requested by the Control topic
+
+bool isStepOp(int32_t Value)
+{
+  return (((Value >= 1) && (Value <= 8)) || (Value == 20));
 }
 
-int32_t extractValue(byte* payload, unsigned int length)
+//ack a command which is not queued at all
+
+void publishInvalid(GatewayDrive *gw, int32_t Value)
 {
-  uint8_t idx = 0;
-  int32_t value = 0;
+  char payload[80];
+
+  snprintf(payload, sizeof(payload), "{\"seq\":%u,\"op\":0,\"val\":%ld,\"res\":\"invalid\",\"ms\":0}",
+           CommandNoSeq, (long)Value);
+  publishOut(gw->AckTopic, payload, false, false);
+}
+
+//the op of the drive commands is the route's op - for the Control
+//topic it's the value, which has to be one of the steps
+
+void OnDriveCommand(void *op, void *p)
+{
+  TopicMatch *Msg = (TopicMatch *)p;
+  uint8_t Op = (uint8_t)(uintptr_t)op;
+  GatewayDrive *gw;
+  int32_t NodeId;
+
+  if(!TopicRouter::GetWildcardValue(Msg, 0, &NodeId) || ((gw = findDrive(NodeId)) == NULL))
+  {
+    Serial.println("Main: command for an unknown drive");
+    return;
+  }
+  if(!Msg->hasValue)
+  {
+    Serial.println("Main: command without a value");
+    return;
+  }
   
-  if(payload[idx] == '-')
-    idx++;
-    
-  while(idx < length)
+  if((Op == 0) && !isStepOp(Msg->Value))
   {
-    value = value * 10;
-    value = value + (payload[idx] - '0');
-    idx++;
+    Serial.println("Main: invalid step");
+    publishInvalid(gw, Msg->Value);
+    return;
   }
-  if(payload[0] == '-')
-    value = -1 * value;
-
-  return value;
+  
+  gw->Commands.SetActTime(millis());
+  if(Op == 0)
+    gw->Commands.Push((uint8_t)Msg->Value, 0);
+  else
+    gw->Commands.Push(Op, Msg->Value);
 }
-void callback(char* topic, byte* payload, unsigned int length) 
+
+//a list of objects to be read/written - queued as a command so
+//it's in order with the others of the drive
+
+void OnObjectRequest(void *op, void *p)
 {
-  Serial.print("Message arrived [");
-  Serial.print(topic);
-  Serial.print("] ");
-  for (int i = 0; i < length; i++) 
+  TopicMatch *Msg = (TopicMatch *)p;
+  GatewayDrive *gw;
+  int32_t NodeId;
+  SDOBatchEntry List[SDOMaxBatch];
+  uint8_t Count;
+  char Tag[ObjectTagLen];
+
+  if(!TopicRouter::GetWildcardValue(Msg, 0, &NodeId) || ((gw = findDrive(NodeId)) == NULL))
   {
-    Serial.print((char)payload[i]);
+    Serial.println("Main: request for an unknown drive");
+    return;
   }
-  Serial.println();
 
-  if(identifyTopic(topic,subTopic))
+  if(!parseObjects(Msg->Payload, Msg->Len, List, &Count, Tag))
   {
-    // Switch on the LED if 1 was received as first character
-    if ((char)payload[0] == '1') 
-    {
-      digitalWrite(LED_PIN, HIGH);   
-      ledState = 1;
-      char payLoad[1];
-      itoa(ledState, payLoad, 10);
-      mqttClient.publish(pubTopic, payLoad,true);
-    } 
-    else 
-    {
-      digitalWrite(LED_PIN, LOW); 
-      ledState = 0;
-      char payLoad[1];
-      itoa(ledState, payLoad, 10);
-      mqttClient.publish(pubTopic, payLoad,true);
-    }
+    publishObjects(gw, Tag, CommandNoSeq, "invalid", false);
+    return;
   }
-  if(identifyTopic(topic,MCControlSubTopic))
+  if(gw->isObjPending)
   {
-    requestedDriveStep = (uint16_t)extractValue(payload,length);
-  } 
-  if(identifyTopic(topic,MCControlTargetSpeed))
+    publishObjects(gw, Tag, CommandNoSeq, "busy", false);
+    return;
+  }
+
+  memcpy(gw->ObjList, List, sizeof(List));
+  gw->ObjCount = Count;
+  strcpy(gw->ObjTag, Tag);
+  gw->isObjPending = true;
+
+  gw->Commands.SetActTime(millis());
+  gw->ObjSeq = gw->Commands.Push(OpObjectAccess, Count);
+  if(gw->ObjSeq == CommandNoSeq)
+  {
+    gw->isObjPending = false;
+    publishObjects(gw, Tag, CommandNoSeq, "dropped", false);
+  }
+}
+
+void setup_routes()
+{
+  pfunction_holder Cb;
+
+  Cb.callback = (pfunction_pointer_t)OnLedControl;
+  Cb.op = NULL;
+  Router.AddRoute(subTopic, &Cb);
+
+  Cb.callback = (pfunction_pointer_t)OnDriveCommand;
+  Cb.op = (void *)0;
+  Router.AddRoute(MCControlSubTopic, &Cb);
+  Cb.op = (void *)(uintptr_t)OpSetTargetSpeed;
+  Router.AddRoute(MCControlTargetSpeed, &Cb);
+  Cb.op = (void *)(uintptr_t)OpSetTargetPos;
+  Router.AddRoute(MCControlTargetPos, &Cb);
+
+  Cb.callback = (pfunction_pointer_t)OnObjectRequest;
+  Cb.op = NULL;
+  Router.AddRoute(MCObjectReqTopic, &Cb);
+}
+
+void callback(char* topic, byte* payload, unsigned int length) 
+{
+  if(!Router.Dispatch(topic, payload, length))
   {
-    TargetSpeed = extractValue(payload,length);
+    Serial.print("Main: unknown topic ");
+    Serial.println(topic);
   }
-  if(identifyTopic(topic,MCControlTargetPos))
+}
+
+//a single attempt to connect - blocks for mqttSocketTimeout at most
+
+bool connectMqtt() 
+{
+  if(WiFi.status() != WL_CONNECTED)
   {
-    TargetPos = extractValue(payload,length);
+    //don't wait for it - checked again with the next attempt
+    WiFi.begin(ssid, password);
+    return false;
   }
   
+  //if (client.connect(clientId.c_str(), mqttUsername, mqttPassword)) 
+  if (!mqttClient.connect("Arduino_Nano_IoT",NULL,NULL,"Nano/MC/Will",1,true,"is Offline"))
+    return false;
+    
+  // ... and resubscribe
+  mqttClient.subscribe(subTopic);
+  mqttClient.subscribe(MCControlSubTopicAll);
+  mqttClient.subscribe(MCObjectReqTopic);
+  mqttClient.publish("Nano/MC/Will","is Online",true);
+  return true;
 }
 
-void reconnect() 
+//keep the connection to the broker - to be called with every loop
+
+void updateMqtt()
 {
-  // Loop until we're reconnected
-  while (!mqttClient.connected()) 
-  {
-    Serial.print("Attempting MQTT connection...");
+  uint32_t currentMillis = millis();
 
-    // Attempt to connect
-    //if (client.connect(clientId.c_str(), mqttUsername, mqttPassword)) 
-    if (mqttClient.connect("Arduino_Nano_IoT",NULL,NULL,"Nano/MC/Will",1,true,"is Offline"))
-    {
-      Serial.println("connected");
-      // ... and resubscribe
-      mqttClient.subscribe(subTopic);
-      mqttClient.subscribe(MCControlSubTopicAll);
-      mqttClient.publish("Nano/MC/Will","is Online",true);
-    } 
-    else 
-    {
-      Serial.print("failed, rc=");
-      Serial.print(mqttClient.state());
-      Serial.println(" try again in 5 seconds");
-      // Wait 5 seconds before retrying
-      delay(5000);
-    }
+  switch(MqttState)
+  {
+    case eMqttConnected:
+      if(mqttClient.connected())
+      {
+        mqttClient.loop();
+        flushOutbox();
+      }
+      else
+      {
+        Serial.println("Main: MQTT connection lost");
+        MqttState = eMqttBackoff;
+        mqttBackoff = mqttBackoffMin;
+        mqttRetryAt = currentMillis;
+      }
+      break;
+    case eMqttBackoff:
+      if((int32_t)(currentMillis - mqttRetryAt) < 0)
+        break;
+        
+      Serial.print("Attempting MQTT connection...");
+      if(connectMqtt())
+      {
+        Serial.print("connected, buffered ");
+        Serial.print(Outbox.GetCount());
+        Serial.print(" dropped ");
+        Serial.println(Outbox.GetDropped());
+        MqttState = eMqttConnected;
+        mqttBackoff = mqttBackoffMin;
+        //the backlog may miss some changes - the full state follows it
+        for(uint8_t i = 0; i < NumDrives; i++)
+          Drives[i].Telemetry.ForceAll();
+      }
+      else
+      {
+        Serial.print("failed, rc=");
+        Serial.print(mqttClient.state());
+        Serial.print(" try again in ");
+        Serial.print(mqttBackoff);
+        Serial.println(" ms");
+        //some jitter so several gateways don't retry in lockstep
+        mqttRetryAt = millis() + mqttBackoff + random(mqttBackoff / 4 + 1);
+        mqttBackoff = (mqttBackoff < (mqttBackoffMax / 2)) ? (2 * mqttBackoff) : mqttBackoffMax;
+      }
+      break;
   }
 }
 
-void updateDriveComm()
+//print the step of a drive
+
+void reportStep(GatewayDrive *gw, const char *text)
+{
+  Serial.print("Main: node ");
+  Serial.print(gw->NodeId);
+  Serial.print(" ");
+  Serial.println(text);
+}
+
+void reportValue(GatewayDrive *gw, const char *text, int32_t value)
+{
+  Serial.print("Main: node ");
+  Serial.print(gw->NodeId);
+  Serial.print(" ");
+  Serial.print(text);
+  Serial.println(value);
+}
+
+//the step machine of a drive - called by the DriveBus whenever
+//the drive is scheduled
+
+void operateDrive(GatewayDrive *gw)
 {
-static bool isAutoUpdate;
-static uint32_t lastAutoUpdate = 0;
-uint32_t currentMillis = millis();
-DriveCommStates NodeState = Drive_A.CheckComState();
+DriveCommStates NodeState = gw->Drive.CheckComState();
+DriveCommand *Command;
    
-   Drive_A.SetActTime(currentMillis);
-   MCMsgHandler.Update(currentMillis); 
+   gw->Commands.SetActTime(millis());
 
    if((NodeState == eMCError) || (NodeState == eMCTimeout))
    {
-      //Serial.println("Main: Reset NodeA State");
-      Drive_A.ResetComState();
+      gw->Drive.ResetComState();
       //should be avoided in the end
-      actDriveStep = 0;
+      if(gw->actDriveStep > 0)
+        gw->Commands.Complete(false);
+      gw->actDriveStep = 0;
    }
 
 
-   switch(actDriveStep)
+   switch(gw->actDriveStep)
    {
       case 0:
-        //do nothing - that's the idle state
-        if(requestedDriveStep > 0)
-        {
-          //start handling of the request
-          actDriveStep = requestedDriveStep;
-          //reset request again          
-          requestedDriveStep = 0;
-          isAutoUpdate = false;
-          Serial.print("Start ");
-          Serial.println(actDriveStep);
-        }
-        else
+        //idle state - start the next command if there is one
+        if((Command = gw->Commands.Start()) != NULL)
         {
-          //no request pending
-          //check for timeout of auto-update
-          if(lastAutoUpdate + updateRate < currentMillis)
+          if(Command->Op == OpSetTargetSpeed)
+          {
+            gw->TargetSpeed = Command->Value;
+            gw->Commands.Complete(true);
+          }
+          else if(Command->Op == OpSetTargetPos)
           {
-            actDriveStep = 20;
-            lastAutoUpdate = currentMillis;
-            isAutoUpdate = true;
+            gw->TargetPos = Command->Value;
+            gw->Commands.Complete(true);
+          }
+          else if(Command->Op == 0)
+          {
+            //nothing to be done
+            gw->Commands.Complete(true);
+          }
+          else if((Command->Op == OpObjectAccess) && (!gw->isObjPending || (Command->Seq != gw->ObjSeq)))
+          {
+            //only the one pushed by OnObjectRequest() has got its list
+            gw->Commands.Complete(false);
+            reportStep(gw,"no object request");
+          }
+          else
+          {
+            //start handling of the request
+            gw->actDriveStep = Command->Op;
+            reportValue(gw,"start ",gw->actDriveStep);
           }
         }
         break;
       case 1:
         //get a copy of the drive status
-        if((Drive_A.UpdateDriveStatus()) == eMCDone)
+        if((gw->Drive.UpdateDriveStatus()) == eMCDone)
         {
           //switch back to idle state
-          actDriveStep = 0;
-          Drive_A.ResetComState();
-          Serial.println("Main: Status updated");
+          gw->actDriveStep = 0;
+          gw->Drive.ResetComState();
+          gw->Commands.Complete(true);
+          reportStep(gw,"Status updated");
         }
         break;
       case 2:
         //disable the drive
-        if((Drive_A.DisableDrive()) == eMCDone)
+        if((gw->Drive.DisableDrive()) == eMCDone)
         {
           //switch back to idle state
-          actDriveStep = 0;
-          Drive_A.ResetComState();
-          Serial.println("Main: Drive disabled");
-          mqttClient.publish(MCStatePubTopic,"Disabled");
+          gw->actDriveStep = 0;
+          gw->Drive.ResetComState();
+          gw->Commands.Complete(true);
+          reportStep(gw,"Drive disabled");
+          publishOut(gw->StateTopic,"Disabled",false,true);
         }
         break;
       case 3:
         //enable the drive
-        if((Drive_A.EnableDrive()) == eMCDone)
+        if((gw->Drive.EnableDrive()) == eMCDone)
         {
           //switch back to idle state
-          actDriveStep = 0;
-          Drive_A.ResetComState();
-          Serial.println("Main: Drive enabled");
-          mqttClient.publish(MCStatePubTopic,"Enabled");
+          gw->actDriveStep = 0;
+          gw->Drive.ResetComState();
+          gw->Commands.Complete(true);
+          reportStep(gw,"Drive enabled");
+          publishOut(gw->StateTopic,"Enabled",false,true);
         }
         break;
       case 4:
         //move at speed
-        if((Drive_A.MoveAtSpeed(0)) == eMCDone)
+        if((gw->Drive.MoveAtSpeed(0)) == eMCDone)
         {
           //switch back to idle state
-          actDriveStep = 0;
-          Drive_A.ResetComState();
-          Serial.println("Main: PV @ 0");
+          gw->actDriveStep = 0;
+          gw->Drive.ResetComState();
+          gw->Commands.Complete(true);
+          reportStep(gw,"PV @ 0");
         }
         break;
       case 5:
         //move at speed
-        if((Drive_A.MoveAtSpeed(TargetSpeed)) == eMCDone)
+        if((gw->Drive.MoveAtSpeed(gw->TargetSpeed)) == eMCDone)
         {
           //switch back to idle state
-          actDriveStep = 0;
-          Drive_A.ResetComState();
-          Serial.print("Main: PV @ ");
-          Serial.println(TargetSpeed);
+          gw->actDriveStep = 0;
+          gw->Drive.ResetComState();
+          gw->Commands.Complete(true);
+          reportValue(gw,"PV @ ",gw->TargetSpeed);
         }
         break;
        case 6:
         //move to pos
-        if((Drive_A.StartAbsMove(0,false)) == eMCDone)
+        if((gw->Drive.StartAbsMove(0,false)) == eMCDone)
         {
           //switch back to idle state
-          actDriveStep = 0;
-          Drive_A.ResetComState();
-          Serial.println("Main: Move to 0");
+          gw->actDriveStep = 0;
+          gw->Drive.ResetComState();
+          gw->Commands.Complete(true);
+          reportStep(gw,"Move to 0");
         }
         break;
        case 7:
         //move to pos
-        if((Drive_A.StartAbsMove(TargetPos,false)) == eMCDone)
+        if((gw->Drive.StartAbsMove(gw->TargetPos,false)) == eMCDone)
         {
           //switch back to idle state
-          actDriveStep = 0;
-          Drive_A.ResetComState();
-          Serial.print("Main: Move to ");
-          Serial.println(TargetPos);
+          gw->actDriveStep = 0;
+          gw->Drive.ResetComState();
+          gw->Commands.Complete(true);
+          reportValue(gw,"Move to ",gw->TargetPos);
         }
         break;
        case 8:
          //wait for pos
-         if(Drive_A.IsInPos() == eMCDone)
+         if(gw->Drive.IsInPos() == eMCDone)
          {
            //switch back to idle state
-           actDriveStep = 0;
-           Drive_A.ResetComState();
-           Serial.println("Main: Drive is in Pos");
+           gw->actDriveStep = 0;
+           gw->Drive.ResetComState();
+           gw->Commands.Complete(true);
+           reportStep(gw,"Drive is in Pos");
          }
          break;
        case 20:
-         //Update ActValues
-         if(Drive_A.UpdateActValues() == eMCDone)
+         //Update SW, OpMode and ActValues in one go
+         NodeState = gw->Drive.RefreshAll(&gw->Snapshot);
+         if(NodeState == eMCDone)
          {
-           char payload[20];
            //switch back to idle state
-           actDriveStep = 0;
-           Drive_A.ResetComState();
-           if(!isAutoUpdate)
-              Serial.println("Main: updates pos/speed");
+           gw->actDriveStep = 0;
+           gw->Commands.Complete(true);
+           reportStep(gw,"updates pos/speed");
            
-           itoa(Drive_A.GetActualPosition(), payload, 10);
-           mqttClient.publish(pubTopicPosition, payload,true);
-
-           itoa(Drive_A.GetActualSpeed(), payload, 10);
-           mqttClient.publish(pubTopicSpeed, payload,true);
-
+           //all of them with the next telemetry message
+           gw->Telemetry.SetValue(gw->FieldSlot[0], gw->Snapshot.Position);
+           gw->Telemetry.SetValue(gw->FieldSlot[1], gw->Snapshot.StatusWord);
+           gw->Telemetry.SetValue(gw->FieldSlot[2], gw->Snapshot.Speed);
+           gw->Telemetry.SetValue(gw->FieldSlot[3], gw->Snapshot.DriveErrors);
+           gw->Telemetry.SetValue(gw->FieldSlot[4], gw->Snapshot.MotorTemp);
+           gw->Telemetry.ForceAll();
+         }
+         else if((NodeState == eMCError) || (NodeState == eMCTimeout))
+         {
+           //the snapshot doesn't use the ComState - give up this time
+           gw->actDriveStep = 0;
+           gw->Commands.Complete(false);
+         }
+         break;
+       case 21:
+         //read/write the objects requested remotely in one go
+         NodeState = gw->Drive.AccessObjects(gw->ObjList, gw->ObjCount);
+         if(NodeState != eMCWaiting)
+         {
+           //switch back to idle state
+           gw->actDriveStep = 0;
+           publishObjects(gw, gw->ObjTag, gw->ObjSeq,
+                          (NodeState == eMCDone) ? "done" : ((NodeState == eMCTimeout) ? "timeout" : "error"),
+                          (NodeState == eMCDone));
+           gw->Commands.Complete(NodeState == eMCDone);
+           reportValue(gw,"objects ",gw->ObjCount);
          }
          break;
        default:
            //switch back to idle state
-           actDriveStep = 0;
-           Serial.println("Main: Unexpected command");
+           gw->actDriveStep = 0;
+           gw->Commands.Complete(false);
+           reportStep(gw,"Unexpected command");
            break;
    }
 }
 
+//callback to be registered at the DriveBus
+
+void *operateDriveCb(void *op, void *p)
+{
+  operateDrive((GatewayDrive *)op);
+  return NULL;
+}
+
+//add a drive with its queue, telemetry, polled objects and topics
+
+bool addDrive(int16_t NodeId)
+{
+  pfunction_holder Cb;
+  GatewayDrive *gw;
+
+  if(NumDrives >= GatewayMaxDrives)
+    return false;
+  gw = &Drives[NumDrives];
+
+  Cb.callback = operateDriveCb;
+  Cb.op = (void *)gw;
+  if(MCBus.AddDrive(&gw->Drive, NodeId, &Cb) == InvalidSlot)
+    return false;
+  NumDrives++;
+
+  gw->NodeId = NodeId;
+  gw->actDriveStep = 0;
+  gw->TargetSpeed = 100;
+  gw->TargetPos = 0;
+  snprintf(gw->StateTopic, GatewayTopicLen, MCStatePubFormat, NodeId);
+  snprintf(gw->TelemetryTopic, GatewayTopicLen,
+           (telemetryEncoding == eTelemetryCbor) ? MCTelemetryCborFormat : MCTelemetryFormat, NodeId);
+  snprintf(gw->AckTopic, GatewayTopicLen, MCAckFormat, NodeId);
+  snprintf(gw->QueueTopic, GatewayTopicLen, MCQueueFormat, NodeId);
+  snprintf(gw->ObjectTopic, GatewayTopicLen, MCObjectRespFormat, NodeId);
+  gw->ObjCount = 0;
+  gw->isObjPending = false;
+  gw->ObjSeq = CommandNoSeq;
+
+  for(uint8_t i = 0; i < NumPolledObjects; i++)
+  {
+    const PolledObject *Polled = &PolledObjects[i];
+    gw->PollSlot[i] = Poller.AddObject(&gw->Drive,Polled->Idx,Polled->SubIdx,Polled->Period,Polled->Priority);
+    gw->FieldSlot[i] = gw->Telemetry.AddField(Polled->Field,Polled->Deadband,Polled->MaxAge);
+  }
+  
+  gw->Telemetry.SetWindow(telemetryWindow);
+  gw->Telemetry.SetEncoding(telemetryEncoding);
+  //the first one is the position
+  gw->Telemetry.SetSampled(gw->FieldSlot[0], telemetrySamplePeriod, telemetrySamplesPerMsg);
+  Cb.callback = (pfunction_pointer_t)OnTelemetryPublish;
+  Cb.op = (void *)gw;
+  gw->Telemetry.Register_OnPublishCb(&Cb);
+
+  //of these only the latest one counts
+  gw->Commands.SetCoalescing(OpSetTargetSpeed, true);
+  gw->Commands.SetCoalescing(OpSetTargetPos, true);
+  gw->Commands.SetCoalescing(1, true);
+  gw->Commands.SetCoalescing(5, true);
+  gw->Commands.SetCoalescing(20, true);
+  Cb.callback = (pfunction_pointer_t)OnCommandAck;
+  Cb.op = (void *)gw;
+  gw->Commands.Register_OnAckCb(&Cb);
+
+  return true;
+}
+
+//serve the drives which answer a scan of the bus
+
+void setup_drive()
+{
+  MCScanResult node;
+  MsgHandler *Handler;
+
+  MCBus.Open(115200);
+  Poller.SetLinkBaud(115200);
+  
+  Handler = MCBus.GetMsgHandler();
+  if(Handler->StartScan(1,GatewayScanLastId,false))
+  {
+    while(Handler->GetScanState() == eScanRunning)
+      Handler->Update(millis());
+  }
+
+  for(uint8_t i = 0; i < Handler->GetScanCount(); i++)
+  {
+    Handler->GetScanResult(i,&node);
+    if(addDrive(node.NodeId))
+    {
+      Serial.print("Main: serving node ");
+      Serial.println(node.NodeId);
+    }
+    else
+    {
+      Serial.print("Main: no space for node ");
+      Serial.println(node.NodeId);
+    }
+  }
+
+  if(NumDrives == 0)
+  {
+    //it may be powered later on
+    Serial.println("Main: no drive found - serving the default one");
+    addDrive(DriveIdDefault);
+  }
+
+  //the budget is shared by all of them - the samples come on top
+  uint16_t rate = (telemetryRate > NumDrives) ? (telemetryRate / NumDrives) : 1;
+  if(telemetryEncoding == eTelemetryCbor)
+    rate += 1000 / (telemetrySamplePeriod * telemetrySamplesPerMsg);
+  for(uint8_t i = 0; i < NumDrives; i++)
+    Drives[i].Telemetry.SetBudget(rate, telemetryBurst);
+  
+  Serial.print("Main: polling load ");
+  Serial.print(Poller.GetLoad());
+  Serial.print(" planned ");
+  Serial.print(Poller.GetPlannedLoad());
+  Serial.println(" permille");
+  if(Poller.IsOverloaded())
+  {
+    Serial.println("Main: polling rates exceed the line - degraded");
+    for(uint8_t i = 0; i < NumDrives; i++)
+    {
+      for(uint8_t j = 0; j < NumPolledObjects; j++)
+      {
+        Serial.print("Main: node ");
+        Serial.print(Drives[i].NodeId);
+        Serial.print(" ");
+        Serial.print(PolledObjects[j].Field);
+        Serial.print(" @ ");
+        Serial.println(Poller.GetEffectivePeriod(Drives[i].PollSlot[j]));
+      }
+    }
+  }
+}
+
+//hand the values polled over to the telemetry of the drive which
+//decides whether they are to be published
+
+void publishPolled()
+{
+  uint32_t value;
+  uint32_t currentMillis = millis();
+  
+  for(uint8_t i = 0; i < NumDrives; i++)
+  {
+    GatewayDrive *gw = &Drives[i];
+
+    for(uint8_t j = 0; j < NumPolledObjects; j++)
+    {
+      const PolledObject *Polled = &PolledObjects[j];
+
+      if(Poller.HasChanged(gw->PollSlot[j]) && Poller.GetValue(gw->PollSlot[j],&value))
+      {
+        if(Polled->Idx == 0x2326)
+          gw->Telemetry.SetValue(gw->FieldSlot[j], (int16_t)value);
+        else if((Polled->Idx == 0x6041) || (Polled->Idx == 0x2320))
+          gw->Telemetry.SetValue(gw->FieldSlot[j], (uint16_t)value);
+        else
+          gw->Telemetry.SetValue(gw->FieldSlot[j], (int32_t)value);
+      }
+    }
+    gw->Telemetry.Update(currentMillis);
+  }
+}
+
+//publish the counters of the command queues
+
+void publishQueues()
+{
+  char queueLoad[80];
+
+  for(uint8_t i = 0; i < NumDrives; i++)
+  {
+    CommandQueue *Commands = &Drives[i].Commands;
+
+    snprintf(queueLoad, sizeof(queueLoad), "{\"depth\":%u,\"max\":%u,\"drop\":%lu,\"coal\":%lu,\"fail\":%lu}",
+             Commands->GetDepth(), Commands->GetMaxDepth(), (unsigned long)Commands->GetDropped(),
+             (unsigned long)Commands->GetCoalesced(), (unsigned long)Commands->GetFailed());
+    publishOut(Drives[i].QueueTopic, queueLoad, false, true);
+  }
+}
+
 void setup() 
 {
   pinMode(LED_PIN, OUTPUT);     
@@ -388,28 +1099,27 @@ void setup()
   setup_wifi();
   mqttClient.setServer(mqttServer, 1883);
   mqttClient.setCallback(callback);
+  setup_routes();
+  mqttClient.setSocketTimeout(mqttSocketTimeout);
+  mqttClient.setBufferSize(mqttBufferSize);
 
   setup_drive();
 }
 
 void loop() 
 {
-long lastMsg = 0;
-
-  if (!mqttClient.connected()) 
-  {
-    reconnect();
-  }
-  mqttClient.loop();
+static long lastMsg = 0;
 
-  updateDriveComm();
+  updateMqtt();
+  MCBus.Update(millis());
+  Poller.Update(millis());
+  publishPolled();
   
   long now = millis();
   if (now - lastMsg > 5000) 
   {
     lastMsg = now;
-    char payLoad[1];
-    itoa(ledState, payLoad, 10);
-    mqttClient.publish(pubTopic, payLoad,true);
+    publishLed();
+    publishQueues();
   }
 }
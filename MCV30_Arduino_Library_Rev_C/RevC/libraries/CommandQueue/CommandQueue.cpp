@@ -0,0 +1,302 @@
+/*---------------------------------------------------
+ * CommandQueue.cpp
+ * implements the queue of the remote commands
+ * of a drive
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <CommandQueue.h>
+
+//--- local defines ---
+
+#define DEBUG_PUSH		0x0001
+#define DEBUG_DROP		0x0002
+
+#define DEBUG_CMDQUEUE (DEBUG_DROP)
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * CommandQueue()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+CommandQueue::CommandQueue()
+{
+	OnAckCb.callback = NULL;
+	OnAckCb.op = NULL;
+}
+
+/*---------------------------------------------------------------------
+ * void SetCoalescing(uint8_t Op, bool isCoalescing)
+ * a command of this op replaces the last one queued if that is of
+ * the same op - e.g. for setpoints of which the latest one counts
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void CommandQueue::SetCoalescing(uint8_t Op, bool isCoalescing)
+{
+	if(Op > CommandMaxOp)
+		return;
+
+	if(isCoalescing)
+		CoalescingOps |= (1UL << Op);
+	else
+		CoalescingOps &= ~(1UL << Op);
+}
+
+/*---------------------------------------------------------------------
+ * void Register_OnAckCb(pfunction_holder *Cb)
+ * the callback gets a pointer to a CommandAck for every change
+ * of the state of a command
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void CommandQueue::Register_OnAckCb(pfunction_holder *Cb)
+{
+	OnAckCb.callback = Cb->callback;
+	OnAckCb.op = Cb->op;
+}
+
+/*---------------------------------------------------------------------
+ * void SetActTime(uint32_t time)
+ * the time stamps of the commands are taken from here
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void CommandQueue::SetActTime(uint32_t time)
+{
+	actTime = time;
+}
+
+/*---------------------------------------------------------------------
+ * uint16_t Push(uint8_t Op, int32_t Value)
+ * queue a command and ack it as queued, coalesced into the last one
+ * or dropped.
+ * returns the sequence number of the command or CommandNoSeq if it
+ * has been dropped
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint16_t CommandQueue::Push(uint8_t Op, int32_t Value)
+{
+	DriveCommand ThisCommand;
+
+	ThisCommand.Seq = NextSeq++;
+	if(NextSeq == CommandNoSeq)
+		NextSeq++;
+	ThisCommand.Op = Op;
+	ThisCommand.Value = Value;
+	ThisCommand.QueuedAt = actTime;
+
+	if(Op > CommandMaxOp)
+	{
+		Dropped++;
+		Ack(&ThisCommand, eCmdDropped);
+		return CommandNoSeq;
+	}
+
+	//the last one queued - if it's not running already
+	if((Count > 0) && !((Count == 1) && isActive) && (CoalescingOps & (1UL << Op)))
+	{
+		DriveCommand *Last = &Queue[(Head + Count - 1) % COMMAND_QUEUE_SIZE];
+
+		if(Last->Op == Op)
+		{
+			Coalesced++;
+			Ack(Last, eCmdCoalesced);
+			*Last = ThisCommand;
+			Ack(Last, eCmdQueued);
+			return ThisCommand.Seq;
+		}
+	}
+
+	if(Count >= COMMAND_QUEUE_SIZE)
+	{
+		#if(DEBUG_CMDQUEUE & DEBUG_DROP)
+		Serial.print("CQ: dropped ");
+		Serial.println(ThisCommand.Seq);
+		#endif
+
+		Dropped++;
+		Ack(&ThisCommand, eCmdDropped);
+		return CommandNoSeq;
+	}
+
+	Queue[(Head + Count) % COMMAND_QUEUE_SIZE] = ThisCommand;
+	Count++;
+	if(Count > MaxDepth)
+		MaxDepth = Count;
+
+	#if(DEBUG_CMDQUEUE & DEBUG_PUSH)
+	Serial.print("CQ: queued ");
+	Serial.print(ThisCommand.Seq);
+	Serial.print(" op ");
+	Serial.println(Op);
+	#endif
+
+	Ack(&Queue[(Head + Count - 1) % COMMAND_QUEUE_SIZE], eCmdQueued);
+	return ThisCommand.Seq;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommand *Start()
+ * take the oldest command to be executed - it stays queued until
+ * Complete() is called
+ * returns NULL if there is none
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommand *CommandQueue::Start()
+{
+	if(Count == 0)
+		return NULL;
+
+	isActive = true;
+	return &Queue[Head];
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommand *GetActive()
+ * the command started or NULL
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommand *CommandQueue::GetActive()
+{
+	if(!isActive)
+		return NULL;
+
+	return &Queue[Head];
+}
+
+/*---------------------------------------------------------------------
+ * void Complete(bool isDone)
+ * ack the command started as done or failed and remove it
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void CommandQueue::Complete(bool isDone)
+{
+	if(!isActive)
+		return;
+
+	DriveCommand ThisCommand = Queue[Head];
+
+	Head = (Head + 1) % COMMAND_QUEUE_SIZE;
+	Count--;
+	isActive = false;
+
+	if(isDone)
+	{
+		Done++;
+		Ack(&ThisCommand, eCmdDone);
+	}
+	else
+	{
+		Failed++;
+		Ack(&ThisCommand, eCmdFailed);
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void Clear()
+ * fail all the commands queued - e.g. if the drive has been lost
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void CommandQueue::Clear()
+{
+	while(Count > 0)
+	{
+		isActive = true;
+		Complete(false);
+	}
+}
+
+/*---------------------------------------------------------------------
+ * the counters
+ * Depth: commands waiting incl. the one running
+ * MaxDepth: the highest depth so far
+ * Dropped: commands rejected as the queue was full
+ * Coalesced: commands replaced by a newer one
+ * Done/Failed: commands completed
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t CommandQueue::GetDepth()
+{
+	return Count;
+}
+
+uint8_t CommandQueue::GetMaxDepth()
+{
+	return MaxDepth;
+}
+
+uint32_t CommandQueue::GetDropped()
+{
+	return Dropped;
+}
+
+uint32_t CommandQueue::GetCoalesced()
+{
+	return Coalesced;
+}
+
+uint32_t CommandQueue::GetDone()
+{
+	return Done;
+}
+
+uint32_t CommandQueue::GetFailed()
+{
+	return Failed;
+}
+
+void CommandQueue::ResetCounters()
+{
+	MaxDepth = Count;
+	Dropped = 0;
+	Coalesced = 0;
+	Done = 0;
+	Failed = 0;
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * void Ack(DriveCommand *Command, CommandResults Result)
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void CommandQueue::Ack(DriveCommand *Command, CommandResults Result)
+{
+	if(OnAckCb.callback == NULL)
+		return;
+
+	CommandAck ThisAck;
+
+	ThisAck.Seq = Command->Seq;
+	ThisAck.Op = Command->Op;
+	ThisAck.Value = Command->Value;
+	ThisAck.Result = Result;
+	ThisAck.Latency = actTime - Command->QueuedAt;
+
+	OnAckCb.callback(OnAckCb.op, (void *)&ThisAck);
+}
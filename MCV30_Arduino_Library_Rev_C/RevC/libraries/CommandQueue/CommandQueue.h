@@ -0,0 +1,103 @@
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+/*--------------------------------------------------------------
+ * class CommandQueue
+ * bounded FIFO of the commands for a drive received from a remote
+ * client, e.g. via MQTT. Each command gets a sequence number and is
+ * acknowledged by a callback when it is queued, done, failed or
+ * dropped. Commands are never overwritten silently:
+ * - a full queue rejects the new command and acks it as dropped
+ * - a command of an op marked for coalescing replaces the last one
+ *   queued if that is of the same op and not started yet. The one
+ *   replaced is acked as coalesced. Commands in between are kept, so
+ *   the order of setpoints and moves is kept too.
+ * The ops are defined by the application - 0..31.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <MC_Helpers.h>
+#include <stdint.h>
+
+//--- service define ---
+
+#ifndef COMMAND_QUEUE_SIZE
+#define COMMAND_QUEUE_SIZE 8
+#endif
+
+const uint8_t CommandMaxOp = 31;
+const uint16_t CommandNoSeq = 0;
+
+typedef enum CommandResults {
+	eCmdQueued,
+	eCmdCoalesced,
+	eCmdDropped,
+	eCmdDone,
+	eCmdFailed
+}
+ CommandResults;
+
+typedef struct DriveCommand {
+	uint16_t Seq;
+	uint8_t Op;
+	int32_t Value;
+	uint32_t QueuedAt;
+} DriveCommand;
+
+//handed to the ack callback
+
+typedef struct CommandAck {
+	uint16_t Seq;
+	uint8_t Op;
+	int32_t Value;
+	CommandResults Result;
+	uint32_t Latency;		//ms from being queued to done or failed
+} CommandAck;
+
+class CommandQueue {
+	public:
+		CommandQueue();
+		void SetCoalescing(uint8_t, bool);
+		void Register_OnAckCb(pfunction_holder *);
+		void SetActTime(uint32_t);
+
+		uint16_t Push(uint8_t, int32_t);
+		DriveCommand *Start();
+		DriveCommand *GetActive();
+		void Complete(bool);
+		void Clear();
+
+		uint8_t GetDepth();
+		uint8_t GetMaxDepth();
+		uint32_t GetDropped();
+		uint32_t GetCoalesced();
+		uint32_t GetDone();
+		uint32_t GetFailed();
+		void ResetCounters();
+
+	private:
+		void Ack(DriveCommand *, CommandResults);
+
+		DriveCommand Queue[COMMAND_QUEUE_SIZE];
+		uint8_t Head = 0;
+		uint8_t Count = 0;
+		bool isActive = false;		//the head has been started
+
+		uint32_t CoalescingOps = 0;
+		uint16_t NextSeq = 1;
+		pfunction_holder OnAckCb;
+
+		uint8_t MaxDepth = 0;
+		uint32_t Dropped = 0;
+		uint32_t Coalesced = 0;
+		uint32_t Done = 0;
+		uint32_t Failed = 0;
+
+		uint32_t actTime = 0;
+};
+
+#endif
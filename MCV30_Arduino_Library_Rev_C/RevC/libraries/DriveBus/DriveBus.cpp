@@ -0,0 +1,304 @@
+/*---------------------------------------------------
+ * DriveBus.cpp
+ * implements the scheduling of the drives of a 
+ * single serial line
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+ 
+//--- includes ---
+
+#include <DriveBus.h>
+
+//--- local defines ---
+
+#define DEBUG_GRANT		0x0001
+#define DEBUG_ERROR		0x0004
+
+#define DEBUG_DRIVEBUS (DEBUG_ERROR) 
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * DriveBus()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveBus::DriveBus()
+{
+	for(uint8_t i = 0; i < DriveBusMaxDrives; i++)
+	{
+		Drive[i] = NULL;
+		OperateCb[i].callback = NULL;
+		OperateCb[i].op = NULL;
+		Weight[i] = DriveBusWeightDefault;
+		Credit[i] = 0;
+	}
+	ResetLatency();
+}
+
+/*---------------------------------------------------------------------
+ * void Open(uint32_t baud)
+ * open the serial line of the MsgHandler
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void DriveBus::Open(uint32_t baud)
+{
+	Handler.Open(baud);
+}
+
+/*---------------------------------------------------------------------
+ * MsgHandler *GetMsgHandler()
+ * access to the MsgHandler e.g. for a bus scan
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+MsgHandler *DriveBus::GetMsgHandler()
+{
+	return &Handler;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t AddDrive(MCDrive *NewDrive, uint8_t NodeId, pfunction_holder *Cb)
+ * Set the NodeId of the drive and connect it to the MsgHandler.
+ * Cb is called with the drive as its p whenever the drive is scheduled.
+ * It's where the sequence of the drive is operated. 
+ * Returns the index of the drive or InvalidSlot if the bus is full.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t DriveBus::AddDrive(MCDrive *NewDrive, uint8_t NodeId, pfunction_holder *Cb)
+{
+	if(DriveCount >= DriveBusMaxDrives)
+		return InvalidSlot;
+		
+	NewDrive->SetNodeId(NodeId);
+	NewDrive->Connect2MsgHandler(&Handler);
+	
+	Drive[DriveCount] = NewDrive;
+	OperateCb[DriveCount].callback = Cb->callback;
+	OperateCb[DriveCount].op = Cb->op;
+	WeightSum += Weight[DriveCount];
+	DriveCount++;
+	
+	return (DriveCount - 1);
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t GetDriveCount()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t DriveBus::GetDriveCount()
+{
+	return DriveCount;
+}
+
+/*---------------------------------------------------------------------
+ * MCDrive *GetDrive(uint8_t idx)
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+MCDrive *DriveBus::GetDrive(uint8_t idx)
+{
+	if(idx >= DriveCount)
+		return NULL;
+	return Drive[idx];
+}
+
+/*---------------------------------------------------------------------
+ * void SetPolicy(DriveBusPolicies NewPolicy)
+ * eBusRoundRobin: every drive gets the first chance in turn
+ * eBusWeighted: a drive with weight n gets the first chance n times
+ *               as often as a drive with weight 1
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void DriveBus::SetPolicy(DriveBusPolicies NewPolicy)
+{
+	Policy = NewPolicy;
+	
+	for(uint8_t i = 0; i < DriveCount; i++)
+		Credit[i] = 0;
+}
+
+/*---------------------------------------------------------------------
+ * void SetWeight(uint8_t idx, uint8_t NewWeight)
+ * weight of a drive for eBusWeighted - at least 1
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void DriveBus::SetWeight(uint8_t idx, uint8_t NewWeight)
+{
+	if(idx >= DriveBusMaxDrives)
+		return;
+	if(NewWeight == 0)
+		NewWeight = 1;
+	
+	if(idx < DriveCount)
+		WeightSum = WeightSum - Weight[idx] + NewWeight;
+	Weight[idx] = NewWeight;
+}
+
+/*---------------------------------------------------------------------
+ * void Update(uint32_t time)
+ * to be called in every loop with millis()
+ * Updates the MsgHandler - the time base of the drives - and calls the
+ * operate callback of every drive. The drive to be called first is selected 
+ * by the policy, the others follow in their order. 
+ * A drive is granted the bus when the MsgHandler has been locked during 
+ * its calls. The time from the first call which found the bus owned
+ * by another drive up to the grant is the service latency.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW time is no longer pushed to the drives
+ *--------------------------------------------------------------------*/
+
+void DriveBus::Update(uint32_t time)
+{
+	actTime = time;
+	Handler.Update(time);
+	
+	if(!Handler.IsLocked())
+		Owner = InvalidSlot;
+	
+	if(DriveCount == 0)
+		return;
+		
+	uint8_t idx = SelectFirst();
+	
+	for(uint8_t i = 0; i < DriveCount; i++)
+	{
+		uint16_t Grants = Handler.GetLockGrants();
+		
+		if(OperateCb[idx].callback != NULL)
+			OperateCb[idx].callback(OperateCb[idx].op, (void *)Drive[idx]);
+		
+		if(Handler.GetLockGrants() != Grants)
+			OnGrant(idx);
+		else if(Handler.IsLocked() && (Owner != idx) && (Drive[idx]->CheckComState() == eMCWaiting))
+		{
+			//wants the bus but another one has got it
+			if(!isPending[idx])
+			{
+				isPending[idx] = true;
+				PendingSince[idx] = actTime;
+			}
+		}
+		
+		idx++;
+		if(idx >= DriveCount)
+			idx = 0;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * bool GetLatency(uint8_t idx, DriveBusLatency *Stats)
+ * service latency of a drive in ms
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool DriveBus::GetLatency(uint8_t idx, DriveBusLatency *Stats)
+{
+	if(idx >= DriveCount)
+		return false;
+		
+	*Stats = Latency[idx];
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * void ResetLatency()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void DriveBus::ResetLatency()
+{
+	for(uint8_t i = 0; i < DriveBusMaxDrives; i++)
+	{
+		isPending[i] = false;
+		LatencySum[i] = 0;
+		Latency[i].Grants = 0;
+		Latency[i].Last = 0;
+		Latency[i].Max = 0;
+		Latency[i].Avg = 0;
+	}
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * uint8_t SelectFirst()
+ * the drive with the highest credit is called first
+ * on equal credit the one with the lower index
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t DriveBus::SelectFirst()
+{
+uint8_t First = 0;
+
+	for(uint8_t i = 1; i < DriveCount; i++)
+		if(Credit[i] > Credit[First])
+			First = i;
+			
+	return First;
+}
+
+/*---------------------------------------------------------------------
+ * void OnGrant(uint8_t idx)
+ * Smooth weighted round-robin: all drives earn their weight and the
+ * one which got the bus pays the sum of all weights. With equal 
+ * weights this results in a plain rotation.
+ * The credits are limited, so a drive which doesn't use the bus
+ * for a long time can't block the others afterwards.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void DriveBus::OnGrant(uint8_t idx)
+{
+int16_t Sum = (Policy == eBusWeighted) ? WeightSum : DriveCount;
+
+	for(uint8_t i = 0; i < DriveCount; i++)
+	{
+		Credit[i] += (Policy == eBusWeighted) ? Weight[i] : 1;
+		if(Credit[i] > Sum)
+			Credit[i] = Sum;
+	}
+	Credit[idx] -= Sum;
+	if(Credit[idx] < -Sum)
+		Credit[idx] = -Sum;
+	
+	Owner = idx;
+	
+	uint32_t Wait = isPending[idx] ? (actTime - PendingSince[idx]) : 0;
+	
+	isPending[idx] = false;
+	LatencySum[idx] += Wait;
+	Latency[idx].Grants++;
+	Latency[idx].Last = Wait;
+	if(Wait > Latency[idx].Max)
+		Latency[idx].Max = Wait;
+	Latency[idx].Avg = LatencySum[idx] / Latency[idx].Grants;
+	
+	#if(DEBUG_DRIVEBUS & DEBUG_GRANT)
+	Serial.print("Bus: grant ");
+	Serial.print(idx, DEC);
+	Serial.print(" after ");
+	Serial.println(Wait, DEC);
+	#endif
+}
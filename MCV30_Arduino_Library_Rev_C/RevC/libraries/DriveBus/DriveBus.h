@@ -0,0 +1,85 @@
+#ifndef DRIVEBUS_H
+#define DRIVEBUS_H
+
+/*--------------------------------------------------------------
+ * class DriveBus
+ * owns the MsgHandler of a serial line and schedules the drives
+ * connected to it. The time base is handed to all of them and 
+ * the sequence of each drive is operated by a callback.
+ * The order the drives are called in is rotated, so every drive
+ * gets its share of the bus lock.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+ 
+//--- inlcudes ----
+ 
+#include <MsgHandler.h>
+#include <MCDrive.h>
+#include <MC_Helpers.h>
+#include <stdint.h>
+
+//--- service define ---
+
+const uint8_t DriveBusMaxDrives = MsgHandler_MaxNodes;
+const uint8_t DriveBusWeightDefault = 1;
+
+typedef enum DriveBusPolicies {
+	eBusRoundRobin,
+	eBusWeighted
+}
+ DriveBusPolicies;
+
+//time a drive had to wait for the bus in ms
+
+typedef struct DriveBusLatency {
+	uint32_t Grants;
+	uint32_t Last;
+	uint32_t Max;
+	uint32_t Avg;
+} DriveBusLatency;
+
+class DriveBus {
+	public:
+		DriveBus();
+		void Open(uint32_t);
+		MsgHandler *GetMsgHandler();
+		
+		uint8_t AddDrive(MCDrive *, uint8_t, pfunction_holder *);
+		uint8_t GetDriveCount();
+		MCDrive *GetDrive(uint8_t);
+		
+		void SetPolicy(DriveBusPolicies);
+		void SetWeight(uint8_t, uint8_t);
+		
+		void Update(uint32_t);
+		
+		bool GetLatency(uint8_t, DriveBusLatency *);
+		void ResetLatency();
+		
+	private:
+		uint8_t SelectFirst();
+		void OnGrant(uint8_t);
+		
+		MsgHandler Handler;
+		
+		MCDrive *Drive[DriveBusMaxDrives];
+		pfunction_holder OperateCb[DriveBusMaxDrives];
+		uint8_t DriveCount = 0;
+		
+		DriveBusPolicies Policy = eBusRoundRobin;
+		uint8_t Weight[DriveBusMaxDrives];
+		int16_t Credit[DriveBusMaxDrives];
+		uint16_t WeightSum = 0;
+		
+		uint8_t Owner = InvalidSlot;
+		bool isPending[DriveBusMaxDrives];
+		uint32_t PendingSince[DriveBusMaxDrives];
+		uint32_t LatencySum[DriveBusMaxDrives];
+		DriveBusLatency Latency[DriveBusMaxDrives];
+		
+		uint32_t actTime;
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*--------------------------------------------------------------
+ * MCDeadlines.cpp
+ * implements the central queue of deadlines
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <MCDeadlines.h>
+
+//--- implementation ---
+
+/*-------------------------------------------------------------
+ * DeadlineQueue()
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+DeadlineQueue::DeadlineQueue()
+{
+}
+
+/*-------------------------------------------------------------
+ * static void InitDeadline(MCDeadline *Item, pfunction_pointer_t Cb, void *op)
+ * to be called once for each MCDeadline before it is used
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+void DeadlineQueue::InitDeadline(MCDeadline *Item, pfunction_pointer_t Cb, void *op)
+{
+	Item->Due = 0;
+	Item->Cb.callback = Cb;
+	Item->Cb.op = op;
+	Item->isArmed = false;
+	Item->Next = NULL;
+}
+
+/*-------------------------------------------------------------
+ * void Arm(MCDeadline *Item, uint32_t Due)
+ * (re-)arm a deadline to be due at the time Due
+ * deadlines with the same due time are called in the order
+ * they have been armed
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+void DeadlineQueue::Arm(MCDeadline *Item, uint32_t Due)
+{
+	if(Item->isArmed)
+		Cancel(Item);
+		
+	Item->Due = Due;
+	Item->isArmed = true;
+	ArmedCount++;
+	
+	MCDeadline **Link = &Head;
+	
+	while((*Link != NULL) && ((int32_t)((*Link)->Due - Due) <= 0))
+		Link = &((*Link)->Next);
+		
+	Item->Next = *Link;
+	*Link = Item;
+}
+
+/*-------------------------------------------------------------
+ * void Cancel(MCDeadline *Item)
+ * remove a deadline from the queue - nothing happens if it
+ * isn't armed
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+void DeadlineQueue::Cancel(MCDeadline *Item)
+{
+	if(!Item->isArmed)
+		return;
+		
+	MCDeadline **Link = &Head;
+	
+	while(*Link != NULL)
+	{
+		if(*Link == Item)
+		{
+			*Link = Item->Next;
+			break;
+		}
+		Link = &((*Link)->Next);
+	}
+	Item->isArmed = false;
+	Item->Next = NULL;
+	ArmedCount--;
+}
+
+/*-------------------------------------------------------------
+ * void Run(uint32_t time)
+ * call all the deadlines which are due
+ * as the queue is sorted it stops at the first one not due yet
+ * a callback may arm its deadline again
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+void DeadlineQueue::Run(uint32_t time)
+{
+	actTime = time;
+	
+	while((Head != NULL) && IsTimeReached(actTime, Head->Due))
+	{
+		MCDeadline *Item = Head;
+		
+		Head = Item->Next;
+		Item->Next = NULL;
+		Item->isArmed = false;
+		ArmedCount--;
+		
+		if(Item->Cb.callback != NULL)
+			Item->Cb.callback(Item->Cb.op, (void *)&actTime);
+	}
+}
+
+/*-------------------------------------------------------------
+ * uint32_t GetTime()
+ * the time of the last Run()
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+uint32_t DeadlineQueue::GetTime()
+{
+	return actTime;
+}
+
+/*-------------------------------------------------------------
+ * bool GetNextDue(uint32_t *Due)
+ * the due time of the next deadline - false if none is armed
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+bool DeadlineQueue::GetNextDue(uint32_t *Due)
+{
+	if(Head == NULL)
+		return false;
+		
+	*Due = Head->Due;
+	return true;
+}
+
+/*-------------------------------------------------------------
+ * uint8_t GetArmedCount()
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+uint8_t DeadlineQueue::GetArmedCount()
+{
+	return ArmedCount;
+}
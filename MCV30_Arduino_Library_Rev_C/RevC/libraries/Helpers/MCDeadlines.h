@@ -0,0 +1,52 @@
+#ifndef MC_DEADLINES_H
+#define MC_DEADLINES_H
+
+/*-----------------------------------------
+ * a queue of deadlines sorted by their due time
+ * components own their MCDeadline and arm it at the queue
+ * instead of comparing their own time stamps in every cycle.
+ * Run() calls the ones which are due only.
+ * All comparisons are done by the difference of the times, so
+ * the wraparound of millis() is fine as long as a deadline is 
+ * less than 2^31 ms ahead.
+ *
+ * 2026-10-18 AW Frame
+ * 
+ * -------------------------------------------------------*/
+
+#include <MC_Helpers.h>
+#include <stdint.h>
+
+//wrap-safe check of a time stamp against a due time
+inline bool IsTimeReached(uint32_t now, uint32_t due)
+{
+	return ((int32_t)(now - due) >= 0);
+}
+
+//the Cb is called with a pointer to the actual time as its p
+
+typedef struct MCDeadline {
+	uint32_t Due;
+	pfunction_holder Cb;
+	bool isArmed;
+	struct MCDeadline *Next;
+} MCDeadline;
+
+class DeadlineQueue {
+	public:
+		DeadlineQueue();
+		static void InitDeadline(MCDeadline *, pfunction_pointer_t, void *);
+		void Arm(MCDeadline *, uint32_t);
+		void Cancel(MCDeadline *);
+		void Run(uint32_t);
+		uint32_t GetTime();
+		bool GetNextDue(uint32_t *);
+		uint8_t GetArmedCount();
+		
+	private:
+		MCDeadline *Head = NULL;
+		uint8_t ArmedCount = 0;
+		uint32_t actTime = 0;
+};
+
+#endif
@@ -0,0 +1,565 @@
+/*---------------------------------------------------
+ * MCAxisGroup.cpp
+ * implements a group of axes moving along a common
+ * linear path
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+ 
+//--- includes ---
+
+#include <MCAxisGroup.h>
+
+//--- local defines ---
+
+#define DEBUG_MOVE		0x0001
+#define DEBUG_ERROR		0x0004
+#define DEBUG_TRIGGER	0x0008
+
+#define DEBUG_AXISGROUP (DEBUG_ERROR) 
+
+//--- steps of MoveLinear() ---
+
+const uint8_t AGStepReadPos = 0;
+const uint8_t AGStepProfile = 1;
+const uint8_t AGStepPrepare = 2;
+const uint8_t AGStepTrigger = 3;
+const uint8_t AGStepFinish = 4;
+const uint8_t AGStepDone = 5;
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * MCAxisGroup()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+MCAxisGroup::MCAxisGroup()
+{
+	for(uint8_t i = 0; i < AxisGroupMaxAxes; i++)
+	{
+		Axis[i] = NULL;
+		StartSkew[i] = 0;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * bool AddAxis(MCDrive *Drive)
+ * add a drive to the group. The drive has to be connected to the 
+ * MsgHandler already. 
+ * Returns false if the group is full.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCAxisGroup::AddAxis(MCDrive *Drive)
+{
+	if(AxisCount >= AxisGroupMaxAxes)
+		return false;
+	
+	Axis[AxisCount] = Drive;
+	AxisCount++;
+	AllAxes = (uint8_t)((1 << AxisCount) - 1);
+	
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t GetAxisCount()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCAxisGroup::GetAxisCount()
+{
+	return AxisCount;
+}
+
+/*---------------------------------------------------------------------
+ * void SetActTime(uint32_t time)
+ * to be called cyclically with millis() - the time base of the group.
+ * The drives take their time from the MsgHandler.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW no longer passed to the drives
+ *--------------------------------------------------------------------*/
+
+void MCAxisGroup::SetActTime(uint32_t time)
+{
+	actTime = time;
+}
+
+/*---------------------------------------------------------------------
+ * void SetLineBaud(uint32_t baud)
+ * baud rate of the line - is used to add the wire time of the CW
+ * frames to the reported start skew
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCAxisGroup::SetLineBaud(uint32_t baud)
+{
+	if(baud > 0)
+		LineBaud = baud;
+}
+
+/*---------------------------------------------------------------------
+ * void SetPathProfile(uint32_t Speed, uint32_t Acc, uint32_t Dec)
+ * profile of the axis with the longest distance of a move
+ * the other axes are scaled down by their distance
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCAxisGroup::SetPathProfile(uint32_t Speed, uint32_t Acc, uint32_t Dec)
+{
+	PathSpeed = Speed;
+	PathAcc = Acc;
+	PathDec = Dec;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates MoveLinear(const int32_t *Targets)
+ * Move all axes to their absolute target so they arrive together.
+ * Targets has to hold a position for each axis in the order they 
+ * have been added.
+ * Steps:
+ * - read the actual position of all axes
+ * - scale speed, acc and dec of each axis by its distance relative to
+ *   the longest one, so all the trapezoidal profiles take the same time
+ * - prepare the PP move at each axis
+ * - send the start bits back-to-back without waiting for the responses
+ * - finish the start at each axis
+ * All axes need to use the same scaling of position and speed.
+ * Axes which are already at their target are not moved at all.
+ *
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when all axes are started
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * Use IsInPos() afterwards to wait for the end of the move.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCAxisGroup::MoveLinear(const int32_t *Targets)
+{
+	switch(GroupStep)
+	{
+		case AGStepReadPos:
+			MoveMask = AllAxes;
+			//no break here
+		case AGStepProfile:
+		case AGStepPrepare:
+		case AGStepFinish:
+			RxTxState = eMCWaiting;
+			for(uint8_t i = 0; i < AxisCount; i++)
+			{
+				uint8_t mask = (1 << i);
+				
+				if(!(AxisDone & mask) && (MoveMask & mask))
+				{
+					DriveCommStates AxisState = RunAxisStep(i, Targets);
+					
+					if(AxisState == eMCDone)
+					{
+						Axis[i]->ResetComState();
+						AxisDone |= mask;
+					}
+					else if((AxisState == eMCError) || (AxisState == eMCTimeout))
+					{
+						RxTxState = AxisState;
+						
+						#if(DEBUG_AXISGROUP & DEBUG_ERROR)
+						Serial.print("Group: Axis ");
+						Serial.print(i, DEC);
+						Serial.print(" failed in step ");
+						Serial.println(GroupStep, DEC);
+						#endif
+						
+						return RxTxState;
+					}
+				}
+			}
+			if((AxisDone & MoveMask) == MoveMask)
+			{
+				if(GroupStep == AGStepReadPos)
+					CalcProfiles(Targets);
+					
+				AxisDone = 0;
+				GroupStep++;
+				
+				if(MoveMask == 0)
+					GroupStep = AGStepDone;
+					
+				#if(DEBUG_AXISGROUP & DEBUG_MOVE)
+				Serial.print("Group: Step ");
+				Serial.println(GroupStep, DEC);
+				#endif
+			}
+			break;
+		case AGStepTrigger:
+			TriggerAll();
+			break;
+		case AGStepDone:
+			RxTxState = eMCDone;
+			break;
+	}
+	return RxTxState;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates IsInPos()
+ * check all the axes to have reached their target
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when all are in position
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCAxisGroup::IsInPos()
+{
+	RxTxState = eMCWaiting;
+	
+	for(uint8_t i = 0; i < AxisCount; i++)
+	{
+		uint8_t mask = (1 << i);
+		
+		if(!(AxisDone & mask))
+		{
+			DriveCommStates AxisState = Axis[i]->IsInPos();
+			
+			if(AxisState == eMCDone)
+			{
+				Axis[i]->ResetComState();
+				AxisDone |= mask;
+			}
+			else if((AxisState == eMCError) || (AxisState == eMCTimeout))
+			{
+				RxTxState = AxisState;
+				return RxTxState;
+			}
+		}
+	}
+	if(AxisDone == AllAxes)
+		RxTxState = eMCDone;
+	
+	return RxTxState;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t GetStartSkew(uint8_t idx)
+ * delay of the start of an axis in us relative to the first one
+ * of the last MoveLinear(). Includes the wire time of the CW frames
+ * sent before.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t MCAxisGroup::GetStartSkew(uint8_t idx)
+{
+	if(idx >= AxisCount)
+		return 0;
+	return StartSkew[idx];
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t GetMaxStartSkew()
+ * the max of the start skews of the last MoveLinear()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t MCAxisGroup::GetMaxStartSkew()
+{
+uint32_t maxSkew = 0;
+
+	for(uint8_t i = 0; i < AxisCount; i++)
+		if(StartSkew[i] > maxSkew)
+			maxSkew = StartSkew[i];
+			
+	return maxSkew;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates StartCSP(uint8_t CycleTime)
+ * switch all the axes to CSP and align their cycles so the setpoints
+ * of a path point are sent to all axes within the same loop
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCAxisGroup::StartCSP(uint8_t CycleTime)
+{
+	RxTxState = eMCWaiting;
+	
+	for(uint8_t i = 0; i < AxisCount; i++)
+	{
+		uint8_t mask = (1 << i);
+		
+		if(!(AxisDone & mask))
+		{
+			DriveCommStates AxisState = Axis[i]->StartCSP(CycleTime);
+			
+			if(AxisState == eMCDone)
+			{
+				Axis[i]->ResetComState();
+				AxisDone |= mask;
+			}
+			else if((AxisState == eMCError) || (AxisState == eMCTimeout))
+			{
+				RxTxState = AxisState;
+				return RxTxState;
+			}
+		}
+	}
+	if(AxisDone == AllAxes)
+	{
+		for(uint8_t i = 0; i < AxisCount; i++)
+			Axis[i]->AlignCSPCycle(actTime);
+			
+		isCSPActive = true;
+		RxTxState = eMCDone;
+	}
+	return RxTxState;
+}
+
+/*---------------------------------------------------------------------
+ * bool PushPathPoint(const int32_t *Positions)
+ * add the next point of the path - a position for each axis
+ * returns false if there is no space at any of the axes
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCAxisGroup::PushPathPoint(const int32_t *Positions)
+{
+	if(GetCSPFree() == 0)
+		return false;
+		
+	for(uint8_t i = 0; i < AxisCount; i++)
+		Axis[i]->PushCSPSetpoint(Positions[i]);
+		
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t GetCSPFree()
+ * number of path points which can be pushed
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCAxisGroup::GetCSPFree()
+{
+uint8_t minFree = CSPBufferSize;
+
+	for(uint8_t i = 0; i < AxisCount; i++)
+		if(Axis[i]->GetCSPFree() < minFree)
+			minFree = Axis[i]->GetCSPFree();
+			
+	return minFree;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates RunCSP()
+ * to be called in every loop while streaming
+ * --> will report eMCWaiting while streaming
+ * --> eMCError or eMCTimeout if any of the axes failed
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCAxisGroup::RunCSP()
+{
+	if(!isCSPActive)
+		return eMCIdle;
+		
+	RxTxState = eMCWaiting;
+	
+	for(uint8_t i = 0; i < AxisCount; i++)
+	{
+		DriveCommStates AxisState = Axis[i]->RunCSP();
+		
+		if((AxisState == eMCError) || (AxisState == eMCTimeout))
+			RxTxState = AxisState;
+	}
+	return RxTxState;
+}
+
+/*---------------------------------------------------------------------
+ * void StopCSP()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCAxisGroup::StopCSP()
+{
+	for(uint8_t i = 0; i < AxisCount; i++)
+		Axis[i]->StopCSP();
+		
+	isCSPActive = false;
+	AxisDone = 0;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates CheckComState()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCAxisGroup::CheckComState()
+{
+	return RxTxState;
+}
+
+/*---------------------------------------------------------------------
+ * void ResetComState()
+ * reset the group and all of its axes
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCAxisGroup::ResetComState()
+{
+	for(uint8_t i = 0; i < AxisCount; i++)
+		Axis[i]->ResetComState();
+		
+	RxTxState = eMCIdle;
+	GroupStep = AGStepReadPos;
+	AxisDone = 0;
+	TriggerCount = 0;
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * DriveCommStates RunAxisStep(uint8_t idx, const int32_t *Targets)
+ * the action of a single axis in the actual GroupStep
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCAxisGroup::RunAxisStep(uint8_t idx, const int32_t *Targets)
+{
+	switch(GroupStep)
+	{
+		case AGStepReadPos:
+			return Axis[idx]->UpdateActValues();
+		case AGStepProfile:
+			return Axis[idx]->SetProfile(AxisAcc[idx], AxisDec[idx], AxisSpeed[idx], 0);
+		case AGStepPrepare:
+			return Axis[idx]->PrepareMovePP(Targets[idx]);
+		case AGStepFinish:
+			return Axis[idx]->FinishMovePP();
+	}
+	return eMCError;
+}
+
+/*---------------------------------------------------------------------
+ * void CalcProfiles(const int32_t *Targets)
+ * Scale the path profile for each axis by its distance relative to
+ * the longest one. Scaling speed, acc and dec by the same factor 
+ * results in the same duration of the trapezoidal profile.
+ * Axes which don't have to move are removed from the MoveMask.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCAxisGroup::CalcProfiles(const int32_t *Targets)
+{
+uint32_t Distance[AxisGroupMaxAxes];
+uint32_t maxDistance = 0;
+
+	for(uint8_t i = 0; i < AxisCount; i++)
+	{
+		int32_t delta = Targets[i] - Axis[i]->GetActualPosition();
+		
+		Distance[i] = (delta < 0) ? (uint32_t)(-delta) : (uint32_t)delta;
+		if(Distance[i] > maxDistance)
+			maxDistance = Distance[i];
+	}
+	
+	for(uint8_t i = 0; i < AxisCount; i++)
+	{
+		if(Distance[i] == 0)
+		{
+			MoveMask &= ~(1 << i);
+			continue;
+		}
+		
+		float ratio = (float)Distance[i] / (float)maxDistance;
+		
+		//the drive needs at least 1 for each of them
+		AxisSpeed[i] = (uint32_t)(ratio * PathSpeed + 0.5);
+		AxisAcc[i] = (uint32_t)(ratio * PathAcc + 0.5);
+		AxisDec[i] = (uint32_t)(ratio * PathDec + 0.5);
+		
+		if(AxisSpeed[i] == 0)
+			AxisSpeed[i] = 1;
+		if(AxisAcc[i] == 0)
+			AxisAcc[i] = 1;
+		if(AxisDec[i] == 0)
+			AxisDec[i] = 1;
+			
+		#if(DEBUG_AXISGROUP & DEBUG_MOVE)
+		Serial.print("Group: Axis ");
+		Serial.print(i, DEC);
+		Serial.print(" speed ");
+		Serial.println(AxisSpeed[i], DEC);
+		#endif
+	}
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates TriggerAll()
+ * Send the start bits to all prepared axes back-to-back within one 
+ * call. An axis whose CW could not be handed over to the Uart is tried
+ * again with the next call - this will show up in its skew.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCAxisGroup::TriggerAll()
+{
+	for(uint8_t i = 0; i < AxisCount; i++)
+	{
+		uint8_t mask = (1 << i);
+		
+		if(!(AxisDone & mask) && (MoveMask & mask))
+		{
+			if(Axis[i]->TriggerMovePP())
+			{
+				uint32_t TriggerAt = micros();
+				
+				//the frames sent before do delay this one on the wire
+				uint32_t WireTime = ((uint32_t)TriggerCount * AxisGroupCwFrameBytes * 10 * 1000000UL) / LineBaud;
+				
+				if(TriggerCount == 0)
+					FirstTriggerAt = TriggerAt;
+				
+				StartSkew[i] = (TriggerAt - FirstTriggerAt) + WireTime;
+				AxisDone |= mask;
+				TriggerCount++;
+			}
+		}
+	}
+	
+	if((AxisDone & MoveMask) == MoveMask)
+	{
+		#if(DEBUG_AXISGROUP & DEBUG_TRIGGER)
+		Serial.print("Group: triggered, max skew ");
+		Serial.println(GetMaxStartSkew(), DEC);
+		#endif
+		
+		AxisDone = 0;
+		TriggerCount = 0;
+		GroupStep = AGStepFinish;
+	}
+	return RxTxState;
+}
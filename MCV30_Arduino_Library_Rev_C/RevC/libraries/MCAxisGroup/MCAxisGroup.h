@@ -0,0 +1,82 @@
+#ifndef MCAXISGROUP_H
+#define MCAXISGROUP_H
+
+/*--------------------------------------------------------------
+ * class MCAxisGroup
+ * moves several MCDrive instances along a common linear path
+ * either by scaled PP profiles and a common start or by 
+ * streaming synchronised CSP setpoints
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+ 
+//--- inlcudes ----
+ 
+#include <MCDrive.h>
+#include <stdint.h>
+
+//--- service define ---
+
+const uint8_t AxisGroupMaxAxes = 4;
+
+//baud rate of the line to estimate the start skew
+const uint32_t AxisGroupBaudDefault = 115200;
+//CW frame incl. prefix and suffix
+const uint8_t AxisGroupCwFrameBytes = 8;
+
+class MCAxisGroup {
+	public:
+		MCAxisGroup();
+		bool AddAxis(MCDrive *);
+		uint8_t GetAxisCount();
+		void SetActTime(uint32_t);
+		void SetLineBaud(uint32_t);
+		
+		void SetPathProfile(uint32_t, uint32_t, uint32_t);
+		DriveCommStates MoveLinear(const int32_t *);
+		DriveCommStates IsInPos();
+		uint32_t GetStartSkew(uint8_t);
+		uint32_t GetMaxStartSkew();
+		
+		DriveCommStates StartCSP(uint8_t);
+		bool PushPathPoint(const int32_t *);
+		uint8_t GetCSPFree();
+		DriveCommStates RunCSP();
+		void StopCSP();
+		
+		DriveCommStates CheckComState();
+		void ResetComState();
+		
+	private:
+		DriveCommStates RunAxisStep(uint8_t, const int32_t *);
+		void CalcProfiles(const int32_t *);
+		DriveCommStates TriggerAll();
+		
+		MCDrive *Axis[AxisGroupMaxAxes];
+		uint8_t AxisCount = 0;
+		uint8_t AllAxes = 0;
+		
+		uint32_t PathSpeed = 1000;
+		uint32_t PathAcc = 1000;
+		uint32_t PathDec = 1000;
+		
+		uint32_t AxisSpeed[AxisGroupMaxAxes];
+		uint32_t AxisAcc[AxisGroupMaxAxes];
+		uint32_t AxisDec[AxisGroupMaxAxes];
+		
+		uint8_t GroupStep = 0;
+		uint8_t AxisDone = 0;
+		uint8_t MoveMask = 0;
+		DriveCommStates RxTxState = eMCIdle;
+		
+		uint32_t LineBaud = AxisGroupBaudDefault;
+		uint32_t FirstTriggerAt = 0;
+		uint32_t StartSkew[AxisGroupMaxAxes];
+		uint8_t TriggerCount = 0;
+		
+		bool isCSPActive = false;
+		uint32_t actTime;
+};
+
+#endif
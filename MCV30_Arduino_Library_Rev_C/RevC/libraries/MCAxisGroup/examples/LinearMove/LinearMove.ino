@@ -0,0 +1,118 @@
+/*--------------------------------------------------------------
+ * LinearMove.ino
+ * move two drives between the corners of a rectangle along 
+ * straight lines. The profiles of both axes are scaled so they 
+ * arrive together. The start skew of the axes is printed for 
+ * each move.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+#include <MsgHandler.h>
+#include <MCDrive.h>
+#include <MCAxisGroup.h>
+#include <stdint.h>
+
+//--- globals ---
+
+const uint32_t MCBaudRate = 115200;
+const uint8_t NumAxes = 2;
+const uint8_t NumCorners = 4;
+
+const int32_t Corners[NumCorners][NumAxes] = {
+  {0, 0},
+  {40000, 10000},
+  {40000, 30000},
+  {0, 20000}
+};
+
+MsgHandler MCMsgHandler;
+MCDrive Drive_X;
+MCDrive Drive_Y;
+MCAxisGroup Group;
+
+const int16_t DriveIdX = 1;
+const int16_t DriveIdY = 2;
+
+uint16_t groupStep = 0;
+uint8_t actCorner = 0;
+
+void setup() {
+  // Debug Port
+  Serial.begin(500000);
+
+  //start the MSG-Handler
+  MCMsgHandler.Open(MCBaudRate);
+
+  Drive_X.SetNodeId(DriveIdX);
+  Drive_X.Connect2MsgHandler(&MCMsgHandler);
+  Drive_Y.SetNodeId(DriveIdY);
+  Drive_Y.Connect2MsgHandler(&MCMsgHandler);
+
+  Group.AddAxis(&Drive_X);
+  Group.AddAxis(&Drive_Y);
+  Group.SetLineBaud(MCBaudRate);
+  Group.SetPathProfile(2000, 1000, 1000);
+}
+
+void loop() {
+  uint32_t currentMillis = millis();
+  DriveCommStates GroupState;
+
+  Group.SetActTime(currentMillis);
+  MCMsgHandler.Update(currentMillis);
+
+  switch(groupStep)
+  {
+    case 0:
+      if((Drive_X.EnableDrive()) == eMCDone)
+      {
+        groupStep = 1;
+        Drive_X.ResetComState();
+      }
+      break;
+    case 1:
+      if((Drive_Y.EnableDrive()) == eMCDone)
+      {
+        groupStep = 2;
+        Drive_Y.ResetComState();
+        Serial.println("Main: Drives enabled");
+      }
+      break;
+    case 2:
+      if((Group.MoveLinear(Corners[actCorner])) == eMCDone)
+      {
+        Group.ResetComState();
+        groupStep = 3;
+        
+        Serial.print("Main: Move to corner ");
+        Serial.print(actCorner);
+        Serial.print(" skew ");
+        for(uint8_t i = 0; i < NumAxes; i++)
+        {
+          Serial.print(Group.GetStartSkew(i));
+          Serial.print(" ");
+        }
+        Serial.println("us");
+      }
+      break;
+    case 3:
+      if((Group.IsInPos()) == eMCDone)
+      {
+        Group.ResetComState();
+        actCorner = (actCorner + 1) % NumCorners;
+        groupStep = 2;
+      }
+      break;
+  }
+
+  GroupState = Group.CheckComState();
+  if((GroupState == eMCError) || (GroupState == eMCTimeout))
+  {
+    Serial.println("Main: Reset Group State");
+    Group.ResetComState();
+    groupStep = 0;
+  }
+}
@@ -27,6 +27,8 @@
 #define DEBUG_HOME		0x0400
 #define DEBUG_RWPARAM	0x0800
 #define DEBUG_PULLSW    0x1000
+#define DEBUG_SEQ       0x2000
+#define DEBUG_CSP       0x4000
 
 #define DEBUG_DRIVE (DEBUG_TO | DEBUG_ERROR) 
 
@@ -64,6 +66,104 @@ const uint16_t PP_ChangeOnSetP	= 0x0200;
 const uint16_t MaxSWResponseDelay = 50;
 const uint16_t PullSWCycleTime = 20;
 
+//--- frame sizes for the CSP cycle time estimate ---
+//write request of 0x607A and its response including prefix and suffix
+//10 bits per byte at the UART and the processing time of the drive
+
+const uint8_t CSPWriteReqBytes = 13;
+const uint8_t CSPWriteRespBytes = 9;
+const uint16_t CSPDriveResponseTime = 1000;
+
+//--- step tables of the sequences ---
+//  Op, Arg, Index, Sub, Len, CW Clear, CW Set, SW Mask, SW Value
+
+#define SEQ_WRITE(idx,sub,len,arg)	{eSeqWriteObj, arg, idx, sub, len, 0, 0, 0, 0}
+#define SEQ_OPMODE(mode,arg)		{eSeqSetOpMode, arg, 0x6060, 0x00, 1, 0, mode, 0, 0}
+#define SEQ_CHECK_OPMODE			{eSeqCheckOpMode, SeqNoArg, 0x6061, 0x00, 1, 0, 0, 0, 0}
+#define SEQ_CW(clear,set)			{eSeqSendCw, SeqNoArg, 0, 0, 0, clear, set, 0, 0}
+#define SEQ_CW_UNTIL(clear,set,arg,mask,value) {eSeqCwUntilSW, arg, 0, 0, 0, clear, set, mask, value}
+#define SEQ_ENABLE					{eSeqEnable, SeqNoArg, 0, 0, 0, 0, 0, FSM402StatusMask, FSM402_Enabled}
+#define SEQ_END						{eSeqEnd, SeqNoArg, 0, 0, 0, 0, 0, 0, 0}
+
+static const DriveSeqStep SeqEnableDrive[] PROGMEM = {
+	SEQ_ENABLE,
+	SEQ_END
+};
+
+static const DriveSeqStep SeqDisableDrive[] PROGMEM = {
+	SEQ_CW_UNTIL(FSM402ControlMask, 0, SeqNoArg, FSM402StatusMask, FSM402_SwitchOnDisabled),
+	SEQ_END
+};
+
+//Arg 0: OpMode
+static const DriveSeqStep SeqSetOpMode[] PROGMEM = {
+	SEQ_OPMODE(0, 0),
+	SEQ_END
+};
+
+//Arg 0..3: ACC, DEC, Speed, ProfileType
+static const DriveSeqStep SeqSetProfile[] PROGMEM = {
+	SEQ_WRITE(0x6083, 0x00, 4, 0),
+	SEQ_WRITE(0x6084, 0x00, 4, 1),
+	SEQ_WRITE(0x6081, 0x00, 4, 2),
+	SEQ_WRITE(0x6086, 0x00, 2, 3),
+	SEQ_END
+};
+
+//PP move split into prepare, trigger and finish for the axis group
+//Arg 0: target position
+static const DriveSeqStep SeqPrepareMovePP[] PROGMEM = {
+	SEQ_OPMODE(1, SeqNoArg),
+	SEQ_CW_UNTIL(PP_StartBit, 0, SeqNoArg, StatusBit_PP_Ack, 0),
+	SEQ_WRITE(0x607A, 0x00, 4, 0),
+	SEQ_END
+};
+
+static const DriveSeqStep SeqFinishMovePP[] PROGMEM = {
+	SEQ_CW_UNTIL(PP_ChangeOnSetP, PP_StartBit | PP_ImmediateBit, SeqNoArg, StatusBit_PP_Ack, StatusBit_PP_Ack),
+	SEQ_CW_UNTIL(PP_StartBit | PP_ImmediateBit | PP_RelativeBit, 0, SeqNoArg, StatusBit_PP_Ack, 0),
+	SEQ_END
+};
+
+//Arg 0: cycle time in ms
+static const DriveSeqStep SeqStartCSP[] PROGMEM = {
+	SEQ_WRITE(0x60C2, 0x01, 1, 0),
+	SEQ_OPMODE(8, SeqNoArg),
+	SEQ_END
+};
+
+//Arg 0: target speed
+static const DriveSeqStep SeqMoveAtSpeed[] PROGMEM = {
+	SEQ_OPMODE(3, SeqNoArg),
+	SEQ_WRITE(0x60FF, 0x00, 4, 0),
+	SEQ_END
+};
+
+//Arg 0: homing method
+static const DriveSeqStep SeqConfigureHoming[] PROGMEM = {
+	SEQ_WRITE(0x6098, 0x00, 1, 0),
+	SEQ_END
+};
+
+static const DriveSeqStep SeqStartHoming[] PROGMEM = {
+	SEQ_CW(PP_StartBit, 0),
+	SEQ_OPMODE(6, SeqNoArg),
+	SEQ_CHECK_OPMODE,
+	SEQ_CW(0, PP_StartBit),
+	SEQ_CW(PP_StartBit, 0),
+	SEQ_END
+};
+
+//Arg 0: target position, Arg 1: immediate, relative and change on setpoint bits
+static const DriveSeqStep SeqMovePP[] PROGMEM = {
+	SEQ_OPMODE(1, SeqNoArg),
+	SEQ_CW_UNTIL(PP_StartBit, 0, SeqNoArg, StatusBit_PP_Ack, 0),
+	SEQ_WRITE(0x607A, 0x00, 4, 0),
+	SEQ_CW_UNTIL(PP_ChangeOnSetP, PP_StartBit, 1, StatusBit_PP_Ack, StatusBit_PP_Ack),
+	SEQ_CW_UNTIL(PP_StartBit | PP_ImmediateBit | PP_RelativeBit, 0, SeqNoArg, StatusBit_PP_Ack, 0),
+	SEQ_END
+};
+
 //--- public functions ---
 
 /*---------------------------------------------------------------------
@@ -71,11 +171,16 @@ const uint16_t PullSWCycleTime = 20;
  * Not much to be dnone in the intializer
  * 
  * 2020-11-22 AW Done
+ * 2026-10-18 AW clear the EMCY callback and the CSP statistics
  *--------------------------------------------------------------------*/
 
 MCDrive::MCDrive()
 {
-	;
+	OnEMCYCb.callback = NULL;
+	OnEMCYCb.op = NULL;
+	DeadlineQueue::InitDeadline(&EMCYRetryDeadline,MCDrive::OnEMCYRetryDeadlineCb,(void *)this);
+	
+	ResetCSPStatistics();
 }
 
 /*---------------------------------------------------------------------
@@ -97,14 +202,29 @@ void MCDrive::SetNodeId(uint8_t ThisNodeId)
  * multiple drives. So the different instances of the MCNode and their
  * embeddd SDOHandlers need to be connected to the instance of the 
  * Msghandler by calling this method.
- * Also sets a default for this instances ComState
+ * Also sets a default for this instances ComState and registers the
+ * EMCY fast path at the MCNode.
+ * A new process image is taken over by the callback of the MCNode.
  * 
  * 2020-11-22 AW Done
+ * 2026-10-18 AW register EMCY fast path
+ * 2026-10-18 AW register process data
  *--------------------------------------------------------------------*/
 
 void MCDrive::Connect2MsgHandler(MsgHandler *ThisHandler)
 {
+	pfunction_holder Cb;
+	
+	Handler = ThisHandler;
 	ThisNode.Connect2MsgHandler(ThisHandler);
+
+	Cb.callback = (pfunction_pointer_t)MCDrive::OnEMCYRxCb;
+	Cb.op = (void *)this;
+	ThisNode.Register_OnEMCYCb(&Cb);
+	
+	Cb.callback = (pfunction_pointer_t)MCDrive::OnProcessDataRxCb;
+	Cb.op = (void *)this;
+	ThisNode.Register_OnProcessDataCb(&Cb);
 	
 	RxTxState = eMCIdle;
 }
@@ -114,14 +234,42 @@ void MCDrive::Connect2MsgHandler(MsgHandler *ThisHandler)
  * If no HW-timer is used this method needs to called cyclically
  * with the latest millis() value to check for any time-outs.
  * Does the same update for the MCNode and embedded SDOhandler.
+ * The drive takes the time from the MsgHandler now. The time-outs, the
+ * retry of an EMCY stop and the process data are run by its 
+ * DeadlineQueue.
+ * Deprecated - does nothing and is kept for compatibility only.
  *  
  * 2020-11-22 AW Done
+ * 2026-10-18 AW retry EMCY stop, process data
+ * 2026-10-18 AW moved to the DeadlineQueue
+ * 2026-10-18 AW deprecated
  *--------------------------------------------------------------------*/
 
 void MCDrive::SetActTime(uint32_t time)
 {
-	actTime = time;
-	ThisNode.SetActTime(time);
+	(void)time;
+}
+
+/*---------------------------------------------------------------------
+ * void RetryEMCYStop()
+ * called by the DeadlineQueue while the quick stop on an EMCY could not
+ * be sent - tried again every ms until the Uart has taken it
+ *  
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::RetryEMCYStop()
+{
+	if(!isEMCYStopPending)
+		return;
+		
+	if(ThisNode.SendCwImmediate(ThisNode.ControlWord & ~FSM402_QSBit))
+	{
+		isEMCYStopPending = false;
+		isEMCYStopped = true;
+	}
+	else
+		Handler->GetDeadlines()->Arm(&EMCYRetryDeadline, ThisNode.GetTime() + 1);
 }
 
 /*-------------------------------------------------------------------
@@ -182,6 +330,46 @@ uint16_t MCDrive::GetSW()
 	return ThisNode.StatusWord;
 }
 
+/*---------------------------------------------------------------------
+ * uint32_t GetSWTimeStamp()
+ * Return the time the last StatusWord has been received.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t MCDrive::GetSWTimeStamp()
+{
+	return ThisNode.GetSWTimeStamp();
+}
+
+/*---------------------------------------------------------------------
+ * bool HasSWChanged()
+ * Check whether a different StatusWord has been received since the
+ * last call. Will reset the flag.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCDrive::HasSWChanged()
+{
+	return ThisNode.HasSWChanged();
+}
+
+/*---------------------------------------------------------------------
+ * void SetSWPushMode(bool enable, uint32_t watchdogTime)
+ * Rely on the StatusWord being sent asynchronously by the drive.
+ * IsInPos(), IsHomingFinished() and all the CW based sequences will then
+ * pull the SW via SDO only if none has been received for watchdogTime.
+ * Async StatusWord is not available in net mode.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::SetSWPushMode(bool enable, uint32_t watchdogTime)
+{
+	ThisNode.SetSWPushMode(enable, watchdogTime);
+}
+
 /*---------------------------------------------------------------------
  * CWCommStates GetCWAccess()
  * Return the actual CWAccessState of this drive. this is for debugging
@@ -213,13 +401,16 @@ uint8_t MCDrive::GetAccessStep()
  * Reset the ComState of the Drive but do the same for teh MCNode instance
  * and reset the AccessSteps to 0 too.
  * Timeout and Retry counters are reset too to have a clean drive.
+ * A RefreshAll() still running is cancelled.
  * 
  * 2020-11-22 AW Done
+ * 2026-10-18 AW CancelRefresh()
  *--------------------------------------------------------------------*/
 
 void MCDrive::ResetComState()
 {
 	RxTxState = eMCIdle;
+	CancelRefresh();
 	ThisNode.ResetComState();
 	SDOAccessState = eIdle;
 	CWAccessState = eCWIdle;
@@ -306,13 +497,15 @@ DriveCommStates MCDrive::UpdateDriveStatus()
 					SDOAccessState = ThisNode.ReadSDO(0x6061, 0x00);
 					RxTxState = eMCWaiting;
 					break;				
+				default:
+					break;
 			}
 			break;
 		case 1:
 			switch(SDOAccessState)
 			{
 				case eDone:
-					ThisNode.StatusWord = (uint16_t)ThisNode.GetObjValue();
+					ThisNode.StoreSW((uint16_t)ThisNode.GetObjValue());
 					AccessStep = 0;
 					ThisNode.ResetSDOState();
 					SDOAccessState = eIdle;
@@ -334,6 +527,8 @@ DriveCommStates MCDrive::UpdateDriveStatus()
 					
 					SDOAccessState = ThisNode.ReadSDO(0x6041, 0x00);
 					break;
+				default:
+					break;
 			}
 			break;
 	}	
@@ -385,6 +580,8 @@ DriveCommStates MCDrive::UpdateActValues()
 					SDOAccessState = ThisNode.ReadSDO(0x6064, 0x00);
 					RxTxState = eMCWaiting;
 					break;				
+				default:
+					break;
 			}
 			break;
 		case 1:
@@ -414,6 +611,8 @@ DriveCommStates MCDrive::UpdateActValues()
 					
 					SDOAccessState = ThisNode.ReadSDO(0x606C, 0x00);
 					break;
+				default:
+					break;
 			}
 			break;
 	}	
@@ -484,6 +683,8 @@ DriveCommStates MCDrive::UpdateMotorTemp()
 			
 			SDOAccessState = ThisNode.ReadSDO(0x2326, 0x03);
 			break;
+		default:
+			break;
 	}
 	//always check whether a communication is stuck final 
 	return CheckComState();
@@ -540,6 +741,8 @@ DriveCommStates MCDrive::UpdateDriveErrors()
 			
 			SDOAccessState = ThisNode.ReadSDO(0x2320, 0x00);
 			break;
+		default:
+			break;
 	}
 	//always check whether a communication is stuck final 
 	return CheckComState();
@@ -558,70 +761,199 @@ uint16_t MCDrive::GetActualDriveErrors()
 }
 
 /*---------------------------------------------------------------------
- * DriveCommStates EnableDrive()
- * Enable the drive state machine.
+ * void EnableProcessData(uint32_t CycleTime)
+ * Map position, speed, motor temperature and the error register as the
+ * process data of the node. These will then be read in one go instead 
+ * of four separate requests. 
+ * CycleTime: 0 - on request by UpdateProcessData() only
+ *           >0 - requested cyclically every CycleTime ms
+ * The GetActualXxx() will report the values of the latest process image.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::EnableProcessData(uint32_t CycleTime)
+{
+	ThisNode.ClearProcessData();
+	ThisNode.MapProcessData(0x6064, 0x00);
+	ThisNode.MapProcessData(0x606C, 0x00);
+	ThisNode.MapProcessData(0x2326, 0x03);
+	ThisNode.MapProcessData(0x2320, 0x00);
+	ThisNode.SetProcessDataCycle(CycleTime);
+	
+	isProcessDataEnabled = true;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates UpdateProcessData()
+ * Request the process data on demand.
  * --> will report eMCWaiting while busy
  * --> will report eMCDone when finished
- * --> needs to be rest to eMCIdle after having registered the eMCDone
- 
- * 2020-11-22 AW Done
+ * Does not use the RxTxState of the drive so there is no need to
+ * reset it afterwards. Errors are reported once only.
+ * 
+ * 2026-10-18 AW Rev_A
  *--------------------------------------------------------------------*/
 
-DriveCommStates MCDrive::EnableDrive()
+DriveCommStates MCDrive::UpdateProcessData()
 {
-uint16_t StatusWord = ThisNode.StatusWord;
-uint16_t ControlWord = ThisNode.ControlWord;
-	
-	if((StatusWord & FSM402StatusMask) == FSM402_Enabled)
+	switch(ThisNode.UpdateProcessData())
 	{
-		if((CWAccessState == eCWIdle) || (CWAccessState == eCWDone))
-		{
-			ThisNode.ResetComState();
-			CWAccessState = eCWIdle;
-			RxTxState = eMCDone;
-			
-			#if(DEBUG_DRIVE & DEBUG_ENABLE)
-			Serial.print("Drive: Enabled SW ");
-			Serial.println(StatusWord, HEX);
-			#endif
-		}
-		else
-		{
-			//CWAccess has to be finshed 
-			CWAccessState = ThisNode.SendCw(ControlWord,MaxSWResponseDelay);
-		}
+		case eDone:
+			TakeProcessData();
+			return eMCDone;
+		case eError:
+			return eMCError;
+		case eTimeout:
+			return eMCTimeout;
+		default:
+			return eMCWaiting;
 	}
-	else
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t GetProcessDataTimeStamp()
+ * time the values of the process image have been received
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t MCDrive::GetProcessDataTimeStamp()
+{
+	return ThisNode.GetProcessDataTimeStamp();
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates RefreshAll(DriveSnapshot *Snapshot)
+ * Read StatusWord, OpMode, position, speed, motor temperature and the
+ * error register by a single batch of SDO reads. This replaces the
+ * sequence of UpdateDriveStatus(), UpdateActValues(), UpdateMotorTemp()
+ * and UpdateDriveErrors() with their six round-trips.
+ * The Snapshot is filled as a whole with eMCDone only, so all of its
+ * values have been requested within a single batch. The local copies 
+ * of the drive (GetSW(), GetActualXxx()) are updated too.
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * Does not use the RxTxState of the drive so there is no need to
+ * reset it afterwards. Errors are reported once only.
+ * A caller which stops polling before eMCDone has to CancelRefresh().
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::RefreshAll(DriveSnapshot *Snapshot)
+{
+	if(!isRefreshRunning)
 	{
-		unsigned int newCW;
-
-        if((StatusWord & FSM402StatusMask) == FSM402_Ready2SwitchOn) 
-			newCW = (ControlWord & FSM402ControlMask) | 0x07;
-		else if((StatusWord & FSM402StatusMask) == FSM402_SwitchedOn) 
-			newCW = (ControlWord & FSM402ControlMask) | 0x0F;
-		else if((StatusWord & FSM402StatusMask) == FSM402_Stopped) 
-			newCW = (ControlWord & FSM402ControlMask) | 0x0F;
-		else if((StatusWord & FSM402StatusMask) == FSM402_FaultState) 
-			newCW = (ControlWord & FSM402ControlMask) | 0x80; 
-		else
-		    newCW = (ControlWord & FSM402ControlMask) | 0x06; 	
-				
-		//send a new request only, if that has not been done last time	
-		#if(DEBUG_DRIVE & DEBUG_ENABLE)
-		if((CWAccessState == eCWIdle) || (CWAccessState == eCWRetry))
+		const uint16_t Idx[SnapshotObjects] = {0x6041, 0x6061, 0x6064, 0x606C, 0x2326, 0x2320};
+		const uint8_t SubIdx[SnapshotObjects] = {0x00, 0x00, 0x00, 0x00, 0x03, 0x00};
+		
+		for(uint8_t i = 0; i < SnapshotObjects; i++)
 		{
-			Serial.print("Drive: Enable ");
-			Serial.println(newCW, HEX);
+			SnapshotList[i].Idx = Idx[i];
+			SnapshotList[i].SubIdx = SubIdx[i];
+			SnapshotList[i].Value = 0;
 		}
-		#endif
+		isRefreshRunning = true;
+		RefreshStartedAt = ThisNode.GetTime();
+	}
+	
+	switch(ThisNode.ReadBatch(SnapshotList, SnapshotObjects))
+	{
+		case eDone:
+			isRefreshRunning = false;
 			
-		//would have to reflect the CWAccessState but that's done
-		//inside the SendCW already
-		CWAccessState = ThisNode.SendCw(newCW,MaxSWResponseDelay);			
-		RxTxState = eMCWaiting;
+			Snapshot->StatusWord = (uint16_t)SnapshotList[0].Value;
+			Snapshot->OpMode = (int8_t)SnapshotList[1].Value;
+			Snapshot->Position = (int32_t)SnapshotList[2].Value;
+			Snapshot->Speed = (int32_t)SnapshotList[3].Value;
+			Snapshot->MotorTemp = (int16_t)SnapshotList[4].Value;
+			Snapshot->DriveErrors = (uint16_t)SnapshotList[5].Value;
+			Snapshot->TimeStamp = ThisNode.GetTime();
+			Snapshot->Duration = ThisNode.GetTime() - RefreshStartedAt;
+			
+			ThisNode.StoreSW(Snapshot->StatusWord);
+			OpModeReported = Snapshot->OpMode;
+			ActualPostion = Snapshot->Position;
+			ActualSpeed = Snapshot->Speed;
+			ActualMotorTemp = Snapshot->MotorTemp;
+			ActualDriveErrors = Snapshot->DriveErrors;
+			
+			#if(DEBUG_DRIVE & DEBUG_UPDATE)
+			Serial.print("Drive: Snapshot in ");
+			Serial.println(Snapshot->Duration, DEC);
+			#endif
+			return eMCDone;
+		case eError:
+			isRefreshRunning = false;
+			return eMCError;
+		case eTimeout:
+			isRefreshRunning = false;
+			return eMCTimeout;
+		default:
+			return eMCWaiting;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void CancelRefresh()
+ * give up a RefreshAll() still running, so the batch of the node is
+ * free for UpdateProcessData() and others. The next RefreshAll()
+ * starts over.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::CancelRefresh()
+{
+	if(isRefreshRunning)
+	{
+		ThisNode.CancelBatch(SnapshotList);
+		isRefreshRunning = false;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates AccessObjects(SDOBatchEntry *List, uint8_t count)
+ * read and write any list of up to SDOMaxBatch objects by a single
+ * batch - entries with a Len > 0 are written. An object the drive
+ * rejects doesn't stop the others but is marked as isFailed.
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when all of them have been answered
+ * Does not use the RxTxState of the drive either.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::AccessObjects(SDOBatchEntry *List, uint8_t count)
+{
+	switch(ThisNode.AccessBatch(List, count))
+	{
+		case eDone:
+			return eMCDone;
+		case eError:
+			return eMCError;
+		case eTimeout:
+			return eMCTimeout;
+		default:
+			return eMCWaiting;
 	}
-	//always check whether a SDO is stuck final 
-	return CheckComState();
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates EnableDrive()
+ * Enable the drive state machine.
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ 
+ * 2020-11-22 AW Done
+ * 2026-10-18 AW use the sequence engine
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::EnableDrive()
+{
+	return RunSequence(SeqEnableDrive);
 }
 
 /*---------------------------------------------------------------------
@@ -632,54 +964,12 @@ uint16_t ControlWord = ThisNode.ControlWord;
  * --> needs to be rest to eMCIdle after having registered the eMCDone
  
  * 2020-11-22 AW Done
+ * 2026-10-18 AW use the sequence engine
  *--------------------------------------------------------------------*/
 
 DriveCommStates MCDrive::DisableDrive()
 {
-uint16_t StatusWord = ThisNode.StatusWord;
-uint16_t ControlWord = ThisNode.ControlWord;
-
-
-	if((StatusWord & FSM402StatusMask) == FSM402_SwitchOnDisabled)
-	{
-		if((CWAccessState == eCWIdle) || (CWAccessState == eCWDone))
-		{
-			ThisNode.ResetComState();
-			CWAccessState = eCWIdle;		
-			RxTxState = eMCDone;
-			
-			#if(DEBUG_DRIVE & DEBUG_DISABLE)
-			Serial.print("Drive: Disabled SW ");
-			Serial.println(StatusWord, HEX);
-			#endif
-		}
-		else
-		{
-			CWAccessState = ThisNode.SendCw(ControlWord,MaxSWResponseDelay);
-		}
-		
-	}
-	else
-	{
-		uint16_t newCW = (ControlWord & ~FSM402ControlMask);
-						
-		//send a new request only, if that has not been done last time	
-		#if(DEBUG_DRIVE & DEBUG_DISABLE)
-		if((CWAccessState == eCWIdle) || (CWAccessState == eCWRetry))
-		{
-			Serial.print("Drive: Disable CW ");
-			Serial.println(ControlWord, HEX);
-		}
-		#endif		
-			
-		//would have to reflect the CWAccessState but that's done
-		//inside the SendCW already
-		CWAccessState = ThisNode.SendCw(newCW,MaxSWResponseDelay);
-		RxTxState = eMCWaiting;
-		
-	}
-	//always check whether a SDO is stuck final 
-	return CheckComState();
+	return RunSequence(SeqDisableDrive);
 }
 
 /*---------------------------------------------------------------------
@@ -702,7 +992,7 @@ uint16_t ControlWord = ThisNode.ControlWord;
 		if((CWAccessState == eCWIdle) || (CWAccessState == eCWDone))
 		{
 			ThisNode.ResetComState();
-			CWAccessState == eCWIdle;
+			CWAccessState = eCWIdle;
 			
 			#if(DEBUG_DRIVE & DEBUG_STOP)
 			Serial.print("Drive: Stopped SW ");
@@ -788,51 +1078,19 @@ DriveCommStates MCDrive::WriteObject(uint16_t index, uint8_t sub, int32_t value,
  *
  * Does not read the OpMode back 0x6061.00 but switches to mCDone as soon
  * as the wite access was successful.
+ * The access is skipped if the OpMode is known to be set already.
  * 
  * Parameters are all supported OpModes of the drive.
  *
  * 2020-11-22 AW Done
+ * 2026-10-18 AW use the sequence engine
  *--------------------------------------------------------------------*/
 
 DriveCommStates MCDrive::SetOpMode(int8_t OpMode)
 {
-
-	if(SDOAccessState == eDone)
-	{
-		ThisNode.ResetComState();
-		SDOAccessState = eIdle;
-		OpModeReported = OpModeRequested;
-		RxTxState = eMCDone;
-		
-		#if(DEBUG_DRIVE & DEBUG_SetOpMode)
-		Serial.println("Drive: OpMode set ");
-		#endif
-	}
-	else
-	{
-		//skip the first access if not required
-		if(OpModeReported == OpMode)
-			RxTxState = eMCDone;
-		else
-		{
-			OpModeRequested = OpMode;
-
-			#if(DEBUG_DRIVE & DEBUG_SetOpMode)
-			if(SDOAccessState == eIdle)
-			{
-				Serial.print("Drive: OpMode ");
-				Seriel.print(OpMode, DEC);
-				Serial.println(" Request");
-			}
-		
-			#endif		
-			SDOAccessState = ThisNode.WriteSDO(0x6060, 0x00,(uint32_t *)&OpModeRequested,1);
-		}
-		RxTxState = eMCWaiting;
-	}					
+	SeqArg[0] = OpMode;
 	
-	//always check whether a SDO is stuck final 
-	return CheckComState();				
+	return RunSequence(SeqSetOpMode);
 }
 
 /*---------------------------------------------------------------------
@@ -850,112 +1108,18 @@ DriveCommStates MCDrive::SetOpMode(int8_t OpMode)
 
  * 
  * 2020-11-22 AW Done
+ * 2026-10-18 AW use the sequence engine, write the ProfileType to 0x6086
  *--------------------------------------------------------------------*/
 
 DriveCommStates MCDrive::SetProfile(uint32_t ProfileACC, uint32_t ProfileDEC, uint32_t ProfileSpeed, int16_t ProfileType)
 {
+	SeqArg[0] = ProfileACC;
+	SeqArg[1] = ProfileDEC;
+	SeqArg[2] = ProfileSpeed;
+	SeqArg[3] = ProfileType;
 	
-	switch(AccessStep)
-	{
-		case 0:
-			if(SDOAccessState == eDone)
-			{
-				ThisNode.ResetComState();
-				SDOAccessState = eIdle;
-				AccessStep = 1;
-				
-				#if(DEBUG_DRIVE & DEBUG_RWPARAM)
-				Serial.println("Drive: ACC set ");
-				#endif
-			}
-			else
-			{
-				#if(DDEBUG_DRIVE & DEBUG_RWPARAM)
-				if(SDOAccessState == eIdle)
-					Serial.print("Drive: Set ACC ");
-				else if(SDOAccessState == eRetry)
-					Serial.print("Drive: Set ACC Retry");
-				#endif
-				
-				SDOAccessState = ThisNode.WriteSDO(0x6083, 0x00,(uint32_t *)&ProfileACC,4);
-				RxTxState = eMCWaiting;
-			}
-			break;
-		case 1:
-			if(SDOAccessState == eDone)
-			{
-				ThisNode.ResetComState();
-				SDOAccessState = eIdle;
-				AccessStep = 2;
-				
-				#if(DEBUG_DRIVE & DEBUG_RWPARAM)
-				Serial.println("Drive: DEC set ");
-				#endif
-			}
-			else
-			{
-				#if(DDEBUG_DRIVE & DEBUG_RWPARAM)
-				if(SDOAccessState == eIdle)
-					Serial.print("Drive: Set DEC ");
-				else if(SDOAccessState == eRetry)
-					Serial.print("Drive: Set DEC Retry");
-				#endif
-				
-				SDOAccessState = ThisNode.WriteSDO(0x6084, 0x00,(uint32_t *)&ProfileDEC,4);
-			}
-			break;
-		case 2:
-			if(SDOAccessState == eDone)
-			{
-				ThisNode.ResetComState();
-				SDOAccessState = eIdle;
-				AccessStep = 3;			
-				
-				#if(DEBUG_DRIVE & DEBUG_RWPARAM)
-				Serial.println("Drive: Speed set ");
-				#endif
-			}
-			else
-			{
-				#if(DDEBUG_DRIVE & DEBUG_RWPARAM)
-				if(SDOAccessState == eIdle)
-					Serial.print("Drive: Set Speed ");
-				else if(SDOAccessState == eRetry)
-					Serial.print("Drive: Set Speed Retry");
-				#endif
-				
-				SDOAccessState = ThisNode.WriteSDO(0x6081, 0x00,(uint32_t *)&ProfileSpeed,4);
-			}
-			break;
-		case 3:
-			if(SDOAccessState == eDone)
-			{
-				ThisNode.ResetComState();
-				SDOAccessState = eIdle;
-				AccessStep = 0;
-				RxTxState = eMCDone;				
-				
-				#if(DEBUG_DRIVE & DEBUG_RWPARAM)
-				Serial.println("Drive: P-Type set ");
-				#endif
-			}
-			else
-			{
-				#if(DDEBUG_DRIVE & DEBUG_RWPARAM)
-				if(SDOAccessState == eIdle)
-					Serial.print("Drive: Set P-Type ");
-				else if(SDOAccessState == eRetry)
-					Serial.print("Drive: Set P-Type Retry");
-				#endif
-				
-				SDOAccessState = ThisNode.WriteSDO(0x6086, 0x00,(uint32_t *)&ProfileSpeed,2);
-			}
-			break;
-	}	//end of switch				
-
-	//always check whether a SDO is stuck final 
-	return CheckComState();				
-}		
+	return RunSequence(SeqSetProfile);
+}		
 
 /*---------------------------------------------------------------------
  * DriveCommStates StartAbsMove(int32_t TargetPos, bool immeditate)
@@ -1006,88 +1170,415 @@ DriveCommStates MCDrive::StartRelMove(int32_t TargetPos, bool immeditate)
 }
 
 /*---------------------------------------------------------------------
- * DriveCommStates MoveAtSpeed(int32_t RefSpeed)
- * Switch the drive to PV mode and move at the given speed.
- * Parameter is:
- * RefSpeed: given in whatever user units the speed in scaled
- *              by the FactorGroup. Default unit is 1/min (rpm)
+ * bool QueueMove(int32_t TargetPos, bool relative)
+ * Add a target position to the PP setpoint queue of the drive.
+ * The queue is worked off by RunPPQueue().
+ * Returns false if the queue is full.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCDrive::QueueMove(int32_t TargetPos, bool relative)
+{
+	if(PPQueueCount >= PPQueueSize)
+		return false;
+		
+	uint8_t Head = (PPQueueTail + PPQueueCount) % PPQueueSize;
+	
+	PPQueue[Head].TargetPos = TargetPos;
+	PPQueue[Head].isRelative = relative;
+	PPQueueCount++;
+	
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * void SetPPBlending(bool enable)
+ * enable: the drive will move through a queued setpoint without
+ *         stopping if the next one is already known (PP_ChangeOnSetP)
+ *         else the drive stops at each setpoint but starts the next
+ *         segment without waiting for the application.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::SetPPBlending(bool enable)
+{
+	isPPBlending = enable;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t GetPPQueueCount()
+ * number of setpoints not handed over to the drive yet
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCDrive::GetPPQueueCount()
+{
+	return PPQueueCount;
+}
+
+/*---------------------------------------------------------------------
+ * void ClearPPQueue()
+ * drop all the setpoints not handed over to the drive yet
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::ClearPPQueue()
+{
+	PPQueueCount = 0;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates RunPPQueue()
+ * Hand over the queued setpoints to the drive. The setpoints are sent 
+ * as buffered setpoints (PP_ImmediateBit == 0) so the drive accepts 
+ * the next one while still moving. The next setpoint is sent as soon 
+ * as the drive has acknowledged the previous one and has released 
+ * StatusBit_PP_Ack again, without returning to the application.
+ * So a whole path is run by calling RunPPQueue() in every loop.
+ *
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when all setpoints are handed over
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * Use IsInPos() afterwards to wait for the last target.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::RunPPQueue()
+{
+DriveCommStates SeqState;
+
+	while(PPQueueCount > 0)
+	{
+		uint16_t StartBits = 0;
+		
+		if(isPPBlending)
+			StartBits |= PP_ChangeOnSetP;
+		if(PPQueue[PPQueueTail].isRelative)
+			StartBits |= PP_RelativeBit;
+		
+		SeqArg[0] = PPQueue[PPQueueTail].TargetPos;
+		SeqArg[1] = StartBits;
+		
+		SeqState = RunSequence(SeqMovePP);
+		if(SeqState != eMCDone)
+			return SeqState;
+		
+		//setpoint is with the drive - continue with the next one
+		PPQueueTail = (PPQueueTail + 1) % PPQueueSize;
+		PPQueueCount--;
+		RxTxState = eMCIdle;
+	}
+	RxTxState = eMCDone;
+	
+	//always check whether a SDO is stuck final 
+	return CheckComState();
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates PrepareMovePP(int32_t TargetPos)
+ * First part of an absolute move in PP mode as used to start several
+ * drives together: OpMode, start bit cleared and target position.
+ * The move is started by TriggerMovePP() then.
  *
  * --> will report eMCWaiting while busy
  * --> will report eMCDone when finished
  * --> needs to be rest to eMCIdle after having registered the eMCDone
  * 
- * 2020-11-22 AW Done
+ * 2026-10-18 AW Rev_A
  *--------------------------------------------------------------------*/
 
-DriveCommStates MCDrive::MoveAtSpeed(int32_t RefSpeed)
+DriveCommStates MCDrive::PrepareMovePP(int32_t TargetPos)
 {
+	SeqArg[0] = TargetPos;
 	
-	switch(AccessStep)
+	return RunSequence(SeqPrepareMovePP);
+}
+
+/*---------------------------------------------------------------------
+ * bool TriggerMovePP()
+ * Start the prepared move immediately by sending the start bit without
+ * waiting for the MsgHandler to be free. The response is not waited for.
+ * Returns false if the CW could not be handed over to the Uart.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCDrive::TriggerMovePP()
+{
+	uint16_t newCW = (ThisNode.ControlWord & ~PP_ChangeOnSetP) | PP_StartBit | PP_ImmediateBit;
+	
+	return ThisNode.SendCwImmediate(newCW);
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates FinishMovePP()
+ * Wait for the triggered move to be acknowledged and clear the 
+ * start bit again.
+ *
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::FinishMovePP()
+{
+	return RunSequence(SeqFinishMovePP);
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates StartCSP(uint8_t CycleTime)
+ * Prepare the cyclic synchronous position mode (OpMode 8):
+ * set the interpolation period 0x60C2.01 to CycleTime ms and switch
+ * the OpMode. The drive has to be enabled by the application and the
+ * first setpoint should be the actual position.
+ * Streaming is started with the eMCDone - the setpoints are sent by
+ * RunCSP() then.
+ *
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::StartCSP(uint8_t CycleTime)
+{
+	SeqArg[0] = CycleTime;
+	
+	DriveCommStates SeqState = RunSequence(SeqStartCSP);
+	
+	if((SeqState == eMCDone) && !isCSPActive)
 	{
-		case 0:
-			if(SDOAccessState == eDone)
+		isCSPActive = true;
+		CSPCycleTime = CycleTime;
+		CSPCycleAt = ThisNode.GetTime();
+		CSPSentAt = 0;
+		
+		#if(DEBUG_DRIVE & DEBUG_CSP)
+		Serial.println("Drive: CSP started");
+		#endif
+	}
+	return SeqState;
+}
+
+/*---------------------------------------------------------------------
+ * void StopCSP()
+ * stop sending setpoints and drop the ones not sent yet
+ * the drive stays in OpMode 8 and holds the last setpoint
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::StopCSP()
+{
+	isCSPActive = false;
+	CSPCount = 0;
+	ResetComState();
+}
+
+/*---------------------------------------------------------------------
+ * void AlignCSPCycle(uint32_t time)
+ * set the start of the next CSP cycle to time so several drives 
+ * streaming together are sent their setpoints in the same loop
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::AlignCSPCycle(uint32_t time)
+{
+	CSPCycleAt = time;
+}
+
+/*---------------------------------------------------------------------
+ * bool PushCSPSetpoint(int32_t TargetPos)
+ * add the next interpolated position to the ring buffer
+ * returns false if the buffer is full
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCDrive::PushCSPSetpoint(int32_t TargetPos)
+{
+	if(CSPCount >= CSPBufferSize)
+		return false;
+	
+	CSPBuffer[(CSPTail + CSPCount) % CSPBufferSize] = TargetPos;
+	CSPCount++;
+	
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t GetCSPFree()
+ * number of setpoints which can be pushed
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCDrive::GetCSPFree()
+{
+	return CSPBufferSize - CSPCount;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates RunCSP()
+ * To be called in every loop while streaming. Every CSPCycleTime
+ * the next setpoint is written to 0x607A. 
+ * If the buffer is empty when the cycle is due an underrun is counted
+ * and the drive keeps the last setpoint. If the write of the last
+ * cycle is not confirmed yet an overrun is counted and the cycle is
+ * skipped - the cycle time is too short for the baud rate then.
+ *
+ * --> will report eMCWaiting while streaming
+ * --> will report eMCIdle if not streaming
+ * --> eMCError or eMCTimeout if the write failed
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::RunCSP()
+{
+	if(!isCSPActive)
+		return eMCIdle;
+	
+	//finish the write of the last cycle
+	if(SDOAccessState != eIdle)
+	{
+		if(SDOAccessState != eDone)
+			SDOAccessState = ThisNode.WriteSDO(0x607A, 0x00,(uint32_t *)&CSPTarget,4);
+		if(SDOAccessState == eDone)
+		{
+			uint32_t RoundTrip = micros() - CSPSentAt;
+			
+			if(RoundTrip > CSPStats.RoundTripMax)
+				CSPStats.RoundTripMax = RoundTrip;
+			//running average over 8 cycles
+			CSPStats.RoundTripAvg = CSPStats.RoundTripAvg - (CSPStats.RoundTripAvg >> 3) + (RoundTrip >> 3);
+			
+			ThisNode.ResetComState();
+			SDOAccessState = eIdle;
+		}
+	}
+	
+	if((ThisNode.GetTime() - CSPCycleAt) >= CSPCycleTime)
+	{
+		//keep the phase but don't try to catch up on lost cycles
+		CSPCycleAt += CSPCycleTime;
+		if((ThisNode.GetTime() - CSPCycleAt) >= CSPCycleTime)
+			CSPCycleAt = ThisNode.GetTime();
+			
+		CSPStats.Cycles++;
+		
+		if(SDOAccessState != eIdle)
+			CSPStats.Overruns++;
+		else if(CSPCount == 0)
+			CSPStats.Underruns++;
+		else
+		{
+			uint32_t now = micros();
+			
+			CSPTarget = CSPBuffer[CSPTail];
+			CSPTail = (CSPTail + 1) % CSPBufferSize;
+			CSPCount--;
+			
+			if(CSPSentAt != 0)
 			{
-				ThisNode.ResetComState();
-				SDOAccessState = eIdle;
-				OpModeReported = 3;
-				AccessStep = 1;			
+				int32_t Jitter = (int32_t)(now - CSPSentAt) - (int32_t)CSPCycleTime * 1000;
 				
-				#if(DEBUG_DRIVE & DEBUG_MoveSpeed)
-				Serial.println("Drive: OpMode set ");
-				#endif
+				if(Jitter < CSPStats.JitterMin)
+					CSPStats.JitterMin = Jitter;
+				if(Jitter > CSPStats.JitterMax)
+					CSPStats.JitterMax = Jitter;
 			}
-			else
-			{
-				//skip the first access if not required
-				if(OpModeReported == 3)
-					AccessStep = 1;
-				else
-				{
-					OpModeRequested = 3;
+			CSPSentAt = now;
+			
+			SDOAccessState = ThisNode.WriteSDO(0x607A, 0x00,(uint32_t *)&CSPTarget,4);
+		}
+	}
+	RxTxState = eMCWaiting;
+	
+	//always check whether a SDO is stuck final 
+	return CheckComState();
+}
 
-					#if(DEBUG_DRIVE & DEBUG_MoveSpeed)
-					if(SDOAccessState == eIdle)
-					{
-						Serial.println("Drive: OpMode 3 Request");
-					}
-				
-					#endif
-				
-					SDOAccessState = ThisNode.WriteSDO(0x6060, 0x00,(uint32_t *)&OpModeRequested,1);
-				}
-				RxTxState = eMCWaiting;
-			}
+/*---------------------------------------------------------------------
+ * void GetCSPStatistics(CSPStatistics *Stats)
+ * copy the statistics of the CSP streaming
+ * jitter is the deviation of the send interval from the cycle time 
+ * and is given in us as is the round-trip time of a setpoint.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
 
-			break;
-		case 1:
-			if(SDOAccessState == eDone)
-			{
-				ThisNode.ResetComState();
-				SDOAccessState = eIdle;
-				AccessStep = 0;
-				RxTxState = eMCDone;
+void MCDrive::GetCSPStatistics(CSPStatistics *Stats)
+{
+	*Stats = CSPStats;
+}
 
-				#if(DEBUG_DRIVE & DEBUG_MoveSpeed)
-				Serial.println("Drive: TSpeed set");
-				#endif
-			}
-			else 			
-			{
-				#if(DEBUG_DRIVE & DEBUG_MoveSpeed)
-				if(SDOAccessState == eIdle)
-				{
-					Serial.print("Drive: Set TSpeed: ");
-					Serial.println(RefSpeed, DEC);
-				}
-				#endif
+/*---------------------------------------------------------------------
+ * void ResetCSPStatistics()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
 
-				SDOAccessState = ThisNode.WriteSDO(0x60FF, 0x00,(uint32_t *)&RefSpeed,4);
-			}
+void MCDrive::ResetCSPStatistics()
+{
+	CSPStats.Cycles = 0;
+	CSPStats.Underruns = 0;
+	CSPStats.Overruns = 0;
+	CSPStats.JitterMin = 0;
+	CSPStats.JitterMax = 0;
+	CSPStats.RoundTripMax = 0;
+	CSPStats.RoundTripAvg = 0;
+	CSPSentAt = 0;
+}
 
-			break;
-	}					
-	//always check whether a SDO is stuck final 
-	return CheckComState();				
+/*---------------------------------------------------------------------
+ * uint32_t EstimateCSPCycleTime(uint32_t baud)
+ * Estimate the shortest cycle time in us for a single drive at the
+ * given baud rate: wire time of the write request and its response
+ * plus the response time of the drive. 
+ * The RoundTripMax measured while streaming is the real figure.
+ * Multiple drives at one line will need a multiple of this.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t MCDrive::EstimateCSPCycleTime(uint32_t baud)
+{
+	if(baud == 0)
+		return 0;
+		
+	return ((uint32_t)(CSPWriteReqBytes + CSPWriteRespBytes) * 10 * 1000000UL) / baud + CSPDriveResponseTime;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates MoveAtSpeed(int32_t RefSpeed)
+ * Switch the drive to PV mode and move at the given speed.
+ * Parameter is:
+ * RefSpeed: given in whatever user units the speed in scaled
+ *              by the FactorGroup. Default unit is 1/min (rpm)
+ *
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * 
+ * 2020-11-22 AW Done
+ * 2026-10-18 AW use the sequence engine
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::MoveAtSpeed(int32_t RefSpeed)
+{
+	SeqArg[0] = RefSpeed;
+	
+	return RunSequence(SeqMoveAtSpeed);
 }
 
 /*---------------------------------------------------------------------
@@ -1100,45 +1591,21 @@ DriveCommStates MCDrive::MoveAtSpeed(int32_t RefSpeed)
  * Parameters are all supported homing modes of the drive.
  * 
  * 2020-11-22 AW Done
+ * 2026-10-18 AW use the sequence engine
  *--------------------------------------------------------------------*/
 
 DriveCommStates MCDrive::ConfigureHoming(int8_t method)
 {
-uint16_t StatusWord = ThisNode.StatusWord;
-uint16_t ControlWord = ThisNode.ControlWord;
-
-	//set homing method
-	if(SDOAccessState == eDone)
-	{
-		ThisNode.ResetComState();
-		SDOAccessState = eIdle;
-		RxTxState = eMCDone;
-		
-		#if(DEBUG_DRIVE & DEBUG_HOME)
-		Serial.println("Drive: Homing set ");
-		#endif
-	}
-	else
-	{
-		#if(DEBUG_DRIVE & DEBUG_HOME)
-		if(SDOAccessState == eIdle)
-		{
-			Serial.println("Drive: Homing Set Mode");
-		}			
-		#endif
+	SeqArg[0] = method;
 	
-		SDOAccessState = ThisNode.WriteSDO(0x6098, 0x00,(uint32_t *)&method,1);
-		RxTxState = eMCWaiting;
-	}
-	//always check whether a SDO is stuck final 
-	return CheckComState();				
+	return RunSequence(SeqConfigureHoming);
 }
 
 /*---------------------------------------------------------------------
  * DriveCommStates StartHoming()
  * Switch the drive to hmong mode and start the pre-configured homing
  * method.
- * Uses an internal step sequence based on AccessStep to do so.
+ * Uses the sequence SeqStartHoming to do so.
  * No Parameters required.
  *
  * --> will report eMCWaiting while busy
@@ -1146,236 +1613,323 @@ uint16_t ControlWord = ThisNode.ControlWord;
  * --> needs to be rest to eMCIdle after having registered the eMCDone
  * 
  * 2020-11-22 AW Done
+ * 2026-10-18 AW use the sequence engine
  *--------------------------------------------------------------------*/
 
 DriveCommStates MCDrive::StartHoming()
 {
-uint16_t StatusWord = ThisNode.StatusWord;
-uint16_t ControlWord = ThisNode.ControlWord;
+	return RunSequence(SeqStartHoming);
+}
 
-	//at the very beginning AccessStep has to be == 0
-	switch(AccessStep)
-	{
-		case 0:
-			//ensure StartBit == 0
-			//as soon as the CWAccessState == eCWDone we can proceed
-			if(CWAccessState == eCWDone)
-			{
-				ThisNode.ResetComState();
-				CWAccessState = eCWIdle;
-				AccessStep = 1;
+/*---------------------------------------------------------------------
+ * DriveCommStates IsInPos()
+ * Check the StatusWord of the drive and test it for the target reached
+ * bit being set. Will update the Statusword cyclically using the internal
+ * Wait4Status.
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * 
+ * 2020-11-22 AW Done
+ *--------------------------------------------------------------------*/
 
-				#if(DEBUG_DRIVE & DEBUG_HOME)
-				Serial.println("Drive: intial Force Bit4==0");
-				#endif
-			}
-			else
+DriveCommStates MCDrive::IsInPos()
+{				
+	return Wait4Status(StatusBit_PP_IsInPos,PullSWCycleTime);	
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates IsHomingFinished()
+ * Check the StatusWord of the drive and test it for pattern indicating a 
+ * successfully completed homing sequence being set. 
+ * Will update the Statusword cyclically using the internal Wait4Status.
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ *
+ * 2020-11-22 AW Done
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::IsHomingFinished()
+{	
+	return Wait4Status(StatusMask_Homing_Finished,PullSWCycleTime);
+}
+
+/*---------------------------------------------------------------------
+ * bool IsLive()
+ * Check whether a boot Msg of the drive has been received
+ * Please note: in net-mode of multiple drives no boot messages
+ * will be sent at all.
+ * If the drive is supervised the state of the supervision is used
+ * instead.
+ *
+ * 2020-11-22 AW untested
+ * 2026-10-18 AW use supervision if active
+ *--------------------------------------------------------------------*/
+
+bool MCDrive::IsLive()
+{
+	if(SupvState != eSupvOff)
+		return (SupvState == eSupvLive);
+	else
+		return ThisNode.IsLive();
+}
+
+/*---------------------------------------------------------------------
+ * void RegisterInitSequence(const DriveInitSequence *Sequence)
+ * Store the settings which have to be restored by Supervise() whenever
+ * the drive has rebooted: OpMode, the profile and the homing method.
+ * A HomingMethod of 0 will skip the homing configuration.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::RegisterInitSequence(const DriveInitSequence *Sequence)
+{
+	InitSequence = *Sequence;
+	hasInitSequence = true;
+}
+
+/*---------------------------------------------------------------------
+ * void SetSupervision(uint32_t SilenceTime, uint32_t ReInitTime)
+ * SilenceTime: if nothing has been received from the drive for this
+ *              time it will be probed by reading its status
+ * ReInitTime:  max time for a single attempt to replay the init 
+ *              sequence. Will be retried after SilenceTime.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::SetSupervision(uint32_t SilenceTime, uint32_t ReInitTime)
+{
+	SupvSilenceTime = SilenceTime;
+	SupvReInitTime = ReInitTime;
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates Supervise()
+ * Liveness supervision of the drive. Is to be called in each cycle 
+ * before any other action of the drive.
+ * A drive is considered to be silent if nothing has been received
+ * for SilenceTime. It will then be probed by UpdateDriveStatus() but 
+ * only if no other action is running (ComState is eMCIdle).
+ * A drive which has sent a boot Msg or which answers again after having
+ * been silent has rebooted and the registered init sequence is replayed.
+ * In net mode there is no boot Msg so only the silence can be detected.
+ * --> will report eMCDone while the drive is live and can be used
+ * --> will report eMCWaiting while the drive is probed, silent or 
+ *     re-initialized. Any other action must not be called then.
+ * HasReInitialized() signals a finished re-init to the application.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::Supervise()
+{
+DriveCommStates retValue = eMCWaiting;
+DriveCommStates ProbeState;
+
+	switch(SupvState)
+	{
+		case eSupvOff:
+			//first call - start as if we had a live drive
+			SupvState = eSupvLive;
+			wasSilent = false;
+			//no break here
+		case eSupvLive:
+			if(ThisNode.HasRebooted())
 			{
-				uint16_t newCW = ControlWord & ~PP_StartBit;
-				
-				#if(DEBUG_DRIVE & DEBUG_HOME)
-				if((CWAccessState == eCWIdle) || (CWAccessState == eCWRetry))
-				{
-					Serial.print("Drive: Reset Start Bit first: ");
-					Serial.println(newCW, HEX);
-				}
-				#endif
-					
-				//no SW response required - 0 will avoid polling
-				CWAccessState = ThisNode.SendCw(newCW,0);
-				RxTxState = eMCWaiting;
+				ThisNode.ClearRebootFlag();
+				StartReInit();
 			}
-			break;
-		case 1:
-			//care for OpMode == 6
-			OpModeRequested = 6;
-			if(SDOAccessState == eDone)
+			else if(((ThisNode.GetTime() - ThisNode.GetLastRxTime()) > SupvSilenceTime) && (RxTxState == eMCIdle))
 			{
-				ThisNode.ResetComState();
-				SDOAccessState = eIdle;
-				AccessStep = 2;
-				
-				#if(DEBUG_DRIVE & DEBUG_HOME)
-				Serial.println("Drive: OpMode set ");
-				#endif
+				//nothing heard for some time and no action running 
+				SupvState = eSupvProbe;
+				SupvStateAt = ThisNode.GetTime();
 			}
 			else
-			{
-				#if(DEBUG_DRIVE & DEBUG_HOME)
-				if(SDOAccessState == eIdle)
-				{
-					Serial.println("Drive: OpMode 6 Request");
-				}				
-				#endif
-			
-				SDOAccessState = ThisNode.WriteSDO(0x6060, 0x00,(uint32_t *)&OpModeRequested,1);
-			}
-			break;
-		case 2:
-			switch(SDOAccessState)
-			{
-				case eDone:
-					OpModeReported = (uint8_t)ThisNode.GetObjValue();
-					ThisNode.ResetSDOState();
-					SDOAccessState = eIdle;
-					if(OpModeReported == OpModeRequested)
-					{
-						OpModeReported = OpModeRequested;
-						AccessStep = 3;
-						#if(DEBUG_DRIVE & DEBUG_HOME)
-						Serial.print("Drive: OpMode pulled as expeted: ");
-						Serial.println(OpModeReported, HEX);
-						#endif
-					}
-					else
-					{
-						//try again
-						AccessStep = 1;
-						#if(DEBUG_DRIVE & DEBUG_HOME)
-						Serial.print("Drive: OpMode pulled unexpected: ");
-						Serial.println(OpModeReported, HEX);
-						#endif
-					}
-						
-					break;
-				case eIdle:
-				case eRetry:
-				case eWaiting:
-					#if(DDEBUG_DRIVE & DEBUG_HOME)
-					if(SDOAccessState == eIdle)
-						Serial.print("Drive: OpMode Request ");
-					else if(SDOAccessState == eRetry)
-						Serial.print("Drive: OpMode Request Retry");
-					#endif
-					
-					SDOAccessState = ThisNode.ReadSDO(0x6061, 0x00);
-					break;				
-			}
+				retValue = eMCDone;
 			break;
-		case 3:
-			//set StartBit		
-			if(CWAccessState == eCWDone)
-			{
-				ThisNode.ResetComState();
-				CWAccessState = eCWIdle;
-				AccessStep = 4;
-
-				#if(DEBUG_DRIVE & DEBUG_HOME)
-				Serial.println("Drive: Start Bit set");
-				#endif
-			}
-			else
+		case eSupvProbe:
+			ProbeState = UpdateDriveStatus();
+			if(ProbeState == eMCDone)
 			{
-				uint16_t newCW = ControlWord | PP_StartBit;
-								
-				#if(DEBUG_DRIVE & DEBUG_HOME)
-				if((CWAccessState == eCWIdle) || (CWAccessState == eCWRetry))
+				ResetComState();
+				if(wasSilent)
+					StartReInit();
+				else
 				{
-					Serial.print("Drive: Set Start Bit: ");
-					Serial.println(newCW, HEX);
+					SupvState = eSupvLive;
+					retValue = eMCDone;
 				}
+			}
+			else if((ProbeState == eMCError) || (ProbeState == eMCTimeout))
+			{
+				ResetComState();
+				wasSilent = true;
+				SupvState = eSupvSilent;
+				SupvStateAt = ThisNode.GetTime();
+				
+				#if(DEBUG_DRIVE & DEBUG_TO)
+				Serial.print("Drive: silent ");
+				Serial.println(ThisNode.GetLastRxTime(), DEC);
 				#endif
-					
-				//no SW response required - 0 will avoid polling
-				CWAccessState = ThisNode.SendCw(newCW,0);			
 			}
 			break;
-		case 4:
-			//reset StartBit again
-			if(CWAccessState == eCWDone)
+		case eSupvSilent:
+			if(ThisNode.HasRebooted())
 			{
-				ThisNode.ResetComState();
-				CWAccessState = eCWIdle;
-				AccessStep = 5;
-
-				#if(DEBUG_DRIVE & DEBUG_HOME)
-				Serial.println("Drive: reset Start-bit again Bit4==0");
-				#endif
+				ThisNode.ClearRebootFlag();
+				StartReInit();
 			}
-			else
+			else if((ThisNode.GetTime() - SupvStateAt) > SupvSilenceTime)
 			{
-				uint16_t newCW = ControlWord & ~PP_StartBit;
-								
-				#if(DEBUG_DRIVE & DEBUG_HOME)
-				if((CWAccessState == eCWIdle) || (CWAccessState == eCWRetry))
-				{
-					Serial.print("Drive: Reset Start Bit again: ");
-					Serial.println(newCW, HEX);
-				}
-				#endif
-					
-				//no SW response required - 0 will avoid polling
-				CWAccessState = ThisNode.SendCw(newCW,0);			
+				SupvState = eSupvProbe;
+				SupvStateAt = ThisNode.GetTime();
 			}
 			break;
-		case 5:
-			//we are done and wait for the calling sequence to reset the ComState
-			RxTxState = eMCDone;
+		case eSupvReInit:
+			ReInit();
 			break;
-			
 	}
-	//always check whether a SDO is stuck final 
-	return CheckComState();				
+	return retValue;
 }
 
 /*---------------------------------------------------------------------
- * DriveCommStates IsInPos()
- * Check the StatusWord of the drive and test it for the target reached
- * bit being set. Will update the Statusword cyclically using the internal
- * Wait4Status.
- * --> will report eMCWaiting while busy
- * --> will report eMCDone when finished
- * --> needs to be rest to eMCIdle after having registered the eMCDone
+ * DriveSupvStates GetSupvState()
+ * Read the state of the liveness supervision.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveSupvStates MCDrive::GetSupvState()
+{
+	return SupvState;
+}
+
+/*---------------------------------------------------------------------
+ * bool HasReInitialized()
+ * Check whether the drive has been re-initialized by Supervise() since
+ * the last call. The application will have to restart its own sequence
+ * as the drive will be disabled after a reboot. Reading does reset the flag.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCDrive::HasReInitialized()
+{
+	bool retValue = hasReInitialized;
+	
+	hasReInitialized = false;
+	return retValue;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t GetReInitCount()
+ * Number of finished re-inits since start-up.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCDrive::GetReInitCount()
+{
+	return ReInitCount;
+}
+		
+/*---------------------------------------------------------------------
+ * uint16_t GetLastError()
+ * Read the last EMCY code. EMCY service is not available in net mode.
+ * 
+ * 2020-11-22 AW Done
+ *--------------------------------------------------------------------*/
+
+uint16_t MCDrive::GetLastError()
+{
+	return ThisNode.GetLastError();
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t GetEMCYCount()
+ * Number of entries in the EMCY history of the node.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCDrive::GetEMCYCount()
+{
+	return ThisNode.GetEMCYCount();
+}
+
+/*---------------------------------------------------------------------
+ * bool GetEMCYRecord(uint8_t age, EMCYRecord *Record)
+ * Copy an entry of the EMCY history of the node. 0 is the latest one.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCDrive::GetEMCYRecord(uint8_t age, EMCYRecord *Record)
+{
+	return ThisNode.GetEMCYRecord(age, Record);
+}
+
+/*---------------------------------------------------------------------
+ * void SetEMCYStopMask(uint8_t mask)
+ * Define the bits of the CiA 301 error register which will trigger a 
+ * quick stop directly when an EMCY is received. 
+ * E.g. EMCYErrReg_Current to stop on any overcurrent.
+ * 0 - which is the default - disables the stop on EMCY.
  * 
- * 2020-11-22 AW Done
+ * 2026-10-18 AW Rev_A
  *--------------------------------------------------------------------*/
 
-DriveCommStates MCDrive::IsInPos()
-{				
-	return Wait4Status(StatusBit_PP_IsInPos,PullSWCycleTime);	
+void MCDrive::SetEMCYStopMask(uint8_t mask)
+{
+	EMCYStopMask = mask;
 }
 
 /*---------------------------------------------------------------------
- * DriveCommStates IsHomingFinished()
- * Check the StatusWord of the drive and test it for pattern indicating a 
- * successfully completed homing sequence being set. 
- * Will update the Statusword cyclically using the internal Wait4Status.
- * --> will report eMCWaiting while busy
- * --> will report eMCDone when finished
- * --> needs to be rest to eMCIdle after having registered the eMCDone
- *
- * 2020-11-22 AW Done
+ * bool IsEMCYStopped()
+ * Check whether a quick stop has been sent because of an EMCY.
+ * 
+ * 2026-10-18 AW Rev_A
  *--------------------------------------------------------------------*/
 
-DriveCommStates MCDrive::IsHomingFinished()
-{	
-	return Wait4Status(StatusMask_Homing_Finished,PullSWCycleTime);
+bool MCDrive::IsEMCYStopped()
+{
+	return isEMCYStopped;
 }
 
 /*---------------------------------------------------------------------
- * bool IsLive()
- * Check whether a boot Msg of the drive has been received
- * Please note: in net-mode of multiple drives no boot messages
- * will be sent at all.
- *
- * 2020-11-22 AW untested
+ * void ClearEMCYStop()
+ * Acknowledge a quick stop triggered by an EMCY. The drive itself has
+ * to be re-enabled by EnableDrive() - which is refused until then.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW unblocks the enable
  *--------------------------------------------------------------------*/
 
-bool MCDrive::IsLive()
+void MCDrive::ClearEMCYStop()
 {
-	return ThisNode.IsLive();
+	isEMCYStopped = false;
+	isEMCYStopPending = false;
+	if(Handler != NULL)
+		Handler->GetDeadlines()->Cancel(&EMCYRetryDeadline);
 }
-		
+
 /*---------------------------------------------------------------------
- * uint16_t GetLastError()
- * Read the last EMCY code. EMCY service is not available in net mode.
+ * void Register_OnEMCYCb(pfunction_holder *Cb)
+ * Register a callback for the EMCY fast path of the application.
+ * It will be called directly after any stop logic of the drive
+ * and gets a pointer to the new EMCYRecord.
  * 
- * 2020-11-22 AW Done
+ * 2026-10-18 AW Rev_A
  *--------------------------------------------------------------------*/
 
-uint16_t MCDrive::GetLastError()
+void MCDrive::Register_OnEMCYCb(pfunction_holder *Cb)
 {
-	return ThisNode.GetLastError();
+	OnEMCYCb.callback = Cb->callback;
+	OnEMCYCb.op = Cb->op;
 }
 
 //-------------------------------------------------------------------
@@ -1383,25 +1937,200 @@ uint16_t MCDrive::GetLastError()
 //-------------------------------------------------------------------
 
 /*---------------------------------------------------------------------
- * void OnTimeOut()
- * Handler for whatever TO might be implemented during complex actions
- * As of now not used.
+ * void StartReInit()
+ * Abort whatever is running and start to replay the init sequence.
+ * The OpMode of a rebooted drive is unknown so it is forced to be written.
  * 
- * 2020-11-22 AW untested
+ * 2026-10-18 AW Rev_A
  *--------------------------------------------------------------------*/
 
-void MCDrive::OnTimeOut()
+void MCDrive::StartReInit()
 {
-	#if(DEBUG_DRIVE & DEBUG_TO)
-	Serial.print("Drive: Timeout ");
+	ResetComState();
+	OpModeReported = InvalidOpMode;
+	ReInitStep = 0;
+	SupvState = eSupvReInit;
+	SupvStateAt = ThisNode.GetTime();
+	
+	#if(DEBUG_DRIVE & DEBUG_ERROR)
+	Serial.println("Drive: re-init");
 	#endif
 }
 
+/*---------------------------------------------------------------------
+ * void ReInit()
+ * Step sequence to replay the registered init sequence. Any failed
+ * step is retried until the ReInitTime is exceeded. The drive is then
+ * considered to be silent and will be probed again after SilenceTime.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::ReInit()
+{
+DriveCommStates StepState = eMCDone;
+
+	if((ThisNode.GetTime() - SupvStateAt) > SupvReInitTime)
+	{
+		//took too long - try again later
+		ResetComState();
+		wasSilent = true;
+		SupvState = eSupvSilent;
+		SupvStateAt = ThisNode.GetTime();
+		return;
+	}
+	
+	if(hasInitSequence)
+	{
+		switch(ReInitStep)
+		{
+			case 0:
+				StepState = SetOpMode(InitSequence.OpMode);
+				break;
+			case 1:
+				StepState = SetProfile(InitSequence.ProfileACC, InitSequence.ProfileDEC,
+									   InitSequence.ProfileSpeed, InitSequence.ProfileType);
+				break;
+			case 2:
+				if(InitSequence.HomingMethod != 0)
+					StepState = ConfigureHoming(InitSequence.HomingMethod);
+				break;
+		}
+	}
+	else
+		ReInitStep = 2;
+	
+	if(StepState == eMCDone)
+	{
+		ResetComState();
+		ReInitStep++;
+		
+		if(ReInitStep > 2)
+		{
+			SupvState = eSupvLive;
+			wasSilent = false;
+			hasReInitialized = true;
+			ReInitCount++;
+			
+			#if(DEBUG_DRIVE & DEBUG_ERROR)
+			Serial.println("Drive: re-init done");
+			#endif
+		}
+	}
+	else if((StepState == eMCError) || (StepState == eMCTimeout))
+	{
+		//retry this step
+		ResetComState();
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void OnEMCYHandler(EMCYRecord *Record)
+ * Fast path for any EMCY received by the node. Is called from within
+ * the Rx handling. If the error register does match the EMCYStopMask
+ * a quick stop is sent immediately without waiting for the next
+ * call of the application. Whatever the drive is running is aborted
+ * so nothing sends an enable CW behind the quick stop.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW latch the stop, abort the running access
+ *--------------------------------------------------------------------*/
+
+void MCDrive::OnEMCYHandler(EMCYRecord *Record)
+{
+	if(Record->ErrorRegister & EMCYStopMask)
+	{
+		//reset the QS bit - same as StopDrive()
+		uint16_t newCW = ThisNode.ControlWord & ~FSM402_QSBit;
+		
+		AbortOnEMCY();
+		
+		//if the Msg can't even be buffered RetryEMCYStop() will retry
+		isEMCYStopPending = true;
+		if(ThisNode.SendCwImmediate(newCW))
+		{
+			isEMCYStopPending = false;
+			isEMCYStopped = true;
+		}
+		else
+			Handler->GetDeadlines()->Arm(&EMCYRetryDeadline, ThisNode.GetTime() + 1);
+
+		#if(DEBUG_DRIVE & DEBUG_STOP)
+		Serial.print("Drive: EMCY stop ");
+		Serial.println(Record->ErrorCode, HEX);
+		#endif
+	}
+	
+	if(OnEMCYCb.callback != NULL)
+		OnEMCYCb.callback(OnEMCYCb.op,(void *)Record);
+}
+
+/*---------------------------------------------------------------------
+ * void AbortOnEMCY()
+ * drop the step sequence running, the PP setpoints queued and the
+ * CSP streaming - the caller sees eMCError for a running sequence
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::AbortOnEMCY()
+{
+	bool isBusy = (RxTxState == eMCWaiting);
+	
+	ResetComState();
+	PPQueueCount = 0;
+	isCSPActive = false;
+	CSPCount = 0;
+	
+	if(isBusy)
+		RxTxState = eMCError;
+}
+
+/*---------------------------------------------------------------------
+ * void OnProcessDataRx()
+ * called by the MCNode when a new process image has been received
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::OnProcessDataRx()
+{
+	if(isProcessDataEnabled)
+		TakeProcessData();
+}
+
+/*---------------------------------------------------------------------
+ * void TakeProcessData()
+ * copy the values of a new process image into the actual values
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCDrive::TakeProcessData()
+{
+uint32_t Value;
+
+	if(ThisNode.GetProcessDataTimeStamp() == ProcessDataTakenAt)
+		return;
+	
+	ProcessDataTakenAt = ThisNode.GetProcessDataTimeStamp();
+	
+	if(ThisNode.GetProcessData(0x6064, 0x00, &Value))
+		ActualPostion = (int32_t)Value;
+	if(ThisNode.GetProcessData(0x606C, 0x00, &Value))
+		ActualSpeed = (int32_t)Value;
+	if(ThisNode.GetProcessData(0x2326, 0x03, &Value))
+		ActualMotorTemp = (int16_t)Value;
+	if(ThisNode.GetProcessData(0x2320, 0x00, &Value))
+		ActualDriveErrors = (uint16_t)Value;
+}
+
 /*---------------------------------------------------------------------
  * DriveCommStates Wait4Status(uint16_t mask, uint16_t CycleTime)
  * Check the StatusWord of teh drive for the given pattern.
  * Will only return with eMCDone when the pattern is found. Will update
- * the StatusWord cyclically.
+ * the StatusWord cyclically. In push mode the cyclic update is done
+ * by the drive and CycleTime is extended to the watchdog time.
  * --> will report eMCWaiting while busy
  * --> will report eMCDone when finished
  * --> needs to be rest to eMCIdle after having registered the eMCDone
@@ -1451,202 +2180,246 @@ DriveCommStates MCDrive::Wait4Status(uint16_t mask, uint16_t CycleTime)
  * DriveCommStates MovePP(int32_t TargetPos, bool immeditate, bool relative)
  * Internal function to start an either absolute or relative move in PP mode.
  * Switches the drive to PP and handles the immediate bit.
- * Uses an internal step sequence based on AccessStep.
+ * A PP_ChangeOnSetP left over by RunPPQueue() is cleared.
+ * Uses the sequence SeqMovePP to do so.
  *
  * --> will report eMCWaiting while busy
  * --> will report eMCDone when finished
  * --> needs to be rest to eMCIdle after having registered the eMCDone
  *
  * 2020-11-22 AW Done
+ * 2026-10-18 AW use the sequence engine
  *--------------------------------------------------------------------*/
 
 DriveCommStates MCDrive::MovePP(int32_t TargetPos, bool immeditate, bool relative)
 {
+uint16_t StartBits = 0;
+
+	if(immeditate)
+		StartBits |= PP_ImmediateBit;
+	if(relative)
+		StartBits |= PP_RelativeBit;
+		
+	SeqArg[0] = TargetPos;
+	SeqArg[1] = StartBits;
+	
+	return RunSequence(SeqMovePP);
+}
+
+/*---------------------------------------------------------------------
+ * DriveCommStates RunSequence(const DriveSeqStep *Seq)
+ * Interpreter for the step tables in flash.
+ * AccessStep is the index of the active step. As long as a step is
+ * finished without the need to wait for a response the next one is
+ * started right away within the same call.
+ *
+ * --> will report eMCWaiting while busy
+ * --> will report eMCDone when finished
+ * --> needs to be rest to eMCIdle after having registered the eMCDone
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+DriveCommStates MCDrive::RunSequence(const DriveSeqStep *Seq)
+{
+DriveSeqStep Step;
+DriveSeqResults Result = eSeqNext;
+
+	while(Result == eSeqNext)
+	{
+		memcpy_P(&Step, &Seq[AccessStep], sizeof(DriveSeqStep));
+		
+		if(Step.Op == eSeqEnd)
+		{
+			AccessStep = 0;
+			RxTxState = eMCDone;
+			
+			#if(DEBUG_DRIVE & DEBUG_SEQ)
+			Serial.println("Drive: Seq done");
+			#endif
+			break;
+		}
+		
+		RxTxState = eMCWaiting;
+		Result = ExecSeqStep(&Step);
+		
+		if(Result == eSeqNext)
+			AccessStep++;
+		else if((Result == eSeqRepeat) && (AccessStep > 0))
+			AccessStep--;
+			
+		#if(DEBUG_DRIVE & DEBUG_SEQ)
+		if(Result != eSeqStay)
+		{
+			Serial.print("Drive: Seq step ");
+			Serial.println(AccessStep, DEC);
+		}
+		#endif
+	}
+	//always check whether a SDO is stuck final 
+	return CheckComState();
+}
+
+/*---------------------------------------------------------------------
+ * DriveSeqResults ExecSeqStep(const DriveSeqStep *Step)
+ * Execute a single step of a sequence.
+ * Returns eSeqNext as soon as the step is finished, eSeqStay while
+ * waiting and eSeqRepeat if the preceding step has to be repeated.
+ *
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW no enable while an EMCY stop is latched
+ *--------------------------------------------------------------------*/
+
+DriveSeqResults MCDrive::ExecSeqStep(const DriveSeqStep *Step)
+{
 uint16_t StatusWord = ThisNode.StatusWord;
 uint16_t ControlWord = ThisNode.ControlWord;
+int32_t Value = (Step->Arg < SeqMaxArgs) ? SeqArg[Step->Arg] : Step->Set;
 
-	//at the very beginning AccessStep has to be == 0
-	switch(AccessStep)
+	switch(Step->Op)
 	{
-		case 0:
-			//care for OpMode == 1
+		case eSeqSetOpMode:
+			//skip the access if not required
+			if((SDOAccessState == eIdle) && (OpModeReported == (int8_t)Value))
+				return eSeqNext;
+				
+			OpModeRequested = (int8_t)Value;
+			
+			if(SDOAccessState != eDone)
+				SDOAccessState = ThisNode.WriteSDO(0x6060, 0x00,(uint32_t *)&OpModeRequested,1);
 			if(SDOAccessState == eDone)
 			{
 				ThisNode.ResetComState();
 				SDOAccessState = eIdle;
-				OpModeReported = 1;
-				AccessStep = 1;
-				
-				#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-				Serial.println("Drive: OpMode set ");
-				#endif
+				OpModeReported = OpModeRequested;
+				return eSeqNext;
 			}
-			else
+			break;
+		case eSeqCheckOpMode:
+			if(SDOAccessState != eDone)
+				SDOAccessState = ThisNode.ReadSDO(0x6061, 0x00);
+			if(SDOAccessState == eDone)
 			{
-				if(OpModeReported == 1)
-					AccessStep = 1;
-				else
-				{
-					OpModeRequested = 1;
-
-					#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-					if(SDOAccessState == eIdle)
-					{
-						Serial.println("Drive: OpMode 1 Request");
-					}
+				OpModeReported = (int8_t)ThisNode.GetObjValue();
+				ThisNode.ResetSDOState();
+				SDOAccessState = eIdle;
 				
-					#endif
+				#if(DEBUG_DRIVE & DEBUG_SEQ)
+				Serial.print("Drive: OpMode pulled ");
+				Serial.println(OpModeReported, HEX);
+				#endif
 				
-					SDOAccessState = ThisNode.WriteSDO(0x6060, 0x00,(uint32_t *)&OpModeRequested,1);
-				}
-				RxTxState = eMCWaiting;
-			}
-			break;
-		case 1:
-			//ensure StartBit == 0
-			//of course the simpler way as this is done in StartHoming will do
-			//in most cases. Here the readyness of the drive is checked too,
-			if( ((ControlWord & PP_StartBit) == 0) &&
-				((StatusWord & StatusBit_PP_Ack) == 0) )
-			{
-				if( ((CWAccessState == eCWIdle) || (CWAccessState == eCWDone)) &&
-					(SDOAccessState == eIdle))
-				{
-					ThisNode.ResetComState();
-					CWAccessState = eCWIdle;
-					AccessStep = 2;
-
-					#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-					Serial.println("Drive: intial Force Bit4==0");
-					#endif
-				}
+				//try again if not as expected
+				if(OpModeReported == OpModeRequested)
+					return eSeqNext;
 				else
-				{
-					CWAccessState = ThisNode.SendCw(ControlWord,MaxSWResponseDelay);			
-				}
-
-			}
-			else
-			{
-				uint16_t newCW = ControlWord & ~PP_StartBit;
-								
-				#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-				if((CWAccessState == eCWIdle) || (CWAccessState == eCWRetry))
-				{
-					Serial.print("Drive: Reset Start Bit first: ");
-					Serial.println(newCW, HEX);
-				}
-				#endif
-					
-				CWAccessState = ThisNode.SendCw(newCW,MaxSWResponseDelay);			
+					return eSeqRepeat;
 			}
 			break;
-		case 2:
-			//set the TPos
+		case eSeqWriteObj:
+			if(SDOAccessState != eDone)
+				SDOAccessState = ThisNode.WriteSDO(Step->Index, Step->Sub,(uint32_t *)&Value,Step->Len);
 			if(SDOAccessState == eDone)
 			{
 				ThisNode.ResetComState();
 				SDOAccessState = eIdle;
-				AccessStep = 3;
-				
-				#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-				Serial.println("Drive: TPos set ");
-				#endif
+				return eSeqNext;
 			}
-			else
+			break;
+		case eSeqSendCw:
+			//no SW response required - 0 will avoid polling
+			if(CWAccessState != eCWDone)
+				CWAccessState = ThisNode.SendCw(SeqControlWord(Step, ControlWord),0);
+			if(CWAccessState == eCWDone)
 			{
-				#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-				if(SDOAccessState == eIdle)
-				{
-					Serial.print("Drive: TPos Request ");
-					Serial.println(TargetPos, DEC);
-				}
-				#endif
-				
-				SDOAccessState = ThisNode.WriteSDO(0x607A, 0x00,(uint32_t *)&TargetPos,4);
+				ThisNode.ResetComState();
+				CWAccessState = eCWIdle;
+				return eSeqNext;
 			}
 			break;
-		case 3:
-			//set StartBit				
-			//of course the simpler way as this is done in StartHoming will do
-			//in most cases. Here the drive rreally starting to move is checeked too.
-			if((StatusWord & StatusBit_PP_Ack) == StatusBit_PP_Ack)
+		case eSeqEnable:
+			//latched by an EMCY stop until ClearEMCYStop()
+			if(isEMCYStopped || isEMCYStopPending)
 			{
-				if( ((CWAccessState == eCWIdle) || (CWAccessState == eCWDone)) &&
-					(SDOAccessState == eIdle))
-				{
-					ThisNode.ResetComState();
-					CWAccessState = eCWIdle;
-					AccessStep = 4;
-					
-					#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-					Serial.println("Drive: PP Started");
-					#endif
-				}
-				else
-				{
-					CWAccessState = ThisNode.SendCw(ControlWord,MaxSWResponseDelay);			
-				}
+				RxTxState = eMCError;
+				return eSeqStay;
 			}
-			else
+			//no break
+		case eSeqCwUntilSW:
+			if(IsSeqStatusReached(Step, StatusWord, ControlWord))
 			{
-				uint16_t newCW = ControlWord | PP_StartBit;
-				
-				if(immeditate)
-					newCW |= PP_ImmediateBit;
-				if(relative)
-					newCW |= PP_RelativeBit;
-									
-				#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-				if((CWAccessState == eCWIdle) || (CWAccessState == eCWRetry))
-				{
-					Serial.print("Drive: Set Start Bit ");
-					Serial.println(newCW, HEX);
-				}
-				#endif
-
-				CWAccessState = ThisNode.SendCw(newCW,MaxSWResponseDelay);
-			}
-			break;
-		case 4:
-			//reset StartBit again
-			//of course the simpler way as this is done in StartHoming will do
-			//in most cases. Here the readyness of the drive is checked too,
-			if((StatusWord & StatusBit_PP_Ack) == 0)
-			{ 
 				if( ((CWAccessState == eCWIdle) || (CWAccessState == eCWDone)) &&
 					(SDOAccessState == eIdle))
 				{
 					ThisNode.ResetComState();
 					CWAccessState = eCWIdle;
-					RxTxState = eMCDone;
-					AccessStep = 0;
-				
-					#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-					Serial.println("Node PP Start Done");
-					#endif
+					return eSeqNext;
 				}
 				else
 				{
-					CWAccessState = ThisNode.SendCw(ControlWord,MaxSWResponseDelay);			
+					//CWAccess has to be finshed 
+					CWAccessState = ThisNode.SendCw(ControlWord,MaxSWResponseDelay);
 				}
 			}
 			else
-			{
-				uint16_t newCW = ControlWord & ~(PP_StartBit | PP_ImmediateBit | PP_RelativeBit);
-								
-				#if(DEBUG_DRIVE & DEBUG_MOVEPP)
-				if((CWAccessState == eCWIdle) || (CWAccessState == eCWRetry))
-				{
-					Serial.print("Drive: Reset Start Bit again ");
-					Serial.println(newCW, HEX);
-				}
-				#endif
+				CWAccessState = ThisNode.SendCw(SeqControlWord(Step, ControlWord),MaxSWResponseDelay);
+			break;
+	}
+	return eSeqStay;
+}
 
-				CWAccessState = ThisNode.SendCw(newCW,MaxSWResponseDelay);			
-			}
-			break;			
+/*---------------------------------------------------------------------
+ * uint16_t SeqControlWord(const DriveSeqStep *Step, uint16_t ControlWord)
+ * The CW to be sent in a step. eSeqEnable does select the transition of
+ * the CiA 402 state machine based on the actual SW, all the others
+ * clear and set the bits given by the step and the argument.
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint16_t MCDrive::SeqControlWord(const DriveSeqStep *Step, uint16_t ControlWord)
+{
+	if(Step->Op == eSeqEnable)
+	{
+		uint16_t DriveState = ThisNode.StatusWord & FSM402StatusMask;
+		
+        if(DriveState == FSM402_Ready2SwitchOn) 
+			return (ControlWord & FSM402ControlMask) | 0x07;
+		else if(DriveState == FSM402_SwitchedOn) 
+			return (ControlWord & FSM402ControlMask) | 0x0F;
+		else if(DriveState == FSM402_Stopped) 
+			return (ControlWord & FSM402ControlMask) | 0x0F;
+		else if(DriveState == FSM402_FaultState) 
+			return (ControlWord & FSM402ControlMask) | 0x80; 
+		else
+		    return (ControlWord & FSM402ControlMask) | 0x06; 	
 	}
-	//always check whether a SDO is stuck final 
-	return CheckComState();				
+	
+	uint16_t newCW = (ControlWord & ~Step->Clear) | Step->Set;
+	
+	if(Step->Arg < SeqMaxArgs)
+		newCW |= (uint16_t)SeqArg[Step->Arg];
+		
+	return newCW;
+}
+
+/*---------------------------------------------------------------------
+ * bool IsSeqStatusReached(const DriveSeqStep *Step, uint16_t StatusWord, uint16_t ControlWord)
+ * Check the SW for the pattern of the step. eSeqCwUntilSW does check
+ * the CW to carry the requested bits too.
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCDrive::IsSeqStatusReached(const DriveSeqStep *Step, uint16_t StatusWord, uint16_t ControlWord)
+{
+	if((StatusWord & Step->SWMask) != Step->SWValue)
+		return false;
+	
+	if(Step->Op == eSeqEnable)
+		return true;
+	
+	uint16_t newCW = SeqControlWord(Step, ControlWord);
+	
+	return (ControlWord == newCW);
 }
@@ -28,13 +28,113 @@ typedef enum DriveCommStates {
 }
  DriveCommStates;
 
+//states of the liveness supervision
+
+typedef enum DriveSupvStates {
+	eSupvOff,
+	eSupvLive,
+	eSupvProbe,
+	eSupvSilent,
+	eSupvReInit
+}
+ DriveSupvStates;
+
+//the settings to be restored after a drive has rebooted
+
+typedef struct DriveInitSequence {
+	int8_t OpMode;
+	uint32_t ProfileACC;
+	uint32_t ProfileDEC;
+	uint32_t ProfileSpeed;
+	int16_t ProfileType;
+	int8_t HomingMethod;
+} DriveInitSequence;
+
+//a single step of the sequences run by the MCDrive
+//the tables of steps are kept in flash
+
+typedef enum DriveSeqOps {
+	eSeqEnd,
+	eSeqWriteObj,
+	eSeqSetOpMode,
+	eSeqCheckOpMode,
+	eSeqSendCw,
+	eSeqCwUntilSW,
+	eSeqEnable
+}
+ DriveSeqOps;
+
+typedef enum DriveSeqResults {
+	eSeqStay,
+	eSeqNext,
+	eSeqRepeat
+}
+ DriveSeqResults;
+
+typedef struct DriveSeqStep {
+	uint8_t Op;
+	uint8_t Arg;		//slot of the argument, SeqNoArg if not used
+	uint16_t Index;		//object to be written
+	uint8_t Sub;
+	uint8_t Len;
+	uint16_t Clear;		//CW bits to be cleared
+	uint16_t Set;		//CW bits to be set or the value without argument
+	uint16_t SWMask;	//SW pattern to wait for
+	uint16_t SWValue;
+} DriveSeqStep;
+
+const uint8_t SeqMaxArgs = 4;
+const uint8_t SeqNoArg = 0xff;
+
+//a single entry of the PP setpoint queue
+
+typedef struct PPSetpoint {
+	int32_t TargetPos;
+	bool isRelative;
+} PPSetpoint;
+
+const uint8_t PPQueueSize = 8;
+
+//statistics of the CSP streaming
+
+typedef struct CSPStatistics {
+	uint32_t Cycles;
+	uint16_t Underruns;
+	uint16_t Overruns;
+	int32_t JitterMin;
+	int32_t JitterMax;
+	uint32_t RoundTripMax;
+	uint32_t RoundTripAvg;
+} CSPStatistics;
+
+const uint8_t CSPBufferSize = 16;
+
+//all the values of a drive read in one go
+
+typedef struct DriveSnapshot {
+	uint16_t StatusWord;
+	int8_t OpMode;
+	int32_t Position;
+	int32_t Speed;
+	int16_t MotorTemp;
+	uint16_t DriveErrors;
+	uint32_t TimeStamp;		//ms of the call of RefreshAll() which reported eMCDone
+	uint32_t Duration;		//ms from the first request to that call
+} DriveSnapshot;
+
+const uint8_t SnapshotObjects = 6;
+
+const uint16_t SupvSilenceTimeDefault = 1000;
+const uint16_t SupvReInitTimeDefault = 2000;
+const int8_t InvalidOpMode = -128;
+
 	
 class MCDrive {
 	public:
 		MCDrive();
 		void Connect2MsgHandler(MsgHandler *);
 		void SetNodeId(uint8_t);
-		void SetActTime(uint32_t);
+		void SetActTime(uint32_t);		//deprecated - the time is the one of the MsgHandler
 
 		DriveCommStates CheckComState();
 		void ResetComState(); 
@@ -56,15 +156,41 @@ class MCDrive {
 		int16_t GetActualMotorTemp();
 		DriveCommStates UpdateDriveErrors();
 		uint16_t GetActualDriveErrors();
+		
+		void EnableProcessData(uint32_t);
+		DriveCommStates UpdateProcessData();
+		uint32_t GetProcessDataTimeStamp();
+		DriveCommStates RefreshAll(DriveSnapshot *);
+		void CancelRefresh();
+		DriveCommStates AccessObjects(SDOBatchEntry *, uint8_t);
 
 		DriveCommStates SetOpMode(int8_t);
 		DriveCommStates SetProfile(uint32_t, uint32_t, uint32_t, int16_t);		
 		
 		DriveCommStates StartAbsMove(int32_t, bool);
 		DriveCommStates StartRelMove(int32_t, bool);
+		bool QueueMove(int32_t, bool);
+		void SetPPBlending(bool);
+		uint8_t GetPPQueueCount();
+		void ClearPPQueue();
+		DriveCommStates RunPPQueue();
+		DriveCommStates PrepareMovePP(int32_t);
+		bool TriggerMovePP();
+		DriveCommStates FinishMovePP();
 		DriveCommStates ConfigureHoming(int8_t);
 		DriveCommStates StartHoming();
 		DriveCommStates MoveAtSpeed(int32_t);
+		
+		DriveCommStates StartCSP(uint8_t);
+		void StopCSP();
+		void AlignCSPCycle(uint32_t);
+		bool PushCSPSetpoint(int32_t);
+		uint8_t GetCSPFree();
+		DriveCommStates RunCSP();
+		void GetCSPStatistics(CSPStatistics *);
+		void ResetCSPStatistics();
+		static uint32_t EstimateCSPCycleTime(uint32_t);
+		
 		DriveCommStates IsInPos();
 		DriveCommStates IsHomingFinished();
 		
@@ -74,26 +200,80 @@ class MCDrive {
 		uint8_t GetAccessStep();
 		
 		uint16_t GetSW();
+		uint32_t GetSWTimeStamp();
+		bool HasSWChanged();
+		void SetSWPushMode(bool,uint32_t);
 		CWCommStates GetCWAccess();
 		
 		bool IsLive();
+		void RegisterInitSequence(const DriveInitSequence *);
+		void SetSupervision(uint32_t, uint32_t);
+		DriveCommStates Supervise();
+		DriveSupvStates GetSupvState();
+		bool HasReInitialized();
+		uint8_t GetReInitCount();
+		
 		uint16_t GetLastError();
+		uint8_t GetEMCYCount();
+		bool GetEMCYRecord(uint8_t, EMCYRecord *);
+		
+		void SetEMCYStopMask(uint8_t);
+		bool IsEMCYStopped();
+		void ClearEMCYStop();
+		void Register_OnEMCYCb(pfunction_holder *);
+		
+		//fast path handler to be registered at the MCNode
+		static void OnEMCYRxCb(void *op,void *p) {
+			((MCDrive *)op)->OnEMCYHandler((EMCYRecord *)p);
+		};
 		
-		//hander to be registered at the OsTimer
-		static void OnTimeOutCb(void *p) {
-			((MCDrive *)p)->OnTimeOut();
+		//new process image of the MCNode
+		static void OnProcessDataRxCb(void *op,void *p) {
+			((MCDrive *)op)->OnProcessDataRx();
+		};
+		
+		//retry of the EMCY stop armed at the DeadlineQueue of the MsgHandler
+		static void *OnEMCYRetryDeadlineCb(void *op, void *p) {
+			((MCDrive *)op)->RetryEMCYStop();
+			return NULL;
 		};
 	
 		MCNode ThisNode;
 
 	private:
-		void OnTimeOut();
+		void OnEMCYHandler(EMCYRecord *);
+		void AbortOnEMCY();
+		void RetryEMCYStop();
+		void OnProcessDataRx();
+		void TakeProcessData();
+		void StartReInit();
+		void ReInit();
 		DriveCommStates Wait4Status(uint16_t, uint16_t);
 		DriveCommStates MovePP(int32_t,bool, bool);
+		DriveCommStates RunSequence(const DriveSeqStep *);
+		DriveSeqResults ExecSeqStep(const DriveSeqStep *);
+		uint16_t SeqControlWord(const DriveSeqStep *, uint16_t);
+		bool IsSeqStatusReached(const DriveSeqStep *, uint16_t, uint16_t);
 		
 		DriveCommStates RxTxState = eMCIdle;
 		
 		uint8_t AccessStep = 0;
+		int32_t SeqArg[SeqMaxArgs];
+		
+		PPSetpoint PPQueue[PPQueueSize];
+		uint8_t PPQueueTail = 0;
+		uint8_t PPQueueCount = 0;
+		bool isPPBlending = true;
+		
+		int32_t CSPBuffer[CSPBufferSize];
+		uint8_t CSPTail = 0;
+		uint8_t CSPCount = 0;
+		int32_t CSPTarget;
+		bool isCSPActive = false;
+		uint32_t CSPCycleTime;
+		uint32_t CSPCycleAt;
+		uint32_t CSPSentAt;
+		CSPStatistics CSPStats;
 		
 		int8_t OpModeRequested;
 		int8_t OpModeReported;	
@@ -103,6 +283,13 @@ class MCDrive {
 		int16_t ActualMotorTemp = 22;	
 		uint16_t ActualDriveErrors = 0;
 		
+		bool isProcessDataEnabled = false;
+		uint32_t ProcessDataTakenAt = 0;
+		
+		SDOBatchEntry SnapshotList[SnapshotObjects];
+		bool isRefreshRunning = false;
+		uint32_t RefreshStartedAt;
+		
 		SDOCommStates SDOAccessState = eIdle;
 		CWCommStates CWAccessState = eCWIdle;
 
@@ -111,11 +298,26 @@ class MCDrive {
 		uint8_t BusyRetryCounter = 0;
 		uint8_t BusyRetryMax = 1;
 		
-		bool isTimerActive = false;
-
-		uint32_t actTime;
+		MsgHandler *Handler = NULL;
 
 		bool isLive = false;
+		
+		DriveSupvStates SupvState = eSupvOff;
+		DriveInitSequence InitSequence;
+		bool hasInitSequence = false;
+		bool wasSilent = false;
+		bool hasReInitialized = false;
+		uint8_t ReInitCount = 0;
+		uint8_t ReInitStep = 0;
+		uint32_t SupvSilenceTime = SupvSilenceTimeDefault;
+		uint32_t SupvReInitTime = SupvReInitTimeDefault;
+		uint32_t SupvStateAt = 0;
+		
+		uint8_t EMCYStopMask = 0;
+		bool isEMCYStopped = false;
+		bool isEMCYStopPending = false;
+		MCDeadline EMCYRetryDeadline;
+		pfunction_holder OnEMCYCb;
 };
 
 #endif
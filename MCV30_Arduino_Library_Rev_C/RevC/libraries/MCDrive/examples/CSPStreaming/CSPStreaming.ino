@@ -0,0 +1,158 @@
+/*--------------------------------------------------------------
+ * CSPStreaming.ino
+ * stream a sine shaped position profile to a single drive in 
+ * cyclic synchronous position mode (OpMode 8) and report the
+ * statistics of the streaming every 2s.
+ * The estimated minimum cycle time per baud rate is printed at start.
+ * Compare it with the RoundTripMax measured at the actual baud rate.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+#include <MsgHandler.h>
+#include <MCDrive.h>
+#include <stdint.h>
+
+//--- globals ---
+
+const uint32_t MCBaudRate = 115200;
+const uint8_t CSPCycleTime = 5;          //ms
+const int32_t Amplitude = 20000;         //increments
+const uint32_t Period = 4000;            //ms for a full sine
+
+const uint32_t BaudRates[] = {9600, 19200, 38400, 57600, 115200};
+
+MsgHandler MCMsgHandler;
+MCDrive Drive_A;
+
+const int16_t DriveIdA = 1;
+uint16_t driveStep = 0;
+
+int32_t StartPos;
+uint32_t PathTime = 0;
+uint32_t LastReportTime;
+
+void setup() {
+  // Debug Port
+  Serial.begin(500000);
+
+  //start the MSG-Handler
+  MCMsgHandler.Open(MCBaudRate);
+
+  Drive_A.SetNodeId(DriveIdA);
+  Drive_A.Connect2MsgHandler(&MCMsgHandler);
+  Drive_A.EnableProcessData(0);
+
+  for(uint8_t i = 0; i < sizeof(BaudRates)/sizeof(BaudRates[0]); i++)
+  {
+    Serial.print("Main: min CSP cycle @");
+    Serial.print(BaudRates[i]);
+    Serial.print(" baud: ");
+    Serial.print(MCDrive::EstimateCSPCycleTime(BaudRates[i]));
+    Serial.println(" us");
+  }
+  LastReportTime = millis();
+}
+
+//fill the ring buffer with the next interpolated positions
+
+void fillSetpoints()
+{
+  while(Drive_A.GetCSPFree() > 0)
+  {
+    float phase = 2.0 * PI * (float)(PathTime % Period) / (float)Period;
+    
+    Drive_A.PushCSPSetpoint(StartPos + (int32_t)(Amplitude * sin(phase)));
+    PathTime += CSPCycleTime;
+  }
+}
+
+void reportStatistics()
+{
+  CSPStatistics Stats;
+
+  Drive_A.GetCSPStatistics(&Stats);
+  
+  Serial.print("Main: cycles ");
+  Serial.print(Stats.Cycles);
+  Serial.print(" underruns ");
+  Serial.print(Stats.Underruns);
+  Serial.print(" overruns ");
+  Serial.print(Stats.Overruns);
+  Serial.print(" jitter ");
+  Serial.print(Stats.JitterMin);
+  Serial.print("..");
+  Serial.print(Stats.JitterMax);
+  Serial.print(" us round-trip avg ");
+  Serial.print(Stats.RoundTripAvg);
+  Serial.print(" max ");
+  Serial.print(Stats.RoundTripMax);
+  Serial.println(" us");
+
+  Drive_A.ResetCSPStatistics();
+}
+
+void loop() {
+  uint32_t currentMillis = millis();
+  DriveCommStates NodeState;
+  
+  MCMsgHandler.Update(currentMillis);
+
+  switch(driveStep)
+  {
+    case 0:
+      if((Drive_A.UpdateDriveStatus()) == eMCDone)
+      {
+        driveStep = 1;
+        Drive_A.ResetComState();
+      }
+      break;
+    case 1:
+      if((Drive_A.EnableDrive()) == eMCDone)
+      {
+        driveStep = 2;
+        Drive_A.ResetComState();
+        Serial.println("Main: Drive enabled");
+      }
+      break;
+    case 2:
+      //start at the actual position
+      if(Drive_A.UpdateProcessData() == eMCDone)
+      {
+        StartPos = Drive_A.GetActualPosition();
+        PathTime = 0;
+        fillSetpoints();
+        driveStep = 3;
+      }
+      break;
+    case 3:
+      if((Drive_A.StartCSP(CSPCycleTime)) == eMCDone)
+      {
+        driveStep = 4;
+        Drive_A.ResetComState();
+        Drive_A.ResetCSPStatistics();
+        Serial.println("Main: CSP streaming");
+      }
+      break;
+    case 4:
+      Drive_A.RunCSP();
+      fillSetpoints();
+      
+      if((currentMillis - LastReportTime) > 2000)
+      {
+        LastReportTime = currentMillis;
+        reportStatistics();
+      }
+      break;
+  }
+  
+  NodeState = Drive_A.CheckComState();
+  if((NodeState == eMCError) || (NodeState == eMCTimeout))
+  {
+    Serial.println("Main: Reset Node State");
+    Drive_A.StopCSP();
+    driveStep = 0;
+  }
+}
@@ -26,7 +26,7 @@
 
 #define DEBUG_NODE (DEBUG_TO | DEBUG_ERROR) 
 
-typedef struct EMCYMsg {
+typedef struct __attribute__((packed)) EMCYMsg {
    uint8_t u8Prefix  : 8;
    uint8_t u8Len     : 8;
    uint8_t u8NodeNr  : 8;
@@ -56,14 +56,24 @@ const uint16_t MaxSWResponseDelay = 50;
 
 /*---------------------------------------------------------------------
  * MCNode::MCNode()
- * as of now there is noting to intialized when created
+ * only the optional callbacks need to be cleared when created
  * 
  * 2020-11-21 AW Done
+ * 2026-10-18 AW clear the SW change and EMCY callbacks
+ * 2026-10-18 AW deadlines
  * ------------------------------------------------------------------*/
 
 MCNode::MCNode()
 {
-	;
+	OnSWChangeCb.callback = NULL;
+	OnSWChangeCb.op = NULL;
+	OnEMCYCb.callback = NULL;
+	OnEMCYCb.op = NULL;
+	OnProcessDataCb.callback = NULL;
+	OnProcessDataCb.op = NULL;
+	DeadlineQueue::InitDeadline(&CWDeadline,MCNode::OnCWDeadlineCb,(void *)this);
+	DeadlineQueue::InitDeadline(&SWDeadline,MCNode::OnSWDeadlineCb,(void *)this);
+	DeadlineQueue::InitDeadline(&ProcessDataDeadline,MCNode::OnProcessDataDeadlineCb,(void *)this);
 }
 
 /*-------------------------------------------------------------------
@@ -117,14 +127,33 @@ void MCNode::Connect2MsgHandler(MsgHandler *ThisHandler)
  * If no HW-timer is used this method needs to called cyclically
  * with the latest millis() value to check for any time-outs.
  * Does the same update for the embedded SDOhandler.
+ * The time is taken from the MsgHandler now and the time-outs and
+ * the cyclic process data are run by its DeadlineQueue.
+ * Deprecated - does nothing and is kept for compatibility only.
  * 
  * 2020-11-21 AW Done
+ * 2026-10-18 AW cyclic process data
+ * 2026-10-18 AW moved to the DeadlineQueue
+ * 2026-10-18 AW deprecated
  * -----------------------------------------------------------------*/
 
 void MCNode::SetActTime(uint32_t time)
 {
-	actTime = time;
-	RWSDO.SetActTime(time);
+	(void)time;
+}
+
+/*-------------------------------------------------------------------
+ * uint32_t GetTime()
+ * the time of the last Update() of the MsgHandler
+ * 
+ * 2026-10-18 AW Rev_A
+ * -----------------------------------------------------------------*/
+
+uint32_t MCNode::GetTime()
+{
+	if(Handler == NULL)
+		return 0;
+	return Handler->GetTime();
 }
 
 /*-------------------------------------------------------------------
@@ -165,8 +194,10 @@ void MCNode::ResetSDOState()
  * Will reset all Com related states and will unlock an still locked
  * MsgHandler.
  * Does the reset of the embedded SDOHandler too.
+ * The CW time-out and the SW watchdog are cancelled.
  * 
  * 2020-11-21 AW Done
+ * 2026-10-18 AW deadlines
  * ------------------------------------------------------------------*/
 
 
@@ -176,6 +207,15 @@ void MCNode::ResetComState()
 	CWAccessState = eCWIdle;
 	SWAccessState = eCWIdle;
 	
+	if(Handler != NULL)
+	{
+		Handler->GetDeadlines()->Cancel(&CWDeadline);
+		Handler->GetDeadlines()->Cancel(&SWDeadline);
+	}
+	isCWResendDue = false;
+	isSWPullDue = false;
+	SWPullPeriod = 0;
+	
 	TORetryCounter = 0;
 	BusyRetryCounter = 0;
 	AccessStep = 0;
@@ -183,7 +223,7 @@ void MCNode::ResetComState()
 	
 	if(hasMsgHandlerLocked)
 	{
-		Handler->UnLockHandler();
+		Handler->UnLockHandler(LockGrant);
 		hasMsgHandlerLocked = false;
 	}
 
@@ -241,15 +281,19 @@ void MCNode::SetBusyRetryMax(uint8_t value)
  * will only unlock it the actual service failed.
  * Successful servie will unlock in OnRxHandler().
  * 
+ * The time-out of the response is armed at the DeadlineQueue of the
+ * MsgHandler - see OnCWTimeOut().
+ * 
  * 2020-11-21 AW Rev_A
  * 2021-04-22 AW removed reference to any timer service
+ * 2026-10-18 AW time-out by the DeadlineQueue
  * ----------------------------------------------------------------*/
 
 CWCommStates MCNode::SendCw(uint16_t Data, uint32_t maxSWDelay = MaxSWResponseDelay)
 {
 	bool doSend = (Data != ControlWord) || firstCWAccess;
 			
-	if((CWAccessState == eCWRetry) && ((CWSentAt + CwRespTimeOut) < actTime) )
+	if((CWAccessState == eCWRetry) && isCWResendDue)
 		doSend = true;
 	
 	//necessary to retrigger the access to the CW in a chain
@@ -287,11 +331,7 @@ CWCommStates MCNode::SendCw(uint16_t Data, uint32_t maxSWDelay = MaxSWResponseDe
 	switch(CWAccessState)
 	{
 		case eCWWaiting:
-			if((CWSentAt + CwRespTimeOut/2) < actTime)
-			{
-				CWAccessState = eCWRetry;
-				doSend = true;
-			}
+			//switched to eCWRetry by OnCWTimeOut() if there is no response
 			#if(DEBUG_NODE & DEBUG_TXCW)
 			Serial.print("W");
 			#endif
@@ -299,7 +339,8 @@ CWCommStates MCNode::SendCw(uint16_t Data, uint32_t maxSWDelay = MaxSWResponseDe
 			//no break here
 		case eCWRetry:		
 		case eCWIdle:
-			if(hasMsgHandlerLocked = Handler->LockHandler())
+			hasMsgHandlerLocked = Handler->LockHandler(&LockGrant);
+			if(hasMsgHandlerLocked)
 			{				 
 				if (doSend)
 				{
@@ -325,13 +366,14 @@ CWCommStates MCNode::SendCw(uint16_t Data, uint32_t maxSWDelay = MaxSWResponseDe
 						#endif
 
 						//generate a TO condition, when the response in not received in time
-						CWSentAt = actTime;
+						isCWResendDue = false;
+						Handler->GetDeadlines()->Arm(&CWDeadline, GetTime() + CwRespTimeOut/2 + 1);
 
 					}
 					else
 					{
 						
-						Handler->UnLockHandler();
+						Handler->UnLockHandler(LockGrant);
 						hasMsgHandlerLocked = false;
 						
 						BusyRetryCounter++;
@@ -346,6 +388,7 @@ CWCommStates MCNode::SendCw(uint16_t Data, uint32_t maxSWDelay = MaxSWResponseDe
 						else
 						{
 							CWAccessState = eCWRetry;
+							isCWResendDue = true;
 
 							#if(DEBUG_NODE & DEBUG_TXCW)
 							Serial.println("Node: CW Busy --> retry");
@@ -358,31 +401,28 @@ CWCommStates MCNode::SendCw(uint16_t Data, uint32_t maxSWDelay = MaxSWResponseDe
 		case eCWRxResponse:
 			//waiting is handled in eCWDone
 			CWAccessState = eCWDone;
-			Handler->UnLockHandler();
+			Handler->UnLockHandler(LockGrant);
 			hasMsgHandlerLocked = false;
 
 			//define tinme now as the start of the waiting time for SW
-			SWRxAt = actTime;
+			RestartSWWatch();
 			break;
 		case eCWDone:
 			//if we stay in this state pull the SW from time to time
 			//only if a non zero waiting time is set
-			if(maxSWDelay > 0)
+			//in push mode this is a slow watchdog only
+			if(IsSWPullDue(maxSWDelay))
 			{
-				if(SWRxAt < (actTime - maxSWDelay))
-				{
-					//we might be waiting for a response but the original access
-					//to the SW is finished
-					//trigger a pull on the SW
-					CWAccessState = eCWWait4SW;		
-				}
+				//we might be waiting for a response but the original access
+				//to the SW is finished
+				//trigger a pull on the SW
+				CWAccessState = eCWWait4SW;		
 			}
 			break;
 		case eCWWait4SW:
 			if(SDOAccessState == eDone)
 			{
-				StatusWord = (uint16_t)RWSDO.GetObjValue();
-				SWRxAt = actTime;
+				StoreSW((uint16_t)RWSDO.GetObjValue());
 				SDOAccessState = RWSDO.CheckComState();
 				CWAccessState = eCWDone;
 								
@@ -401,6 +441,8 @@ CWCommStates MCNode::SendCw(uint16_t Data, uint32_t maxSWDelay = MaxSWResponseDe
 				SDOAccessState = RWSDO.ReadSDO(0x6041, 0x00);
 			}
 			break;	
+		default:
+			break;
 	}  // end of switch
 	
 	//map the CWAccessState to the universal RxTxState
@@ -421,8 +463,11 @@ CWCommStates MCNode::SendCw(uint16_t Data, uint32_t maxSWDelay = MaxSWResponseDe
  * StatusWord and if as expected stop calling this method as soon
  * as it ended up in eCWDone.
  * Needs a call to ResetComState to switch back to eCWIdle.
+ * In push mode a StatusWord received asynchronously within the
+ * watchdog time is used directly and the SDO is a watchdog only.
  * 
  * 2020-07-17 AW
+ * 2026-10-18 AW push mode
  * ------------------------------------------------------------*/
  
 CWCommStates MCNode::PullSW(uint32_t maxSWDelay)
@@ -430,14 +475,23 @@ CWCommStates MCNode::PullSW(uint32_t maxSWDelay)
 	switch(SWAccessState)
 	{
 		case eCWIdle:
-			//define tinme now as the start of the waiting time for SW
-			SWRxAt = actTime;
-			SWAccessState = eCWWait4SW;
+			if(isSWPushMode && isSWValid && ((GetTime() - SWUpdatedAt) <= SWWatchdogTime))
+			{
+				//the pushed SW is recent enough - no need to ask for it
+				SWAccessState = eCWDone;
+			}
+			else
+			{
+				//define tinme now as the start of the waiting time for SW
+				RestartSWWatch();
+				SWAccessState = eCWWait4SW;
+			}
 			break;
 		case eCWDone:
 			//if we stay in this state pull the SW from time to time
 			//only if a non zero waiting time is set
-			if((SWRxAt < (actTime - maxSWDelay)) && (maxSWDelay > 0))
+			//in push mode this is a slow watchdog only
+			if(IsSWPullDue(maxSWDelay))
 			{
 				//we might be waiting for a response but the original access
 				//to the SW is finished
@@ -449,8 +503,7 @@ CWCommStates MCNode::PullSW(uint32_t maxSWDelay)
 			if(SDOAccessState == eDone)
 			{
 				//could have a debug option t only print changed responses
-				StatusWord = (uint16_t)RWSDO.GetObjValue();
-				SWRxAt = actTime;
+				StoreSW((uint16_t)RWSDO.GetObjValue());
 				SDOAccessState = RWSDO.CheckComState();
 				SWAccessState = eCWDone;
 								
@@ -469,6 +522,8 @@ CWCommStates MCNode::PullSW(uint32_t maxSWDelay)
 				SDOAccessState = RWSDO.ReadSDO(0x6041, 0x00);
 			}
 			break;	
+		default:
+			break;
 	}
 
 	//map the CWAccessState to the universal RxTxState
@@ -479,6 +534,122 @@ CWCommStates MCNode::PullSW(uint32_t maxSWDelay)
 	return RxTxState;
 }
 
+/*------------------------------------------------------------------
+ * void SetSWPushMode(bool enable, uint32_t watchdogTime)
+ * In push mode the StatusWord is expected to be sent by the drive
+ * asynchronously whenever it changes. SendCw() and PullSW() will then
+ * use the SDO access to 0x6041 as a slow watchdog only which is
+ * triggered when no StatusWord has been received for watchdogTime.
+ * Async StatusWord messages are not available in net mode. So in
+ * net mode push mode would only slow down any wait for the SW.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::SetSWPushMode(bool enable, uint32_t watchdogTime)
+{
+	isSWPushMode = enable;
+	SWWatchdogTime = watchdogTime;
+}
+
+/*------------------------------------------------------------------
+ * bool IsSWPushMode()
+ * Check whether the StatusWord is expected to be pushed by the drive.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+bool MCNode::IsSWPushMode()
+{
+	return isSWPushMode;
+}
+
+/*------------------------------------------------------------------
+ * void StoreSW(uint16_t value)
+ * Store a newly received StatusWord, either pushed by the drive or
+ * pulled via SDO. Updates the time stamp and will flag a change and
+ * call the registered change callback if the value is different from
+ * the one stored before. The SW watchdog starts over.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW SW watchdog at the DeadlineQueue
+ * ----------------------------------------------------------------*/
+
+void MCNode::StoreSW(uint16_t value)
+{
+	bool isNew = (value != StatusWord) || !isSWValid;
+
+	StatusWord = value;
+	SWUpdatedAt = GetTime();
+	RestartSWWatch();
+	isSWValid = true;
+
+	if(isNew)
+	{
+		isSWChanged = true;
+		SWChangeCount++;
+		
+		if(OnSWChangeCb.callback != NULL)
+			OnSWChangeCb.callback(OnSWChangeCb.op,(void *)&StatusWord);
+	}
+}
+
+/*------------------------------------------------------------------
+ * bool HasSWChanged()
+ * Check whether the StatusWord has changed since the last call.
+ * Reading the flag does reset it.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+bool MCNode::HasSWChanged()
+{
+	bool retValue = isSWChanged;
+	
+	isSWChanged = false;
+	return retValue;
+}
+
+/*------------------------------------------------------------------
+ * uint8_t GetSWChangeCount()
+ * Read the free running counter of StatusWord changes. Can be used
+ * to detect changes by several users without resetting a flag.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+uint8_t MCNode::GetSWChangeCount()
+{
+	return SWChangeCount;
+}
+
+/*------------------------------------------------------------------
+ * uint32_t GetSWTimeStamp()
+ * Read the time the StatusWord has been received last.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+uint32_t MCNode::GetSWTimeStamp()
+{
+	return SWUpdatedAt;
+}
+
+/*------------------------------------------------------------------
+ * void Register_OnSWChangeCb(pfunction_holder *Cb)
+ * store the function and object pointer for the callback
+ * called whenever a changed StatusWord is received. The callback
+ * gets a pointer to the StatusWord as its parameter.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::Register_OnSWChangeCb(pfunction_holder *Cb)
+{
+	OnSWChangeCb.callback = Cb->callback;
+	OnSWChangeCb.op = Cb->op;
+}
+
 /*------------------------------------------------------------------
  * CWCommStates SendReset()
  * Send a ResetNode message to the drive.
@@ -495,7 +666,8 @@ CWCommStates MCNode::SendReset()
 		case eCWIdle:
 		case eCWRetry:
 			//must not send if Msghandler not available
-			if(hasMsgHandlerLocked = Handler->LockHandler())
+			hasMsgHandlerLocked = Handler->LockHandler(&LockGrant);
+			if(hasMsgHandlerLocked)
 			{				 
 				ResetReqBuffer.u8Len = 6;
 				ResetReqBuffer.u8NodeNr = (uint8_t)NodeId;
@@ -505,7 +677,7 @@ CWCommStates MCNode::SendReset()
 				{
 					CWAccessState = eCWDone;
 					//directly unlock the Msghandler - no response expected
-					Handler->UnLockHandler();
+					Handler->UnLockHandler(LockGrant);
 					isLive = false;
 
 					BusyRetryCounter = 0;
@@ -517,7 +689,7 @@ CWCommStates MCNode::SendReset()
 				}
 				else
 				{					
-					Handler->UnLockHandler();
+					Handler->UnLockHandler(LockGrant);
 					BusyRetryCounter++;
 					if(BusyRetryCounter > BusyRetryMax)
 					{
@@ -539,10 +711,50 @@ CWCommStates MCNode::SendReset()
 				}
 			}
 		break;
+		default:
+			break;
 	}
 	return CWAccessState;
 }
 
+/*------------------------------------------------------------------
+ * bool SendCwImmediate(uint16_t Data)
+ * Send a ControlWord right away without waiting for the lock of the
+ * MsgHandler and without any retry. This is intended for the reaction
+ * on an EMCY where a quick stop has to be sent within one frame time.
+ * The response of the drive is consumed silently by the OnRxHandler.
+ * Any pending CW access is not affected but will see the changed
+ * ControlWord.
+ * Returns false if the Msg could neither be sent nor be buffered.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+bool MCNode::SendCwImmediate(uint16_t Data)
+{
+	CwSwMsg ImmediateMsg;
+
+	ImmediateMsg.u8Len = 6;
+	ImmediateMsg.u8NodeNr = (uint8_t)NodeId;
+	ImmediateMsg.u8Cmd = eCtrlWord;
+	ImmediateMsg.Payload = Data;
+
+	//MsgHandler and Uart do copy the Msg so a local one will do
+	if(Handler->SendMsg(Channel,(MCMsg *)&ImmediateMsg))
+	{
+		ControlWord = Data;
+		isImmediateCwPending = true;
+
+		#if(DEBUG_NODE & DEBUG_TXCW)
+		Serial.print("Node: immediate CW ");
+		Serial.println(Data, HEX);
+		#endif
+		
+		return true;
+	}
+	return false;
+}
+
 /*------------------------------------------------------------------
  * bool IsLive()
  * Check whether a boot Msg of the drive has been received
@@ -556,6 +768,56 @@ bool MCNode::IsLive()
 {
 	return isLive;
 }
+
+/*------------------------------------------------------------------
+ * bool HasRebooted()
+ * Check whether a boot Msg has been received since the flag has been 
+ * cleared last. Is not reset by reading it - use ClearRebootFlag().
+ * Any boot Msg will reset the ComState of the node.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+bool MCNode::HasRebooted()
+{
+	return hasRebooted;
+}
+
+/*------------------------------------------------------------------
+ * void ClearRebootFlag()
+ * Acknowledge a reboot of the drive.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::ClearRebootFlag()
+{
+	hasRebooted = false;
+}
+
+/*------------------------------------------------------------------
+ * uint8_t GetBootCount()
+ * Number of boot Msgs received from the drive.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+uint8_t MCNode::GetBootCount()
+{
+	return BootCount;
+}
+
+/*------------------------------------------------------------------
+ * uint32_t GetLastRxTime()
+ * Time of the last valid Msg of any kind received from the drive.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+uint32_t MCNode::GetLastRxTime()
+{
+	return Handler->GetLastRxTime(Channel);
+}
 		
 /*------------------------------------------------------------------
  * uint16_t GetLastError()
@@ -570,37 +832,409 @@ uint16_t MCNode::GetLastError()
 }
 
 /*------------------------------------------------------------------
- * SDOCommStates ReadSDO(unsigned int Idx, unsigned char SubIdx)
+ * uint8_t GetEMCYCount()
+ * Number of EMCY records available in the history.
+ * Is limited to EMCYHistorySize.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+uint8_t MCNode::GetEMCYCount()
+{
+	return EMCYCount;
+}
+
+/*------------------------------------------------------------------
+ * bool GetEMCYRecord(uint8_t age, EMCYRecord *Record)
+ * Copy an entry of the EMCY history. age 0 is the latest one.
+ * Returns false if there is no entry of the requested age.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+bool MCNode::GetEMCYRecord(uint8_t age, EMCYRecord *Record)
+{
+	if(age >= EMCYCount)
+		return false;
+	
+	//EMCYHead is the slot the next record will be written to
+	uint8_t slot = (EMCYHead + EMCYHistorySize - 1 - age) % EMCYHistorySize;
+	*Record = EMCYHistory[slot];
+	
+	return true;
+}
+
+/*------------------------------------------------------------------
+ * void ClearEMCYHistory()
+ * Drop all the entries of the EMCY history. The last error code
+ * is kept.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::ClearEMCYHistory()
+{
+	EMCYHead = 0;
+	EMCYCount = 0;
+}
+
+/*------------------------------------------------------------------
+ * void Register_OnEMCYCb(pfunction_holder *Cb)
+ * store the function and object pointer for the EMCY fast path.
+ * The callback is called directly from the OnRxHandler as soon as the
+ * EMCY has been received and before the MsgHandler does send any
+ * pending messages. It gets a pointer to the new EMCYRecord.
+ * Must be kept short. 
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::Register_OnEMCYCb(pfunction_holder *Cb)
+{
+	OnEMCYCb.callback = Cb->callback;
+	OnEMCYCb.op = Cb->op;
+}
+
+/*------------------------------------------------------------------
+ * bool MapProcessData(uint16_t Idx, uint8_t SubIdx)
+ * add an object to the process data of this node
+ * returns false if there is no space left
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW start the cycle
+ * ----------------------------------------------------------------*/
+
+bool MCNode::MapProcessData(uint16_t Idx, uint8_t SubIdx)
+{
+	if(ProcessDataCount >= MCNodeMaxProcessData)
+		return false;
+		
+	ProcessMap[ProcessDataCount].Idx = Idx;
+	ProcessMap[ProcessDataCount].SubIdx = SubIdx;
+	ProcessMap[ProcessDataCount].Value = 0;
+	ProcessImage[ProcessDataCount] = 0;
+	ProcessDataCount++;
+	isProcessDataValid = false;
+	
+	//the cycle may have been set before
+	if((ProcessDataCycle > 0) && (Handler != NULL) && !ProcessDataDeadline.isArmed)
+		Handler->GetDeadlines()->Arm(&ProcessDataDeadline, GetTime());
+	
+	return true;
+}
+
+/*------------------------------------------------------------------
+ * void ClearProcessData()
+ * remove all objects from the process data
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW stop the cycle, keep the batch of other lists
+ * ----------------------------------------------------------------*/
+
+void MCNode::ClearProcessData()
+{
+	CancelBatch(ProcessMap);
+	if(Handler != NULL)
+		Handler->GetDeadlines()->Cancel(&ProcessDataDeadline);
+	ProcessDataCount = 0;
+	isProcessDataValid = false;
+}
+
+/*------------------------------------------------------------------
+ * void SetProcessDataCycle(uint32_t period)
+ * request the process data every period ms by a deadline at the
+ * DeadlineQueue of the MsgHandler - the first one right away.
+ * 0 will disable the cyclic request - UpdateProcessData() has to be
+ * called then.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW run by the DeadlineQueue
+ * ----------------------------------------------------------------*/
+
+void MCNode::SetProcessDataCycle(uint32_t period)
+{
+	ProcessDataCycle = period;
+	
+	if(Handler == NULL)
+		return;
+		
+	if((period > 0) && (ProcessDataCount > 0))
+		Handler->GetDeadlines()->Arm(&ProcessDataDeadline, GetTime());
+	else
+		Handler->GetDeadlines()->Cancel(&ProcessDataDeadline);
+}
+
+/*------------------------------------------------------------------
+ * void OnProcessDataDue()
+ * called by the DeadlineQueue - start a new cycle of the process data
+ * or go on with the one running. While the batch is running or the one
+ * of another list has to be waited for, it's called again 1ms later.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::OnProcessDataDue()
+{
+	if((ProcessDataCycle == 0) || (ProcessDataCount == 0))
+		return;
+		
+	uint32_t actTime = GetTime();
+	
+	if(BatchOwner != ProcessMap)
+		ProcessDataReqAt = actTime;
+	
+	uint32_t Due = ProcessDataReqAt + ProcessDataCycle;
+	
+	//never due right away - the queue would call it again in the same run
+	if((UpdateProcessData() == eWaiting) || IsTimeReached(actTime, Due))
+		Due = actTime + 1;
+		
+	Handler->GetDeadlines()->Arm(&ProcessDataDeadline, Due);
+}
+
+/*------------------------------------------------------------------
+ * void Register_OnProcessDataCb(pfunction_holder *Cb)
+ * Register a callback which is called whenever a new process image
+ * has been received - gets a pointer to the MCNode.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::Register_OnProcessDataCb(pfunction_holder *Cb)
+{
+	OnProcessDataCb.callback = Cb->callback;
+	OnProcessDataCb.op = Cb->op;
+}
+
+/*------------------------------------------------------------------
+ * SDOCommStates UpdateProcessData()
+ * Request all the mapped objects at once by a batch of SDO reads.
+ * The MC V3.0 UART protocol has no PDO service of its own so the
+ * batch is the closest: the requests are sent back-to-back and the
+ * responses are collected within about a single round-trip.
+ * Is to be called until eDone. The process image is updated as a
+ * whole with eDone and no reset is required afterwards.
+ * eError or eTimeout will be reported once and the next call will
+ * start over again.
+ * A new process image is handed over to the OnProcessDataCb.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW OnProcessDataCb
+ * ----------------------------------------------------------------*/
+
+SDOCommStates MCNode::UpdateProcessData()
+{
+	if(ProcessDataCount == 0)
+		return eError;
+		
+	SDOCommStates BatchState = ReadBatch(ProcessMap, ProcessDataCount);
+	
+	switch(BatchState)
+	{
+		case eDone:
+			for(uint8_t i = 0; i < ProcessDataCount; i++)
+				ProcessImage[i] = ProcessMap[i].Value;
+			ProcessDataAt = GetTime();
+			isProcessDataValid = true;
+			
+			if(OnProcessDataCb.callback != NULL)
+				OnProcessDataCb.callback(OnProcessDataCb.op,(void *)this);
+			break;
+		case eError:
+		case eTimeout:
+			ProcessDataErrors++;
+			
+			#if(DEBUG_NODE & DEBUG_ERROR)
+			Serial.print("Node: Process data failed ");
+			Serial.println(BatchState, DEC);
+			#endif
+			break;
+		default:
+			break;
+	}
+	return BatchState;
+}
+
+/*------------------------------------------------------------------
+ * bool GetProcessData(uint16_t Idx, uint8_t SubIdx, uint32_t *Value)
+ * read an object from the process image
+ * returns false if the object is not mapped or the image is not valid
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+bool MCNode::GetProcessData(uint16_t Idx, uint8_t SubIdx, uint32_t *Value)
+{
+	if(!isProcessDataValid)
+		return false;
+		
+	for(uint8_t i = 0; i < ProcessDataCount; i++)
+	{
+		if((ProcessMap[i].Idx == Idx) && (ProcessMap[i].SubIdx == SubIdx))
+		{
+			*Value = ProcessImage[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+/*------------------------------------------------------------------
+ * uint32_t GetProcessDataTimeStamp()
+ * time the process image has been updated last
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+uint32_t MCNode::GetProcessDataTimeStamp()
+{
+	return ProcessDataAt;
+}
+
+/*------------------------------------------------------------------
+ * bool IsProcessDataValid()
+ * true as soon as the process image has been updated once
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+bool MCNode::IsProcessDataValid()
+{
+	return isProcessDataValid;
+}
+
+/*------------------------------------------------------------------
+ * uint16_t GetProcessDataErrors()
+ * number of failed updates of the process data
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+uint16_t MCNode::GetProcessDataErrors()
+{
+	return ProcessDataErrors;
+}
+
+/*------------------------------------------------------------------
+ * SDOCommStates ReadBatch(SDOBatchEntry *List, uint8_t count)
+ * Read a list of objects by a single batch of the built-in SDOHandler.
+ * The values are stored into the List.
+ * There is only one batch at a time: while the batch of another 
+ * list is running eWaiting is reported and the List is queued 
+ * implicitly by calling again.
+ * The batch is reset with eDone, eError or eTimeout already, so
+ * there is no need to reset it afterwards. A caller giving up a
+ * batch has to CancelBatch() it - otherwise it's taken over by the
+ * next list once it hasn't been polled for MCNODE_BATCH_OWNER_TIMEOUT.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW owner time-out
+ * ----------------------------------------------------------------*/
+
+SDOCommStates MCNode::ReadBatch(SDOBatchEntry *List, uint8_t count)
+{
+	return RunBatch(List, count, false);
+}
+
+/*------------------------------------------------------------------
+ * SDOCommStates AccessBatch(SDOBatchEntry *List, uint8_t count)
+ * Read and write a list of objects by a single batch - see
+ * SDOHandler::AccessBatch(). Shares the batch with ReadBatch().
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+SDOCommStates MCNode::AccessBatch(SDOBatchEntry *List, uint8_t count)
+{
+	return RunBatch(List, count, true);
+}
+
+/*------------------------------------------------------------------
+ * void CancelBatch(const SDOBatchEntry *List)
+ * give up the batch of the List if it's still running - its late
+ * responses are dropped by the SDOHandler. The batch of any other
+ * list isn't touched.
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::CancelBatch(const SDOBatchEntry *List)
+{
+	if((BatchOwner != NULL) && (BatchOwner == List))
+	{
+		RWSDO.ResetBatchState();
+		BatchOwner = NULL;
+	}
+}
+
+/*------------------------------------------------------------------
+ * SDOCommStates RunBatch(SDOBatchEntry *List, uint8_t count, bool isAccess)
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW take over a batch its owner doesn't poll any longer
+ * ----------------------------------------------------------------*/
+
+SDOCommStates MCNode::RunBatch(SDOBatchEntry *List, uint8_t count, bool isAccess)
+{
+	if((BatchOwner != NULL) && (BatchOwner != List))
+	{
+		if((GetTime() - BatchPolledAt) < MCNODE_BATCH_OWNER_TIMEOUT)
+			return eWaiting;
+		
+		#if(DEBUG_NODE & DEBUG_ERROR)
+		Serial.println("Node: batch owner timeout");
+		#endif
+		CancelBatch(BatchOwner);
+	}
+	
+	BatchOwner = List;
+	BatchPolledAt = GetTime();
+	
+	SDOCommStates BatchState = isAccess ? RWSDO.AccessBatch(List, count) : RWSDO.ReadBatch(List, count);
+	
+	if((BatchState == eDone) || (BatchState == eError) || (BatchState == eTimeout))
+	{
+		RWSDO.ResetBatchState();
+		BatchOwner = NULL;
+	}
+	return BatchState;
+}
+
+/*------------------------------------------------------------------
+ * SDOCommStates ReadSDO(uint16_t Idx, uint8_t SubIdx)
  * Provide access to the SDO serive of the built-in SDOHandler.
  * 
  * 2020-11-21 AW Done
+ * 2026-10-18 AW fixed size types as the SDOHandler
  * ----------------------------------------------------------------*/
 
-SDOCommStates MCNode::ReadSDO(unsigned int Idx, unsigned char SubIdx)
+SDOCommStates MCNode::ReadSDO(uint16_t Idx, uint8_t SubIdx)
 {
 	return RWSDO.ReadSDO(Idx,SubIdx);
 }
 
 /*------------------------------------------------------------------
- * DOCommStates WriteSDO(unsigned int Idx, unsigned char SubIdx,unsigned long * pData,unsigned char len)
+ * DOCommStates WriteSDO(uint16_t Idx, uint8_t SubIdx,uint32_t * pData,uint8_t len)
  * Provide access to the SDO serive of the built-in SDOHandler.
  * 
  * 2020-11-21 AW Done
+ * 2026-10-18 AW fixed size types - unsigned long is 64 bit on a host
  * ----------------------------------------------------------------*/
 
-SDOCommStates MCNode::WriteSDO(unsigned int Idx, unsigned char SubIdx,unsigned long * pData,unsigned char len)
+SDOCommStates MCNode::WriteSDO(uint16_t Idx, uint8_t SubIdx,uint32_t * pData,uint8_t len)
 {
 	return RWSDO.WriteSDO(Idx,SubIdx,pData,len);
 }
 
 /*------------------------------------------------------------------
- * unsigned long GetObjValue()
+ * uint32_t GetObjValue()
  * Provide access to the SDO serive of the built-in SDOHandler.
  * 
  * 2020-11-21 AW Done
+ * 2026-10-18 AW fixed size types
  * ----------------------------------------------------------------*/
 
-unsigned long MCNode::GetObjValue()
+uint32_t MCNode::GetObjValue()
 {
 	return RWSDO.GetObjValue();
 }
@@ -632,17 +1266,30 @@ void MCNode::OnRxHandler(MCMsg *Msg)
 			#endif
 			
 			isLive = true;
+			hasRebooted = true;
+			BootCount++;
 			
 			RWSDO.ResetComState();
 			ResetComState();
 				
 			break;
 		case eCtrlWord:
+			//could be the response to an immediate CW which is not
+			//tracked by the CWAccessState
+			if(isImmediateCwPending)
+			{
+				isImmediateCwPending = false;
+				if((CWAccessState != eCWWaiting) && (CWAccessState != eCWRetry))
+					break;
+			}
 			//mus be the response - check for ok
 			//there mnight be a transient moment where an response is recevied while being 
 			//in eCWRetry
 			if((CWAccessState == eCWWaiting) || (CWAccessState == eCWRetry))
 			{
+				Handler->GetDeadlines()->Cancel(&CWDeadline);
+				isCWResendDue = false;
+				
 				if(((CwMsgResponse *)Msg)->Error == 0)
 				{
 					#if(DEBUG_NODE & DEBUG_TXCW)
@@ -673,8 +1320,7 @@ void MCNode::OnRxHandler(MCMsg *Msg)
 		case eStatusWord:
 			//does contain valuable data
 			//can be received at anytime
-			StatusWord = ((CwSwMsg *)Msg)->Payload;
-			SWRxAt = actTime;
+			StoreSW(((CwSwMsg *)Msg)->Payload);
 			
 			#if(DEBUG_NODE & DEBUG_RXSW)
 			Serial.print("Node: Rx SW ");
@@ -684,7 +1330,25 @@ void MCNode::OnRxHandler(MCMsg *Msg)
 		case eEmergencyMsg:
 			//does contain valuable data
 			//can be received at anytime
-			EMCYCode = ((EMCYMsg *)Msg)->ErrorCode;
+			//is stored in the history and handed over to the fast path
+			{
+				EMCYMsg *EMCY = (EMCYMsg *)Msg;
+				EMCYRecord *Record = &(EMCYHistory[EMCYHead]);
+				
+				EMCYCode = EMCY->ErrorCode;
+				
+				Record->ErrorCode = EMCY->ErrorCode;
+				Record->ErrorRegister = EMCY->ErrorRegister;
+				Record->FaulhaberErrorReg = EMCY->FaulhaberErrorReg;
+				Record->RxAt = GetTime();
+				
+				EMCYHead = (EMCYHead + 1) % EMCYHistorySize;
+				if(EMCYCount < EMCYHistorySize)
+					EMCYCount++;
+				
+				if(OnEMCYCb.callback != NULL)
+					OnEMCYCb.callback(OnEMCYCb.op,(void *)Record);
+			}
 			
 			#if(DEBUG_NODE & DEBUG_RXEMCY)
 			Serial.print("Node: Rx EMCY ");
@@ -722,58 +1386,100 @@ void MCNode::CheckSDOStatus()
 }
 
 /*------------------------------------------------------------------
- * SDOCommStates CheckSDOState()
- * Read-acces to the ComState of the built-in SDOHandler
+ * bool IsSWPullDue(uint32_t maxSWDelay)
+ * Check whether the StatusWord has to be pulled again.
+ * A maxSWDelay of 0 will never pull. In push mode the pull is a
+ * watchdog only and will not be done more often than SWWatchdogTime.
+ * The watchdog is armed at the DeadlineQueue from the last SW received
+ * on and flags the pull by OnSWPullDue() - nothing is compared here.
  * 
- * 2020-11-21 AW Done
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW SW watchdog at the DeadlineQueue
  * ----------------------------------------------------------------*/
 
-SDOCommStates MCNode::CheckSDOState()
+bool MCNode::IsSWPullDue(uint32_t maxSWDelay)
 {
-	//check the SDOState
-	return RWSDO.CheckComState();
+	uint32_t period = maxSWDelay;
+	
+	if(maxSWDelay == 0)
+		return false;
+	
+	if(isSWPushMode && (period < SWWatchdogTime))
+		period = SWWatchdogTime;
+	
+	if(period != SWPullPeriod)
+	{
+		SWPullPeriod = period;
+		Handler->GetDeadlines()->Arm(&SWDeadline, SWRxAt + period + 1);
+	}
+	
+	if(!isSWPullDue)
+		return false;
+		
+	isSWPullDue = false;
+	return true;
 }
 
 /*------------------------------------------------------------------
- * void OnTimeOut()
- * Would be called by a HW-timer
- * Not really tested as the HW timer wasn't stable
+ * void RestartSWWatch()
+ * a StatusWord has been received or is waited for from now on - 
+ * the next pull is due SWPullPeriod later
  * 
- * 2020-11-21 AW Done
+ * 2026-10-18 AW Rev_A
  * ----------------------------------------------------------------*/
 
-void MCNode::OnTimeOut()
+void MCNode::RestartSWWatch()
 {
-	#if(DEBUG_NODE & DEBUG_TO)
-	Serial.print("Node: Timeout ");
-	#endif
-	
-	if(hasMsgHandlerLocked)
-	{
-		Handler->UnLockHandler();
-		hasMsgHandlerLocked = false;
-	}
+	SWRxAt = GetTime();
+	isSWPullDue = false;
 	
-	if(CWAccessState > eCWIdle)
+	if((SWPullPeriod > 0) && (Handler != NULL))
+		Handler->GetDeadlines()->Arm(&SWDeadline, SWRxAt + SWPullPeriod + 1);
+}
+
+/*------------------------------------------------------------------
+ * void OnSWPullDue()
+ * called by the DeadlineQueue - no StatusWord for SWPullPeriod
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::OnSWPullDue()
+{
+	isSWPullDue = true;
+}
+
+/*------------------------------------------------------------------
+ * void OnCWTimeOut()
+ * called by the DeadlineQueue if the response to a CW hasn't been
+ * received within CwRespTimeOut/2 - the CW is sent again by the
+ * next SendCw()
+ * 
+ * 2026-10-18 AW Rev_A
+ * ----------------------------------------------------------------*/
+
+void MCNode::OnCWTimeOut()
+{
+	if(CWAccessState == eCWWaiting)
 	{
-		if(TORetryCounter < TORetryMax)
-		{
-			CWAccessState = eCWRetry;
+		CWAccessState = eCWRetry;
+		isCWResendDue = true;
 		
-			TORetryCounter++;
+		#if(DEBUG_NODE & DEBUG_TO)
+		Serial.println("Node: CW timeout --> retry");
+		#endif
+	}
+}
 
-			#if(DEBUG_NODE & DEBUG_TO)
-			Serial.println("retry");
-			#endif
-		}
-		else
-		{	
-			CWAccessState = eCWTimeout;
-			TORetryCounter = 0;
+/*------------------------------------------------------------------
+ * SDOCommStates CheckSDOState()
+ * Read-acces to the ComState of the built-in SDOHandler
+ * 
+ * 2020-11-21 AW Done
+ * ----------------------------------------------------------------*/
 
-			#if(DEBUG_NODE & DEBUG_TO)
-			Serial.println("final");
-			#endif
-		}
-	}
+SDOCommStates MCNode::CheckSDOState()
+{
+	//check the SDOState
+	return RWSDO.CheckComState();
 }
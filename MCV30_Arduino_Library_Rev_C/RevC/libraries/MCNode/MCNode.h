@@ -24,6 +24,21 @@
 #define MCNodeTxMsg UART_Msg
 
 const uint8_t MaxDeviceNameLen = 32;
+const uint16_t SWWatchdogDefault = 500;
+const uint8_t EMCYHistorySize = 4;
+const uint8_t MCNodeMaxProcessData = SDOMaxBatch;
+
+//a batch not polled by its owner for this long can be taken over
+#ifndef MCNODE_BATCH_OWNER_TIMEOUT
+#define MCNODE_BATCH_OWNER_TIMEOUT 100		//can be raised by a build flag
+#endif
+
+//bits of the CiA 301 error register as reported in the EMCY
+const uint8_t EMCYErrReg_Generic = 0x01;
+const uint8_t EMCYErrReg_Current = 0x02;
+const uint8_t EMCYErrReg_Voltage = 0x04;
+const uint8_t EMCYErrReg_Temperature = 0x08;
+const uint8_t EMCYErrReg_Communication = 0x10;
 
 typedef struct __attribute__((packed)) CwSwMsg {
    uint8_t u8Prefix  : 8;
@@ -46,6 +61,15 @@ typedef struct __attribute__((packed)) ResetReqMsg {
 
 //no need for CW and SW - these are plain 16 bit payload
 
+//a single entry in the EMCY history of a node
+
+typedef struct EMCYRecord {
+   uint16_t ErrorCode;
+   uint8_t ErrorRegister;
+   uint16_t FaulhaberErrorReg;
+   uint32_t RxAt;
+} EMCYRecord;
+
 typedef enum CWCommStates {
 	eCWIdle,
 	eCWWaiting,
@@ -65,7 +89,8 @@ class MCNode {
 		MCNode();
 		void Connect2MsgHandler(MsgHandler *);
 		void SetNodeId(uint8_t);
-		void SetActTime(uint32_t);
+		void SetActTime(uint32_t);		//deprecated - the time is the one of the MsgHandler
+		uint32_t GetTime();
 		
 		CWCommStates CheckComState();
 		void ResetComState(); 
@@ -76,16 +101,46 @@ class MCNode {
 		CWCommStates SendCw(uint16_t,uint32_t);
 		CWCommStates PullSW(uint32_t);
 
+		void SetSWPushMode(bool,uint32_t);
+		bool IsSWPushMode();
+		void StoreSW(uint16_t);
+		bool HasSWChanged();
+		uint8_t GetSWChangeCount();
+		uint32_t GetSWTimeStamp();
+		void Register_OnSWChangeCb(pfunction_holder *);
+
 		CWCommStates SendReset();
+		bool SendCwImmediate(uint16_t);
 						
-		SDOCommStates ReadSDO(unsigned int, unsigned char);
-		SDOCommStates WriteSDO(unsigned int, unsigned char,unsigned long *,unsigned char);
+		SDOCommStates ReadSDO(uint16_t, uint8_t);
+		SDOCommStates WriteSDO(uint16_t, uint8_t,uint32_t *,uint8_t);
 		SDOCommStates CheckSDOState();
 
-		unsigned long GetObjValue();
+		uint32_t GetObjValue();
 
 		bool IsLive();
+		bool HasRebooted();
+		void ClearRebootFlag();
+		uint8_t GetBootCount();
+		uint32_t GetLastRxTime();
 		uint16_t GetLastError();
+		uint8_t GetEMCYCount();
+		bool GetEMCYRecord(uint8_t, EMCYRecord *);
+		void ClearEMCYHistory();
+		void Register_OnEMCYCb(pfunction_holder *);
+		
+		bool MapProcessData(uint16_t, uint8_t);
+		void ClearProcessData();
+		void SetProcessDataCycle(uint32_t);
+		SDOCommStates UpdateProcessData();
+		bool GetProcessData(uint16_t, uint8_t, uint32_t *);
+		uint32_t GetProcessDataTimeStamp();
+		bool IsProcessDataValid();
+		void Register_OnProcessDataCb(pfunction_holder *);
+		uint16_t GetProcessDataErrors();
+		SDOCommStates ReadBatch(SDOBatchEntry *, uint8_t);
+		SDOCommStates AccessBatch(SDOBatchEntry *, uint8_t);
+		void CancelBatch(const SDOBatchEntry *);
 
 		uint16_t StatusWord;
 		uint16_t ControlWord;
@@ -94,16 +149,29 @@ class MCNode {
 			((MCNode *)op)->OnRxHandler((MCMsg *)p);
 		};
 		
-		//hander to be registered at the OsTimer
-		static void OnTimeOutCb(void *p) {
-			((MCNode *)p)->OnTimeOut();
+		//handlers to be armed at the DeadlineQueue of the MsgHandler
+		static void *OnCWDeadlineCb(void *op, void *p) {
+			((MCNode *)op)->OnCWTimeOut();
+			return NULL;
+		};
+		static void *OnSWDeadlineCb(void *op, void *p) {
+			((MCNode *)op)->OnSWPullDue();
+			return NULL;
+		};
+		static void *OnProcessDataDeadlineCb(void *op, void *p) {
+			((MCNode *)op)->OnProcessDataDue();
+			return NULL;
 		};
 
 	
 	private:
 		void OnRxHandler(MCMsg *);
-		void OnTimeOut();
+		void OnCWTimeOut();
+		void OnSWPullDue();
+		void OnProcessDataDue();
 		void CheckSDOStatus();
+		bool IsSWPullDue(uint32_t);
+		void RestartSWWatch();
 
 		CwSwMsg CwMsgBuffer;
 		ResetReqMsg ResetReqBuffer;
@@ -120,29 +188,61 @@ class MCNode {
 		int16_t NodeId = invalidNodeId;
 
 		uint16_t EMCYCode;
+		EMCYRecord EMCYHistory[EMCYHistorySize];
+		uint8_t EMCYHead = 0;
+		uint8_t EMCYCount = 0;
+		pfunction_holder OnEMCYCb;
+		bool isImmediateCwPending = false;
 		uint8_t DeviceName[MaxDeviceNameLen];
 		uint8_t firstCWAccess = 1;
 		
 		bool hasMsgHandlerLocked = false;
+		uint16_t LockGrant = 0;
 		
 		SDOHandler RWSDO;
 
-		MsgHandler *Handler;
+		MsgHandler *Handler = NULL;
 		MCNodeTxMsg TxMsg;
 
-		bool isTimerActive = false;
-		uint32_t actTime;
-
 		uint8_t TORetryCounter = 0;
 		uint8_t TORetryMax = 1;
 
 		uint8_t BusyRetryCounter = 0;
 		uint8_t BusyRetryMax = 1;
 
-		uint32_t CWSentAt;
-		uint32_t SWRxAt;
+		MCDeadline CWDeadline;
+		bool isCWResendDue = false;
+		MCDeadline SWDeadline;
+		bool isSWPullDue = false;
+		uint32_t SWPullPeriod = 0;
+		uint32_t SWRxAt = 0;
+
+		bool isSWPushMode = false;
+		bool isSWValid = false;
+		bool isSWChanged = false;
+		uint8_t SWChangeCount = 0;
+		uint32_t SWUpdatedAt = 0;
+		uint32_t SWWatchdogTime = SWWatchdogDefault;
+		pfunction_holder OnSWChangeCb;
 
 		bool isLive = false;
+		bool hasRebooted = false;
+		uint8_t BootCount = 0;
+		
+		SDOBatchEntry ProcessMap[MCNodeMaxProcessData];
+		uint32_t ProcessImage[MCNodeMaxProcessData];
+		uint8_t ProcessDataCount = 0;
+		uint32_t ProcessDataCycle = 0;
+		uint32_t ProcessDataReqAt = 0;
+		uint32_t ProcessDataAt = 0;
+		MCDeadline ProcessDataDeadline;
+		pfunction_holder OnProcessDataCb;
+		bool isProcessDataValid = false;
+		uint16_t ProcessDataErrors = 0;
+		const SDOBatchEntry *BatchOwner = NULL;
+		uint32_t BatchPolledAt = 0;
+		
+		SDOCommStates RunBatch(SDOBatchEntry *, uint8_t, bool);
 };
  
 
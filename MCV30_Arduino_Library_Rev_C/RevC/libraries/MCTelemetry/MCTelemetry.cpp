@@ -0,0 +1,750 @@
+/*---------------------------------------------------
+ * MCTelemetry.cpp
+ * implements the batched publishing of the actual
+ * values of the drives
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <MCTelemetry.h>
+#include <string.h>
+
+//--- local defines ---
+
+#define DEBUG_PUBLISH	0x0001
+#define DEBUG_BUDGET	0x0002
+
+#define DEBUG_TELEMETRY 0
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * MCTelemetry()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+MCTelemetry::MCTelemetry()
+{
+	Tokens = 1000UL * Burst;
+	OnPublishCb.callback = NULL;
+	OnPublishCb.op = NULL;
+	Series.Field = TelemetryNoField;
+	Series.Count = 0;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t AddField(const char *Name, uint32_t Deadband, uint32_t MaxAge)
+ * add a field to be published as "Name":value
+ * Name is not copied and has to be kept by the caller.
+ * Deadband: the value is published if it has moved by more than this
+ * MaxAge: ms after which the value is published even if unchanged -
+ * 0 to publish changes only
+ * returns the slot of the field or TelemetryNoField
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCTelemetry::AddField(const char *Name, uint32_t Deadband, uint32_t MaxAge)
+{
+	if((FieldCount >= TELEMETRY_MAX_FIELDS) || (Name == NULL))
+		return TelemetryNoField;
+
+	TelemetryField *ThisField = &Field[FieldCount];
+
+	ThisField->Name = Name;
+	ThisField->Value = 0;
+	ThisField->Sent = 0;
+	ThisField->Deadband = Deadband;
+	ThisField->MaxAge = MaxAge;
+	ThisField->SentAt = 0;
+	ThisField->isValid = false;
+	ThisField->isPublished = false;
+	ThisField->isForced = false;
+	ThisField->isInMsg = false;
+
+	return FieldCount++;
+}
+
+/*---------------------------------------------------------------------
+ * void SetValue(uint8_t slot, int32_t value)
+ * take over a new value of a field - is cheap and can be called
+ * whenever a value has been read
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCTelemetry::SetValue(uint8_t slot, int32_t value)
+{
+	if(slot >= FieldCount)
+		return;
+
+	TelemetryField *ThisField = &Field[slot];
+
+	ThisField->Value = value;
+	ThisField->isValid = true;
+
+	//count the changes which are swallowed by the deadband
+	if(ThisField->isPublished && (value != ThisField->Sent) && !IsDue(slot))
+		Suppressed++;
+}
+
+/*---------------------------------------------------------------------
+ * void ForceAll()
+ * publish all the valid fields with the next message
+ * regardless of their deadband
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCTelemetry::ForceAll()
+{
+	for(uint8_t i = 0; i < FieldCount; i++)
+		Field[i].isForced = true;
+}
+
+/*---------------------------------------------------------------------
+ * void SetEncoding(TelemetryEncodings encoding)
+ * eTelemetryText: {"pos":1234,..} as a terminated string
+ * eTelemetryCbor: the same as a binary CBOR map incl. the samples
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCTelemetry::SetEncoding(TelemetryEncodings encoding)
+{
+	Encoding = encoding;
+	Series.Count = 0;
+}
+
+/*---------------------------------------------------------------------
+ * bool SetSampled(uint8_t slot, uint16_t period, uint8_t perMsg)
+ * sample the value of a field every period ms - used in CBOR mode
+ * only. The samples are sent delta encoded instead of the single
+ * value, a message is due once perMsg samples have been taken.
+ * If the budget doesn't allow for them the oldest ones are dropped
+ * once TELEMETRY_MAX_SAMPLES are buffered.
+ * A single field can be sampled - the last one set.
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::SetSampled(uint8_t slot, uint16_t period, uint8_t perMsg)
+{
+	if((slot >= FieldCount) || (period == 0) || (perMsg == 0) || (perMsg > TELEMETRY_MAX_SAMPLES))
+		return false;
+
+	Series.Field = slot;
+	Series.Period = period;
+	Series.PerMsg = perMsg;
+	Series.Count = 0;
+
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * void SetBudget(uint16_t rate, uint8_t burst)
+ * rate: messages per second on average, 1..1000
+ * burst: messages which may be sent in a row after a quiet time
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCTelemetry::SetBudget(uint16_t rate, uint8_t burst)
+{
+	if((rate == 0) || (rate > 1000) || (burst == 0))
+		return;
+
+	Rate = rate;
+	Burst = burst;
+	if(Tokens > 1000UL * Burst)
+		Tokens = 1000UL * Burst;
+}
+
+/*---------------------------------------------------------------------
+ * void SetWindow(uint16_t window)
+ * ms between two messages at least - the changes within are
+ * collected into a single message
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCTelemetry::SetWindow(uint16_t window)
+{
+	Window = window;
+}
+
+/*---------------------------------------------------------------------
+ * void Register_OnPublishCb(pfunction_holder *Cb)
+ * the callback is called with a pointer to a TelemetryMsg and
+ * has to set its isSent if the message could be published
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCTelemetry::Register_OnPublishCb(pfunction_holder *Cb)
+{
+	OnPublishCb.callback = Cb->callback;
+	OnPublishCb.op = Cb->op;
+}
+
+/*---------------------------------------------------------------------
+ * bool Update(uint32_t time)
+ * to be called cyclically. Publishes a single message at most:
+ * - if any field is due
+ * - and the last message is at least Window ms ago
+ * - and there is a message left in the budget
+ * A failed publish costs the budget too, so a broken connection
+ * isn't hammered.
+ * returns true if a message has been published
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::Update(uint32_t time)
+{
+	actTime = time;
+	Refill();
+
+	if(Encoding == eTelemetryCbor)
+		Sample();
+
+	if(OnPublishCb.callback == NULL)
+		return false;
+
+	if((actTime - PublishedAt) < Window)
+		return false;
+
+	bool isAnyDue = IsSeriesDue();
+
+	for(uint8_t i = 0; (i < FieldCount) && !isAnyDue; i++)
+		isAnyDue = IsDue(i);
+
+	if(!isAnyDue)
+		return false;
+
+	if(Tokens < 1000)
+	{
+		//count once per message held back
+		if(!isDeferred)
+		{
+			Deferred++;
+			isDeferred = true;
+
+			#if(DEBUG_TELEMETRY & DEBUG_BUDGET)
+			Serial.println("TM: budget exceeded");
+			#endif
+		}
+		return false;
+	}
+	isDeferred = false;
+
+	TelemetryMsg Msg;
+
+	Msg.isBinary = (Encoding == eTelemetryCbor);
+	Msg.Fields = Msg.isBinary ? ComposeCbor() : Compose();
+	if(Msg.Fields == 0)
+		return false;
+		
+	Msg.Payload = Payload;
+	Msg.Len = PayloadLen;
+	Msg.isSent = false;
+
+	OnPublishCb.callback(OnPublishCb.op, (void *)&Msg);
+
+	Tokens -= 1000;
+	PublishedAt = actTime;
+
+	if(!Msg.isSent)
+	{
+		//the samples are kept for the next one
+		isSeriesInMsg = false;
+		Failed++;
+		return false;
+	}
+
+	#if(DEBUG_TELEMETRY & DEBUG_PUBLISH)
+	Serial.print("TM: ");
+	if(Msg.isBinary)
+	{
+		Serial.print(Msg.Len);
+		Serial.println(" bytes");
+	}
+	else
+		Serial.println(Payload);
+	#endif
+
+	if(isSeriesInMsg)
+	{
+		SamplesSent += Series.Count;
+		Series.Count = 0;
+		isSeriesInMsg = false;
+	}
+
+	for(uint8_t i = 0; i < FieldCount; i++)
+	{
+		TelemetryField *ThisField = &Field[i];
+
+		if(ThisField->isInMsg)
+		{
+			ThisField->Sent = ThisField->Value;
+			ThisField->SentAt = actTime;
+			ThisField->isPublished = true;
+			ThisField->isForced = false;
+			ThisField->isInMsg = false;
+		}
+	}
+	Published++;
+	FieldsSent += Msg.Fields;
+
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * the counters
+ * Published: messages sent
+ * FieldsSent: values sent in them
+ * Suppressed: changes not published due to the deadband
+ * Deferred: messages held back by the budget
+ * Failed: messages the callback couldn't publish
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t MCTelemetry::GetPublished()
+{
+	return Published;
+}
+
+uint32_t MCTelemetry::GetFieldsSent()
+{
+	return FieldsSent;
+}
+
+uint32_t MCTelemetry::GetSuppressed()
+{
+	return Suppressed;
+}
+
+uint32_t MCTelemetry::GetDeferred()
+{
+	return Deferred;
+}
+
+uint32_t MCTelemetry::GetFailed()
+{
+	return Failed;
+}
+
+uint32_t MCTelemetry::GetSamplesSent()
+{
+	return SamplesSent;
+}
+
+uint32_t MCTelemetry::GetSamplesDropped()
+{
+	return SamplesDropped;
+}
+
+void MCTelemetry::ResetCounters()
+{
+	Published = 0;
+	FieldsSent = 0;
+	Suppressed = 0;
+	Deferred = 0;
+	Failed = 0;
+	SamplesSent = 0;
+	SamplesDropped = 0;
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * bool IsDue(uint8_t slot)
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::IsDue(uint8_t slot)
+{
+	TelemetryField *ThisField = &Field[slot];
+
+	if(!ThisField->isValid)
+		return false;
+
+	//sent by its samples
+	if((Encoding == eTelemetryCbor) && (slot == Series.Field))
+		return false;
+
+	if(!ThisField->isPublished || ThisField->isForced)
+		return true;
+
+	if(ThisField->MaxAge && ((actTime - ThisField->SentAt) >= ThisField->MaxAge))
+		return true;
+
+	//distance in uint32 to be safe against overflows
+	uint32_t delta;
+
+	if(ThisField->Value > ThisField->Sent)
+		delta = (uint32_t)ThisField->Value - (uint32_t)ThisField->Sent;
+	else
+		delta = (uint32_t)ThisField->Sent - (uint32_t)ThisField->Value;
+
+	return (delta > ThisField->Deadband);
+}
+
+/*---------------------------------------------------------------------
+ * void Sample()
+ * take a sample of the sampled field if its period has passed
+ * the samples are taken at FirstAt + n x Period nominally
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCTelemetry::Sample()
+{
+	if((Series.Field == TelemetryNoField) || !Field[Series.Field].isValid)
+		return;
+
+	if(Series.Count == 0)
+	{
+		Series.FirstAt = actTime;
+		Series.SampledAt = actTime;
+	}
+	else if((actTime - Series.SampledAt) < Series.Period)
+		return;
+	else if((actTime - Series.SampledAt) < (2UL * Series.Period))
+		Series.SampledAt += Series.Period;
+	else
+		//too late - don't catch up
+		Series.SampledAt = actTime;
+
+	if(Series.Count >= TELEMETRY_MAX_SAMPLES)
+	{
+		memmove(&Series.Sample[0], &Series.Sample[1], (TELEMETRY_MAX_SAMPLES - 1) * sizeof(int32_t));
+		Series.Count--;
+		Series.FirstAt += Series.Period;
+		SamplesDropped++;
+	}
+	Series.Sample[Series.Count++] = Field[Series.Field].Value;
+}
+
+/*---------------------------------------------------------------------
+ * bool IsSeriesDue()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::IsSeriesDue()
+{
+	return (Encoding == eTelemetryCbor) && (Series.Field != TelemetryNoField) && (Series.Count >= Series.PerMsg);
+}
+
+/*---------------------------------------------------------------------
+ * void Refill()
+ * add Rate/1000 messages per ms to the budget
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void MCTelemetry::Refill()
+{
+	uint32_t limit = 1000UL * Burst;
+	uint32_t elapsed = actTime - RefilledAt;
+
+	RefilledAt = actTime;
+
+	//Rate is 1 at least, so this will fill it up anyway
+	if(elapsed >= limit)
+		Tokens = limit;
+	else
+	{
+		Tokens += elapsed * Rate;
+		if(Tokens > limit)
+			Tokens = limit;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t Compose()
+ * put the fields which are due into the payload
+ * fields which don't fit are left due for the next message - the
+ * first field rotates so all of them get their turn
+ * returns the number of fields in the payload
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCTelemetry::Compose()
+{
+	uint8_t count = 0;
+	uint8_t slot = FirstField;
+	uint8_t missed = TelemetryNoField;
+
+	PayloadLen = 0;
+	Append("{");
+
+	for(uint8_t i = 0; i < FieldCount; i++)
+	{
+		TelemetryField *ThisField = &Field[slot];
+		uint8_t len = PayloadLen;
+
+		ThisField->isInMsg = false;
+
+		if(IsDue(slot))
+		{
+			if(((count == 0) || Append(",")) && Append("\"") && Append(ThisField->Name)
+				&& Append("\":") && AppendInt(ThisField->Value))
+			{
+				ThisField->isInMsg = true;
+				count++;
+			}
+			else
+			{
+				PayloadLen = len;
+				if(missed == TelemetryNoField)
+					missed = slot;
+			}
+		}
+		slot = (slot + 1) % FieldCount;
+	}
+	
+	//the first one missed is the first one next time
+	if(missed != TelemetryNoField)
+		FirstField = missed;
+
+	//the space of the closing bracket is kept free by Append()
+	Payload[PayloadLen++] = '}';
+	Payload[PayloadLen] = 0;
+
+	return count;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t ComposeCbor()
+ * like Compose() but as an indefinite CBOR map. The samples come
+ * first and are sent whenever there are some.
+ * returns the number of fields in the payload incl. the samples
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t MCTelemetry::ComposeCbor()
+{
+	const uint8_t MapStart = 0xbf;
+	uint8_t count = 0;
+	uint8_t slot = FirstField;
+	uint8_t missed = TelemetryNoField;
+
+	PayloadLen = 0;
+	AppendBytes(&MapStart, 1);
+	isSeriesInMsg = false;
+
+	if((Series.Field != TelemetryNoField) && (Series.Count > 0))
+	{
+		uint8_t len = PayloadLen;
+		bool isOk = AppendCborText("t") && AppendCborHead(0, Series.FirstAt)
+				 && AppendCborText("dt") && AppendCborHead(0, Series.Period)
+				 && AppendCborText(Field[Series.Field].Name) && AppendCborHead(4, Series.Count)
+				 && AppendCborInt(Series.Sample[0]);
+
+		for(uint8_t i = 1; isOk && (i < Series.Count); i++)
+			isOk = AppendCborInt((int32_t)((uint32_t)Series.Sample[i] - (uint32_t)Series.Sample[i - 1]));
+
+		if(isOk)
+		{
+			isSeriesInMsg = true;
+			Field[Series.Field].isInMsg = true;
+			count++;
+		}
+		else
+			PayloadLen = len;
+	}
+
+	for(uint8_t i = 0; i < FieldCount; i++)
+	{
+		TelemetryField *ThisField = &Field[slot];
+		uint8_t len = PayloadLen;
+
+		if(isSeriesInMsg && (slot == Series.Field))
+		{
+			slot = (slot + 1) % FieldCount;
+			continue;
+		}
+		ThisField->isInMsg = false;
+
+		if(IsDue(slot))
+		{
+			if(AppendCborText(ThisField->Name) && AppendCborInt(ThisField->Value))
+			{
+				ThisField->isInMsg = true;
+				count++;
+			}
+			else
+			{
+				PayloadLen = len;
+				if(missed == TelemetryNoField)
+					missed = slot;
+			}
+		}
+		slot = (slot + 1) % FieldCount;
+	}
+	
+	if(missed != TelemetryNoField)
+		FirstField = missed;
+
+	//the space of the break is kept free by AppendBytes()
+	Payload[PayloadLen++] = (char)0xff;
+
+	return count;
+}
+
+/*---------------------------------------------------------------------
+ * bool Append(const char *Text)
+ * returns false if it doesn't fit - one byte is kept for the
+ * closing bracket
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::Append(const char *Text)
+{
+	uint8_t len = PayloadLen;
+
+	while(*Text)
+	{
+		if(len >= (TELEMETRY_MAX_PAYLOAD - 1))
+			return false;
+		Payload[len++] = *Text++;
+	}
+	PayloadLen = len;
+	Payload[PayloadLen] = 0;
+
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * bool AppendInt(int32_t value)
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::AppendInt(int32_t value)
+{
+	char Digits[12];
+	uint8_t idx = sizeof(Digits) - 1;
+	uint32_t magnitude = (value < 0) ? (0 - (uint32_t)value) : (uint32_t)value;
+
+	Digits[idx] = 0;
+	do
+	{
+		Digits[--idx] = '0' + (magnitude % 10);
+		magnitude /= 10;
+	}
+	while(magnitude > 0);
+
+	if(value < 0)
+		Digits[--idx] = '-';
+
+	return Append(&Digits[idx]);
+}
+
+/*---------------------------------------------------------------------
+ * bool AppendBytes(const uint8_t *Data, uint8_t len)
+ * returns false if it doesn't fit - one byte is kept for the
+ * break of the map
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::AppendBytes(const uint8_t *Data, uint8_t len)
+{
+	if((PayloadLen + len) > (TELEMETRY_MAX_PAYLOAD - 1))
+		return false;
+
+	memcpy(&Payload[PayloadLen], Data, len);
+	PayloadLen += len;
+
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * bool AppendCborHead(uint8_t major, uint32_t value)
+ * the initial byte of a CBOR item and its argument in the shortest
+ * form - big endian
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::AppendCborHead(uint8_t major, uint32_t value)
+{
+	uint8_t Head[5];
+	uint8_t len;
+
+	major <<= 5;
+	if(value < 24)
+	{
+		Head[0] = major | (uint8_t)value;
+		len = 1;
+	}
+	else if(value <= 0xff)
+	{
+		Head[0] = major | 24;
+		Head[1] = (uint8_t)value;
+		len = 2;
+	}
+	else if(value <= 0xffff)
+	{
+		Head[0] = major | 25;
+		Head[1] = (uint8_t)(value >> 8);
+		Head[2] = (uint8_t)value;
+		len = 3;
+	}
+	else
+	{
+		Head[0] = major | 26;
+		Head[1] = (uint8_t)(value >> 24);
+		Head[2] = (uint8_t)(value >> 16);
+		Head[3] = (uint8_t)(value >> 8);
+		Head[4] = (uint8_t)value;
+		len = 5;
+	}
+
+	return AppendBytes(Head, len);
+}
+
+/*---------------------------------------------------------------------
+ * bool AppendCborInt(int32_t value)
+ * a negative value n is encoded as -1 - n
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::AppendCborInt(int32_t value)
+{
+	if(value >= 0)
+		return AppendCborHead(0, (uint32_t)value);
+	else
+		return AppendCborHead(1, ~(uint32_t)value);
+}
+
+/*---------------------------------------------------------------------
+ * bool AppendCborText(const char *Text)
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool MCTelemetry::AppendCborText(const char *Text)
+{
+	uint8_t len = (uint8_t)strlen(Text);
+	uint8_t start = PayloadLen;
+
+	if(AppendCborHead(3, len) && AppendBytes((const uint8_t *)Text, len))
+		return true;
+
+	PayloadLen = start;
+	return false;
+}
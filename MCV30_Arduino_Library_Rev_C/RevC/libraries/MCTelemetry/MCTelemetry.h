@@ -0,0 +1,167 @@
+#ifndef MCTELEMETRY_H
+#define MCTELEMETRY_H
+
+/*--------------------------------------------------------------
+ * class MCTelemetry
+ * collects the actual values of the drives as fields and publishes
+ * the ones which are due in a single message like
+ *   {"pos":1234,"spd":-20}
+ * A field is due if it has moved by more than its deadband since it
+ * has been published last or if it is older than its max-age.
+ * The messages are limited by a budget of messages per second so the
+ * publishing never stalls the drive loop. A field which can't be sent
+ * is sent with its latest value later on.
+ * The message is handed to a callback which does the actual publish.
+ * Instead of the text the message can be encoded as a CBOR map with
+ * the same keys (RFC 8949). In this mode a single field - e.g. the
+ * position - can be sampled at a fixed period and is sent as an array
+ * of the first sample followed by the deltas to the one before:
+ *   {"t":<ms of the first sample>,"dt":<period>,"pos":[1234,3,4,3,..]}
+ * so a high sample rate needs a few bytes per sample and a message per
+ * batch of samples only.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <MC_Helpers.h>
+#include <stdint.h>
+
+//--- service define ---
+
+#ifndef TELEMETRY_MAX_FIELDS
+#define TELEMETRY_MAX_FIELDS 12
+#endif
+
+//PubSubClient sends 256 bytes incl. the topic by default
+#ifndef TELEMETRY_MAX_PAYLOAD
+#define TELEMETRY_MAX_PAYLOAD 128
+#endif
+
+//samples of the sampled field buffered at most
+#ifndef TELEMETRY_MAX_SAMPLES
+#define TELEMETRY_MAX_SAMPLES 16
+#endif
+
+const uint8_t TelemetryNoField = 0xff;
+const uint16_t TelemetryRateDefault = 10;		//messages per second
+const uint8_t TelemetryBurstDefault = 3;
+const uint16_t TelemetryWindowDefault = 50;		//ms to collect changes
+
+typedef enum TelemetryEncodings {
+	eTelemetryText,
+	eTelemetryCbor
+}
+ TelemetryEncodings;
+
+typedef struct TelemetryField {
+	const char *Name;
+	int32_t Value;
+	int32_t Sent;			//value published last
+	uint32_t Deadband;		//publish if moved by more than this
+	uint32_t MaxAge;		//ms - publish even if unchanged, 0 for never
+	uint32_t SentAt;
+	bool isValid;
+	bool isPublished;		//has been published at least once
+	bool isForced;
+	bool isInMsg;			//part of the message being published
+} TelemetryField;
+
+//the samples of a field in CBOR mode
+
+typedef struct TelemetrySeries {
+	uint8_t Field;
+	uint16_t Period;		//ms between the samples
+	uint8_t PerMsg;			//samples which make a message due
+	uint8_t Count;
+	uint32_t FirstAt;		//ms of Sample[0]
+	uint32_t SampledAt;
+	int32_t Sample[TELEMETRY_MAX_SAMPLES];
+} TelemetrySeries;
+
+//handed to the publish callback - isSent to be set by it
+//the payload is binary if isBinary, else a terminated text
+
+typedef struct TelemetryMsg {
+	const char *Payload;
+	uint8_t Len;
+	uint8_t Fields;
+	bool isBinary;
+	bool isSent;
+} TelemetryMsg;
+
+class MCTelemetry {
+	public:
+		MCTelemetry();
+
+		uint8_t AddField(const char *, uint32_t, uint32_t);
+		void SetValue(uint8_t, int32_t);
+		void ForceAll();
+
+		void SetBudget(uint16_t, uint8_t);
+		void SetWindow(uint16_t);
+		void SetEncoding(TelemetryEncodings);
+		bool SetSampled(uint8_t, uint16_t, uint8_t);
+		void Register_OnPublishCb(pfunction_holder *);
+
+		bool Update(uint32_t);
+
+		uint32_t GetPublished();
+		uint32_t GetFieldsSent();
+		uint32_t GetSuppressed();
+		uint32_t GetDeferred();
+		uint32_t GetFailed();
+		uint32_t GetSamplesSent();
+		uint32_t GetSamplesDropped();
+		void ResetCounters();
+
+	private:
+		bool IsDue(uint8_t);
+		void Refill();
+		void Sample();
+		bool IsSeriesDue();
+		uint8_t Compose();
+		uint8_t ComposeCbor();
+		bool Append(const char *);
+		bool AppendInt(int32_t);
+		bool AppendBytes(const uint8_t *, uint8_t);
+		bool AppendCborHead(uint8_t, uint32_t);
+		bool AppendCborInt(int32_t);
+		bool AppendCborText(const char *);
+
+		TelemetryField Field[TELEMETRY_MAX_FIELDS];
+		uint8_t FieldCount = 0;
+		uint8_t FirstField = 0;		//rotates if not all fit into a message
+
+		char Payload[TELEMETRY_MAX_PAYLOAD + 1];
+		uint8_t PayloadLen = 0;
+		TelemetryEncodings Encoding = eTelemetryText;
+
+		TelemetrySeries Series;
+		bool isSeriesInMsg = false;
+
+		pfunction_holder OnPublishCb;
+
+		//token bucket in 1/1000 of a message
+		uint16_t Rate = TelemetryRateDefault;
+		uint8_t Burst = TelemetryBurstDefault;
+		uint32_t Tokens;
+		uint32_t RefilledAt = 0;
+		uint16_t Window = TelemetryWindowDefault;
+		uint32_t PublishedAt = 0;
+		bool isDeferred = false;
+
+		uint32_t Published = 0;
+		uint32_t FieldsSent = 0;
+		uint32_t Suppressed = 0;
+		uint32_t Deferred = 0;
+		uint32_t Failed = 0;
+		uint32_t SamplesSent = 0;
+		uint32_t SamplesDropped = 0;
+
+		uint32_t actTime = 0;
+};
+
+#endif
@@ -0,0 +1,162 @@
+/*---------------------------------------------------
+ * TelemetryOutbox.cpp
+ * implements the buffer of the messages to be sent
+ * once the broker is back
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <TelemetryOutbox.h>
+#include <string.h>
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * TelemetryOutbox()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+TelemetryOutbox::TelemetryOutbox()
+{
+}
+
+/*---------------------------------------------------------------------
+ * bool Push(const char *Topic, const char *Payload, bool isRetained,
+ *           bool isLatestOnly)
+ * queue a message - drops the oldest one if the outbox is full
+ * isLatestOnly: replace a queued message of the same topic in place
+ * returns false if the payload is too long to be kept
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool TelemetryOutbox::Push(const char *Topic, const char *Payload, bool isRetained, bool isLatestOnly)
+{
+	if(Payload == NULL)
+	{
+		Dropped++;
+		return false;
+	}
+
+	return Push(Topic, (const uint8_t *)Payload, strlen(Payload), isRetained, isLatestOnly);
+}
+
+/*---------------------------------------------------------------------
+ * bool Push(const char *Topic, const uint8_t *Payload, uint16_t Len,
+ *           bool isRetained, bool isLatestOnly)
+ * the same for a binary payload of Len bytes
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool TelemetryOutbox::Push(const char *Topic, const uint8_t *Payload, uint16_t Len, bool isRetained, bool isLatestOnly)
+{
+	if((Topic == NULL) || (Payload == NULL) || (Len > TELEMETRY_MAX_PAYLOAD))
+	{
+		Dropped++;
+		return false;
+	}
+
+	OutboxEntry *ThisEntry = NULL;
+
+	if(isLatestOnly)
+	{
+		for(uint8_t i = 0; i < Count; i++)
+		{
+			OutboxEntry *Waiting = &Entry[(Head + i) % TELEMETRY_OUTBOX_SIZE];
+
+			if(strcmp(Waiting->Topic, Topic) == 0)
+			{
+				ThisEntry = Waiting;
+				break;
+			}
+		}
+	}
+
+	if(ThisEntry == NULL)
+	{
+		if(Count >= TELEMETRY_OUTBOX_SIZE)
+		{
+			//drop the oldest one
+			Head = (Head + 1) % TELEMETRY_OUTBOX_SIZE;
+			Count--;
+			Dropped++;
+		}
+		ThisEntry = &Entry[(Head + Count) % TELEMETRY_OUTBOX_SIZE];
+		Count++;
+	}
+
+	ThisEntry->Topic = Topic;
+	memcpy(ThisEntry->Payload, Payload, Len);
+	ThisEntry->Payload[Len] = 0;
+	ThisEntry->Len = Len;
+	ThisEntry->isRetained = isRetained;
+	Queued++;
+
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * OutboxEntry *Peek()
+ * the oldest message or NULL - stays queued until Pop()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+OutboxEntry *TelemetryOutbox::Peek()
+{
+	if(Count == 0)
+		return NULL;
+
+	return &Entry[Head];
+}
+
+/*---------------------------------------------------------------------
+ * void Pop()
+ * remove the oldest message once it has been published
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void TelemetryOutbox::Pop()
+{
+	if(Count == 0)
+		return;
+
+	Head = (Head + 1) % TELEMETRY_OUTBOX_SIZE;
+	Count--;
+}
+
+void TelemetryOutbox::Clear()
+{
+	Head = 0;
+	Count = 0;
+}
+
+/*---------------------------------------------------------------------
+ * the counters
+ * Count: messages waiting
+ * Queued: messages pushed
+ * Dropped: messages lost as the outbox was full or they were too long
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t TelemetryOutbox::GetCount()
+{
+	return Count;
+}
+
+uint32_t TelemetryOutbox::GetQueued()
+{
+	return Queued;
+}
+
+uint32_t TelemetryOutbox::GetDropped()
+{
+	return Dropped;
+}
@@ -0,0 +1,58 @@
+#ifndef TELEMETRY_OUTBOX_H
+#define TELEMETRY_OUTBOX_H
+
+/*--------------------------------------------------------------
+ * class TelemetryOutbox
+ * a bounded FIFO of messages which couldn't be published while the
+ * broker is away. If it is full the oldest message is dropped.
+ * A message which is marked LatestOnly replaces a queued one of the
+ * same topic - e.g. a state of which only the latest is of interest.
+ * The payload is copied, the topic isn't and has to be kept by the
+ * caller. The payload may be binary if its length is given.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <MCTelemetry.h>
+#include <stdint.h>
+
+//--- service define ---
+
+#ifndef TELEMETRY_OUTBOX_SIZE
+#define TELEMETRY_OUTBOX_SIZE 8
+#endif
+
+typedef struct OutboxEntry {
+	const char *Topic;
+	char Payload[TELEMETRY_MAX_PAYLOAD + 1];
+	uint16_t Len;
+	bool isRetained;
+} OutboxEntry;
+
+class TelemetryOutbox {
+	public:
+		TelemetryOutbox();
+
+		bool Push(const char *, const char *, bool, bool);
+		bool Push(const char *, const uint8_t *, uint16_t, bool, bool);
+		OutboxEntry *Peek();
+		void Pop();
+		void Clear();
+
+		uint8_t GetCount();
+		uint32_t GetQueued();
+		uint32_t GetDropped();
+
+	private:
+		OutboxEntry Entry[TELEMETRY_OUTBOX_SIZE];
+		uint8_t Head = 0;		//oldest one
+		uint8_t Count = 0;
+
+		uint32_t Queued = 0;
+		uint32_t Dropped = 0;
+};
+
+#endif
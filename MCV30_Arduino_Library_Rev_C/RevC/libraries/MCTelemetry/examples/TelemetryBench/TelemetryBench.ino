@@ -0,0 +1,186 @@
+/*--------------------------------------------------------------
+ * TelemetryBench.ino
+ * compare publishing the actual values of a drive one message per
+ * value and update (like the MQTT server did) with the MCTelemetry.
+ * No broker is needed: a stand-in takes the messages and blocks the
+ * loop like a publish of the PubSubClient over WiFi does - a fixed
+ * time per message plus a time per byte.
+ * The drive values are simulated: a moving position, a noisy speed
+ * and a slowly rising temperature, updated every ms.
+ * Every BenchTime the messages and bytes per second and the longest
+ * loop pass (the jitter the drive communication would see) are
+ * reported. The two modes alternate.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+#include <MCTelemetry.h>
+#include <stdint.h>
+
+//--- globals ---
+
+const uint32_t BenchTime = 5000;         //ms per mode
+const uint32_t UpdateRate = 20;          //ms the naive mode publishes
+const uint32_t PublishBaseUs = 1500;     //cost of a message at the stand-in
+const uint32_t PublishByteUs = 20;       //and per byte
+
+MCTelemetry Telemetry;
+uint8_t PosField;
+uint8_t SpeedField;
+uint8_t TempField;
+uint8_t SWField;
+
+bool isNaive = true;
+uint32_t ModeStartedAt;
+uint32_t LastUpdate;
+uint32_t LastLoop;
+uint32_t MaxLoopUs;
+
+uint32_t Messages;
+uint32_t Bytes;
+
+int32_t Position = 0;
+int32_t Speed = 0;
+int16_t Temp = 250;
+uint16_t StatusWord = 0x0627;
+
+//--- stand-in of the broker ---
+
+bool brokerPublish(const char *Topic, const char *Payload)
+{
+  uint16_t len = strlen(Topic) + strlen(Payload);
+
+  delayMicroseconds(PublishBaseUs + len * PublishByteUs);
+  Messages++;
+  Bytes += len;
+  return true;
+}
+
+void OnPublish(void *op, void *p)
+{
+  TelemetryMsg *Msg = (TelemetryMsg *)p;
+
+  Msg->isSent = brokerPublish("Nano/MC/Telemetry", Msg->Payload);
+}
+
+//--- the simulated drive ---
+
+void simulateDrive(uint32_t now)
+{
+  Speed = 1000 + (int32_t)random(-20, 21);
+  Position += Speed / 100;
+  if((now % 1000) == 0)
+    Temp++;
+}
+
+void publishNaive()
+{
+  char payload[12];
+
+  itoa(Position, payload, 10);
+  brokerPublish("Nano/MC/ActPosition", payload);
+  itoa(Speed, payload, 10);
+  brokerPublish("Nano/MC/ActSpeed", payload);
+  itoa(Temp, payload, 10);
+  brokerPublish("Nano/MC/MotorTemp", payload);
+  itoa(StatusWord, payload, 10);
+  brokerPublish("Nano/MC/StatusWord", payload);
+}
+
+void startMode(uint32_t now)
+{
+  ModeStartedAt = now;
+  Messages = 0;
+  Bytes = 0;
+  MaxLoopUs = 0;
+  Telemetry.ResetCounters();
+}
+
+void report(uint32_t now)
+{
+  uint32_t seconds = (now - ModeStartedAt) / 1000;
+
+  Serial.print(isNaive ? "naive     " : "telemetry ");
+  Serial.print(Messages / seconds);
+  Serial.print(" msg/s ");
+  Serial.print(Bytes / seconds);
+  Serial.print(" byte/s max loop ");
+  Serial.print(MaxLoopUs);
+  Serial.print(" us");
+  if(!isNaive)
+  {
+    Serial.print(" suppressed ");
+    Serial.print(Telemetry.GetSuppressed());
+    Serial.print(" deferred ");
+    Serial.print(Telemetry.GetDeferred());
+  }
+  Serial.println();
+}
+
+void setup() {
+  pfunction_holder Cb;
+
+  // Debug Port
+  Serial.begin(500000);
+  while(!Serial)
+    ;
+
+  //position in increments, speed in rpm, temp in 1/10 deg
+  PosField = Telemetry.AddField("pos", 50, 1000);
+  SpeedField = Telemetry.AddField("spd", 25, 2000);
+  TempField = Telemetry.AddField("temp", 5, 10000);
+  SWField = Telemetry.AddField("sw", 0, 10000);
+
+  Telemetry.SetBudget(10, 3);
+  Telemetry.SetWindow(50);
+
+  Cb.callback = (pfunction_pointer_t)OnPublish;
+  Cb.op = NULL;
+  Telemetry.Register_OnPublishCb(&Cb);
+
+  LastLoop = micros();
+  LastUpdate = millis();
+  startMode(LastUpdate);
+}
+
+void loop() {
+  uint32_t now = millis();
+  uint32_t nowUs = micros();
+
+  if((nowUs - LastLoop) > MaxLoopUs)
+    MaxLoopUs = nowUs - LastLoop;
+  LastLoop = nowUs;
+
+  //new values every ms like the PollPlanner delivers them
+  static uint32_t lastSim = 0;
+  if(now != lastSim)
+  {
+    lastSim = now;
+    simulateDrive(now);
+    Telemetry.SetValue(PosField, Position);
+    Telemetry.SetValue(SpeedField, Speed);
+    Telemetry.SetValue(TempField, Temp);
+    Telemetry.SetValue(SWField, StatusWord);
+  }
+
+  if(isNaive)
+  {
+    if((now - LastUpdate) >= UpdateRate)
+    {
+      LastUpdate = now;
+      publishNaive();
+    }
+  }
+  else
+    Telemetry.Update(now);
+
+  if((now - ModeStartedAt) >= BenchTime)
+  {
+    report(now);
+    isNaive = !isNaive;
+    startMode(now);
+    LastLoop = micros();
+  }
+}
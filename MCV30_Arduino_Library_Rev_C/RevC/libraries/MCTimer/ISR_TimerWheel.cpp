@@ -0,0 +1,721 @@
+/*--------------------------------------------------------------
+ * ISR_TimerWheel.cpp
+ * hierarchical timer wheel with the API of the ISR_Timer
+ *
+ * The wheel has TimerWheelLevels levels of TimerWheelSlots each.
+ * A timer is linked to the slot of level 0 if it expires within 
+ * the next TimerWheelSlots ticks, to level 1 if it expires within 
+ * TimerWheelSlots^2 ticks and so on. Whenever level 0 wraps the
+ * next slot of level 1 is cascaded - its timers are sorted into 
+ * level 0 again. So any timer is moved TimerWheelLevels-1 times at
+ * most, no matter how many timers there are.
+ * Ticks without any work are skipped by the bitmap of the used slots
+ * of level 0, so a run() after a long sleep of a tickless timer is 
+ * cheap too. The bitmaps of all the levels tell the next tick with
+ * any work for a tickless timer.
+ *
+ * 2026-10-18 AW Frame
+ * 2026-10-18 AW tickless support
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include "ISR_TimerWheel.h"
+#include <string.h>
+
+//--- local defines ---
+
+//the timers may be changed by the loop while run() is called by the
+//ISR - lock the ISR out then. Within run() the ISR is locked already.
+#define TW_LOCK()	if(!isRunning) noInterrupts()
+#define TW_UNLOCK()	if(!isRunning) interrupts()
+
+#ifdef ISR_TIMERWHEEL_TICK_US
+#define TW_NOW()	micros()
+#else
+#define TW_NOW()	millis()
+#endif
+
+//the owner of a tickless hardware timer is told about a new timer
+//which might expire earlier than the one it's waiting for - not
+//from within run() as the owner does reschedule after it anyway
+#define TW_CHANGED()	if(!isRunning && (onChange != NULL)) onChange()
+
+static volatile bool isRunning = false;
+
+//--- implementation ---
+
+ISR_TimerWheel::ISR_TimerWheel()
+	: numTimers (-1)
+{
+}
+
+/*---------------------------------------------------------------------
+ * void init()
+ * clear all the timers and start the wheel at the actual time
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::init()
+{
+	for(uint8_t i = 0; i < MAX_TIMERS; i++)
+	{
+		memset((void *)&timer[i], 0, sizeof(wheel_timer_t));
+		timer[i].prev = TimerWheelNone;
+		timer[i].list = TimerWheelNone;
+		timer[i].next = (i + 1 < MAX_TIMERS) ? (i + 1) : TimerWheelNone;
+	}
+	freeList = 0;
+	
+	for(uint8_t i = 0; i <= TimerWheelExpired; i++)
+		head[i] = TimerWheelNone;
+	for(uint8_t level = 0; level < TimerWheelLevels; level++)
+		levelMap[level] = 0;
+		
+	wheelTick = 0;
+	wheelTime = TW_NOW();
+	numTimers = 0;
+}
+
+/*---------------------------------------------------------------------
+ * void run()
+ * Handle all the ticks up to now since the last call - the tick of
+ * the actual time too, so the slot of tick N is handled as soon as
+ * wheelTime has reached the time of tick N. Each tick does cascade
+ * the upper levels if level 0 has wrapped and moves the timers of its
+ * slot to the list of the expired ones. The expired ones are called 
+ * afterwards, periodic ones are linked to the wheel again before.
+ * A periodic timer which has expired several times since the last 
+ * run() is called once only - like with the ISR_Timer.
+ * Empty slots of level 0 are skipped in one go.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW skip idle ticks
+ * 2026-10-18 AW handle the tick of now - a timer was a tick late
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::run()
+{
+	if(numTimers < 0)
+		return;
+		
+	//wheelTime is ahead of now once the tick of now has been handled
+	long elapsed = (long)(TW_NOW() - wheelTime);
+	uint32_t ticks = (elapsed < 0) ? 0 : (elapsed / TimerWheelTickTime + 1);
+	
+	isRunning = true;
+	
+	while(ticks > 0)
+	{
+		uint8_t idle = SkipIdleTicks(ticks);
+		
+		if(idle > 0)
+		{
+			wheelTick += idle;
+			wheelTime += idle * TimerWheelTickTime;
+			ticks -= idle;
+		}
+		else
+		{
+			wheelTime += TimerWheelTickTime;
+			Tick();
+			ticks--;
+		}
+	}
+	
+	while(head[TimerWheelExpired] != TimerWheelNone)
+	{
+		uint8_t i = head[TimerWheelExpired];
+		
+		Unlink(i);
+		Fire(i);
+	}
+	
+	isRunning = false;
+}
+
+int ISR_TimerWheel::setTimer(unsigned long d, timer_callback f, unsigned n) {
+	return setupTimer(ToTicks(d), (void *)f, NULL, false, n);
+}
+
+int ISR_TimerWheel::setTimer(unsigned long d, timer_callback_p f, void* p, unsigned n) {
+	return setupTimer(ToTicks(d), (void *)f, p, true, n);
+}
+
+int ISR_TimerWheel::setInterval(unsigned long d, timer_callback f) {
+	return setupTimer(ToTicks(d), (void *)f, NULL, false, RUN_FOREVER);
+}
+
+int ISR_TimerWheel::setInterval(unsigned long d, timer_callback_p f, void* p) {
+	return setupTimer(ToTicks(d), (void *)f, p, true, RUN_FOREVER);
+}
+
+int ISR_TimerWheel::setTimeout(unsigned long d, timer_callback f) {
+	return setupTimer(ToTicks(d), (void *)f, NULL, false, RUN_ONCE);
+}
+
+int ISR_TimerWheel::setTimeout(unsigned long d, timer_callback_p f, void* p) {
+	return setupTimer(ToTicks(d), (void *)f, p, true, RUN_ONCE);
+}
+
+/*---------------------------------------------------------------------
+ * int setTimeoutMicros(unsigned long us, timer_callback_p f, void* p)
+ * one-shot timer in us - rounded up to the next tick of the wheel
+ * so a resolution below 1ms needs ISR_TIMERWHEEL_TICK_US
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+int ISR_TimerWheel::setTimeoutMicros(unsigned long us, timer_callback_p f, void* p) {
+	return setupTimer(ToTicksMicros(us), (void *)f, p, true, RUN_ONCE);
+}
+
+/*---------------------------------------------------------------------
+ * bool changeInterval(unsigned numTimer, unsigned long d)
+ * set a new interval and restart the timer from now
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool ISR_TimerWheel::changeInterval(unsigned numTimer, unsigned long d)
+{
+	if((numTimer >= MAX_TIMERS) || (timer[numTimer].callback == NULL))
+		return false;
+		
+	TW_LOCK();
+	timer[numTimer].delay = ToTicks(d);
+	Unlink(numTimer);
+	timer[numTimer].expires = NowTick() + timer[numTimer].delay;
+	Insert(numTimer);
+	TW_UNLOCK();
+	TW_CHANGED();
+	
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * void deleteTimer(unsigned numTimer)
+ * cancel a timer by its handle - O(1)
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::deleteTimer(unsigned numTimer)
+{
+	if((numTimer >= MAX_TIMERS) || (numTimers <= 0))
+		return;
+	
+	if(timer[numTimer].callback != NULL)
+	{
+		TW_LOCK();
+		Release(numTimer);
+		TW_UNLOCK();
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void restartTimer(unsigned numTimer)
+ * let the timer start over from now
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::restartTimer(unsigned numTimer)
+{
+	if((numTimer >= MAX_TIMERS) || (timer[numTimer].callback == NULL))
+		return;
+		
+	TW_LOCK();
+	Unlink(numTimer);
+	timer[numTimer].expires = NowTick() + timer[numTimer].delay;
+	Insert(numTimer);
+	TW_UNLOCK();
+	TW_CHANGED();
+}
+
+bool ISR_TimerWheel::isEnabled(unsigned numTimer) {
+	if (numTimer >= MAX_TIMERS) {
+		return false;
+	}
+	return timer[numTimer].enabled;
+}
+
+void ISR_TimerWheel::enable(unsigned numTimer) {
+	if (numTimer >= MAX_TIMERS) {
+		return;
+	}
+	timer[numTimer].enabled = true;
+}
+
+void ISR_TimerWheel::disable(unsigned numTimer) {
+	if (numTimer >= MAX_TIMERS) {
+		return;
+	}
+	timer[numTimer].enabled = false;
+}
+
+void ISR_TimerWheel::enableAll() {
+	for (uint8_t i = 0; i < MAX_TIMERS; i++) {
+		if (timer[i].callback != NULL && timer[i].maxNumRuns == RUN_FOREVER) {
+			timer[i].enabled = true;
+		}
+	}
+}
+
+void ISR_TimerWheel::disableAll() {
+	for (uint8_t i = 0; i < MAX_TIMERS; i++) {
+		if (timer[i].callback != NULL && timer[i].maxNumRuns == RUN_FOREVER) {
+			timer[i].enabled = false;
+		}
+	}
+}
+
+void ISR_TimerWheel::toggle(unsigned numTimer) {
+	if (numTimer >= MAX_TIMERS) {
+		return;
+	}
+	timer[numTimer].enabled = !timer[numTimer].enabled;
+}
+
+unsigned ISR_TimerWheel::getNumTimers() {
+	return numTimers;
+}
+
+/*---------------------------------------------------------------------
+ * bool getNextExpiry(unsigned long *us)
+ * the time in us until run() has to be called for the earliest timer
+ * returns false if there is no timer at all.
+ * The earliest timer is found by the bitmaps - see NextDueTick().
+ * Doesn't lock the ISR - to be called from within the ISR or with
+ * the interrupts locked.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW by the bitmaps instead of a scan of the timers
+ *--------------------------------------------------------------------*/
+
+bool ISR_TimerWheel::getNextExpiry(unsigned long *us)
+{
+	if(numTimers <= 0)
+		return false;
+		
+	uint32_t next = NextDueTick();
+	
+	//the slot of a tick is handled as soon as its time is reached
+	int32_t ticks = (int32_t)(next - wheelTick);
+	if(ticks < 0)
+		ticks = 0;
+		
+	long remaining = (long)((wheelTime + ticks * TimerWheelTickTime) - TW_NOW());
+	if(remaining < 0)
+		remaining = 0;
+		
+	#ifdef ISR_TIMERWHEEL_TICK_US
+	*us = remaining;
+	#else
+	if(remaining > 4000000L)
+		remaining = 4000000L;
+	*us = remaining * 1000UL;
+	#endif
+	
+	return true;
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * int setupTimer(uint32_t ticks, void* f, void* p, bool h, unsigned n)
+ * take a timer from the free list and link it into the wheel
+ * returns the handle or -1 if f is NULL or there is no free timer
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+int ISR_TimerWheel::setupTimer(uint32_t ticks, void* f, void* p, bool h, unsigned n)
+{
+	if(numTimers < 0)
+		init();
+		
+	if(f == NULL)
+		return -1;
+		
+	TW_LOCK();
+	
+	uint8_t i = freeList;
+	
+	if(i == TimerWheelNone)
+	{
+		TW_UNLOCK();
+		return -1;
+	}
+	freeList = timer[i].next;
+	
+	timer[i].delay = ticks;
+	timer[i].callback = f;
+	timer[i].param = p;
+	timer[i].hasParam = h;
+	timer[i].maxNumRuns = n;
+	timer[i].numRuns = 0;
+	timer[i].enabled = true;
+	timer[i].next = TimerWheelNone;
+	timer[i].prev = TimerWheelNone;
+	timer[i].list = TimerWheelNone;
+	timer[i].expires = NowTick() + timer[i].delay;
+	Insert(i);
+	
+	numTimers++;
+	
+	TW_UNLOCK();
+	TW_CHANGED();
+	
+	return i;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t ToTicks(unsigned long d)
+ * ms to ticks - rounded up so a timer never expires early
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t ISR_TimerWheel::ToTicks(unsigned long d)
+{
+	#ifdef ISR_TIMERWHEEL_TICK_US
+	uint32_t ticks = d * (1000UL / ISR_TIMERWHEEL_TICK_US);
+	#else
+	uint32_t ticks = (d + ISR_TIMERWHEEL_TICK - 1) / ISR_TIMERWHEEL_TICK;
+	#endif
+	
+	if(ticks == 0)
+		ticks = 1;
+	return ticks;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t ToTicksMicros(unsigned long us)
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t ISR_TimerWheel::ToTicksMicros(unsigned long us)
+{
+	uint32_t ticks = (us + TimerWheelUsPerTick - 1) / TimerWheelUsPerTick;
+	
+	if(ticks == 0)
+		ticks = 1;
+	return ticks;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t NowTick()
+ * the first tick not before the actual time - run() may not have been
+ * called for a while, so the wheel can be behind. A new timer has to
+ * count from now or it would expire early. As the slot of a tick is
+ * handled at the time of the tick, it's rounded up.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW rounded up
+ *--------------------------------------------------------------------*/
+
+uint32_t ISR_TimerWheel::NowTick()
+{
+	long elapsed = (long)(TW_NOW() - wheelTime);
+	
+	if(elapsed <= 0)
+		return wheelTick;
+	return wheelTick + (elapsed + TimerWheelTickTime - 1) / TimerWheelTickTime;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t SkipIdleTicks(uint32_t maxTicks)
+ * the number of ticks from now on which have nothing to do - their
+ * slots of level 0 are empty and there is no cascade. 
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t ISR_TimerWheel::SkipIdleTicks(uint32_t maxTicks)
+{
+	uint8_t index = wheelTick & TimerWheelSlotMask;
+	uint8_t idle = 0;
+	
+	if(index == 0)
+		return 0;
+		
+	while(((index + idle) < TimerWheelSlots) && (idle < maxTicks) && 
+		  !(levelMap[0] & (1UL << (index + idle))))
+		idle++;
+		
+	return idle;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t NextDueTick()
+ * the tick the earliest timer expires: the first used slot of level 0
+ * from now on tells it directly. The slots of an upper level cover 
+ * one range of ticks each, so its earliest timer is linked to its 
+ * first used slot from the next cascade on - only this one list is 
+ * scanned per level. Instead of all the timers, as it's called with 
+ * every interrupt of a tickless timer and every new timer.
+ * There has to be at least one timer linked.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t ISR_TimerWheel::NextDueTick()
+{
+	uint32_t next = wheelTick + TimerWheelRange;
+	
+	for(uint8_t level = 0; level < TimerWheelLevels; level++)
+	{
+		uint32_t map = levelMap[level];
+		
+		if(map == 0)
+			continue;
+		
+		uint8_t shift = level * TimerWheelSlotBits;
+		uint32_t base = wheelTick;
+		
+		//an upper level is cascaded on the next wrap of the level below
+		if(level > 0)
+			base = (wheelTick + (1UL << shift) - 1) & ~((1UL << shift) - 1);
+		
+		//first used slot from the one of base on
+		uint8_t index = (base >> shift) & TimerWheelSlotMask;
+		
+		if(index != 0)
+			map = (map >> index) | (map << (TimerWheelSlots - index));
+		
+		uint8_t slot = (index + __builtin_ctzl(map)) & TimerWheelSlotMask;
+		
+		if(level == 0)
+		{
+			uint32_t due = base + ((slot - index) & TimerWheelSlotMask);
+			
+			if((int32_t)(due - next) < 0)
+				next = due;
+			continue;
+		}
+		
+		//may still be before a slot of level 0 beyond the wrap
+		for(uint8_t i = head[level * TimerWheelSlots + slot]; i != TimerWheelNone; i = timer[i].next)
+		{
+			if((int32_t)(timer[i].expires - next) < 0)
+				next = timer[i].expires;
+		}
+	}
+	return next;
+}
+
+/*---------------------------------------------------------------------
+ * void Insert(uint8_t i)
+ * link a timer to the slot its expiry time falls into
+ * timers beyond the range of the wheel are linked to the last slot
+ * of the top level and are sorted in again when it is cascaded
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::Insert(uint8_t i)
+{
+	uint32_t expires = timer[i].expires;
+	uint32_t idx = expires - wheelTick;
+	uint8_t level;
+	
+	if((int32_t)idx < 0)
+	{
+		//overdue - handle with the next tick
+		Link(i, wheelTick & TimerWheelSlotMask);
+		return;
+	}
+	
+	for(level = 0; level < TimerWheelLevels - 1; level++)
+	{
+		if(idx < (1UL << ((level + 1) * TimerWheelSlotBits)))
+			break;
+	}
+	
+	if(idx > TimerWheelRange)
+		expires = wheelTick + TimerWheelRange;
+		
+	uint8_t slot = (expires >> (level * TimerWheelSlotBits)) & TimerWheelSlotMask;
+	
+	Link(i, level * TimerWheelSlots + slot);
+}
+
+/*---------------------------------------------------------------------
+ * void Link(uint8_t i, uint8_t list)
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::Link(uint8_t i, uint8_t list)
+{
+	timer[i].prev = TimerWheelNone;
+	timer[i].next = head[list];
+	if(head[list] != TimerWheelNone)
+		timer[head[list]].prev = i;
+	head[list] = i;
+	timer[i].list = list;
+	
+	if(list < TimerWheelExpired)
+		levelMap[list >> TimerWheelSlotBits] |= (1UL << (list & TimerWheelSlotMask));
+}
+
+/*---------------------------------------------------------------------
+ * void Unlink(uint8_t i)
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::Unlink(uint8_t i)
+{
+	if(timer[i].list == TimerWheelNone)
+		return;
+		
+	if(timer[i].prev != TimerWheelNone)
+		timer[timer[i].prev].next = timer[i].next;
+	else
+		head[timer[i].list] = timer[i].next;
+		
+	if(timer[i].next != TimerWheelNone)
+		timer[timer[i].next].prev = timer[i].prev;
+		
+	if((timer[i].list < TimerWheelExpired) && (head[timer[i].list] == TimerWheelNone))
+		levelMap[timer[i].list >> TimerWheelSlotBits] &= ~(1UL << (timer[i].list & TimerWheelSlotMask));
+		
+	timer[i].next = TimerWheelNone;
+	timer[i].prev = TimerWheelNone;
+	timer[i].list = TimerWheelNone;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t Cascade(uint8_t level, uint8_t index)
+ * sort the timers of a slot of an upper level into the lower ones
+ * returns the index so the next level is cascaded on 0
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t ISR_TimerWheel::Cascade(uint8_t level, uint8_t index)
+{
+	uint8_t list = level * TimerWheelSlots + index;
+	
+	while(head[list] != TimerWheelNone)
+	{
+		uint8_t i = head[list];
+		
+		Unlink(i);
+		Insert(i);
+	}
+	return index;
+}
+
+/*---------------------------------------------------------------------
+ * void Tick()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::Tick()
+{
+	uint8_t index = wheelTick & TimerWheelSlotMask;
+	
+	if(index == 0)
+	{
+		for(uint8_t level = 1; level < TimerWheelLevels; level++)
+		{
+			uint8_t slot = (wheelTick >> (level * TimerWheelSlotBits)) & TimerWheelSlotMask;
+			
+			if(Cascade(level, slot) != 0)
+				break;
+		}
+	}
+	
+	wheelTick++;
+	
+	while(head[index] != TimerWheelNone)
+	{
+		uint8_t i = head[index];
+		
+		Unlink(i);
+		Link(i, TimerWheelExpired);
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void Fire(uint8_t i)
+ * Call an expired timer. A timer to be repeated is linked to the 
+ * wheel before, the last run of a timer is released before - so the
+ * callback may set up or delete timers.
+ * A disabled timer is kept running but not called - like with the 
+ * ISR_Timer.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::Fire(uint8_t i)
+{
+	wheel_timer_t *t = &timer[i];
+	bool isToBeCalled = false;
+	bool isLastRun = false;
+	
+	if(t->enabled)
+	{
+		if(t->maxNumRuns == RUN_FOREVER)
+			isToBeCalled = true;
+		else if(t->numRuns < t->maxNumRuns)
+		{
+			isToBeCalled = true;
+			t->numRuns++;
+			if(t->numRuns >= t->maxNumRuns)
+				isLastRun = true;
+		}
+	}
+	
+	void *callback = t->callback;
+	void *param = t->param;
+	bool hasParam = t->hasParam;
+	
+	if(isLastRun)
+		Release(i);
+	else
+	{
+		t->expires += t->delay;
+		if((int32_t)(t->expires - wheelTick) < 0)
+		{
+			//skip the runs missed
+			uint32_t late = wheelTick - t->expires;
+			t->expires += ((late / t->delay) + 1) * t->delay;
+		}
+		Insert(i);
+	}
+	
+	if(isToBeCalled)
+	{
+		if(hasParam)
+			(*(timer_callback_p)callback)(param);
+		else
+			(*(timer_callback)callback)();
+	}
+}
+
+/*---------------------------------------------------------------------
+ * void Release(uint8_t i)
+ * put a timer back to the free list
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void ISR_TimerWheel::Release(uint8_t i)
+{
+	Unlink(i);
+	memset((void *)&timer[i], 0, sizeof(wheel_timer_t));
+	timer[i].prev = TimerWheelNone;
+	timer[i].list = TimerWheelNone;
+	timer[i].next = freeList;
+	freeList = i;
+	
+	numTimers--;
+}
@@ -0,0 +1,158 @@
+#ifndef ISR_TIMERWHEEL_H
+#define ISR_TIMERWHEEL_H
+
+/*--------------------------------------------------------------
+ * class ISR_TimerWheel
+ * drop in replacement for the ISR_Timer based on a hierarchical
+ * timer wheel. Instead of scanning all the slots in every run() 
+ * the timers are sorted into the wheel by their expiry time:
+ * - adding and deleting a timer is O(1)
+ * - a tick handles a single slot of the wheel and the timers
+ *   which expire in it only
+ * The number of timers is set by ISR_TIMERWHEEL_CAPACITY.
+ * The handles returned are the slots of the timers like with the
+ * ISR_Timer, so the API stays the same.
+ * For a tickless hardware timer getNextExpiry() tells when run() 
+ * has to be called next - by the bitmaps of the used slots, w/o a
+ * scan of the timers. With ISR_TIMERWHEEL_TICK_US the wheel is 
+ * driven by micros() to get a resolution below 1ms.
+ *
+ * 2026-10-18 AW Frame
+ * 2026-10-18 AW tickless support
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <stddef.h>
+#include <inttypes.h>
+
+#if defined(ARDUINO)
+  #if ARDUINO >= 100
+    #include <Arduino.h>
+  #else
+    #include <WProgram.h>
+  #endif
+#endif
+
+#include <ISR_Timer.h>
+
+//--- definitions ---
+
+//can be raised by a build flag e.g. -DISR_TIMERWHEEL_CAPACITY=64
+//at most 254
+#ifndef ISR_TIMERWHEEL_CAPACITY
+#define ISR_TIMERWHEEL_CAPACITY 32
+#endif
+
+//ms per tick of the wheel
+#ifndef ISR_TIMERWHEEL_TICK
+#define ISR_TIMERWHEEL_TICK 1
+#endif
+
+//us per tick of the wheel - replaces ISR_TIMERWHEEL_TICK if defined
+//e.g. -DISR_TIMERWHEEL_TICK_US=100 
+#ifdef ISR_TIMERWHEEL_TICK_US
+#if (ISR_TIMERWHEEL_TICK_US == 0) || ((1000 % ISR_TIMERWHEEL_TICK_US) != 0)
+#error "ISR_TIMERWHEEL_TICK_US has to be a divider of 1000"
+#endif
+//tick in units of the time base micros()
+const unsigned long TimerWheelTickTime = ISR_TIMERWHEEL_TICK_US;
+const unsigned long TimerWheelUsPerTick = ISR_TIMERWHEEL_TICK_US;
+#else
+//tick in units of the time base millis()
+const unsigned long TimerWheelTickTime = ISR_TIMERWHEEL_TICK;
+const unsigned long TimerWheelUsPerTick = 1000UL * ISR_TIMERWHEEL_TICK;
+#endif
+
+const uint8_t TimerWheelLevels = 4;
+const uint8_t TimerWheelSlotBits = 5;
+const uint8_t TimerWheelSlots = (1 << TimerWheelSlotBits);
+const uint8_t TimerWheelSlotMask = TimerWheelSlots - 1;
+//ticks covered by the wheel - longer timers are cascaded again
+const uint32_t TimerWheelRange = (1UL << (TimerWheelLevels * TimerWheelSlotBits)) - 1;
+
+const uint8_t TimerWheelNone = 0xff;
+const uint8_t TimerWheelExpired = TimerWheelLevels * TimerWheelSlots;
+
+class ISR_TimerWheel {
+
+public:
+	const static int MAX_TIMERS = ISR_TIMERWHEEL_CAPACITY;
+
+	const static int RUN_FOREVER = 0;
+	const static int RUN_ONCE = 1;
+
+	ISR_TimerWheel();
+
+	void init();
+	void run();
+
+	int setInterval(unsigned long d, timer_callback f);
+	int setInterval(unsigned long d, timer_callback_p f, void* p);
+	int setTimeout(unsigned long d, timer_callback f);
+	int setTimeout(unsigned long d, timer_callback_p f, void* p);
+	int setTimer(unsigned long d, timer_callback f, unsigned n);
+	int setTimer(unsigned long d, timer_callback_p f, void* p, unsigned n);
+	int setTimeoutMicros(unsigned long us, timer_callback_p f, void* p);
+
+	bool changeInterval(unsigned numTimer, unsigned long d);
+	void deleteTimer(unsigned numTimer);
+	void restartTimer(unsigned numTimer);
+
+	bool isEnabled(unsigned numTimer);
+	void enable(unsigned numTimer);
+	void disable(unsigned numTimer);
+	void enableAll();
+	void disableAll();
+	void toggle(unsigned numTimer);
+
+	unsigned getNumTimers();
+	unsigned getNumAvailableTimers() { return MAX_TIMERS - numTimers; };
+	
+	bool getNextExpiry(unsigned long *us);
+	void setOnChange(timer_callback f) { onChange = f; };
+
+private:
+	int setupTimer(uint32_t ticks, void* f, void* p, bool h, unsigned n);
+	uint32_t ToTicks(unsigned long);
+	uint32_t ToTicksMicros(unsigned long);
+	uint8_t SkipIdleTicks(uint32_t);
+	uint32_t NextDueTick();
+	uint32_t NowTick();
+	void Insert(uint8_t);
+	void Link(uint8_t, uint8_t);
+	void Unlink(uint8_t);
+	uint8_t Cascade(uint8_t, uint8_t);
+	void Tick();
+	void Fire(uint8_t);
+	void Release(uint8_t);
+
+	typedef struct {
+		uint32_t expires;			// tick the timer is due
+		uint32_t delay;				// ticks
+		void* callback;
+		void* param;
+		bool hasParam;
+		unsigned maxNumRuns;
+		unsigned numRuns;
+		bool enabled;
+		uint8_t next;				// double linked list of a slot
+		uint8_t prev;
+		uint8_t list;				// slot the timer is linked to
+	} wheel_timer_t;
+
+	wheel_timer_t timer[MAX_TIMERS];
+	uint8_t head[TimerWheelExpired + 1];
+	uint32_t levelMap[TimerWheelLevels];	// bit per used slot of a level
+	uint8_t freeList;
+
+	uint32_t wheelTick;				// next tick to be handled
+	unsigned long wheelTime;		// millis() or micros() of this tick
+	
+	timer_callback onChange = NULL;	// the earliest expiry may have changed
+
+	int numTimers;
+};
+
+#endif
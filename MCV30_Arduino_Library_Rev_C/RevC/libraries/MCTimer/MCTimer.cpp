@@ -3,6 +3,7 @@
  * Implementation of the MCTimer behavior
  *
  * 2020-05-09 AW Rev A
+ * 2026-10-18 AW tickless mode
  *
  *--------------------------------------------------------------*/
  
@@ -22,6 +23,9 @@
 MCTimer OsTimer;
 		
 static void Handler(void);
+#ifdef MCTIMER_TICKLESS
+static void OnServiceChange(void);
+#endif
 
  
  //---implementaton
@@ -39,15 +43,26 @@ static void Handler(void);
  
  static void Handler()
  {
-    OsTimer.TimerService.run();
+    OsTimer.OnInterrupt();
+ }
+ 
+#ifdef MCTIMER_TICKLESS
+ static void OnServiceChange()
+ {
+    OsTimer.Reschedule();
  }
+#endif
  
  /* ----------------------------------------------------
   * MCTimer::init()
   * initialize the low leven hw timer and regsiter the
   * Handler as the low leven int handler method
   * 
+  * In tickless mode the HW timer is left stopped until
+  * the first timer is set at the TimerService.
+  * 
   * 2020-05-10 AW Rev A
+  * 2026-10-18 AW tickless mode
   * 
   * ----------------------------------------------------*/
   
@@ -60,5 +75,95 @@ static void Handler(void);
     // 4) set period in µs - which also starts the serivce
     Timer1.initialize();
     Timer1.stop();
+#ifdef MCTIMER_TICKLESS
+    Timer1.attachInterrupt(Handler);
+    TimerService.setOnChange(OnServiceChange);
+#else
     Timer1.attachInterrupt(Handler,HwPeriod);
+#endif
+ }
+ 
+ /* ----------------------------------------------------
+  * void MCTimer::OnInterrupt()
+  * called by the HW timer - runs the TimerService and 
+  * programs the next interrupt in tickless mode
+  * 
+  * 2026-10-18 AW Rev A
+  * 
+  * ----------------------------------------------------*/
+  
+ void MCTimer::OnInterrupt()
+ {
+    WakeUps++;
+    TimerService.run();
+#ifdef MCTIMER_TICKLESS
+    Program();
+#endif
+ }
+ 
+ /* ----------------------------------------------------
+  * void MCTimer::Reschedule()
+  * to be called from the loop whenever a timer might expire
+  * earlier than the one the HW timer is programmed for.
+  * Is called by the TimerService itself on any new timer.
+  * Does nothing unless in tickless mode.
+  * 
+  * 2026-10-18 AW Rev A
+  * 
+  * ----------------------------------------------------*/
+  
+ void MCTimer::Reschedule()
+ {
+#ifdef MCTIMER_TICKLESS
+    noInterrupts();
+    Program();
+    interrupts();
+#endif
+ }
+ 
+ /* ----------------------------------------------------
+  * unsigned long MCTimer::GetWakeUps()
+  * number of interrupts of the HW timer since start
+  * 
+  * 2026-10-18 AW Rev A
+  * 
+  * ----------------------------------------------------*/
+  
+ unsigned long MCTimer::GetWakeUps()
+ {
+    noInterrupts();
+    unsigned long count = WakeUps;
+    interrupts();
+    return count;
+ }
+ 
+ /* ----------------------------------------------------
+  * void MCTimer::Program()
+  * program the HW timer for the earliest timer of the 
+  * TimerService or stop it if there is none.
+  * The HW timer is periodic - it is programmed again with 
+  * every interrupt so it acts as a one-shot.
+  * Interrupts have to be locked.
+  * 
+  * 2026-10-18 AW Rev A
+  * 
+  * ----------------------------------------------------*/
+  
+ void MCTimer::Program()
+ {
+#ifdef MCTIMER_TICKLESS
+    unsigned long sleep;
+    
+    Timer1.stop();
+    if(!TimerService.getNextExpiry(&sleep))
+        return;
+        
+    if(sleep < MCTimerMinSleepUs)
+        sleep = MCTimerMinSleepUs;
+    else if(sleep > MCTimerMaxSleepUs)
+        sleep = MCTimerMaxSleepUs;
+        
+    Timer1.setPeriod(sleep);
+    Timer1.start();
+#endif
  }
@@ -10,14 +10,33 @@
  * This handler calls the ISR_Timer.run() to handle the services
  * Services are regsitered directly at the exposed instance of the
  * ISR_Timer
+ * The ISR_TimerWheel is used as the service by default, the linear
+ * scan of the ISR_Timer can be selected by MCTIMER_LINEAR_SCAN
+ * 
+ * With MCTIMER_TICKLESS the HW timer doesn't run with a fixed period.
+ * It is programmed for the earliest timer of the service only and 
+ * reprogrammed after each interrupt or when a new timer is set. 
+ * Combine it with ISR_TIMERWHEEL_TICK_US for a resolution below 1ms.
  *
  * 2020-05-09: AW Rev A
+ * 2026-10-18: AW timer wheel as the default service
+ * 2026-10-18: AW tickless mode
  *
  *-----------------------------------------------*/
 
 //--- includes
 
+#if defined(MCTIMER_TICKLESS) && defined(MCTIMER_LINEAR_SCAN)
+#error "MCTIMER_TICKLESS needs the ISR_TimerWheel"
+#endif
+
+#ifdef MCTIMER_LINEAR_SCAN
 #include <ISR_Timer.h>
+typedef ISR_Timer MCTimerService;
+#else
+#include <ISR_TimerWheel.h>
+typedef ISR_TimerWheel MCTimerService;
+#endif
 #include "Arduino.h"
 
 //--- definitions
@@ -25,19 +44,31 @@
 const unsigned int defaultPeriodms = 10;
 const unsigned int usPerms = 1000;
 
+//limits of a single sleep in tickless mode
+//a longer one is split - the HW timers can't do much more anyway
+const unsigned long MCTimerMinSleepUs = 50;
+const unsigned long MCTimerMaxSleepUs = 1000000UL;
+
 
 class MCTimer
 {
 	public:
-		ISR_Timer TimerService;
+		MCTimerService TimerService;
 		
 		//constructor can be called with a different period time
+		//which is not used in tickless mode
 		MCTimer();
 		MCTimer(unsigned long period);
+		
+		void OnInterrupt();
+		void Reschedule();
+		unsigned long GetWakeUps();
 	
 	private:
 		unsigned long HwPeriod = usPerms*defaultPeriodms;
+		volatile unsigned long WakeUps = 0;
 		void init(void);
+		void Program();
 };
 				
 
@@ -0,0 +1,98 @@
+/*--------------------------------------------------------------
+ * TimerWheelBench.ino
+ * compare the cost of a tick of the ISR_Timer (linear scan of
+ * all slots) and the ISR_TimerWheel for a growing number of timers.
+ * run() is called once per ms - so each call handles a single 
+ * tick - and the time spent in run() is averaged over BenchTime.
+ * The timers are long running ones which don't expire during the 
+ * measurement, plus a single 1ms interval to have some work in
+ * every tick.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+#include <ISR_Timer.h>
+#include <ISR_TimerWheel.h>
+#include <stdint.h>
+
+//--- globals ---
+
+const uint32_t BenchTime = 1000;     //ms per measurement
+const uint8_t TimerCounts[] = {1, 2, 4, 8, 16, 24, 32};
+
+volatile uint32_t Calls = 0;
+
+void OnTick()
+{
+  Calls++;
+}
+
+void OnLongTimer()
+{
+}
+
+//measure the average time of a run() in us
+//for n timers of the given service
+
+template <class Service> float measure(Service *service, uint8_t n)
+{
+  uint32_t spent = 0;
+  uint32_t ticks = 0;
+  uint32_t last;
+  uint32_t start;
+
+  service->init();
+  service->setInterval(1, OnTick);
+  for(uint8_t i = 1; i < n; i++)
+    service->setInterval(600000UL + i * 1000UL, OnLongTimer);
+
+  last = millis();
+  start = last;
+  while((millis() - start) < BenchTime)
+  {
+    //once per tick
+    if(millis() != last)
+    {
+      uint32_t t0 = micros();
+      service->run();
+      spent += micros() - t0;
+      ticks++;
+      last = millis();
+    }
+  }
+  return (float)spent / (float)ticks;
+}
+
+ISR_Timer LinearTimer;
+ISR_TimerWheel WheelTimer;
+
+void setup() {
+  // Debug Port
+  Serial.begin(500000);
+  while(!Serial)
+    ;
+
+  Serial.println("timers  linear[us]  wheel[us]");
+  
+  for(uint8_t i = 0; i < sizeof(TimerCounts); i++)
+  {
+    uint8_t n = TimerCounts[i];
+
+    Serial.print(n);
+    Serial.print("       ");
+    if(n <= ISR_Timer::MAX_TIMERS)
+      Serial.print(measure(&LinearTimer, n));
+    else
+      Serial.print(" --- ");
+    Serial.print("        ");
+    if(n <= ISR_TimerWheel::MAX_TIMERS)
+      Serial.println(measure(&WheelTimer, n));
+    else
+      Serial.println(" --- ");
+  }
+}
+
+void loop() {
+}
@@ -0,0 +1,23 @@
+#ifndef TICKLESS_SIM_ARDUINO_H
+#define TICKLESS_SIM_ARDUINO_H
+
+/*--------------------------------------------------------------
+ * Arduino.h
+ * the few calls of the Arduino core the MCTimer needs - driven by
+ * the simulated time of TicklessSim
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+extern uint64_t SimTimeUs;
+
+inline unsigned long millis() { return (unsigned long)(SimTimeUs / 1000); }
+inline unsigned long micros() { return (unsigned long)SimTimeUs; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+#endif
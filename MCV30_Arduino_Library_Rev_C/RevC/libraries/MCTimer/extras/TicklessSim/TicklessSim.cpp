@@ -0,0 +1,197 @@
+/*--------------------------------------------------------------
+ * TicklessSim.cpp
+ * host simulation of the MCTimer with a simulated HW timer to
+ * validate the scheduling of the tickless mode.
+ * Runs a typical load for SimDuration:
+ * - a 10ms and a 25ms interval for the cyclic tasks
+ * - a 1s one-shot
+ * - a protocol deadline of RespTimeOutUs armed by the loop for a
+ *   request every RequestPeriodUs - every second request gets its
+ *   response in time and the deadline is deleted again
+ * and reports the number of interrupts and how late the timers
+ * are called. Fails if any timer is called early or if in tickless
+ * mode any timer is later than two ticks of the wheel.
+ *
+ * build and run from this folder - periodic 10ms HW timer:
+ *   g++ -DARDUINO=100 -I. -I../.. TicklessSim.cpp ../../MCTimer.cpp
+ *       ../../ISR_TimerWheel.cpp -o sim_ticked && ./sim_ticked
+ * tickless with a 100us wheel:
+ *   g++ -DARDUINO=100 -DMCTIMER_TICKLESS -DISR_TIMERWHEEL_TICK_US=100
+ *       -I. -I../.. TicklessSim.cpp ../../MCTimer.cpp
+ *       ../../ISR_TimerWheel.cpp -o sim_tickless && ./sim_tickless
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <Arduino.h>
+#include <TimerOne.h>
+#include <MCTimer.h>
+#include <stdio.h>
+
+//--- globals ---
+
+uint64_t SimTimeUs = 0;
+TimerOne Timer1;
+
+extern MCTimer OsTimer;
+
+const uint64_t SimDuration = 2000000ULL;	//us
+const unsigned long RequestPeriodUs = 7000;
+const unsigned long RespTimeOutUs = 1500;
+const unsigned long RespDelayUs = 400;
+
+#ifdef ISR_TIMERWHEEL_TICK_US
+const unsigned long MaxLateUs = 2 * ISR_TIMERWHEEL_TICK_US;
+#else
+const unsigned long MaxLateUs = 0;		//not checked
+#endif
+
+typedef struct SimRecord {
+	const char *Name;
+	uint64_t DueAt;
+	unsigned long PeriodUs;
+	unsigned long Calls;
+	unsigned long Early;
+	uint64_t LateSum;
+	uint64_t LateMax;
+	bool isArmed;
+	int Handle;
+} SimRecord;
+
+SimRecord Cyclic10 = {"interval 10ms", 0, 10000};
+SimRecord Cyclic25 = {"interval 25ms", 0, 25000};
+SimRecord OneShot = {"timeout 1s", 0, 0};
+SimRecord Deadline = {"deadline 1.5ms", 0, 0};
+
+unsigned long Requests = 0;
+unsigned long Responses = 0;
+unsigned long Blocked = 0;
+
+//--- implementation ---
+
+//called by the TimerService - check against the due time
+//and move the due time on for an interval
+
+static void OnTimer(void *p)
+{
+	SimRecord *Record = (SimRecord *)p;
+
+	if(SimTimeUs < Record->DueAt)
+		Record->Early++;
+	else
+	{
+		uint64_t late = SimTimeUs - Record->DueAt;
+
+		Record->LateSum += late;
+		if(late > Record->LateMax)
+			Record->LateMax = late;
+	}
+	Record->Calls++;
+	Record->isArmed = false;
+
+	if(Record->PeriodUs)
+		Record->DueAt += Record->PeriodUs;
+}
+
+//the loop sends a request and arms its deadline
+//like the SDOHandler it waits for the deadline of the last one
+
+static bool SendRequest()
+{
+	if(Deadline.isArmed)
+	{
+		Blocked++;
+		return false;
+	}
+	Requests++;
+	Deadline.DueAt = SimTimeUs + RespTimeOutUs;
+	Deadline.isArmed = true;
+	Deadline.Handle = OsTimer.TimerService.setTimeoutMicros(RespTimeOutUs, OnTimer, &Deadline);
+	return true;
+}
+
+//the response of every second request is in time
+
+static void ReceiveResponse()
+{
+	if(Deadline.isArmed)
+	{
+		OsTimer.TimerService.deleteTimer(Deadline.Handle);
+		Deadline.isArmed = false;
+		Responses++;
+	}
+}
+
+static void report(SimRecord *Record, bool *isOk)
+{
+	printf("%-16s calls %6lu early %lu late avg %6lu max %6lu us\n",
+		Record->Name, Record->Calls, Record->Early,
+		Record->Calls ? (unsigned long)(Record->LateSum / Record->Calls) : 0UL,
+		(unsigned long)Record->LateMax);
+
+	if(Record->Early > 0)
+		*isOk = false;
+	if(MaxLateUs && (Record->LateMax > MaxLateUs))
+		*isOk = false;
+}
+
+int main()
+{
+	bool isOk = true;
+
+	Cyclic10.DueAt = SimTimeUs + Cyclic10.PeriodUs;
+	OsTimer.TimerService.setInterval(10, OnTimer, &Cyclic10);
+	Cyclic25.DueAt = SimTimeUs + Cyclic25.PeriodUs;
+	OsTimer.TimerService.setInterval(25, OnTimer, &Cyclic25);
+	OneShot.DueAt = SimTimeUs + 1000000ULL;
+	OsTimer.TimerService.setTimeout(1000, OnTimer, &OneShot);
+
+	uint64_t RequestAt = RequestPeriodUs / 2;
+	uint64_t ResponseAt = SimDuration;
+
+	while(SimTimeUs < SimDuration)
+	{
+		//next event of the loop or of the HW timer
+		uint64_t LoopAt = (ResponseAt < RequestAt) ? ResponseAt : RequestAt;
+		bool isInterrupt = Timer1.isEnabled && (Timer1.NextAt <= LoopAt);
+
+		SimTimeUs = isInterrupt ? Timer1.NextAt : LoopAt;
+
+		if(isInterrupt)
+		{
+			Timer1.NextAt += Timer1.PeriodUs;
+			Timer1.Isr();
+		}
+		else if(LoopAt == ResponseAt)
+		{
+			ReceiveResponse();
+			ResponseAt = SimDuration;
+		}
+		else
+		{
+			if(SendRequest() && (Requests & 1))
+				ResponseAt = SimTimeUs + RespDelayUs;
+			RequestAt += RequestPeriodUs;
+		}
+	}
+
+	#ifdef MCTIMER_TICKLESS
+	printf("tickless, wheel tick %lu us - a periodic HW timer of the same resolution needs %lu interrupts\n",
+		TimerWheelUsPerTick, (unsigned long)(SimDuration / TimerWheelUsPerTick));
+	#else
+	printf("periodic HW timer %u ms, wheel tick %lu us\n", defaultPeriodms, TimerWheelUsPerTick);
+	#endif
+	printf("interrupts %lu in %lu ms, requests %lu answered %lu blocked %lu\n",
+		OsTimer.GetWakeUps(), (unsigned long)(SimDuration / 1000), Requests, Responses, Blocked);
+
+	report(&Cyclic10, &isOk);
+	report(&Cyclic25, &isOk);
+	report(&OneShot, &isOk);
+	report(&Deadline, &isOk);
+
+	printf(isOk ? "OK\n" : "FAILED\n");
+	return isOk ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+#ifndef TICKLESS_SIM_TIMERONE_H
+#define TICKLESS_SIM_TIMERONE_H
+
+/*--------------------------------------------------------------
+ * TimerOne.h
+ * simulated HW timer with the API of the TimerOne used by MCTimer
+ * The timer is periodic like the real one - TicklessSim calls the
+ * ISR at NextAt and advances NextAt by the period.
+ * No constructor so it is ready before the static OsTimer is.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+#include <Arduino.h>
+
+class TimerOne {
+	public:
+		void initialize(unsigned long us = 1000000UL) { PeriodUs = us; };
+		void setPeriod(unsigned long us) { PeriodUs = us; };
+		void start() { isEnabled = true; NextAt = SimTimeUs + PeriodUs; };
+		void stop() { isEnabled = false; };
+		void attachInterrupt(void (*isr)()) { Isr = isr; };
+		void attachInterrupt(void (*isr)(), unsigned long us) {
+			Isr = isr;
+			setPeriod(us);
+			start();
+		};
+		
+		bool isEnabled;
+		unsigned long PeriodUs;
+		uint64_t NextAt;
+		void (*Isr)();
+};
+
+extern TimerOne Timer1;
+
+#endif
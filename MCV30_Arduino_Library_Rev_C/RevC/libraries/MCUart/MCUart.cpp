@@ -1,6 +1,7 @@
 //---------------------------------------------------------------------
 // MCUart.cpp
 // 2021-04-21 removed reference to any timer service
+// 2026-10-18 the port can be attached - Serial1 by default
 
 //---------------------------------------------------------------------
 //  includes
@@ -46,6 +47,42 @@ MCUart::MCUart()
 	rxIdx = 0;
 	rxSize = 0;
 	state = eUartNotReady;
+	DeadlineQueue::InitDeadline(&RxDeadline,MCUart::OnDeadlineCb,(void *)this);
+}
+
+/*----------------------------------------------------------
+ * AttachDeadlines(DeadlineQueue *Queue)
+ * the queue the time-out of a frame is armed at
+ * has to be attached before Update() is called
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * ---------------------------------------------------------*/
+
+void MCUart::AttachDeadlines(DeadlineQueue *Queue)
+{
+	Deadlines = Queue;
+}
+
+/*----------------------------------------------------------
+ * AttachPort(HardwareSerial *NewPort)
+ * the serial port the frames are sent and received at
+ * to be attached before Open() - e.g. Serial2 on a board with
+ * more than one UART or a POSIX port on a host
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * ---------------------------------------------------------*/
+
+void MCUart::AttachPort(HardwareSerial *NewPort)
+{
+	if(NewPort != NULL)
+		Port = NewPort;
+}
+
+HardwareSerial *MCUart::GetPort()
+{
+	return Port;
 }
 
 /*----------------------------------------------------------
@@ -54,6 +91,7 @@ MCUart::MCUart()
  * 
  * 2020-05-15 AW Frame
  * 2020-11-18    Done
+ * 2026-10-18    settle time by MCUART_SETTLE_TIME
  * 
  * ---------------------------------------------------------*/
  void MCUart::Open(uint32_t baud = 115200)
@@ -67,15 +105,15 @@ MCUart::MCUart()
 	Serial.println(BaudRate, DEC);
 	#endif
 
-	Serial1.begin(BaudRate);
+	Port->begin(BaudRate);
 
-	while(!Serial1)
+	while(!(*Port))
 		;
 	//Serial 1 seems to need some additional time to be really ready
-	delay(1000);
+	delay(MCUART_SETTLE_TIME);
 	for(uint16_t i = 0; i < 10;i++)
-		Serial1.write((uint8_t)0);
-	Serial1.flush();
+		Port->write((uint8_t)0);
+	Port->flush();
 	state = eUartOperating;
 }
 
@@ -94,11 +132,11 @@ MCUart::MCUart()
 	rxIdx = 0;
 	rxSize = 0;
 	
-	Serial1.flush();
-	Serial1.end();
+	Port->flush();
+	Port->end();
 	state = eUartNotReady;
 
-	Serial1.begin(BaudRate);
+	Port->begin(BaudRate);
 	state = eUartOperating;
 }
 
@@ -116,15 +154,20 @@ void MCUart::ResetUart()
 	rxIdx = 0;
 	rxSize = 0;
 	state = eUartOperating;
+	if(Deadlines != NULL)
+		Deadlines->Cancel(&RxDeadline);
 }
 
 /*----------------------------------------------------------
  * Update()
  * is to be called in each cycle an will collect the Rx data
+ * the time-out of a frame is armed at the DeadlineQueue
  * 
  * 2020-05-13 AW Frame
  * 2020-11-18    Rev_A
  * 2021-04-21    Removed reference to timer
+ * 2026-10-18    time-out by the DeadlineQueue
+ * 2026-10-18    w/o a DeadlineQueue attached there is no time-out
  * 
  * ---------------------------------------------------------*/
  
@@ -134,22 +177,17 @@ void MCUart::ResetUart()
 
 	if(state == eUartOperating)
 	{
-		while(Serial1.available())
+		while(Port->available())
 		{
 			//read the first char
-			uint8_t inChar = (uint8_t)Serial1.read();
+			uint8_t inChar = (uint8_t)Port->read();
 			//now add it to the buffer if applicable
 			if(rxIdx < UART_MAX_MSG_SIZE)
 			{
 				if(rxIdx == 0)
 				{
 					rxSize = UART_MIN_MSG_SIZE;
-					if(inChar ==  MsgPrefix)
-					{
-						To_Threshold = actTime + MsgTimeout;
-						isTimerActive = true;
-					}
-					else
+					if(inChar !=  MsgPrefix)
 						store = false;
 				}
 				else if (rxIdx == 1)
@@ -164,7 +202,8 @@ void MCUart::ResetUart()
 					Serial.print(">");
 					Serial.print(inChar, HEX);
 					#endif
-					To_Threshold = actTime + MsgTimeout;
+					if(Deadlines != NULL)
+						Deadlines->Arm(&RxDeadline, actTime + MsgTimeout);
 					
 					RxMsg.u8Data[rxIdx++] = inChar;
 					//check for finished
@@ -173,7 +212,8 @@ void MCUart::ResetUart()
 					  //all characters received
 					  rxIdx = 0;
 					  
-					  isTimerActive = false;
+					  if(Deadlines != NULL)
+						  Deadlines->Cancel(&RxDeadline);
 
 					  if(inChar == MsgSuffix)
 					  {
@@ -203,28 +243,6 @@ void MCUart::ResetUart()
 				rxSize = 0;
 			}
 		}
-		
-		if((isTimerActive) && (To_Threshold < actTime))	
-		{	
-			OnTimeOut();
-			isTimerActive = false;
-			//once again set a time-out which has to elaps before new
-			//messages are to be handeled
-			To_Threshold = actTime + MsgTimeout;
-			state = eUartTimeout;
-		}
-	}
-	else
-	{
-		//we are in TO state
-		if(To_Threshold < actTime)
-		{
-			#if(DEBUG_UART & DEBUG_TO)
-			Serial.print("UART: revocered from TO!");
-			#endif
-			//elapsed
-			state = eUartOperating;
-		}
 	}
  }
 
@@ -256,7 +274,7 @@ void MCUart::Register_OnRxCb(pfunction_holder *Cb)
 
 short MCUart::CheckStatus()
 {
-	return Serial1.availableForWrite();	
+	return Port->availableForWrite();	
 }
 
 /*----------------------------------------------------------
@@ -276,7 +294,7 @@ bool status = false;
 
 	uint8_t len = Msg->Hdr.u8Len + 2;
 
-	if((len <= Serial1.availableForWrite()) && (state == eUartOperating))
+	if((len <= Port->availableForWrite()) && (state == eUartOperating))
 	{		 
 		status = true;
 		
@@ -302,7 +320,7 @@ bool status = false;
 		Serial.println("#");
 		#endif
 		
-		Serial1.write((char *)(TxMsg.u8Data),TxMsg.Hdr.u8Len +2);
+		Port->write((char *)(TxMsg.u8Data),TxMsg.Hdr.u8Len +2);
 	}
 	#if(DEBUG_UART & DEBUG_TXFRAME)
 	else
@@ -341,3 +359,32 @@ void MCUart::OnTimeOut()
 	Serial.println("UART TO");
 	#endif
 }
+
+/*----------------------------------------------------------
+ * OnDeadline(uint32_t actTime)
+ * called by the DeadlineQueue when the time-out of a frame has
+ * elapsed. Drop the frame and wait once again for a time-out 
+ * to elapse before new messages are handled.
+ * The second call does end the TO state.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+void MCUart::OnDeadline(uint32_t actTime)
+{
+	if(state == eUartOperating)
+	{
+		OnTimeOut();
+		state = eUartTimeout;
+		if(Deadlines != NULL)
+			Deadlines->Arm(&RxDeadline, actTime + MsgTimeout);
+	}
+	else if(state == eUartTimeout)
+	{
+		#if(DEBUG_UART & DEBUG_TO)
+		Serial.print("UART: revocered from TO!");
+		#endif
+		state = eUartOperating;
+	}
+}
@@ -5,6 +5,7 @@
  * MCUart.h
  *
  * 2021-04-21 removed reference to any timer service
+ * 2026-10-18 the port can be attached - Serial1 by default
  *
  * ------------------------------------------------------------------*/
 
@@ -12,6 +13,7 @@
 //  includes
 
 #include <MC_Helpers.h>
+#include <MCDeadlines.h>
 #include <stdint.h>
 
 //---------------------------------------------------------------------
@@ -21,6 +23,12 @@
 const unsigned int UART_MAX_MSG_SIZE = 64;
 const unsigned int UART_MIN_MSG_SIZE = 6;
 
+//time the port is given after being opened in ms
+//can be raised by a build flag e.g. -DMCUART_SETTLE_TIME=2000
+#ifndef MCUART_SETTLE_TIME
+#define MCUART_SETTLE_TIME 1000
+#endif
+
 typedef struct __attribute__((packed)) UART_MsgHdr {
    uint8_t u8Prefix  : 8;
    uint8_t u8Len     : 8;
@@ -57,9 +65,14 @@ class MCUart
 		void Stop();
 		void Start(uint32_t baud = 115200);
 		void ResetUart();
+		void AttachDeadlines(DeadlineQueue *);
+		void AttachPort(HardwareSerial *);
+		HardwareSerial *GetPort();
 		
-		static void OnTimeOutCb(void *p) {
-			((MCUart *)p)->OnTimeOut();
+		//handler to be armed at the DeadlineQueue
+		static void *OnDeadlineCb(void *op, void *p) {
+			((MCUart *)op)->OnDeadline(*(uint32_t *)p);
+			return NULL;
 		};
 	
 	private:
@@ -72,11 +85,13 @@ class MCUart
 		UART_Msg RxMsg;
 		UART_Msg TxMsg;
 		
+		HardwareSerial *Port = &Serial1;
 		pfunction_holder OnRxCb;
 	
 		void OnTimeOut();
-		uint32_t To_Threshold;
-		bool isTimerActive = false;
+		void OnDeadline(uint32_t);
+		DeadlineQueue *Deadlines = NULL;
+		MCDeadline RxDeadline;
 		UartStates state;
 };
 
@@ -18,6 +18,7 @@
 #define DEBUG_REGNODE	0x0002
 #define DEBUG_TXMSG		0x0004
 #define DEBUG_ULCK      0x0008
+#define DEBUG_SCAN      0x0010
 
 //--- definitions ---
 
@@ -25,6 +26,20 @@
 
 const uint16_t MsgHandlerMaxLeaseTime = 20;
 
+//SDO read request as used by the bus scan
+typedef struct __attribute__((packed)) ScanReqMsg {
+   uint8_t u8Prefix  : 8;
+   uint8_t u8Len     : 8;
+   uint8_t u8NodeNr  : 8;
+   MCMsgCommands u8Cmd : 8;
+   uint16_t Idx;
+   uint8_t SubIdx;
+   uint8_t CRC;
+   uint8_t u8Suffix;
+} ScanReqMsg;
+
+const uint8_t ScanSlotFree = 0;
+
 
 //--- implementation ---
 
@@ -44,11 +59,14 @@ MsgHandler::MsgHandler()
 	Cb.callback = (pfunction_pointer_t)MsgHandler::OnMsgRxCb;
 	Cb.op = (void *)this;
 	Uart.Register_OnRxCb(&Cb);
+	Uart.AttachDeadlines(&Deadlines);
+	DeadlineQueue::InitDeadline(&LockDeadline,MsgHandler::OnLockDeadlineCb,(void *)this);
 	//now set default values for no node regsitered
 	for(int16_t i = 0; i < MsgHandler_MaxNodes;i++)
 	{
 		nodeId[i] = invalidNodeId;
 		TxMsgPending[i] = false;
+		RxAt[i] = 0;
 		OnRxSDOCb[i].callback = NULL;
 		OnRxSysCb[i].callback = NULL;
 	}
@@ -68,14 +86,32 @@ void MsgHandler::Open(uint32_t baudrate)
 	Uart.Open(baudrate);	
 }
 
+/*------------------------------------------------------
+ * AttachPort(HardwareSerial *Port)
+ * the serial port of this bus - to be called before Open()
+ * w/o it's Serial1
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+ 
+void MsgHandler::AttachPort(HardwareSerial *Port)
+{
+	Uart.AttachPort(Port);
+}
+
 /*------------------------------------------------------
  * Update()
  * needed to call the Update of the underlying Uart as there
  * is no real interrupt driven Rx or Tx here
  * If the Msghandler has been locked for a too long time
  * it will e unlocked here to give the system a chance to recover
+ * A running bus scan is advanced here too and does keep the lock.
+ * The due deadlines of the DeadlineQueue are called last.
  * 
  * 2020-05-15 AW Rev A
+ * 2026-10-18 AW bus scan
+ * 2026-10-18 AW DeadlineQueue
  * 
  * ----------------------------------------------------*/
  
@@ -84,13 +120,16 @@ void MsgHandler::Update(uint32_t timeNow)
 	actTime = timeNow;
 	Uart.Update(actTime);
 	
-	if(isLocked && (actTime - lockTime > MsgHandlerMaxLeaseTime))
+	if(ScanState == eScanRunning)
 	{
-		UnLockHandler();
-		#if(DEBUG_MSGHandler & DEBUG_ULCK)
-		Serial.println("Msg: unlocked");
-		#endif
+		UpdateScan();
+		//renew the lease
+		if(isLocked)
+			Deadlines.Arm(&LockDeadline, actTime + MsgHandlerMaxLeaseTime + 1);
 	}
+	
+	//all the time-outs registered which are due
+	Deadlines.Run(actTime);
 }
 
 /*------------------------------------------------------
@@ -126,13 +165,32 @@ bool MsgHandler::LockHandler()
 	else
 	{
 		isLocked = true;
-		lockTime = actTime;
+		LockGrants++;
+		Deadlines.Arm(&LockDeadline, actTime + MsgHandlerMaxLeaseTime + 1);
 	}	
 	return true;
 
 }
 
 
+/*------------------------------------------------------
+ * LockHandler(uint16_t *Grant)
+ * same as LockHandler() but hands out the number of the grant.
+ * A holder which keeps it can renew its lease and can't unlock
+ * the lock of someone else once its own lease has expired.
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+bool MsgHandler::LockHandler(uint16_t *Grant)
+{
+	if(!LockHandler())
+		return false;
+		
+	*Grant = LockGrants;
+	return true;
+}
+
 /*------------------------------------------------------
  * UnLockHandler()
  * unlock the handler - to allow for others to access it
@@ -144,6 +202,116 @@ bool MsgHandler::LockHandler()
 void MsgHandler::UnLockHandler()
 {
 	isLocked = false;
+	Deadlines.Cancel(&LockDeadline);
+}
+
+/*------------------------------------------------------
+ * UnLockHandler(uint16_t Grant)
+ * unlock the handler if it's still locked by this grant
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+void MsgHandler::UnLockHandler(uint16_t Grant)
+{
+	if(HasLock(Grant))
+		UnLockHandler();
+}
+
+/*------------------------------------------------------
+ * RenewLease(uint16_t Grant)
+ * re-arm the lease for a holder which is still busy - e.g. a
+ * batch of SDOs running longer than MsgHandlerMaxLeaseTime
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+void MsgHandler::RenewLease(uint16_t Grant)
+{
+	if(HasLock(Grant))
+		Deadlines.Arm(&LockDeadline, actTime + MsgHandlerMaxLeaseTime + 1);
+}
+
+/*------------------------------------------------------
+ * HasLock(uint16_t Grant)
+ * false once the lease of the grant has expired or the lock
+ * has been released
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+bool MsgHandler::HasLock(uint16_t Grant)
+{
+	return isLocked && (LockGrants == Grant);
+}
+
+/*------------------------------------------------------
+ * IsLocked()
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+bool MsgHandler::IsLocked()
+{
+	return isLocked;
+}
+
+/*------------------------------------------------------
+ * GetLockGrants()
+ * number of times the lock has been granted - wraps around
+ * can be compared before and after a call to see whether the
+ * lock has been granted in between
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+uint16_t MsgHandler::GetLockGrants()
+{
+	return LockGrants;
+}
+
+/*------------------------------------------------------
+ * GetDeadlines()
+ * the queue the time-outs of the Uart, the lock and the
+ * nodes using this MsgHandler are armed at. It is run by
+ * Update(), so the time-outs are checked once per cycle
+ * no matter how many nodes there are.
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+DeadlineQueue *MsgHandler::GetDeadlines()
+{
+	return &Deadlines;
+}
+
+/*------------------------------------------------------
+ * GetTime()
+ * the time of the last Update(). It's the time base of all
+ * the nodes and drives using this MsgHandler - they take it
+ * from here instead of being given it in every cycle.
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+uint32_t MsgHandler::GetTime()
+{
+	return actTime;
+}
+
+/*------------------------------------------------------
+ * OnLeaseExpired()
+ * the lock has been held for longer than the lease
+ * 
+ * 2026-10-18 AW Rev A
+ * 
+ * ----------------------------------------------------*/
+void MsgHandler::OnLeaseExpired()
+{
+	UnLockHandler();
+	#if(DEBUG_MSGHandler & DEBUG_ULCK)
+	Serial.println("Msg: unlocked");
+	#endif
 }
 
 
@@ -152,8 +320,11 @@ void MsgHandler::UnLockHandler()
  * react to a received Msg
  * first check the CRC. If valid use a switch case
  * to call the registered handler
+ * The time of any valid Msg is stored per node to allow
+ * for a liveness check.
  * 
  * 2020-05-15 AW Rev A
+ * 2026-10-18 AW store Rx time per node
  * 
  * ----------------------------------------------------*/
  
@@ -161,10 +332,16 @@ void MsgHandler::OnRxHandler(MCMsg *RxMsg)
 {
 uint8_t NodeHandle = FindNode(RxMsg->Hdr.u8NodeNr);
 
+	//responses to a bus scan are consumed here
+	if((ScanState == eScanRunning) && OnScanRx(RxMsg))
+		return;
+
 	if((NodeHandle < MsgHandler_MaxNodes) && (NodeHandle != InvalidSlot) && IsCrcOk((UART_Msg *)RxMsg))
 	{
 		MCMsgCommands cmd = RxMsg->Hdr.u8Cmd;
 		
+		RxAt[NodeHandle] = actTime;
+		
 		switch(cmd)
 		{
 			case eBootMsg:
@@ -283,6 +460,22 @@ int8_t thisNodeId = -1;
 }
 		
 
+/*----------------------------------------------------------
+ *  uint32_t MsgHandler::GetLastRxTime(uint8_t)
+ *  time any valid Msg has been received last from this node
+ *  is 0 if nothing has been received so far
+ * 
+ * 2026-10-18 AW
+ * ----------------------------------------------------------*/ 
+
+uint32_t MsgHandler::GetLastRxTime(uint8_t NodeHandle)
+{
+	if(NodeHandle < MsgHandler_MaxNodes)
+		return RxAt[NodeHandle];
+	else
+		return 0;
+}
+
 /*----------------------------------------------------------
  * void UnRegisterNode(char)
  * remove the entry for a given node
@@ -373,6 +566,272 @@ bool MsgHandler::SendMsg(uint8_t NodeHandle, MCMsg *NewTxMsg)
 	return returnValue;
 }
 
+/*----------------------------------------------------------
+ * SendRawMsg(uint8_t NodeId, UART_Msg *TxMsg)
+ * send a Msg to a node which doesn't need to be registered
+ * no buffering if the Uart is busy
+ * TxMsg has to be a full UART_Msg - the CRC is appended in place
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW takes a UART_Msg
+ * 
+ * --------------------------------------------------------*/
+
+bool MsgHandler::SendRawMsg(uint8_t NodeId, UART_Msg *ThisMsg)
+{
+	ThisMsg->Hdr.u8NodeNr = NodeId;
+	ThisMsg->u8Data[ThisMsg->Hdr.u8Len] = CalcCRC((const uint8_t *)&(ThisMsg->u8Data[1]), ThisMsg->Hdr.u8Len-1);
+
+	return Uart.WriteMsg(ThisMsg);
+}
+
+/*----------------------------------------------------------
+ * bool StartScan(uint8_t firstId, uint8_t lastId, bool autoRegister)
+ * start a scan for the nodes in the range firstId .. lastId
+ * Each node is probed by reading its device type 0x1000.00.
+ * Up to ScanWindow probes are sent without waiting for the responses,
+ * a probe without response is dropped after ScanTimeOut.
+ * The scan is advanced by Update() and will keep the MsgHandler locked
+ * until it is finished. Nodes found can be registered automatically
+ * as long as there are free slots.
+ * In net mode all nodes share the line - use a ScanWindow of 1 if
+ * the responses of different nodes collide.
+ * Returns false if the MsgHandler is locked by someone else.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+bool MsgHandler::StartScan(uint8_t firstId, uint8_t lastId, bool autoRegister)
+{
+	if((ScanState == eScanRunning) || !LockHandler())
+		return false;
+	
+	ScanNextId = firstId;
+	ScanLastId = lastId;
+	ScanAutoRegister = autoRegister;
+	ScanCount = 0;
+	
+	for(uint8_t i = 0; i < MsgHandler_MaxScanWindow; i++)
+		ScanSlotId[i] = ScanSlotFree;
+	
+	//node 0 is the broadcast address and never probed
+	if(ScanNextId == 0)
+		ScanNextId = 1;
+	
+	ScanState = eScanRunning;
+	
+	#if(DEBUG_MSGHandler & DEBUG_SCAN)
+	Serial.print("Msg: Scan ");
+	Serial.print(firstId, DEC);
+	Serial.print("..");
+	Serial.println(lastId, DEC);
+	#endif
+	
+	return true;
+}
+
+/*----------------------------------------------------------
+ * void SetScanTiming(uint8_t window, uint16_t timeOut)
+ * window:  number of probes sent without waiting for responses
+ * timeOut: time in ms to wait for the response of a single probe
+ * ignored while a scan is running
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+void MsgHandler::SetScanTiming(uint8_t window, uint16_t timeOut)
+{
+	if(ScanState == eScanRunning)
+		return;
+	
+	if(window > MsgHandler_MaxScanWindow)
+		window = MsgHandler_MaxScanWindow;
+	if(window == 0)
+		window = 1;
+	
+	ScanWindow = window;
+	ScanTimeOut = timeOut;
+}
+
+/*----------------------------------------------------------
+ * MCScanStates GetScanState()
+ * eScanRunning while the scan is active, eScanDone when finished
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+MCScanStates MsgHandler::GetScanState()
+{
+	return ScanState;
+}
+
+/*----------------------------------------------------------
+ * uint8_t GetScanCount()
+ * number of nodes which responded to the last scan
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+uint8_t MsgHandler::GetScanCount()
+{
+	return ScanCount;
+}
+
+/*----------------------------------------------------------
+ * bool GetScanResult(uint8_t idx, MCScanResult *Result)
+ * copy the NodeId and device type of a node found by the scan
+ * A node responding with an SDO error is reported with 
+ * DeviceType 0.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+bool MsgHandler::GetScanResult(uint8_t idx, MCScanResult *Result)
+{
+	if(idx >= ScanCount)
+		return false;
+	
+	*Result = ScanResults[idx];
+	return true;
+}
+
+/*----------------------------------------------------------
+ * void UpdateScan()
+ * drop timed out probes and send new ones as long as the window
+ * is not filled. Finish the scan when all are done
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+void MsgHandler::UpdateScan()
+{
+bool isPending = false;
+bool isUartReady = true;
+
+	for(uint8_t i = 0; i < ScanWindow; i++)
+	{
+		if(ScanSlotId[i] != ScanSlotFree)
+		{
+			if((actTime - ScanSlotSentAt[i]) > ScanTimeOut)
+				ScanSlotId[i] = ScanSlotFree;
+		}
+		
+		if((ScanSlotId[i] == ScanSlotFree) && isUartReady && (ScanNextId <= ScanLastId) && (ScanNextId != 0))
+		{
+			//built in a full size buffer as the CRC is appended in place
+			UART_Msg ProbeMsg;
+			ScanReqMsg *Probe = (ScanReqMsg *)&ProbeMsg;
+			
+			Probe->u8Len = 7;
+			Probe->u8Cmd = eSdoReadReq;
+			Probe->Idx = ScanObjIdx;
+			Probe->SubIdx = 0;
+			
+			if(SendRawMsg(ScanNextId, &ProbeMsg))
+			{
+				ScanSlotId[i] = ScanNextId;
+				ScanSlotSentAt[i] = actTime;
+				//will wrap to 0 after 255 which stops the scan too
+				ScanNextId++;
+			}
+			else
+				isUartReady = false;
+		}
+		
+		if(ScanSlotId[i] != ScanSlotFree)
+			isPending = true;
+	}
+	
+	if(!isPending && ((ScanNextId > ScanLastId) || (ScanNextId == 0)))
+		FinishScan();
+}
+
+/*----------------------------------------------------------
+ * bool OnScanRx(MCMsg *)
+ * check whether a received Msg is the response to a probe
+ * and store the result if so
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+bool MsgHandler::OnScanRx(MCMsg *RxMsg)
+{
+	UART_Msg *Raw = (UART_Msg *)RxMsg;
+	MCMsgCommands cmd = RxMsg->Hdr.u8Cmd;
+	uint16_t Idx = (uint16_t)Raw->u8Data[4] + ((uint16_t)Raw->u8Data[5] << 8);
+	
+	if(((cmd != eSdoReadReq) && (cmd != eSdoError)) || (Idx != ScanObjIdx) || !IsCrcOk(Raw))
+		return false;
+	
+	for(uint8_t i = 0; i < ScanWindow; i++)
+	{
+		if((ScanSlotId[i] != ScanSlotFree) && (ScanSlotId[i] == RxMsg->Hdr.u8NodeNr))
+		{
+			ScanSlotId[i] = ScanSlotFree;
+			
+			if(ScanCount < MsgHandler_MaxScanResults)
+			{
+				uint32_t DeviceType = 0;
+				
+				if((cmd == eSdoReadReq) && (RxMsg->Hdr.u8Len >= 11))
+					DeviceType = ( ((uint32_t)(Raw->u8Data[10]) << 24) + 
+								   ((uint32_t)(Raw->u8Data[9]) << 16) +
+								   ((uint32_t)(Raw->u8Data[8]) <<  8) +
+									(uint32_t)Raw->u8Data[7]             );
+				
+				ScanResults[ScanCount].NodeId = RxMsg->Hdr.u8NodeNr;
+				ScanResults[ScanCount].DeviceType = DeviceType;
+				ScanCount++;
+			}
+			
+			#if(DEBUG_MSGHandler & DEBUG_SCAN)
+			Serial.print("Msg: Scan found ");
+			Serial.println(RxMsg->Hdr.u8NodeNr, DEC);
+			#endif
+			
+			return true;
+		}
+	}
+	return false;
+}
+
+/*----------------------------------------------------------
+ * void FinishScan()
+ * register the nodes found if requested and release the lock
+ * 
+ * 2026-10-18 AW Rev_A
+ * 
+ * --------------------------------------------------------*/
+
+void MsgHandler::FinishScan()
+{
+	if(ScanAutoRegister)
+	{
+		for(uint8_t i = 0; i < ScanCount; i++)
+		{
+			if(FindNode(ScanResults[i].NodeId) == InvalidSlot)
+			{
+				if(RegisterNode(ScanResults[i].NodeId) == InvalidSlot)
+					break;
+			}
+		}
+	}
+	ScanState = eScanDone;
+	UnLockHandler();
+	
+	#if(DEBUG_MSGHandler & DEBUG_SCAN)
+	Serial.print("Msg: Scan done ");
+	Serial.println(ScanCount, DEC);
+	#endif
+}
+
 /*----------------------------------------------------------
  * Register_onRxCb(function_holder *cb)
  * store the function and object pointer for the callback
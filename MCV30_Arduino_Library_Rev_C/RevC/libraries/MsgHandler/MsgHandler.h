@@ -41,48 +41,114 @@ typedef union MCMsg {
    UART_Msg Raw;
 } MCMsg;
 
-const uint8_t MsgHandler_MaxNodes = 4;
+//can be raised by a build flag e.g. -DMSGHANDLER_MAX_NODES=16
+#ifndef MSGHANDLER_MAX_NODES
+#define MSGHANDLER_MAX_NODES 4
+#endif
+
+const uint8_t MsgHandler_MaxNodes = MSGHANDLER_MAX_NODES;
 const int16_t invalidNodeId = -1;
 const uint8_t InvalidSlot = 0xff;
 
+//--- bus scan ---
+
+const uint8_t MsgHandler_MaxScanResults = 16;
+const uint8_t MsgHandler_MaxScanWindow = 8;
+const uint8_t ScanWindowDefault = 4;
+const uint16_t ScanTimeOutDefault = 5;
+const uint16_t ScanObjIdx = 0x1000;
+
+typedef enum MCScanStates {
+	eScanIdle,
+	eScanRunning,
+	eScanDone
+} MCScanStates;
+
+typedef struct MCScanResult {
+	uint8_t NodeId;
+	uint32_t DeviceType;
+} MCScanResult;
+
 
 class MsgHandler {
 	public:
 		MsgHandler();
 		void Open(uint32_t);
+		void AttachPort(HardwareSerial *);
 		void Update(uint32_t);
 		uint8_t RegisterNode(uint8_t);
 		void UnRegisterNode(uint8_t);
 		int8_t GetNodeId(uint8_t);
+		uint32_t GetLastRxTime(uint8_t);
 		bool SendMsg(uint8_t, MCMsg *);
 		void Register_OnRxSDOCb(uint8_t,pfunction_holder *);
 		void Register_OnRxSysCb(uint8_t,pfunction_holder *);
 		void ResetMsgHandler();
 		
+		bool StartScan(uint8_t, uint8_t, bool);
+		void SetScanTiming(uint8_t, uint16_t);
+		MCScanStates GetScanState();
+		uint8_t GetScanCount();
+		bool GetScanResult(uint8_t, MCScanResult *);
+		
 		bool LockHandler();
+		bool LockHandler(uint16_t *);
 		void UnLockHandler();
+		void UnLockHandler(uint16_t);
+		void RenewLease(uint16_t);
+		bool HasLock(uint16_t);
+		bool IsLocked();
+		uint16_t GetLockGrants();
+		
+		DeadlineQueue *GetDeadlines();
+		uint32_t GetTime();
 				
 		static void OnMsgRxCb(void *op,void *p) {
 			((MsgHandler *)op)->OnRxHandler((MCMsg *)p);
 		};
+		
+		//lease of the lock armed at the DeadlineQueue
+		static void *OnLockDeadlineCb(void *op, void *p) {
+			((MsgHandler *)op)->OnLeaseExpired();
+			return NULL;
+		};
 
 	private:
 		void OnRxHandler(MCMsg *);
 		uint8_t FindNode(uint8_t);
 		bool IsCrcOk(const UART_Msg *);
 		uint8_t CalcCRC(const uint8_t *,int);
+		bool SendRawMsg(uint8_t, UART_Msg *);
+		void UpdateScan();
+		bool OnScanRx(MCMsg *);
+		void FinishScan();
+		void OnLeaseExpired();
 		bool isLocked = false;
+		uint16_t LockGrants = 0;
 		
 		MCUart Uart;
+		DeadlineQueue Deadlines;
+		MCDeadline LockDeadline;
 		//a buffer to be used, if the interface is blocked
 		MCMsg TxMsg[MsgHandler_MaxNodes];
 		bool TxMsgPending[MsgHandler_MaxNodes];
 		int16_t nodeId[MsgHandler_MaxNodes];
 		pfunction_holder OnRxSDOCb[MsgHandler_MaxNodes];
 		pfunction_holder OnRxSysCb[MsgHandler_MaxNodes];	
+		uint32_t RxAt[MsgHandler_MaxNodes];
+		
+		uint32_t actTime = 0;
 		
-		uint32_t actTime;
-		uint32_t lockTime;
+		MCScanStates ScanState = eScanIdle;
+		bool ScanAutoRegister = false;
+		uint8_t ScanNextId;
+		uint8_t ScanLastId;
+		uint8_t ScanWindow = ScanWindowDefault;
+		uint16_t ScanTimeOut = ScanTimeOutDefault;
+		uint8_t ScanSlotId[MsgHandler_MaxScanWindow];
+		uint32_t ScanSlotSentAt[MsgHandler_MaxScanWindow];
+		uint8_t ScanCount = 0;
+		MCScanResult ScanResults[MsgHandler_MaxScanResults];
 };
 
 
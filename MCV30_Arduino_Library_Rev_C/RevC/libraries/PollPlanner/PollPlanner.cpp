@@ -0,0 +1,530 @@
+/*---------------------------------------------------
+ * PollPlanner.cpp
+ * implements the polling of drive objects at 
+ * individual rates
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+ 
+//--- includes ---
+
+#include <PollPlanner.h>
+
+//--- local defines ---
+
+#define DEBUG_PLAN		0x0001
+#define DEBUG_BATCH		0x0002
+#define DEBUG_ERROR		0x0004
+
+#define DEBUG_POLL (DEBUG_ERROR) 
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * PollPlanner()
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+PollPlanner::PollPlanner()
+{
+	SetLinkBaud(PollBaudDefault);
+}
+
+/*---------------------------------------------------------------------
+ * void SetLinkBaud(uint32_t baud)
+ * baud rate of the line - is used to estimate its capacity
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void PollPlanner::SetLinkBaud(uint32_t baud)
+{
+	if(baud == 0)
+		return;
+		
+	LinkBaud = baud;
+	//10 bits per byte
+	ObjectCost = ((uint32_t)(PollReqBytes + PollRespBytes) * 10 * 1000000UL) / LinkBaud;
+	Plan();
+}
+
+/*---------------------------------------------------------------------
+ * void SetLinkBudget(uint16_t budget)
+ * share of the line in permille the polling may use
+ * leave some for the commands and the latency of the drive
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void PollPlanner::SetLinkBudget(uint16_t budget)
+{
+	if((budget == 0) || (budget > 1000))
+		return;
+		
+	LinkBudget = budget;
+	Plan();
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t AddObject(MCDrive *Drive, uint16_t Idx, uint8_t SubIdx, 
+ *                   uint16_t Period, uint8_t Priority)
+ * add an object to be polled every Period ms
+ * Priority: higher is more important - the lower ones are degraded
+ * first if the line is overloaded
+ * returns the slot of the object or InvalidSlot
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t PollPlanner::AddObject(MCDrive *Drive, uint16_t Idx, uint8_t SubIdx, uint16_t Period, uint8_t Priority)
+{
+	if((ObjectCount >= PollPlannerMaxObjects) || (Period == 0))
+		return InvalidSlot;
+		
+	PollObject *Obj = &Object[ObjectCount];
+	
+	Obj->Drive = Drive;
+	Obj->Idx = Idx;
+	Obj->SubIdx = SubIdx;
+	Obj->Priority = Priority;
+	Obj->Period = Period;
+	Obj->Stretch = 0;
+	Obj->Release = actTime;
+	Obj->Value = 0;
+	Obj->TimeStamp = 0;
+	Obj->isValid = false;
+	Obj->hasChanged = false;
+	Obj->Misses = 0;
+	Obj->Failures = 0;
+	Obj->isDisabled = false;
+	
+	ObjectCount++;
+	Plan();
+	
+	return (ObjectCount - 1);
+}
+
+/*---------------------------------------------------------------------
+ * void Update(uint32_t time)
+ * to be called in every loop with millis()
+ * collects the response of the running batch or starts the next one
+ * The batch is run by AccessBatch() so an object rejected by the drive
+ * doesn't fail the others of the same batch.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW objects rejected one by one
+ *--------------------------------------------------------------------*/
+
+void PollPlanner::Update(uint32_t time)
+{
+	actTime = time;
+	
+	if(BatchCount == 0)
+		Dispatch();
+	
+	if(BatchCount == 0)
+		return;
+		
+	switch(BatchDrive->ThisNode.AccessBatch(BatchList, BatchCount))
+	{
+		case eDone:
+			OnBatchDone();
+			break;
+		case eError:
+		case eTimeout:
+			//no response - the objects stay due and are tried again
+			Errors++;
+			BatchCount = 0;
+			
+			#if(DEBUG_POLL & DEBUG_ERROR)
+			Serial.println("Poll: batch failed");
+			#endif
+			break;
+		default:
+			break;
+	}
+}
+
+/*---------------------------------------------------------------------
+ * bool GetValue(uint8_t slot, uint32_t *Value)
+ * latest value of an object - false if not received yet
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool PollPlanner::GetValue(uint8_t slot, uint32_t *Value)
+{
+	if((slot >= ObjectCount) || !Object[slot].isValid)
+		return false;
+		
+	*Value = Object[slot].Value;
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t GetTimeStamp(uint8_t slot)
+ * time the value of an object has been received
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t PollPlanner::GetTimeStamp(uint8_t slot)
+{
+	if(slot >= ObjectCount)
+		return 0;
+	return Object[slot].TimeStamp;
+}
+
+/*---------------------------------------------------------------------
+ * bool HasChanged(uint8_t slot)
+ * check whether a different value has been received
+ * reading the flag does reset it
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool PollPlanner::HasChanged(uint8_t slot)
+{
+	if(slot >= ObjectCount)
+		return false;
+	
+	bool retValue = Object[slot].hasChanged;
+	Object[slot].hasChanged = false;
+	
+	return retValue;
+}
+
+/*---------------------------------------------------------------------
+ * uint16_t GetEffectivePeriod(uint8_t slot)
+ * period in ms the object is polled with after degrading
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint16_t PollPlanner::GetEffectivePeriod(uint8_t slot)
+{
+	if(slot >= ObjectCount)
+		return 0;
+	return (uint16_t)EffectivePeriod(slot);
+}
+
+/*---------------------------------------------------------------------
+ * uint16_t GetMisses(uint8_t slot)
+ * number of times the value has been received after its deadline
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint16_t PollPlanner::GetMisses(uint8_t slot)
+{
+	if(slot >= ObjectCount)
+		return 0;
+	return Object[slot].Misses;
+}
+
+/*---------------------------------------------------------------------
+ * bool IsDisabled(uint8_t slot)
+ * true if the object has been rejected by the drive PollMaxFailures
+ * times in a row and is no longer polled
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool PollPlanner::IsDisabled(uint8_t slot)
+{
+	if(slot >= ObjectCount)
+		return false;
+	return Object[slot].isDisabled;
+}
+
+/*---------------------------------------------------------------------
+ * uint16_t GetLoad()
+ * load of the line in permille the requested rates would need
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint16_t PollPlanner::GetLoad()
+{
+	return RequestedLoad;
+}
+
+/*---------------------------------------------------------------------
+ * uint16_t GetPlannedLoad()
+ * load of the line in permille after degrading
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint16_t PollPlanner::GetPlannedLoad()
+{
+	return PlannedLoad;
+}
+
+/*---------------------------------------------------------------------
+ * bool IsOverloaded()
+ * true if the requested rates exceed the budget of the line
+ * and some objects are polled less often than requested
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool PollPlanner::IsOverloaded()
+{
+	return isOverloaded;
+}
+
+/*---------------------------------------------------------------------
+ * uint16_t GetErrors()
+ * number of failed batches and of objects rejected by the drive
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW rejected objects
+ *--------------------------------------------------------------------*/
+
+uint16_t PollPlanner::GetErrors()
+{
+	return Errors;
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * void Plan()
+ * Calculate the load the requested rates put onto the line. As long
+ * as it exceeds the budget, the period of an object of the lowest
+ * priority is doubled - the one with the highest load first.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void PollPlanner::Plan()
+{
+	for(uint8_t i = 0; i < ObjectCount; i++)
+		Object[i].Stretch = 0;
+		
+	RequestedLoad = CalcLoad();
+	PlannedLoad = RequestedLoad;
+	isOverloaded = (RequestedLoad > LinkBudget);
+	
+	while(PlannedLoad > LinkBudget)
+	{
+		uint8_t Victim = InvalidSlot;
+		
+		for(uint8_t i = 0; i < ObjectCount; i++)
+		{
+			if((Object[i].Stretch >= PollMaxStretch) || Object[i].isDisabled)
+				continue;
+			if((Victim == InvalidSlot) 
+				|| (Object[i].Priority < Object[Victim].Priority)
+				|| ((Object[i].Priority == Object[Victim].Priority) && (EffectivePeriod(i) < EffectivePeriod(Victim))))
+				Victim = i;
+		}
+		if(Victim == InvalidSlot)
+			//nothing left to be degraded
+			break;
+		
+		Object[Victim].Stretch++;
+		PlannedLoad = CalcLoad();
+	}
+	
+	#if(DEBUG_POLL & DEBUG_PLAN)
+	if(isOverloaded)
+	{
+		Serial.print("Poll: overload ");
+		Serial.print(RequestedLoad, DEC);
+		Serial.print(" -> ");
+		Serial.println(PlannedLoad, DEC);
+	}
+	#endif
+}
+
+/*---------------------------------------------------------------------
+ * uint16_t CalcLoad()
+ * sum of cost / period of all objects in permille
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW w/o the disabled ones
+ *--------------------------------------------------------------------*/
+
+uint16_t PollPlanner::CalcLoad()
+{
+uint32_t Load = 0;
+
+	//us per ms is permille already
+	for(uint8_t i = 0; i < ObjectCount; i++)
+		if(!Object[i].isDisabled)
+			Load += ObjectCost / EffectivePeriod(i);
+	
+	if(Load > 0xffff)
+		Load = 0xffff;
+	return (uint16_t)Load;
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t EffectivePeriod(uint8_t slot)
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t PollPlanner::EffectivePeriod(uint8_t slot)
+{
+	return ((uint32_t)Object[slot].Period << Object[slot].Stretch);
+}
+
+/*---------------------------------------------------------------------
+ * uint32_t Deadline(uint8_t slot)
+ * the next value has to be received until the next release
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint32_t PollPlanner::Deadline(uint8_t slot)
+{
+	return Object[slot].Release + EffectivePeriod(slot);
+}
+
+/*---------------------------------------------------------------------
+ * bool IsDue(uint8_t slot)
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool PollPlanner::IsDue(uint8_t slot)
+{
+	return ((int32_t)(actTime - Object[slot].Release) >= 0);
+}
+
+/*---------------------------------------------------------------------
+ * void Dispatch()
+ * Select the due object with the earliest deadline and add the other
+ * due objects of the same drive in the order of their deadline.
+ * They are read in a single batch then. Disabled objects are skipped.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW skip the disabled ones
+ *--------------------------------------------------------------------*/
+
+void PollPlanner::Dispatch()
+{
+bool isTaken[PollPlannerMaxObjects];
+
+	for(uint8_t i = 0; i < ObjectCount; i++)
+		isTaken[i] = false;
+		
+	BatchCount = 0;
+	BatchDrive = NULL;
+	
+	while(BatchCount < SDOMaxBatch)
+	{
+		uint8_t Next = InvalidSlot;
+		
+		for(uint8_t i = 0; i < ObjectCount; i++)
+		{
+			if(isTaken[i] || Object[i].isDisabled || !IsDue(i))
+				continue;
+			if((BatchDrive != NULL) && (Object[i].Drive != BatchDrive))
+				continue;
+			if((Next == InvalidSlot) || ((int32_t)(Deadline(i) - Deadline(Next)) < 0))
+				Next = i;
+		}
+		if(Next == InvalidSlot)
+			break;
+			
+		isTaken[Next] = true;
+		BatchDrive = Object[Next].Drive;
+		BatchSlot[BatchCount] = Next;
+		BatchList[BatchCount].Idx = Object[Next].Idx;
+		BatchList[BatchCount].SubIdx = Object[Next].SubIdx;
+		BatchList[BatchCount].Value = 0;
+		BatchList[BatchCount].Len = 0;
+		BatchCount++;
+	}
+	
+	#if(DEBUG_POLL & DEBUG_BATCH)
+	if(BatchCount > 0)
+	{
+		Serial.print("Poll: batch of ");
+		Serial.println(BatchCount, DEC);
+	}
+	#endif
+}
+
+/*---------------------------------------------------------------------
+ * void OnBatchDone()
+ * Take the values and release the objects for their next period.
+ * An object which has fallen behind by more than a period is not
+ * caught up but released from now on.
+ * The ones rejected by the drive are handed to OnObjectFailed().
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW rejected objects
+ *--------------------------------------------------------------------*/
+
+void PollPlanner::OnBatchDone()
+{
+	for(uint8_t i = 0; i < BatchCount; i++)
+	{
+		uint8_t slot = BatchSlot[i];
+		PollObject *Obj = &Object[slot];
+		
+		if(BatchList[i].isFailed)
+		{
+			OnObjectFailed(slot);
+			continue;
+		}
+		Obj->Failures = 0;
+		
+		if((int32_t)(actTime - Deadline(slot)) > 0)
+			Obj->Misses++;
+			
+		if(!Obj->isValid || (Obj->Value != BatchList[i].Value))
+			Obj->hasChanged = true;
+			
+		Obj->Value = BatchList[i].Value;
+		Obj->TimeStamp = actTime;
+		Obj->isValid = true;
+		
+		Obj->Release += EffectivePeriod(slot);
+		if((int32_t)(actTime - Obj->Release) >= 0)
+			Obj->Release = actTime;
+	}
+	BatchCount = 0;
+}
+
+/*---------------------------------------------------------------------
+ * void OnObjectFailed(uint8_t slot)
+ * The object has been rejected by the drive. It's tried again after
+ * its period doubled with every failure in a row - up to 2^PollMaxStretch.
+ * After PollMaxFailures in a row it's disabled and the rates are planned
+ * again w/o it.
+ * 
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+void PollPlanner::OnObjectFailed(uint8_t slot)
+{
+	PollObject *Obj = &Object[slot];
+	
+	Errors++;
+	if(Obj->Failures < 0xff)
+		Obj->Failures++;
+	
+	#if(DEBUG_POLL & DEBUG_ERROR)
+	Serial.print("Poll: object failed ");
+	Serial.println(Obj->Idx, HEX);
+	#endif
+	
+	if(Obj->Failures >= PollMaxFailures)
+	{
+		Obj->isDisabled = true;
+		Plan();
+		return;
+	}
+	
+	uint8_t BackOff = (Obj->Failures < PollMaxStretch) ? Obj->Failures : PollMaxStretch;
+	
+	Obj->Release = actTime + (EffectivePeriod(slot) << BackOff);
+}
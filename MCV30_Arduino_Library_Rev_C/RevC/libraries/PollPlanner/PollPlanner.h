@@ -0,0 +1,112 @@
+#ifndef POLLPLANNER_H
+#define POLLPLANNER_H
+
+/*--------------------------------------------------------------
+ * class PollPlanner
+ * polls objects of the drives of a serial line, each at its own
+ * rate. The SDO channel is scheduled earliest-deadline-first.
+ * If the rates requested exceed the capacity of the line the
+ * objects of the lowest priority are polled less often.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+ 
+//--- inlcudes ----
+ 
+#include <MCDrive.h>
+#include <stdint.h>
+
+//--- service define ---
+
+//5 objects of each of the 4 drives of a line
+//can be raised by a build flag e.g. -DPOLLPLANNER_MAX_OBJECTS=32
+#ifndef POLLPLANNER_MAX_OBJECTS
+#define POLLPLANNER_MAX_OBJECTS 20
+#endif
+
+const uint8_t PollPlannerMaxObjects = POLLPLANNER_MAX_OBJECTS;
+const uint32_t PollBaudDefault = 115200;
+const uint16_t PollBudgetDefault = 800;			//permille of the line
+const uint8_t PollMaxStretch = 4;				//period x 2^4 at most
+
+//an object rejected by the drive this many times in a row is no longer polled
+#ifndef POLLPLANNER_MAX_FAILURES
+#define POLLPLANNER_MAX_FAILURES 8			//can be raised by a build flag
+#endif
+
+const uint8_t PollMaxFailures = POLLPLANNER_MAX_FAILURES;
+
+//bytes on the wire for a single SDO read
+//request 'S',len,node,cmd,idx,sub,crc,'E' and response with 4 bytes data
+const uint8_t PollReqBytes = 9;
+const uint8_t PollRespBytes = 13;
+
+typedef struct PollObject {
+	MCDrive *Drive;
+	uint16_t Idx;
+	uint8_t SubIdx;
+	uint8_t Priority;		//higher is more important
+	uint16_t Period;		//ms requested
+	uint8_t Stretch;		//period is doubled this many times
+	uint32_t Release;		//ms the next request is due
+	uint32_t Value;
+	uint32_t TimeStamp;
+	bool isValid;
+	bool hasChanged;
+	uint16_t Misses;
+	uint8_t Failures;		//rejected by the drive in a row
+	bool isDisabled;
+} PollObject;
+
+class PollPlanner {
+	public:
+		PollPlanner();
+		void SetLinkBaud(uint32_t);
+		void SetLinkBudget(uint16_t);
+		
+		uint8_t AddObject(MCDrive *, uint16_t, uint8_t, uint16_t, uint8_t);
+		void Update(uint32_t);
+		
+		bool GetValue(uint8_t, uint32_t *);
+		uint32_t GetTimeStamp(uint8_t);
+		bool HasChanged(uint8_t);
+		uint16_t GetEffectivePeriod(uint8_t);
+		uint16_t GetMisses(uint8_t);
+		bool IsDisabled(uint8_t);
+		
+		uint16_t GetLoad();
+		uint16_t GetPlannedLoad();
+		bool IsOverloaded();
+		uint16_t GetErrors();
+		
+	private:
+		void Plan();
+		uint16_t CalcLoad();
+		uint32_t EffectivePeriod(uint8_t);
+		uint32_t Deadline(uint8_t);
+		bool IsDue(uint8_t);
+		void Dispatch();
+		void OnBatchDone();
+		void OnObjectFailed(uint8_t);
+		
+		PollObject Object[PollPlannerMaxObjects];
+		uint8_t ObjectCount = 0;
+		
+		uint32_t LinkBaud = PollBaudDefault;
+		uint16_t LinkBudget = PollBudgetDefault;
+		uint32_t ObjectCost;		//us on the wire for one object
+		uint16_t RequestedLoad = 0;
+		uint16_t PlannedLoad = 0;
+		bool isOverloaded = false;
+		
+		SDOBatchEntry BatchList[SDOMaxBatch];
+		uint8_t BatchSlot[SDOMaxBatch];
+		uint8_t BatchCount = 0;
+		MCDrive *BatchDrive = NULL;
+		uint16_t Errors = 0;
+		
+		uint32_t actTime = 0;
+};
+
+#endif
@@ -17,6 +17,7 @@
 #define DEBUG_RREQ		0x0004
 #define DEBUG_ERROR		0x0008
 #define DEBUG_TO		0x0010
+#define DEBUG_BATCH		0x0020
 
 #define DEBUG_SDO (DEBUG_TO | DEBUG_ERROR)
 
@@ -31,11 +32,14 @@ const unsigned int SDORespTimeOut = 20;
  * init the instance by at least initializing the RxLen
  * 
  * 2020-11-18 AW Done
+ * 2026-10-18 AW deadlines
  *---------------------------------------------------*/
  
 SDOHandler::SDOHandler()
 {
 	RxLen = 0;
+	DeadlineQueue::InitDeadline(&RespDeadline,SDOHandler::OnRespDeadlineCb,(void *)this);
+	DeadlineQueue::InitDeadline(&BatchDeadline,SDOHandler::OnBatchDeadlineCb,(void *)this);
 }
 
 /*-------------------------------------------------------
@@ -118,6 +122,8 @@ void SDOHandler::ResetComState()
 	RxTxState = eIdle;
 	TORetryCounter = 0;
 	BusyRetryCounter = 0;
+	//a time-out still armed would switch to eRetry later on
+	Handler->GetDeadlines()->Cancel(&RespDeadline);
 	//Handler should not be reset, as it could be used by different
 	//instances of the Drive
 	//Handler->ResetMsgHandler();	
@@ -125,7 +131,7 @@ void SDOHandler::ResetComState()
 	
 	if(hasMsgHandlerLocked)
 	{
-		Handler->UnLockHandler();
+		Handler->UnLockHandler(LockGrant);
 		hasMsgHandlerLocked = false;
 	}
 }
@@ -163,7 +169,8 @@ SDOCommStates SDOHandler::ReadSDO(uint16_t Idx, uint8_t SubIdx)
 			RxRqMsg.Idx = Idx;
 			RxRqMsg.SubIdx = SubIdx;
 
-			if(hasMsgHandlerLocked = Handler->LockHandler())
+			hasMsgHandlerLocked = Handler->LockHandler(&LockGrant);
+			if(hasMsgHandlerLocked)
 			{
 				//try to send the data
 				if(Handler->SendMsg(Channel,(MCMsg *)&RxRqMsg))
@@ -178,13 +185,12 @@ SDOCommStates SDOHandler::ReadSDO(uint16_t Idx, uint8_t SubIdx)
 					Serial.println(" --> cWaiting");
 					#endif
 
-					//time our is handled by polling
-					RequestSentAt = actTime;
-					isTimerActive = true;
+					//time out is handled by the DeadlineQueue
+					Handler->GetDeadlines()->Arm(&RespDeadline, Handler->GetTime() + SDORespTimeOut + 1);
 				}
 				else
 				{
-					Handler->UnLockHandler();
+					Handler->UnLockHandler(LockGrant);
 					hasMsgHandlerLocked = false;
 
 					//didn't work
@@ -210,6 +216,8 @@ SDOCommStates SDOHandler::ReadSDO(uint16_t Idx, uint8_t SubIdx)
 				}
 			}
 			break;
+		default:
+			break;
 	}
 	return RxTxState;
 }
@@ -253,7 +261,8 @@ SDOCommStates SDOHandler::WriteSDO(uint16_t Idx, uint8_t SubIdx,uint32_t *Data,u
 			else if(len == 4)
 				*((uint32_t *)TxRqMsg.u8UserData) = *(uint32_t *)Data;
 				
-			if(hasMsgHandlerLocked = Handler->LockHandler())
+			hasMsgHandlerLocked = Handler->LockHandler(&LockGrant);
+			if(hasMsgHandlerLocked)
 			{				 
 				//send the data
 				if(Handler->SendMsg(Channel,(MCMsg *)&TxRqMsg))
@@ -269,12 +278,11 @@ SDOCommStates SDOHandler::WriteSDO(uint16_t Idx, uint8_t SubIdx,uint32_t *Data,u
 					#endif
 
 					//handle time-out
-					RequestSentAt = actTime;
-					isTimerActive = true;
+					Handler->GetDeadlines()->Arm(&RespDeadline, Handler->GetTime() + SDORespTimeOut + 1);
 				}
 				else
 				{
-					Handler->UnLockHandler();
+					Handler->UnLockHandler(LockGrant);
 					hasMsgHandlerLocked = false;
 
 					BusyRetryCounter++;
@@ -299,6 +307,8 @@ SDOCommStates SDOHandler::WriteSDO(uint16_t Idx, uint8_t SubIdx,uint32_t *Data,u
 				}
 			}
 			break;
+		default:
+			break;
 	} //end of switch (RxTxState)
 	return RxTxState;
 }
@@ -324,18 +334,173 @@ uint32_t SDOHandler::GetObjValue()
 		
 	return retValue;	
 }
+
+/*-------------------------------------------------------------
+ * SDOCommStates ReadBatch(SDOBatchEntry *List, uint8_t count)
+ * Read a list of up to SDOMaxBatch parameters in one go.
+ * The requests are sent back-to-back without waiting for the single
+ * responses, up to BatchWindow of them are in flight. Responses are
+ * matched by Idx and SubIdx and their value is stored into the List.
+ * So reading n objects does cost a single lock of the MsgHandler and
+ * about one round-trip instead of n.
+ * Is to be called cyclically until eDone and needs to be reset by
+ * ResetBatchState() afterwards. The single SDO access can't be used
+ * while the batch is running as the MsgHandler is kept locked.
+ * After a time-out only the unanswered requests are sent again.
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+SDOCommStates SDOHandler::ReadBatch(SDOBatchEntry *List, uint8_t count)
+{
+	return RunBatch(List, count, false);
+}
+
+/*-------------------------------------------------------------
+ * SDOCommStates AccessBatch(SDOBatchEntry *List, uint8_t count)
+ * Like ReadBatch() but the entries with a Len > 0 are written and
+ * a request rejected by the drive doesn't abort the batch: the entry
+ * is marked as isFailed and its Value is the error code. So eDone
+ * means every entry has been answered - each one is to be checked.
+ * Meant for the remote access to any list of objects.
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+SDOCommStates SDOHandler::AccessBatch(SDOBatchEntry *List, uint8_t count)
+{
+	return RunBatch(List, count, true);
+}
+
+/*-------------------------------------------------------------
+ * SDOCommStates CheckBatchState()
+ * return the state of the batch
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+SDOCommStates SDOHandler::CheckBatchState()
+{
+	return BatchState;
+}
+
+/*-------------------------------------------------------------
+ * void ResetBatchState()
+ * to be called after the batch is done or failed
+ * will unlock the MsgHandler if still locked
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW keep the requests in flight as stale
+ * 2026-10-18 AW whatever the state
+ * -------------------------------------------------------------*/
+
+void SDOHandler::ResetBatchState()
+{
+	if(BatchInFlight != 0)
+		KeepStaleBatch();
+		
+	BatchState = eIdle;
+	BatchPending = 0;
+	BatchInFlight = 0;
+	BatchTORetryCounter = 0;
+	Handler->GetDeadlines()->Cancel(&BatchDeadline);
+	
+	if(hasBatchLocked)
+	{
+		Handler->UnLockHandler(BatchLockGrant);
+		hasBatchLocked = false;
+	}
+}
+
+/*-------------------------------------------------------------
+ * void SetBatchWindow(uint8_t window)
+ * set the max number of requests of a batch being in flight
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+void SDOHandler::SetBatchWindow(uint8_t window)
+{
+	if(window == 0)
+		window = 1;
+	BatchWindow = window;
+}
+
 //-------------------------------------------------------------------
 //--- private calls ---
 
+/*-------------------------------------------------------------
+ * SDOCommStates RunBatch(SDOBatchEntry *List, uint8_t count, bool isAccess)
+ * the state machine of ReadBatch() and AccessBatch()
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW lock lost by an expired lease
+ * -------------------------------------------------------------*/
+
+SDOCommStates SDOHandler::RunBatch(SDOBatchEntry *List, uint8_t count, bool isAccess)
+{
+	//the lease may have expired and the lock been granted to someone else
+	if(hasBatchLocked && !Handler->HasLock(BatchLockGrant))
+		hasBatchLocked = false;
+	
+	switch(BatchState)
+	{
+		case eIdle:
+			if(count > SDOMaxBatch)
+				count = SDOMaxBatch;
+				
+			BatchList = List;
+			BatchCount = count;
+			isBatchAccess = isAccess;
+			if(isAccess)
+			{
+				for(uint8_t i = 0; i < count; i++)
+					List[i].isFailed = false;
+			}
+			BatchPending = (uint8_t)((1 << count) - 1);
+			BatchInFlight = 0;
+			BatchTORetryCounter = 0;
+			BatchState = eRetry;
+			//no break here
+		case eRetry:
+			if(!hasBatchLocked)
+				hasBatchLocked = Handler->LockHandler(&BatchLockGrant);
+			
+			if(hasBatchLocked)
+			{
+				BatchState = eWaiting;
+				Handler->GetDeadlines()->Arm(&BatchDeadline, Handler->GetTime() + SDORespTimeOut + 1);
+			}
+			else
+				break;
+			//no break here
+		case eWaiting:
+			if(!hasBatchLocked)
+				hasBatchLocked = Handler->LockHandler(&BatchLockGrant);
+				
+			if(hasBatchLocked)
+				SendBatch();
+			break;
+		default:
+			break;
+	}
+	return BatchState;
+}
+
+
 /*-------------------------------------------------------------------
  * void OnRxHandler(MCMsg *Msg)
  * The actual handler for any SDO services received by the MsgHandler
  * Checks wheter the received response belongs to any open
  * requenst and will switch these to eDone.
  * Other will transit to eError.
+ * Responses to a running batch are handed over to OnBatchRx().
  * 
  * 2020-11-18 AW Rev_A
  * 2021-04-22 AW removed reference to timer
+ * 2026-10-18 AW batch
+ * 2026-10-18 AW late responses of a batch given up are dropped,
+ *               no eError w/o a request being open
  * -----------------------------------------------------------------*/
 
 void SDOHandler::OnRxHandler(MCMsg *Msg)
@@ -343,6 +508,23 @@ void SDOHandler::OnRxHandler(MCMsg *Msg)
 	MCMsgCommands Cmd = Msg->Hdr.u8Cmd;
 	SDOMaxMsg *SDO = (SDOMaxMsg *)Msg;
 	
+	//responses to a running batch are handled separately
+	if((BatchState == eWaiting) && OnBatchRx(SDO))
+		return;
+	
+	//responses to a batch which has timed out or been reset
+	if(IsStaleBatchRx(SDO))
+		return;
+	
+	//nothing to be answered - don't fail the next request
+	if((RxTxState != eWaiting) && (RxTxState != eRetry))
+	{
+		#if(DEBUG_SDO & DEBUG_ERROR)
+		Serial.print("SDO: Rx dropped Idx: ");
+		Serial.println(SDO->Idx, HEX);
+		#endif
+		return;
+	}
 	
 	switch(Cmd)
 	{
@@ -356,7 +538,7 @@ void SDOHandler::OnRxHandler(MCMsg *Msg)
 				RxLen = (SDO->u8Len) - 7;
 				
 				//reset any active timer
-				isTimerActive = false;
+				Handler->GetDeadlines()->Cancel(&RespDeadline);
 				
 				#if(DEBUG_SDO  & DEBUG_RXMSG)
 				Serial.print("SDO: Rx Idx ");
@@ -367,23 +549,12 @@ void SDOHandler::OnRxHandler(MCMsg *Msg)
 
 				//cast the response to an unit32_t depending on the
 				//lenght of the payload	
-				if(RxLen == 1)
-					//this is char
-					RxData = (uint32_t)(*((uint8_t *)SDO->u8UserData));
-				else if(RxLen == 2)
-					//this is int
-					RxData = (uint32_t)SDO->u8UserData[0] + (uint32_t)((SDO->u8UserData[1])<<8);					
-				else if(RxLen == 4)
-					//this is long data
-					RxData =  ( ((uint32_t)(SDO->u8UserData[3]) << 24) + 
-								((uint32_t)(SDO->u8UserData[2]) << 16) +
-								((uint32_t)(SDO->u8UserData[1]) <<  8) +
-								 (uint32_t)SDO->u8UserData[0]             );
+				RxData = GetRxValue(SDO);
 				
 				//switch transfer to eDone state and unlock the 
 				//used MsgHandler	
 				RxTxState = eDone;
-				Handler->UnLockHandler();
+				Handler->UnLockHandler(LockGrant);
 				hasMsgHandlerLocked = false;
 
 			}
@@ -412,11 +583,11 @@ void SDOHandler::OnRxHandler(MCMsg *Msg)
 				//swtich the state to the eDone and unlock the underlying 
 				//MsgHandler
 				RxTxState = eDone;
-				Handler->UnLockHandler();
+				Handler->UnLockHandler(LockGrant);
 				hasMsgHandlerLocked = false;
 				
 				//reset any active timer
-				isTimerActive = false;
+				Handler->GetDeadlines()->Cancel(&RespDeadline);
 
 				#if(DEBUG_SDO  & DEBUG_RXMSG)
 				Serial.print("SDO: Tx Idx ");
@@ -453,21 +624,59 @@ void SDOHandler::OnRxHandler(MCMsg *Msg)
 /*----------------------------------------------------
  * void SetActTime(uint32_t time)
  * Soft-Update of the internal time in case of no HW timer being used.
- * use the updated time to check whether any of the responses
- * is timed out and call the OnTimeOut() if so.
+ * The time-outs of the responses are armed at the DeadlineQueue of the
+ * MsgHandler and are no longer checked here.
+ * The time is taken from the MsgHandler.
+ * Deprecated - does nothing and is kept for compatibility only.
  * 
  * 2020-11-18 AW Rev_A
  * 2021-04-22 AW removed reference to timer
+ * 2026-10-18 AW batch time-out
+ * 2026-10-18 AW time-outs moved to the DeadlineQueue
+ * 2026-10-18 AW time of the MsgHandler
+ * 2026-10-18 AW deprecated
  * -----------------------------------------------------------*/
 
 void SDOHandler::SetActTime(uint32_t time)
 {
-	actTime = time;
-	
-	if((isTimerActive) && ((RequestSentAt + SDORespTimeOut) < actTime))	
-	{	
-		OnTimeOut();
-		isTimerActive = false;
+	(void)time;
+}
+
+/*----------------------------------------------------------
+ * void OnBatchTimeOut()
+ * No response of a batch within SDORespTimeOut since the last
+ * request has been sent. Unanswered requests will be sent again by
+ * the next ReadBatch().
+ * The requests in flight are kept as stale for another SDORespTimeOut.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW stale requests
+ * -------------------------------------------------------------*/
+
+void SDOHandler::OnBatchTimeOut()
+{
+	if(BatchState == eWaiting)
+	{
+		#if(DEBUG_SDO & DEBUG_TO)
+		Serial.print("SDO: Batch timeout ");
+		Serial.println(BatchPending, HEX);
+		#endif
+
+		if(hasBatchLocked)
+		{
+			Handler->UnLockHandler(BatchLockGrant);
+			hasBatchLocked = false;
+		}
+		
+		KeepStaleBatch();
+		BatchInFlight = 0;
+		if(BatchTORetryCounter < TORetryMax)
+		{
+			BatchTORetryCounter++;
+			BatchState = eRetry;
+		}
+		else
+			BatchState = eTimeout;
 	}
 
 }
@@ -496,7 +705,7 @@ void SDOHandler::OnTimeOut()
 		
 		if(hasMsgHandlerLocked)
 		{
-			Handler->UnLockHandler();
+			Handler->UnLockHandler(LockGrant);
 			hasMsgHandlerLocked = false;
 		}
 
@@ -517,3 +726,229 @@ void SDOHandler::OnTimeOut()
 }
 
 
+/*-------------------------------------------------------------
+ * void SendBatch()
+ * send the requests which are still pending but not in flight
+ * as long as the window and the Uart allow for
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW renew the lease of the MsgHandler
+ * -------------------------------------------------------------*/
+
+void SDOHandler::SendBatch()
+{
+uint8_t InFlight = 0;
+
+	for(uint8_t i = 0; i < BatchCount; i++)
+		if(BatchInFlight & (1 << i))
+			InFlight++;
+			
+	for(uint8_t i = 0; (i < BatchCount) && (InFlight < BatchWindow); i++)
+	{
+		uint8_t mask = (1 << i);
+		
+		if((BatchPending & mask) && !(BatchInFlight & mask))
+		{
+			BatchTxMsg.u8Len = 7;
+			BatchTxMsg.u8Cmd = eSdoReadReq;
+			BatchTxMsg.Idx = BatchList[i].Idx;
+			BatchTxMsg.SubIdx = BatchList[i].SubIdx;
+			
+			if(isBatchAccess && (BatchList[i].Len > 0))
+			{
+				uint8_t len = (BatchList[i].Len > 4) ? 4 : BatchList[i].Len;
+				
+				BatchTxMsg.u8Len = 7 + len;
+				BatchTxMsg.u8Cmd = eSdoWriteReq;
+				for(uint8_t j = 0; j < len; j++)
+					BatchTxMsg.u8UserData[j] = (uint8_t)(BatchList[i].Value >> (8 * j));
+			}
+			
+			if(Handler->SendMsg(Channel,(MCMsg *)&BatchTxMsg))
+			{
+				BatchInFlight |= mask;
+				Handler->GetDeadlines()->Arm(&BatchDeadline, Handler->GetTime() + SDORespTimeOut + 1);
+				Handler->RenewLease(BatchLockGrant);
+				InFlight++;
+				
+				#if(DEBUG_SDO & DEBUG_BATCH)
+				Serial.print("SDO: Batch Req ");
+				Serial.println(BatchTxMsg.Idx, HEX);
+				#endif
+			}
+			else
+				//try again with the next call
+				break;
+		}
+	}
+}
+
+/*-------------------------------------------------------------
+ * bool OnBatchRx(SDOMaxMsg *SDO)
+ * check whether a received Msg is the response to one of the
+ * requests in flight and store the value if so.
+ * Returns false for all the others.
+ * 
+ * 2026-10-18 AW Rev_A
+ * 2026-10-18 AW writes and errors per entry of AccessBatch()
+ * 2026-10-18 AW renew the lease of the MsgHandler
+ * 2026-10-18 AW the requests in flight are stale on an error
+ * -------------------------------------------------------------*/
+
+bool SDOHandler::OnBatchRx(SDOMaxMsg *SDO)
+{
+	MCMsgCommands Cmd = SDO->u8Cmd;
+
+	if((Cmd != eSdoReadReq) && (Cmd != eSdoError) && !(isBatchAccess && (Cmd == eSdoWriteReq)))
+		return false;
+		
+	for(uint8_t i = 0; i < BatchCount; i++)
+	{
+		uint8_t mask = (1 << i);
+		bool isWrite = isBatchAccess && (BatchList[i].Len > 0);
+		
+		if((BatchInFlight & mask) && (BatchList[i].Idx == SDO->Idx) && (BatchList[i].SubIdx == SDO->SubIdx) &&
+		   ((Cmd == eSdoError) || (isWrite == (Cmd == eSdoWriteReq))))
+		{
+			BatchInFlight &= ~mask;
+			
+			if((Cmd == eSdoError) && isBatchAccess)
+			{
+				//keep the others going
+				BatchList[i].isFailed = true;
+				BatchList[i].Value = GetRxValue(SDO);
+				BatchPending &= ~mask;
+				
+				if(BatchPending == 0)
+					BatchState = eDone;
+				
+				#if(DEBUG_SDO & DEBUG_ERROR)
+				Serial.print("SDO: Batch Error Idx: ");
+				Serial.println(SDO->Idx, HEX);
+				#endif
+			}
+			else if(Cmd == eSdoError)
+			{
+				//the others may still be answered - don't let them hit the next request
+				BatchState = eError;
+				KeepStaleBatch();
+				BatchInFlight = 0;
+				
+				#if(DEBUG_SDO & DEBUG_ERROR)
+				Serial.print("SDO: Batch Error Idx: ");
+				Serial.println(SDO->Idx, HEX);
+				#endif
+			}
+			else
+			{
+				if(!isWrite)
+					BatchList[i].Value = GetRxValue(SDO);
+				BatchPending &= ~mask;
+				
+				if(BatchPending == 0)
+					BatchState = eDone;
+			}
+			
+			if(BatchState != eWaiting)
+				Handler->GetDeadlines()->Cancel(&BatchDeadline);
+			else
+				Handler->RenewLease(BatchLockGrant);
+				
+			if((BatchState != eWaiting) && hasBatchLocked)
+			{
+				Handler->UnLockHandler(BatchLockGrant);
+				hasBatchLocked = false;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+/*-------------------------------------------------------------
+ * void KeepStaleBatch()
+ * remember the requests still in flight when the batch is given
+ * up by a time-out, an error or a reset. Their responses may still arrive
+ * within the next SDORespTimeOut and are dropped then.
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+void SDOHandler::KeepStaleBatch()
+{
+	StaleCount = 0;
+	for(uint8_t i = 0; i < BatchCount; i++)
+	{
+		if(BatchInFlight & (1 << i))
+		{
+			StaleIdx[StaleCount] = BatchList[i].Idx;
+			StaleSubIdx[StaleCount] = BatchList[i].SubIdx;
+			StaleCount++;
+		}
+	}
+	StaleUntil = Handler->GetTime() + SDORespTimeOut + 1;
+}
+
+/*-------------------------------------------------------------
+ * bool IsStaleBatchRx(SDOMaxMsg *SDO)
+ * true for a late response to one of the stale requests
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+bool SDOHandler::IsStaleBatchRx(SDOMaxMsg *SDO)
+{
+	if(StaleCount == 0)
+		return false;
+		
+	if((int32_t)(Handler->GetTime() - StaleUntil) >= 0)
+	{
+		StaleCount = 0;
+		return false;
+	}
+	
+	for(uint8_t i = 0; i < StaleCount; i++)
+	{
+		if((StaleIdx[i] == SDO->Idx) && (StaleSubIdx[i] == SDO->SubIdx))
+		{
+			//each of them is answered once
+			StaleCount--;
+			StaleIdx[i] = StaleIdx[StaleCount];
+			StaleSubIdx[i] = StaleSubIdx[StaleCount];
+			
+			#if(DEBUG_SDO & DEBUG_BATCH)
+			Serial.print("SDO: Batch late Rx ");
+			Serial.println(SDO->Idx, HEX);
+			#endif
+			return true;
+		}
+	}
+	return false;
+}
+
+/*-------------------------------------------------------------
+ * uint32_t GetRxValue(SDOMaxMsg *SDO)
+ * cast the payload of a read response to an uint32_t depending on
+ * the lenght of the payload	
+ * 
+ * 2026-10-18 AW Rev_A
+ * -------------------------------------------------------------*/
+
+uint32_t SDOHandler::GetRxValue(SDOMaxMsg *SDO)
+{
+	uint8_t len = (SDO->u8Len) - 7;
+	
+	if(len == 1)
+		//this is char
+		return (uint32_t)(*((uint8_t *)SDO->u8UserData));
+	else if(len == 2)
+		//this is int
+		return (uint32_t)SDO->u8UserData[0] + (uint32_t)((SDO->u8UserData[1])<<8);
+	else if(len == 4)
+		//this is long data
+		return  ( ((uint32_t)(SDO->u8UserData[3]) << 24) + 
+				  ((uint32_t)(SDO->u8UserData[2]) << 16) +
+				  ((uint32_t)(SDO->u8UserData[1]) <<  8) +
+				   (uint32_t)SDO->u8UserData[0]             );
+	return 0;
+}
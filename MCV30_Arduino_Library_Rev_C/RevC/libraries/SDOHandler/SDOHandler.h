@@ -77,56 +77,109 @@ typedef enum SDOCommStates {
 }
  SDOCommStates;
 
+//a single entry of a batch of read requests
+//Value is filled in when the response is received
+//Len and isFailed are used by AccessBatch() only:
+//Len > 0 writes Value with Len bytes, a rejected access is marked as
+//isFailed with the error code of the drive as Value
+
+typedef struct SDOBatchEntry {
+   uint16_t  Idx;
+   uint8_t SubIdx;
+   uint32_t Value;
+   uint8_t Len;
+   bool isFailed;
+} SDOBatchEntry;
+
+const uint8_t SDOMaxBatch = 8;
+const uint8_t SDOBatchWindowDefault = 4;
+
 //define the class itself
 
 class SDOHandler {
 	public:
 		SDOHandler();
 		void init(MsgHandler *,uint8_t);
-		void SetActTime(uint32_t);
+		void SetActTime(uint32_t);		//deprecated - the time is the one of the MsgHandler
 		
 		SDOCommStates ReadSDO(uint16_t, uint8_t);
 		SDOCommStates WriteSDO(uint16_t, uint8_t,uint32_t *,uint8_t);
-		unsigned long GetObjValue();
+		uint32_t GetObjValue();
 		SDOCommStates CheckComState();
 		void ResetComState(); 
 		void SetTORetryMax(uint8_t);
 		void SetBusyRetryMax(uint8_t);
 		
+		SDOCommStates ReadBatch(SDOBatchEntry *, uint8_t);
+		SDOCommStates AccessBatch(SDOBatchEntry *, uint8_t);
+		SDOCommStates CheckBatchState();
+		void ResetBatchState();
+		void SetBatchWindow(uint8_t);
+		
 		//handler to be registered at the Msghandler instance
 		static void OnSDOMsgRxCb(void *op,void *p) {
 			((SDOHandler *)op)->OnRxHandler((MCMsg *)p);
 		};
 		
-		//hander to be registered at the OsTimer
-		static void OnTimeOutCb(void *p) {
-			((SDOHandler *)p)->OnTimeOut();
+		//handlers to be armed at the DeadlineQueue of the MsgHandler
+		static void *OnRespDeadlineCb(void *op, void *p) {
+			((SDOHandler *)op)->OnTimeOut();
+			return NULL;
+		};
+		static void *OnBatchDeadlineCb(void *op, void *p) {
+			((SDOHandler *)op)->OnBatchTimeOut();
+			return NULL;
 		};
 	
 	private:
 		void OnRxHandler(MCMsg *);
 		void OnTimeOut();
+		void OnBatchTimeOut();
+		SDOCommStates RunBatch(SDOBatchEntry *, uint8_t, bool);
+		void SendBatch();
+		bool OnBatchRx(SDOMaxMsg *);
+		void KeepStaleBatch();
+		bool IsStaleBatchRx(SDOMaxMsg *);
+		uint32_t GetRxValue(SDOMaxMsg *);
 		char Channel = InvalidSlot;
 
 		SDOMaxMsg TxRqMsg;
 		SDOMaxMsg RxRqMsg;
 		SDOCommStates RxTxState = eIdle;
 
-		unsigned long RxData;
+		uint32_t RxData;
 		char RxLen;
 
 		MsgHandler *Handler;
 		
-		uint32_t RequestSentAt;
-		bool isTimerActive = false;
-		uint32_t actTime;
+		MCDeadline RespDeadline;
 
 		bool hasMsgHandlerLocked = false;
+		uint16_t LockGrant = 0;
 				
 		uint8_t TORetryCounter = 0;
 		uint8_t TORetryMax = 1;
 		uint8_t BusyRetryCounter = 0;
 		uint8_t BusyRetryMax = 3;
+		
+		SDOMaxMsg BatchTxMsg;
+		SDOBatchEntry *BatchList;
+		uint8_t BatchCount = 0;
+		uint8_t BatchPending = 0;
+		uint8_t BatchInFlight = 0;
+		uint8_t BatchWindow = SDOBatchWindowDefault;
+		SDOCommStates BatchState = eIdle;
+		MCDeadline BatchDeadline;
+		uint8_t BatchTORetryCounter = 0;
+		bool hasBatchLocked = false;
+		uint16_t BatchLockGrant = 0;
+		bool isBatchAccess = false;
+		
+		//requests of a batch given up - late responses are dropped
+		uint16_t StaleIdx[SDOMaxBatch];
+		uint8_t StaleSubIdx[SDOMaxBatch];
+		uint8_t StaleCount = 0;
+		uint32_t StaleUntil = 0;
 };
  
 
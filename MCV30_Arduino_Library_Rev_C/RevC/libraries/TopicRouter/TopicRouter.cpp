@@ -0,0 +1,353 @@
+/*---------------------------------------------------
+ * TopicRouter.cpp
+ * implements the dispatching of the MQTT messages
+ * received by a trie of the topic levels
+ *
+ * 2026-10-18 AW Frame
+ *
+ *--------------------------------------------------------------*/
+
+//--- includes ---
+
+#include <TopicRouter.h>
+#include <string.h>
+
+//--- local defines ---
+
+#define DEBUG_ADD		0x0001
+#define DEBUG_UNMATCHED	0x0002
+
+#define DEBUG_ROUTER (DEBUG_UNMATCHED)
+
+//--- public functions ---
+
+/*---------------------------------------------------------------------
+ * TopicRouter()
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+TopicRouter::TopicRouter()
+{
+	Nodes[0].Level = NULL;
+	Nodes[0].Hash = 0;
+	Nodes[0].Len = 0;
+	Nodes[0].isWildcard = false;
+	Nodes[0].Child = TopicNoNode;
+	Nodes[0].Sibling = TopicNoNode;
+	Nodes[0].Route = TopicNoRoute;
+}
+
+/*---------------------------------------------------------------------
+ * uint8_t AddRoute(const char *Pattern, pfunction_holder *Cb)
+ * add a topic pattern - a level may be "+" to match any single level
+ * the handler gets a pointer to a TopicMatch
+ * returns the route or TopicNoRoute if the pattern is invalid, has
+ * been added already or there's no space left
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t TopicRouter::AddRoute(const char *Pattern, pfunction_holder *Cb)
+{
+	uint8_t Node = 0;
+	const char *Level = Pattern;
+
+	if((Pattern == NULL) || (NumRoutes >= TOPIC_ROUTER_MAX_ROUTES))
+		return TopicNoRoute;
+
+	while(true)
+	{
+		const char *End = strchr(Level, '/');
+		if(End == NULL)
+			End = Level + strlen(Level);
+
+		//multi level wildcards and "+" as part of a level aren't supported
+		for(const char *c = Level; c < End; c++)
+		{
+			if((*c == '#') || ((*c == '+') && ((End - Level) != 1)))
+				return TopicNoRoute;
+		}
+
+		if((End - Level) > 0xfe)
+			return TopicNoRoute;
+
+		Node = AddNode(Node, Level, (uint8_t)(End - Level));
+		if(Node == TopicNoNode)
+			return TopicNoRoute;
+
+		if(*End == '\0')
+			break;
+		Level = End + 1;
+	}
+
+	if(Nodes[Node].Route != TopicNoRoute)
+		return TopicNoRoute;
+
+	Nodes[Node].Route = NumRoutes;
+	Routes[NumRoutes].callback = Cb->callback;
+	Routes[NumRoutes].op = Cb->op;
+
+	#if(DEBUG_ROUTER & DEBUG_ADD)
+	Serial.print("TR: route ");
+	Serial.print(NumRoutes);
+	Serial.print(" ");
+	Serial.print(Pattern);
+	Serial.print(" nodes ");
+	Serial.println(NumNodes);
+	#endif
+
+	return NumRoutes++;
+}
+
+/*---------------------------------------------------------------------
+ * bool Dispatch(char *Topic, uint8_t *Payload, unsigned int Length)
+ * to be registered as the callback of the PubSubClient directly
+ * literal levels are preferred over a "+" of the same level
+ * returns false if no route matches
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool TopicRouter::Dispatch(char *Topic, uint8_t *Payload, unsigned int Length)
+{
+	TopicMatch ThisMatch;
+
+	ThisMatch.Topic = Topic;
+	ThisMatch.Payload = Payload;
+	ThisMatch.Len = (uint16_t)Length;
+	ThisMatch.Value = 0;
+	ThisMatch.hasValue = ParseValue(Payload, ThisMatch.Len, &ThisMatch.Value);
+	ThisMatch.Wildcards = 0;
+	ThisMatch.Route = TopicNoRoute;
+
+	if((Topic == NULL) || !Match(0, Topic, &ThisMatch))
+	{
+		#if(DEBUG_ROUTER & DEBUG_UNMATCHED)
+		Serial.print("TR: no route for ");
+		Serial.println(Topic);
+		#endif
+
+		Unmatched++;
+		return false;
+	}
+
+	Dispatched++;
+	if(Routes[ThisMatch.Route].callback != NULL)
+		Routes[ThisMatch.Route].callback(Routes[ThisMatch.Route].op, (void *)&ThisMatch);
+
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * static bool ParseValue(const uint8_t *Text, uint16_t Len, int32_t *Value)
+ * a decimal number with an optional sign - nothing else, the text
+ * needn't be terminated
+ * returns false if it isn't one or out of range
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool TopicRouter::ParseValue(const uint8_t *Text, uint16_t Len, int32_t *Value)
+{
+	uint16_t idx = 0;
+	bool isNegative = false;
+	uint32_t Abs = 0;
+	uint32_t Limit = 0x7fffffffUL;
+
+	if((Text == NULL) || (Len == 0))
+		return false;
+
+	if((Text[0] == '-') || (Text[0] == '+'))
+	{
+		isNegative = (Text[0] == '-');
+		if(isNegative)
+			Limit++;
+		idx++;
+	}
+
+	if(idx == Len)
+		return false;
+
+	for(; idx < Len; idx++)
+	{
+		uint8_t Digit = Text[idx] - '0';
+
+		if(Digit > 9)
+			return false;
+		if(Abs > ((Limit - Digit) / 10))
+			return false;
+		Abs = 10 * Abs + Digit;
+	}
+
+	*Value = isNegative ? (int32_t)(0 - Abs) : (int32_t)Abs;
+	return true;
+}
+
+/*---------------------------------------------------------------------
+ * static bool GetWildcardValue(TopicMatch *Match, uint8_t Idx, int32_t *Value)
+ * the level matched by the Idx-th "+" as a number - e.g. a node id
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool TopicRouter::GetWildcardValue(TopicMatch *ThisMatch, uint8_t Idx, int32_t *Value)
+{
+	if(Idx >= ThisMatch->Wildcards)
+		return false;
+
+	return ParseValue((const uint8_t *)ThisMatch->Wildcard[Idx], ThisMatch->WildcardLen[Idx], Value);
+}
+
+/*---------------------------------------------------------------------
+ * the counters
+ * NumNodes: levels of all the patterns incl. the root
+ * Dispatched: messages handed to a handler
+ * Unmatched: messages without a route
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t TopicRouter::GetNumNodes()
+{
+	return NumNodes;
+}
+
+uint32_t TopicRouter::GetDispatched()
+{
+	return Dispatched;
+}
+
+uint32_t TopicRouter::GetUnmatched()
+{
+	return Unmatched;
+}
+
+void TopicRouter::ResetCounters()
+{
+	Dispatched = 0;
+	Unmatched = 0;
+}
+
+//--- private functions ---
+
+/*---------------------------------------------------------------------
+ * uint8_t AddNode(uint8_t Parent, const char *Level, uint8_t Len)
+ * find the child of a level or add it - literal levels are added in
+ * front, a wildcard at the end so the literals are tried first
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint8_t TopicRouter::AddNode(uint8_t Parent, const char *Level, uint8_t Len)
+{
+	bool isWildcard = ((Len == 1) && (Level[0] == '+'));
+	uint16_t Hash = HashLevel(Level, Len);
+	uint8_t Last = TopicNoNode;
+
+	for(uint8_t Child = Nodes[Parent].Child; Child != TopicNoNode; Child = Nodes[Child].Sibling)
+	{
+		TopicNode *Node = &Nodes[Child];
+
+		if(isWildcard ? Node->isWildcard :
+		   (!Node->isWildcard && (Node->Hash == Hash) && (Node->Len == Len) && (memcmp(Node->Level, Level, Len) == 0)))
+			return Child;
+		Last = Child;
+	}
+
+	if(NumNodes >= TOPIC_ROUTER_MAX_NODES)
+		return TopicNoNode;
+
+	TopicNode *Node = &Nodes[NumNodes];
+
+	Node->Level = Level;
+	Node->Hash = Hash;
+	Node->Len = Len;
+	Node->isWildcard = isWildcard;
+	Node->Child = TopicNoNode;
+	Node->Route = TopicNoRoute;
+
+	if(isWildcard && (Last != TopicNoNode))
+	{
+		Node->Sibling = TopicNoNode;
+		Nodes[Last].Sibling = NumNodes;
+	}
+	else
+	{
+		Node->Sibling = Nodes[Parent].Child;
+		Nodes[Parent].Child = NumNodes;
+	}
+
+	return NumNodes++;
+}
+
+/*---------------------------------------------------------------------
+ * bool Match(uint8_t Parent, const char *Level, TopicMatch *ThisMatch)
+ * match the level of the topic and the ones following against the
+ * children of Parent - goes back to a "+" if a literal level leads
+ * to no route
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+bool TopicRouter::Match(uint8_t Parent, const char *Level, TopicMatch *ThisMatch)
+{
+	const char *End = strchr(Level, '/');
+	if(End == NULL)
+		End = Level + strlen(Level);
+
+	if((End - Level) > 0xfe)
+		return false;
+
+	uint8_t Len = (uint8_t)(End - Level);
+	uint16_t Hash = HashLevel(Level, Len);
+
+	for(uint8_t Child = Nodes[Parent].Child; Child != TopicNoNode; Child = Nodes[Child].Sibling)
+	{
+		TopicNode *Node = &Nodes[Child];
+
+		if(Node->isWildcard)
+		{
+			if(ThisMatch->Wildcards >= TOPIC_ROUTER_MAX_WILDCARDS)
+				continue;
+			ThisMatch->Wildcard[ThisMatch->Wildcards] = Level;
+			ThisMatch->WildcardLen[ThisMatch->Wildcards] = Len;
+			ThisMatch->Wildcards++;
+		}
+		else if((Node->Hash != Hash) || (Node->Len != Len) || (memcmp(Node->Level, Level, Len) != 0))
+			continue;
+
+		if(*End == '\0')
+		{
+			if(Node->Route != TopicNoRoute)
+			{
+				ThisMatch->Route = Node->Route;
+				return true;
+			}
+		}
+		else if(Match(Child, End + 1, ThisMatch))
+			return true;
+
+		if(Node->isWildcard)
+			ThisMatch->Wildcards--;
+	}
+
+	return false;
+}
+
+/*---------------------------------------------------------------------
+ * static uint16_t HashLevel(const char *Level, uint8_t Len)
+ * to skip most of the compares of the siblings
+ *
+ * 2026-10-18 AW Rev_A
+ *--------------------------------------------------------------------*/
+
+uint16_t TopicRouter::HashLevel(const char *Level, uint8_t Len)
+{
+	uint16_t Hash = Len;
+
+	for(uint8_t i = 0; i < Len; i++)
+		Hash = (Hash << 5) + Hash + (uint8_t)Level[i];
+
+	return Hash;
+}
@@ -0,0 +1,96 @@
+#ifndef TOPICROUTER_H
+#define TOPICROUTER_H
+
+/*--------------------------------------------------------------
+ * class TopicRouter
+ * dispatches the messages received by the MQTT client to handlers.
+ * The topic patterns are split into their levels once and kept as a
+ * trie, so a topic is matched level by level - the cost depends on
+ * the depth of the topic and the siblings of a level only, not on
+ * the number of patterns. A level "+" matches any single level,
+ * e.g. "Nano/MC/+/Ctrl/+" for the drive and the command. The levels
+ * matched by a "+" are handed to the handler as pointers into the
+ * topic. The payload isn't copied either: it is parsed in place as a
+ * numeric value if it is one.
+ * The patterns are not copied and have to be kept by the caller.
+ *
+ * 2026-10-18 AW Frame
+ *
+ *-------------------------------------------------------------*/
+
+//--- inlcudes ----
+
+#include <MC_Helpers.h>
+#include <stdint.h>
+
+//--- service define ---
+
+#ifndef TOPIC_ROUTER_MAX_NODES
+#define TOPIC_ROUTER_MAX_NODES 24
+#endif
+
+#ifndef TOPIC_ROUTER_MAX_ROUTES
+#define TOPIC_ROUTER_MAX_ROUTES 12
+#endif
+
+#ifndef TOPIC_ROUTER_MAX_WILDCARDS
+#define TOPIC_ROUTER_MAX_WILDCARDS 3
+#endif
+
+const uint8_t TopicNoRoute = 0xff;
+const uint8_t TopicNoNode = 0xff;
+
+typedef struct TopicNode {
+	const char *Level;		//not terminated - part of the pattern
+	uint16_t Hash;
+	uint8_t Len;
+	bool isWildcard;
+	uint8_t Child;			//first one
+	uint8_t Sibling;		//next one - the wildcard is the last one
+	uint8_t Route;
+} TopicNode;
+
+//handed to the handler - all pointers refer to the message received
+
+typedef struct TopicMatch {
+	const char *Topic;
+	const uint8_t *Payload;
+	uint16_t Len;
+	bool hasValue;			//the payload is a number
+	int32_t Value;
+	uint8_t Wildcards;
+	const char *Wildcard[TOPIC_ROUTER_MAX_WILDCARDS];
+	uint8_t WildcardLen[TOPIC_ROUTER_MAX_WILDCARDS];
+	uint8_t Route;
+} TopicMatch;
+
+class TopicRouter {
+	public:
+		TopicRouter();
+
+		uint8_t AddRoute(const char *, pfunction_holder *);
+		bool Dispatch(char *, uint8_t *, unsigned int);
+
+		static bool ParseValue(const uint8_t *, uint16_t, int32_t *);
+		static bool GetWildcardValue(TopicMatch *, uint8_t, int32_t *);
+
+		uint8_t GetNumNodes();
+		uint32_t GetDispatched();
+		uint32_t GetUnmatched();
+		void ResetCounters();
+
+	private:
+		uint8_t AddNode(uint8_t, const char *, uint8_t);
+		bool Match(uint8_t, const char *, TopicMatch *);
+		static uint16_t HashLevel(const char *, uint8_t);
+
+		TopicNode Nodes[TOPIC_ROUTER_MAX_NODES];
+		uint8_t NumNodes = 1;			//0 is the root
+		pfunction_holder Routes[TOPIC_ROUTER_MAX_ROUTES];
+		uint8_t NumRoutes = 0;
+
+		uint32_t Dispatched = 0;
+		uint32_t Unmatched = 0;
+};
+
+#endif